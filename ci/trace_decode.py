@@ -0,0 +1,111 @@
+#!/usr/bin/env python
+#
+# converts trace dumps of daisy::Tracer::Dump(), e.g. from a capture of the
+# USB serial port, into a Chrome trace JSON file. Open it at
+# https://ui.perfetto.dev or chrome://tracing
+#
+# Lines that don't belong to a dump are ignored, each dump in the capture
+# becomes a process of its own in the timeline.
+#
+import sys
+import json
+import argparse
+
+parser = argparse.ArgumentParser(description='Converts daisy trace dumps to Chrome trace JSON')
+parser.add_argument('input', nargs='?', help='captured serial output, stdin if omitted')
+parser.add_argument('-o', '--output', help='JSON file to write, stdout if omitted')
+args = parser.parse_args()
+
+PHASES = {'B', 'E', 'i', 'C'}
+
+
+def decode_records(hex_data):
+    """splits a data line into (tick, event, phase, value) tuples"""
+    records = []
+    for pos in range(0, len(hex_data) - 15, 16):
+        record = hex_data[pos:pos + 16]
+        records.append((int(record[0:8], 16),
+                        int(record[8:10], 16),
+                        chr(int(record[10:12], 16)),
+                        int(record[12:16], 16)))
+    return records
+
+
+def to_events(dump, pid):
+    """converts the records of a dump to Chrome trace events"""
+    events = [{'name': 'process_name', 'ph': 'M', 'pid': pid,
+               'args': {'name': 'daisy trace %d' % pid}}]
+    if dump['overwritten'] > 0:
+        sys.stderr.write('dump %d: %d older records were overwritten\n'
+                         % (pid, dump['overwritten']))
+
+    # the tick counter wraps around, consecutive records are close in time
+    time = 0
+    prev = None
+    timed = []
+    for tick, event, phase, value in dump['records']:
+        if prev is not None:
+            delta = (tick - prev) & 0xffffffff
+            if delta >= 0x80000000:
+                delta -= 0x100000000
+            time += delta
+        prev = tick
+        timed.append((time, event, phase, value))
+    # records can be slightly out of order when an interrupt got in between
+    # reading the tick and storing the record
+    timed.sort(key=lambda record: record[0])
+
+    start = timed[0][0] if timed else 0
+    for time, event, phase, value in timed:
+        if phase not in PHASES:
+            continue
+        name = dump['names'].get(event, 'event %d' % event)
+        entry = {'name': name, 'ph': phase, 'pid': pid, 'tid': 0,
+                 'ts': (time - start) * 1e6 / dump['freq']}
+        if phase == 'C':
+            entry['args'] = {name: value}
+        elif phase != 'E':
+            entry['args'] = {'value': value}
+        if phase == 'i':
+            entry['s'] = 't'
+        events.append(entry)
+    return events
+
+
+if args.input:
+    with open(args.input, errors='replace') as f:
+        lines = f.read().splitlines()
+else:
+    lines = sys.stdin.read().splitlines()
+
+events = []
+dump = None
+num_dumps = 0
+for line in lines:
+    fields = line.strip().split()
+    if len(fields) < 2 or fields[0] != '#trace':
+        continue
+    if fields[1] == 'start' and len(fields) >= 5:
+        dump = {'freq': float(fields[2]), 'overwritten': int(fields[4]),
+                'names': {}, 'records': []}
+    elif dump is None:
+        continue
+    elif fields[1] == 'event' and len(fields) >= 4:
+        dump['names'][int(fields[2])] = fields[3]
+    elif fields[1] == 'data' and len(fields) >= 3:
+        dump['records'] += decode_records(fields[2])
+    elif fields[1] == 'end':
+        num_dumps += 1
+        events += to_events(dump, num_dumps)
+        dump = None
+
+if num_dumps == 0:
+    sys.stderr.write('no complete trace dump found\n')
+    quit(1)
+
+output = json.dumps({'traceEvents': events, 'displayTimeUnit': 'ns'}, indent=1)
+if args.output:
+    with open(args.output, 'w') as f:
+        f.write(output)
+else:
+    print(output)
@@ -39,6 +39,7 @@
 #include "hid/disp/oled_display.h"
 #include "hid/disp/graphics_common.h"
 #include "hid/wavplayer.h"
+#include "hid/wavstreamer.h"
 #include "hid/led.h"
 #include "hid/rgb_led.h"
 #include "dev/sr_595.h"
@@ -62,13 +63,23 @@
 #include "ui/FullScreenItemMenu.h"
 #include "util/scopedirqblocker.h"
 #include "util/CpuLoadMeter.h"
+#include "util/CpuLoadProfiler.h"
 #include "util/FIFO.h"
 #include "util/FixedCapStr.h"
 #include "util/MappedValue.h"
 #include "util/PersistentStorage.h"
+#include "util/SampleConversion.h"
+#include "util/SpscQueue.h"
+#include "util/AudioGraph.h"
 #include "util/Stack.h"
 #include "util/VoctCalibration.h"
 #include "util/WaveTableLoader.h"
+#include "util/WavParser.h"
+#include "util/DeferredFormat.h"
+#include "util/LogRing.h"
+#include "util/Trace.h"
 #include "util/WavWriter.h"
+#include "util/DoubleBuffer.h"
+#include "util/SensorPoller.h"
 #endif
 #endif
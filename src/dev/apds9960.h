@@ -2,6 +2,8 @@
 #ifndef DSY_APDS9960_H
 #define DSY_APDS9960_H
 
+#include "util/SensorPoller.h"
+
 #define APDS9960_ADDRESS (0x39) /**< I2C Address */
 
 #define APDS9960_UP 0x01    /**< Gesture Up */
@@ -119,8 +121,22 @@ class Apds9960I2CTransport
                != i2c_.ReceiveBlocking(APDS9960_ADDRESS, data, size, 10);
     }
 
+    /** Starts reading from a reg address with a DMA, see SensorPoller
+        \return false if the read couldn't be started or queued
+    */
+    bool DmaReadReg(uint8_t            reg,
+                    uint8_t           *buff,
+                    uint16_t           size,
+                    SensorPollCallback callback,
+                    void              *context)
+    {
+        return dma_reader_.ReadRegisters(
+            i2c_, APDS9960_ADDRESS, reg, buff, size, callback, context);
+    }
+
   private:
-    I2CHandle i2c_;
+    I2CHandle           i2c_;
+    SensorPollI2CReader dma_reader_;
 };
 
 /** @brief Device support for APDS9960
@@ -174,6 +190,17 @@ class Apds9960
         ERR
     };
 
+    /** Readings decoded from a SensorPoller read */
+    struct PolledData
+    {
+        uint8_t  status;    /**< the STATUS register */
+        uint16_t clear;     /**< raw clear channel value */
+        uint16_t red;       /**< raw red channel value */
+        uint16_t green;     /**< raw green channel value */
+        uint16_t blue;      /**< raw blue channel value */
+        uint8_t  proximity; /**< proximity data */
+    };
+
     // turn on/off elements
     void enable(bool en = true);
     /** Initialize the APDS9960 device
@@ -686,13 +713,56 @@ class Apds9960
         *b = GetColorDataBlue();
     }
 
+    /** The status, color and proximity registers. Gestures are read from
+        the gesture FIFO and aren't polled.
+    */
+    SensorPollWindow GetPollWindow() const
+    {
+        return {APDS9960_STATUS,
+                APDS9960_PDATA - APDS9960_STATUS + 1,
+                config_.integrationTimeMs};
+    }
+
+    /** Starts reading the poll window with a DMA, called by a SensorPoller */
+    bool
+    StartPollRead(uint8_t *buff, SensorPollCallback callback, void *context)
+    {
+        return transport_.DmaReadReg(APDS9960_STATUS,
+                                     buff,
+                                     APDS9960_PDATA - APDS9960_STATUS + 1,
+                                     callback,
+                                     context);
+    }
+
+    /** Decodes the poll window, called by a SensorPoller when the read has
+        finished. The readings are published for GetPolledData().
+    */
+    void DecodePoll(const uint8_t *regs)
+    {
+        PolledData data;
+        data.status    = regs[0];
+        data.clear     = (regs[2] << 8) | regs[1];
+        data.red       = (regs[4] << 8) | regs[3];
+        data.green     = (regs[6] << 8) | regs[5];
+        data.blue      = (regs[8] << 8) | regs[7];
+        data.proximity = regs[9];
+        polled_.Write(data);
+    }
+
+    /** Get the latest readings of a SensorPoller, lock-free
+        \param data receives the readings
+        \return false if there weren't any yet
+    */
+    bool GetPolledData(PolledData &data) const { return polled_.Read(data); }
+
   private:
     uint8_t gestCnt_, UCount_, DCount_, LCount_, RCount_; // counters
     uint8_t gestureReceived_;
     bool    transport_error_;
 
-    Config    config_;
-    Transport transport_;
+    Config                   config_;
+    Transport                transport_;
+    DoubleBuffer<PolledData> polled_;
 
     /** Set the global transport_error_ bool */
     void SetTransportErr(bool err) { transport_error_ |= err; }
@@ -4,6 +4,10 @@
 
 #include "per/i2c.h"
 #include "per/spi.h"
+#include "util/color.h"
+#include "util/scopedirqblocker.h"
+#include <algorithm>
+#include <string.h>
 
 namespace daisy
 {
@@ -53,12 +57,49 @@ class DotStarSpiTransport
         return spi_.BlockingTransmit(data, size) == SpiHandle::Result::OK;
     };
 
+    /** Called when a DMA transfer finished, from the SPI interrupt */
+    typedef void (*DmaCallback)(void *context, bool success);
+
+    /** Writes data with DMA and returns right away. The data has to be in
+     *  memory the DMA can access, e.g. DMA_BUFFER_MEM_SECTION, and stay
+     *  untouched until the callback. Transfers are queued by the SpiHandle
+     *  and finish in order.
+     *  \return false if the transfer couldn't be queued
+     */
+    bool
+    DmaWrite(uint8_t *data, size_t size, DmaCallback callback, void *context)
+    {
+        dma_callback_         = callback;
+        dma_callback_context_ = context;
+        return spi_.DmaTransmit(data, size, nullptr, &DmaWriteDone, this)
+               == SpiHandle::Result::OK;
+    }
+
   private:
-    SpiHandle spi_;
+    static void DmaWriteDone(void *context, SpiHandle::Result result)
+    {
+        auto transport = static_cast<DotStarSpiTransport *>(context);
+        if(transport->dma_callback_)
+            transport->dma_callback_(transport->dma_callback_context_,
+                                     result == SpiHandle::Result::OK);
+    }
+
+    SpiHandle   spi_;
+    DmaCallback dma_callback_         = nullptr;
+    void       *dma_callback_context_ = nullptr;
 };
 
 
 /** \brief Device support for Adafruit DotStar LEDs (Opsco SK9822)
+    \details The pixels are kept in a buffer laid out exactly like the data
+             on the wire: the start frame, the pixels and the end frame.
+             Show() sends all of it in a single transfer.
+
+             With a DmaBuffer in the Config, Show() copies the frame into
+             one of its two halves and sends it with DMA in the background,
+             so the next frame can be drawn while the previous one is still
+             going out. This needs a transport with DmaWrite(), like the
+             DotStarSpiTransport.
     \author Nick Donaldson
     \date March 2023
 */
@@ -66,11 +107,28 @@ template <typename Transport>
 class DotStar
 {
   public:
+    static const size_t kMaxNumPixels  = 64;
+    static const size_t kStartFrameLen = 4;
+    /** The end frame clocks the data through all pixels, which takes half a
+     *  clock per pixel, but at least 32 clocks for the SK9822.
+     */
+    static const size_t kMaxEndFrameLen
+        = std::max<size_t>(4, (kMaxNumPixels + 15) / 16);
+    static const size_t kMaxWireLen
+        = kStartFrameLen + 4 * kMaxNumPixels + kMaxEndFrameLen;
+
+    /** Two wire buffers for sending frames with DMA. It has to be placed in
+     *  memory the DMA can access, e.g. like this:
+     *      DotStarSpi::DmaBuffer DMA_BUFFER_MEM_SECTION buffer;
+     */
+    using DmaBuffer = uint8_t[2][kMaxWireLen];
+
     enum class Result
     {
         OK,
         ERR_INVALID_ARGUMENT,
-        ERR_TRANSPORT
+        ERR_TRANSPORT,
+        ERR_BUSY
     };
 
     struct Config
@@ -90,12 +148,14 @@ class DotStar
                    transport_config; /**< Transport-specific configuration */
         ColorOrder color_order;      /**< Pixel color channel ordering */
         uint16_t   num_pixels;       /**< Number of pixels/LEDs (max 64) */
+        DmaBuffer *dma_buffer;       /**< Show() with DMA if set */
 
         void Defaults()
         {
             transport_config.Defaults();
             color_order = ColorOrder::RGB;
             num_pixels  = 1;
+            dma_buffer  = nullptr;
         };
     };
 
@@ -110,6 +170,18 @@ class DotStar
         }
         transport_.Init(config.transport_config);
         num_pixels_ = config.num_pixels;
+        dma_buffer_ = config.dma_buffer;
+
+        next_dma_half_ = 0;
+        num_in_flight_ = 0;
+        dma_error_     = false;
+
+        // start frame of zeros, end frame of ones
+        const size_t end_frame_len
+            = std::max<size_t>(4, (num_pixels_ + 15) / 16);
+        wire_len_ = kStartFrameLen + 4 * num_pixels_ + end_frame_len;
+        memset(wire_, 0x00, kStartFrameLen);
+        memset(&wire_[wire_len_ - end_frame_len], 0xFF, end_frame_len);
         // first color byte is always global brightness (hence +1 offset)
         r_offset_ = ((config.color_order >> 4) & 0b11) + 1;
         g_offset_ = ((config.color_order >> 2) & 0b11) + 1;
@@ -157,17 +229,17 @@ class DotStar
         {
             return Result::ERR_INVALID_ARGUMENT;
         }
-        uint8_t *pixel = (uint8_t *)(&pixels_[idx]);
+        uint8_t *pixel = GetPixel(idx);
         pixel[0]       = 0xE0 | std::min(b, (uint16_t)31);
         return Result::OK;
     };
 
-    uint16_t GetPixelColor(uint16_t idx)
+    uint32_t GetPixelColor(uint16_t idx)
     {
         if(idx >= num_pixels_)
             return 0;
         uint32_t       c     = 0;
-        const uint8_t *pixel = (uint8_t *)&pixels_[idx];
+        const uint8_t *pixel = GetPixel(idx);
         c                    = c | (pixel[r_offset_] << 16);
         c                    = c | (pixel[g_offset_] << 8);
         c                    = c | pixel[b_offset_];
@@ -211,7 +283,7 @@ class DotStar
         {
             return Result::ERR_INVALID_ARGUMENT;
         }
-        uint8_t *pixel   = (uint8_t *)(&pixels_[idx]);
+        uint8_t *pixel   = GetPixel(idx);
         pixel[r_offset_] = r;
         pixel[b_offset_] = b;
         pixel[g_offset_] = g;
@@ -268,35 +340,74 @@ class DotStar
         }
     };
 
-    /** \brief Writes current pixel buffer data to LEDs */
+    /** \brief Writes current pixel buffer data to LEDs
+     *  \details With a DmaBuffer, this returns as soon as the frame is
+     *           queued. It never waits for the DMA.
+     *  \return ERR_BUSY if both halves of the DmaBuffer are still being
+     *          sent, the frame isn't sent then. ERR_TRANSPORT if the
+     *          transfer couldn't be started, or if a DMA transfer failed
+     *          since the last call
+     */
     Result Show()
     {
-        uint8_t sf[4] = {0x00, 0x00, 0x00, 0x00};
-        uint8_t ef[4] = {0xFF, 0xFF, 0xFF, 0xFF};
-        if(!transport_.Write(sf, 4))
+        if(dma_buffer_ == nullptr)
         {
-            return Result::ERR_TRANSPORT;
+            return transport_.Write(wire_, wire_len_) ? Result::OK
+                                                      : Result::ERR_TRANSPORT;
         }
-        for(uint16_t i = 0; i < num_pixels_; i++)
+
+        // transfers finish in order, the older one uses the other half
+        if(num_in_flight_ >= 2)
+            return Result::ERR_BUSY;
+
+        uint8_t *tx = (*dma_buffer_)[next_dma_half_];
+        memcpy(tx, wire_, wire_len_);
         {
-            if(!transport_.Write((uint8_t *)&pixels_[i], 4))
-            {
-                return Result::ERR_TRANSPORT;
-            }
+            ScopedIrqBlocker block;
+            num_in_flight_ = num_in_flight_ + 1;
         }
-        if(!transport_.Write(ef, 4))
+        if(!transport_.DmaWrite(tx, wire_len_, &DmaWriteDone, this))
         {
+            ScopedIrqBlocker block;
+            num_in_flight_ = num_in_flight_ - 1;
             return Result::ERR_TRANSPORT;
         }
-        return Result::OK;
+        next_dma_half_ ^= 1;
+
+        const bool error = dma_error_;
+        dma_error_       = false;
+        return error ? Result::ERR_TRANSPORT : Result::OK;
     };
 
-  private:
-    static const size_t kMaxNumPixels = 64;
-    Transport           transport_;
-    uint16_t            num_pixels_;
-    uint32_t            pixels_[kMaxNumPixels];
-    uint8_t             r_offset_, g_offset_, b_offset_;
+    /** \return true while frames are being sent with DMA */
+    bool IsTransmitting() const { return num_in_flight_ > 0; }
+
+  protected:
+    uint8_t *GetPixel(uint16_t idx)
+    {
+        return &wire_[kStartFrameLen + 4 * idx];
+    }
+
+    static void DmaWriteDone(void *context, bool success)
+    {
+        auto dotstar            = static_cast<DotStar *>(context);
+        dotstar->num_in_flight_ = dotstar->num_in_flight_ - 1;
+        if(!success)
+            dotstar->dma_error_ = true;
+    }
+
+    Transport transport_;
+    uint16_t  num_pixels_;
+    uint8_t   r_offset_, g_offset_, b_offset_;
+
+    /** start frame, pixels and end frame, as sent on the wire */
+    uint8_t wire_[kMaxWireLen];
+    size_t  wire_len_;
+
+    DmaBuffer       *dma_buffer_;
+    uint8_t          next_dma_half_;
+    volatile uint8_t num_in_flight_;
+    volatile bool    dma_error_;
 };
 
 using DotStarSpi = DotStar<DotStarSpiTransport>;
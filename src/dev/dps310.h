@@ -2,6 +2,8 @@
 #ifndef DSY_DPS310_H
 #define DSY_DPS310_H
 
+#include "util/SensorPoller.h"
+
 #define DPS310_I2CADDR_DEFAULT (0x77) ///< Default breakout addres
 
 #define DPS310_PRSB2 0x00       ///< Highest byte of pressure data
@@ -133,6 +135,19 @@ class Dps310I2CTransport
                | uint32_t(buffer[2]);
     }
 
+    /** Starts reading from a reg address with a DMA, see SensorPoller
+        \return false if the read couldn't be started or queued
+    */
+    bool DmaReadReg(uint8_t            reg,
+                    uint8_t           *buff,
+                    uint16_t           size,
+                    SensorPollCallback callback,
+                    void              *context)
+    {
+        return dma_reader_.ReadRegisters(
+            i2c_, config_.address, reg, buff, size, callback, context);
+    }
+
     bool GetError()
     {
         bool tmp = error_;
@@ -141,8 +156,9 @@ class Dps310I2CTransport
     }
 
   private:
-    I2CHandle i2c_;
-    Config    config_;
+    I2CHandle           i2c_;
+    Config              config_;
+    SensorPollI2CReader dma_reader_;
 
     // true if error has occured since last check
     bool error_;
@@ -337,6 +353,13 @@ class Dps310
         ERR
     };
 
+    /** Readings decoded from a SensorPoller read */
+    struct PolledData
+    {
+        float temperature; /**< in degrees Centigrade */
+        float pressure;    /**< in hPa */
+    };
+
     /** Initialize the Dps310 device
         \param config Configuration settings
     */
@@ -477,6 +500,7 @@ class Dps310
     {
         WriteBits(DPS310_PRSCFG, rate, 3, 4);
         WriteBits(DPS310_PRSCFG, os, 4, 0);
+        pressure_rate_ = rate;
 
         if(os > DPS310_8SAMPLES)
         {
@@ -525,23 +549,47 @@ class Dps310
         raw_temperature = twosComplement(Read24(DPS310_TMPB2), 24);
         raw_pressure    = twosComplement(Read24(DPS310_PRSB2), 24);
 
-        _scaled_rawtemp = (float)raw_temperature / temp_scale;
-        _temperature    = _scaled_rawtemp * _c1 + _c0 / 2.0;
+        Compensate(raw_temperature, raw_pressure, _temperature, _pressure);
+    }
 
-        _pressure = (float)raw_pressure / pressure_scale;
+    /** The pressure and temperature registers, read once per measurement */
+    SensorPollWindow GetPollWindow() const
+    {
+        return {DPS310_PRSB2, 6, 1000u >> pressure_rate_};
+    }
 
-        _pressure
-            = (int32_t)_c00
-              + _pressure
-                    * ((int32_t)_c10
-                       + _pressure
-                             * ((int32_t)_c20 + _pressure * (int32_t)_c30))
-              + _scaled_rawtemp
-                    * ((int32_t)_c01
-                       + _pressure
-                             * ((int32_t)_c11 + _pressure * (int32_t)_c21));
+    /** Starts reading the poll window with a DMA, called by a SensorPoller.
+        Only supported by the I2C transport.
+    */
+    bool
+    StartPollRead(uint8_t *buff, SensorPollCallback callback, void *context)
+    {
+        return transport_.DmaReadReg(
+            DPS310_PRSB2, buff, 6, callback, context);
     }
 
+    /** Decodes the poll window, called by a SensorPoller when the read has
+        finished. The readings are published for GetPolledData().
+    */
+    void DecodePoll(const uint8_t *regs)
+    {
+        const int32_t raw_prs = twosComplement(
+            uint32_t(regs[0]) << 16 | uint32_t(regs[1]) << 8 | regs[2], 24);
+        const int32_t raw_temp = twosComplement(
+            uint32_t(regs[3]) << 16 | uint32_t(regs[4]) << 8 | regs[5], 24);
+
+        PolledData data;
+        Compensate(raw_temp, raw_prs, data.temperature, data.pressure);
+        data.pressure /= 100;
+        polled_.Write(data);
+    }
+
+    /** Get the latest readings of a SensorPoller, lock-free
+        \param data receives the readings
+        \return false if there weren't any yet
+    */
+    bool GetPolledData(PolledData &data) const { return polled_.Read(data); }
+
     /** Get last temperature reading
         \return temp in degrees Centigrade
     */
@@ -643,8 +691,35 @@ class Dps310
     int32_t _c00, _c10;
 
     int32_t raw_pressure, raw_temperature;
-    float   _temperature, _scaled_rawtemp, _pressure;
+    float   _temperature, _pressure;
     int32_t temp_scale, pressure_scale;
+    uint8_t pressure_rate_ = DPS310_64HZ;
+
+    DoubleBuffer<PolledData> polled_;
+
+    /** Applies the calibration coefficients to raw readings
+        \param temperature receives the temperature in degrees Centigrade
+        \param pressure receives the pressure in Pa
+    */
+    void Compensate(int32_t raw_temp,
+                    int32_t raw_prs,
+                    float  &temperature,
+                    float  &pressure) const
+    {
+        const float scaled_rawtemp = (float)raw_temp / temp_scale;
+        temperature                = scaled_rawtemp * _c1 + _c0 / 2.0;
+
+        pressure = (float)raw_prs / pressure_scale;
+
+        pressure
+            = (int32_t)_c00
+              + pressure
+                    * ((int32_t)_c10
+                       + pressure * ((int32_t)_c20 + pressure * (int32_t)_c30))
+              + scaled_rawtemp
+                    * ((int32_t)_c01
+                       + pressure * ((int32_t)_c11 + pressure * (int32_t)_c21));
+    }
 };
 
 /** @} */
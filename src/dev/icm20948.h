@@ -2,6 +2,9 @@
 #ifndef DSY_ICM20948_H
 #define DSY_ICM20948_H
 
+#include "util/SensorPoller.h"
+#include "util/SpscQueue.h"
+
 // Misc configuration macros
 #define I2C_MASTER_RESETS_BEFORE_FAIL \
     5 ///< The number of times to try resetting a stuck I2C master before giving up
@@ -21,6 +24,13 @@
 #define ICM20X_B0_PWR_MGMT_1 0x06   ///< primary power management register
 #define ICM20X_B0_ACCEL_XOUT_H 0x2D ///< first byte of accel data
 #define ICM20X_B0_GYRO_XOUT_H 0x33  ///< first byte of accel data
+#define ICM20X_B0_REG_INT_ENABLE_3 0x13 ///< FIFO watermark interrupt enable
+#define ICM20X_B0_FIFO_EN_1 0x66        ///< Slave FIFO enables
+#define ICM20X_B0_FIFO_EN_2 0x67        ///< Accel, gyro and temp FIFO enables
+#define ICM20X_B0_FIFO_RST 0x68         ///< FIFO reset
+#define ICM20X_B0_FIFO_MODE 0x69        ///< FIFO stream or snapshot mode
+#define ICM20X_B0_FIFO_COUNTH 0x70      ///< FIFO byte count MSB, LSB follows
+#define ICM20X_B0_FIFO_R_W 0x72         ///< FIFO read port
 
 // Bank 2
 #define ICM20X_B2_GYRO_SMPLRT_DIV 0x00    ///< Gyroscope data rate divisor
@@ -178,6 +188,19 @@ class Icm20948I2CTransport
         return buffer;
     }
 
+    /** Starts reading from a reg address with a DMA, see SensorPoller
+        \return false if the read couldn't be started or queued
+    */
+    bool DmaReadReg(uint8_t            reg,
+                    uint8_t           *buff,
+                    uint16_t           size,
+                    SensorPollCallback callback,
+                    void              *context)
+    {
+        return dma_reader_.ReadRegisters(
+            i2c_, config_.address, reg, buff, size, callback, context);
+    }
+
     bool GetError()
     {
         bool tmp = error_;
@@ -186,8 +209,9 @@ class Icm20948I2CTransport
     }
 
   private:
-    I2CHandle i2c_;
-    Config    config_;
+    I2CHandle           i2c_;
+    Config              config_;
+    SensorPollI2CReader dma_reader_;
 
     // true if error has occured since last check
     bool error_;
@@ -316,7 +340,14 @@ template <typename Transport>
 class Icm20948
 {
   public:
-    Icm20948() {}
+    // the rate divisors are 0 after a reset of the chip
+    Icm20948()
+    : fifo_frame_size_(0),
+      num_fifo_overflows_(0),
+      accel_rate_divisor_(0),
+      gyro_rate_divisor_(0)
+    {
+    }
     ~Icm20948() {}
 
     struct Config
@@ -333,6 +364,54 @@ class Icm20948
         float z;
     };
 
+    /** Readings decoded from a SensorPoller read, in the units of
+        GetAccelVect(), GetGyroVect(), GetMagVect() and GetTemp()
+    */
+    struct PolledData
+    {
+        Icm20948Vect accel;
+        Icm20948Vect gyro;
+        Icm20948Vect mag;
+        float        temp;
+    };
+
+    /** The sensors written to the on-chip FIFO, see SetupFifo() */
+    struct FifoConfig
+    {
+        bool accel; /**< accelerometer, 6 bytes per frame */
+        bool gyro;  /**< gyro, 6 bytes per frame */
+        bool temp;  /**< temperature, 2 bytes per frame */
+        /** the magnetometer data of the I2C master, 9 bytes per frame.
+            Requires SetupMag(). */
+        bool mag;
+        /** pulse the INT pin when the FIFO reaches its watermark */
+        bool watermark_interrupt;
+
+        FifoConfig()
+        : accel(true),
+          gyro(true),
+          temp(false),
+          mag(false),
+          watermark_interrupt(false)
+        {
+        }
+    };
+
+    /** A sample read from the FIFO, in the units of GetAccelVect(),
+        GetGyroVect(), GetMagVect() and GetTemp(). The readings of sensors
+        that aren't written to the FIFO are zero.
+    */
+    struct FifoSample
+    {
+        /** System::GetUs() time the sample was taken, estimated from the
+            time of the read and the sample rate */
+        uint32_t     timestamp_us;
+        Icm20948Vect accel;
+        Icm20948Vect gyro;
+        Icm20948Vect mag;
+        float        temp;
+    };
+
     /** The accelerometer data range */
     enum icm20948_accel_range_t
     {
@@ -500,15 +579,13 @@ class Icm20948
         return WriteExternalRegister(0x0C, mag_reg_addr, value);
     }
 
-    void ScaleValues()
+    /** \return the number of LSBs per degree per second */
+    float GetGyroScale() const
     {
         icm20948_gyro_range_t gyro_range
             = (icm20948_gyro_range_t)current_gyro_range_;
-        icm20948_accel_range_t accel_range
-            = (icm20948_accel_range_t)current_accel_range_;
 
-        float accel_scale = 1.0;
-        float gyro_scale  = 1.0;
+        float gyro_scale = 1.0;
 
         if(gyro_range == ICM20948_GYRO_RANGE_250_DPS)
             gyro_scale = 131.0;
@@ -519,6 +596,17 @@ class Icm20948
         if(gyro_range == ICM20948_GYRO_RANGE_2000_DPS)
             gyro_scale = 16.4;
 
+        return gyro_scale;
+    }
+
+    /** \return the number of LSBs per g */
+    float GetAccelScale() const
+    {
+        icm20948_accel_range_t accel_range
+            = (icm20948_accel_range_t)current_accel_range_;
+
+        float accel_scale = 1.0;
+
         if(accel_range == ICM20948_ACCEL_RANGE_2_G)
             accel_scale = 16384.0;
         if(accel_range == ICM20948_ACCEL_RANGE_4_G)
@@ -528,6 +616,14 @@ class Icm20948
         if(accel_range == ICM20948_ACCEL_RANGE_16_G)
             accel_scale = 2048.0;
 
+        return accel_scale;
+    }
+
+    void ScaleValues()
+    {
+        const float accel_scale = GetAccelScale();
+        const float gyro_scale  = GetGyroScale();
+
         gyroX = rawGyroX / gyro_scale;
         gyroY = rawGyroY / gyro_scale;
         gyroZ = rawGyroZ / gyro_scale;
@@ -546,6 +642,7 @@ class Icm20948
     */
     void SetAccelRateDivisor(uint16_t new_accel_divisor)
     {
+        accel_rate_divisor_ = new_accel_divisor;
         SetBank(2);
         Write16(ICM20X_B2_ACCEL_SMPLRT_DIV_1, new_accel_divisor);
         SetBank(0);
@@ -595,6 +692,7 @@ class Icm20948
     */
     void SetGyroRateDivisor(uint8_t new_gyro_divisor)
     {
+        gyro_rate_divisor_ = new_gyro_divisor;
         SetBank(2);
         Write8(ICM20X_B2_GYRO_SMPLRT_DIV, new_gyro_divisor);
         SetBank(0);
@@ -800,6 +898,242 @@ class Icm20948
         SetBank(0);
     }
 
+    /** Accel, gyro, temp and the magnetometer data of the I2C master, like
+        Process(). The registers are in bank 0, so don't switch banks while
+        polling.
+    */
+    SensorPollWindow GetPollWindow() const
+    {
+        return {ICM20X_B0_ACCEL_XOUT_H, kPollWindowSize, 10};
+    }
+
+    /** Starts reading the poll window with a DMA, called by a SensorPoller.
+        Only supported by the I2C transport.
+    */
+    bool
+    StartPollRead(uint8_t *buff, SensorPollCallback callback, void *context)
+    {
+        return transport_.DmaReadReg(
+            ICM20X_B0_ACCEL_XOUT_H, buff, kPollWindowSize, callback, context);
+    }
+
+    /** Decodes the poll window, called by a SensorPoller when the read has
+        finished. The readings are published for GetPolledData().
+    */
+    void DecodePoll(const uint8_t *regs)
+    {
+        const float accel_scale = GetAccelScale();
+        const float gyro_scale  = GetGyroScale();
+
+        PolledData data;
+        data.accel.x = int16_t(regs[0] << 8 | regs[1]) / accel_scale;
+        data.accel.y = int16_t(regs[2] << 8 | regs[3]) / accel_scale;
+        data.accel.z = int16_t(regs[4] << 8 | regs[5]) / accel_scale;
+        data.accel.x *= SENSORS_GRAVITY_EARTH;
+        data.accel.y *= SENSORS_GRAVITY_EARTH;
+        data.accel.z *= SENSORS_GRAVITY_EARTH;
+
+        data.gyro.x = int16_t(regs[6] << 8 | regs[7]) / gyro_scale;
+        data.gyro.y = int16_t(regs[8] << 8 | regs[9]) / gyro_scale;
+        data.gyro.z = int16_t(regs[10] << 8 | regs[11]) / gyro_scale;
+        data.gyro.x *= SENSORS_DPS_TO_RADS;
+        data.gyro.y *= SENSORS_DPS_TO_RADS;
+        data.gyro.z *= SENSORS_DPS_TO_RADS;
+
+        data.temp = (int16_t(regs[12] << 8 | regs[13]) / 333.87) + 21.0;
+
+        // Mag data is read little endian
+        data.mag.x = int16_t(regs[16] << 8 | regs[15]) * ICM20948_UT_PER_LSB;
+        data.mag.y = int16_t(regs[18] << 8 | regs[17]) * ICM20948_UT_PER_LSB;
+        data.mag.z = int16_t(regs[20] << 8 | regs[19]) * ICM20948_UT_PER_LSB;
+
+        polled_.Write(data);
+    }
+
+    /** Get the latest readings of a SensorPoller, lock-free
+        \param data receives the readings
+        \return false if there weren't any yet
+    */
+    bool GetPolledData(PolledData &data) const { return polled_.Read(data); }
+
+    /** Writes samples of the selected sensors to the on-chip FIFO at the
+        sample rate, see SetGyroRateDivisor() and SetAccelRateDivisor().
+        ReadFifo() then fetches many samples with a few burst reads, instead
+        of one Process() per sample.
+        With the accelerometer and the gyro, set both rate divisors so that
+        they run at the same rate.
+        \param config the sensors to write to the FIFO
+        \return ERR if no sensor was selected or the transport failed
+    */
+    Result SetupFifo(const FifoConfig &config)
+    {
+        SetBank(0);
+
+        // stop writing to the FIFO while it's set up
+        Write8(ICM20X_B0_FIFO_EN_1, 0);
+        Write8(ICM20X_B0_FIFO_EN_2, 0);
+
+        fifo_config_     = config;
+        fifo_frame_size_ = (config.accel ? 6 : 0) + (config.gyro ? 6 : 0)
+                           + (config.temp ? 2 : 0) + (config.mag ? 9 : 0);
+        if(fifo_frame_size_ == 0)
+            return ERR;
+
+        WriteBits(ICM20X_B0_USER_CTRL, 1, 1, 6);
+        // snapshot mode: a full FIFO keeps its contents, see ReadFifo()
+        Write8(ICM20X_B0_FIFO_MODE, 0x1F);
+        Write8(ICM20X_B0_REG_INT_ENABLE_3,
+               config.watermark_interrupt ? 0x01 : 0x00);
+        ResetFifo();
+
+        Write8(ICM20X_B0_FIFO_EN_1, config.mag ? 0x01 : 0x00);
+        Write8(ICM20X_B0_FIFO_EN_2,
+               (config.accel ? 0x10 : 0x00) | (config.gyro ? 0x0E : 0x00)
+                   | (config.temp ? 0x01 : 0x00));
+
+        return GetTransportError();
+    }
+
+    /** Stops writing to the FIFO and disables it */
+    void DisableFifo()
+    {
+        SetBank(0);
+        Write8(ICM20X_B0_FIFO_EN_1, 0);
+        Write8(ICM20X_B0_FIFO_EN_2, 0);
+        Write8(ICM20X_B0_REG_INT_ENABLE_3, 0);
+        WriteBits(ICM20X_B0_USER_CTRL, 0, 1, 6);
+        ResetFifo();
+        fifo_frame_size_ = 0;
+    }
+
+    /** Discards the contents of the FIFO */
+    void ResetFifo()
+    {
+        SetBank(0);
+        Write8(ICM20X_B0_FIFO_RST, 0x1F);
+        Write8(ICM20X_B0_FIFO_RST, 0x00);
+    }
+
+    /** \return the number of bytes in the FIFO */
+    uint16_t GetFifoCount()
+    {
+        uint8_t buffer[2];
+        SetBank(0);
+        ReadReg(ICM20X_B0_FIFO_COUNTH, buffer, 2);
+        return (buffer[0] & 0x1F) << 8 | buffer[1];
+    }
+
+    /** Drains the FIFO with burst reads and decodes all complete samples
+        in one go. Samples that don't fit into the queue stay in the FIFO
+        for the next call.
+        Call this often enough that the FIFO doesn't run full, e.g. from the
+        main loop or when the watermark interrupt fires. A full FIFO is
+        discarded, see GetNumFifoOverflows().
+        \param samples receives the samples, oldest first
+        \return the number of samples that were added, a burst read that
+                fails stops the call after the samples read so far
+    */
+    template <size_t kCapacity>
+    size_t ReadFifo(SpscQueue<FifoSample, kCapacity> &samples)
+    {
+        if(fifo_frame_size_ == 0)
+            return 0;
+
+        const uint32_t now   = System::GetUs();
+        const uint16_t count = GetFifoCount();
+        if(GetTransportError() != OK)
+            return 0;
+        if(count > kFifoSize - fifo_frame_size_)
+        {
+            // samples were lost, the last frame may be incomplete
+            num_fifo_overflows_++;
+            ResetFifo();
+            return 0;
+        }
+
+        const size_t queued = count / fifo_frame_size_;
+        const size_t free   = kCapacity - samples.GetNumElements();
+        const size_t num    = queued < free ? queued : free;
+        if(num == 0)
+            return 0;
+
+        // the newest sample was taken about now, the others before it
+        const uint32_t period_us = GetFifoSamplePeriodUs();
+        uint32_t       timestamp = now - uint32_t(queued - 1) * period_us;
+
+        // the FIFO holds the registers in the order of their addresses
+        const uint8_t gyro_offset = fifo_config_.accel ? 6 : 0;
+        const uint8_t temp_offset = gyro_offset + (fifo_config_.gyro ? 6 : 0);
+        // skip the status byte of the magnetometer
+        const uint8_t mag_offset
+            = temp_offset + (fifo_config_.temp ? 2 : 0) + 1;
+
+        const float accel_factor = SENSORS_GRAVITY_EARTH / GetAccelScale();
+        const float gyro_factor  = SENSORS_DPS_TO_RADS / GetGyroScale();
+
+        const size_t frames_per_read = kFifoReadSize / fifo_frame_size_;
+        uint8_t      buffer[kFifoReadSize];
+        size_t       done = 0;
+        while(done < num)
+        {
+            size_t frames = num - done;
+            if(frames > frames_per_read)
+                frames = frames_per_read;
+            ReadReg(ICM20X_B0_FIFO_R_W, buffer, frames * fifo_frame_size_);
+            // the rest stays in the FIFO, the timestamps of the next call
+            // start over from the newest sample
+            if(GetTransportError() != OK)
+                return done;
+
+            const uint8_t *frame = buffer;
+            for(size_t i = 0; i < frames; i++)
+            {
+                FifoSample sample   = {};
+                sample.timestamp_us = timestamp;
+                if(fifo_config_.accel)
+                    sample.accel = DecodeVect(frame, accel_factor);
+                if(fifo_config_.gyro)
+                    sample.gyro = DecodeVect(frame + gyro_offset, gyro_factor);
+                if(fifo_config_.temp)
+                {
+                    const int16_t raw
+                        = frame[temp_offset] << 8 | frame[temp_offset + 1];
+                    sample.temp = (raw / 333.87) + 21.0;
+                }
+                if(fifo_config_.mag)
+                {
+                    // Mag data is read little endian
+                    const uint8_t *mag = frame + mag_offset;
+                    sample.mag.x
+                        = int16_t(mag[1] << 8 | mag[0]) * ICM20948_UT_PER_LSB;
+                    sample.mag.y
+                        = int16_t(mag[3] << 8 | mag[2]) * ICM20948_UT_PER_LSB;
+                    sample.mag.z
+                        = int16_t(mag[5] << 8 | mag[4]) * ICM20948_UT_PER_LSB;
+                }
+                samples.PushBack(sample);
+                timestamp += period_us;
+                frame += fifo_frame_size_;
+            }
+            done += frames;
+        }
+        return done;
+    }
+
+    /** \return the time between two FIFO samples in microseconds, from
+        the rate divisor of the gyro, or the accelerometer without gyro
+    */
+    uint32_t GetFifoSamplePeriodUs() const
+    {
+        // the gyro samples at 1100Hz, the accelerometer at 1125Hz
+        if(fifo_config_.gyro)
+            return (1 + gyro_rate_divisor_) * 1000000u / 1100u;
+        return (1 + accel_rate_divisor_) * 1000000u / 1125u;
+    }
+
+    /** \return the number of times the FIFO ran full and was discarded */
+    uint32_t GetNumFifoOverflows() const { return num_fifo_overflows_; }
+
     Icm20948Vect GetAccelVect()
     {
         Icm20948Vect vect;
@@ -955,8 +1289,31 @@ class Icm20948
     Result GetTransportError() { return transport_.GetError() ? ERR : OK; }
 
   private:
-    Config    config_;
-    Transport transport_;
+    /** Accel, gyro, temp and 9 bytes of mag, see Process() */
+    static constexpr uint8_t kPollWindowSize = 14 + 9;
+    /** Size of the on-chip FIFO */
+    static constexpr uint16_t kFifoSize = 512;
+    /** Maximum size of a single burst read from the FIFO */
+    static constexpr uint8_t kFifoReadSize = 255;
+
+    /** Decodes three big endian values */
+    static Icm20948Vect DecodeVect(const uint8_t *regs, float factor)
+    {
+        Icm20948Vect vect;
+        vect.x = int16_t(regs[0] << 8 | regs[1]) * factor;
+        vect.y = int16_t(regs[2] << 8 | regs[3]) * factor;
+        vect.z = int16_t(regs[4] << 8 | regs[5]) * factor;
+        return vect;
+    }
+
+    Config                   config_;
+    Transport                transport_;
+    DoubleBuffer<PolledData> polled_;
+    FifoConfig               fifo_config_;
+    uint8_t                  fifo_frame_size_;
+    uint32_t                 num_fifo_overflows_;
+    uint16_t                 accel_rate_divisor_;
+    uint8_t                  gyro_rate_divisor_;
 
     uint16_t _sensorid_accel, ///< ID number for accelerometer
         _sensorid_gyro,       ///< ID number for gyro
@@ -7,6 +7,8 @@
 #include <stdint.h>
 #include "per/i2c.h"
 #include "per/gpio.h"
+#include "sys/system.h"
+#include "util/scopedirqblocker.h"
 
 namespace daisy
 {
@@ -16,6 +18,21 @@ namespace daisy
  * can also be supplied with raw 12bit values.
  * This driver uses two buffers - one for drawing, one for transmitting.
  * Multiple LedDriverPca9685 instances can be used at the same time.
+ *
+ * Only the leds that changed since the last transmission are sent: chips
+ * without changes are skipped, and for the others only the registers from
+ * the first to the last changed led are written.
+ *
+ * The buffers can be swapped and transmitted right away with
+ * SwapBuffersAndTransmit(), or paced by a timer: draw each frame between
+ * BeginFrame() and SubmitFrame(), and call Refresh() from a timer
+ * interrupt, e.g.
+ *
+ *     timer.SetCallback(&LedDriverPca9685<2>::RefreshCallback, &driver);
+ *
+ * Frames submitted faster than the refresh rate are merged. GetStats()
+ * tells how often that happened. The timer interrupt must not have a
+ * higher priority than the I2C DMA interrupt.
  * \param numDrivers    The number of PCA9685 driver attached to the I2C
  *                      peripheral.
  * \param persistentBufferContents If set to true, the current draw buffer 
@@ -25,10 +42,13 @@ namespace daisy
  *                      If you will alway update all leds before calling 
  *                      SwapBuffersAndTransmit(), you can set this to false
  *                      and safe some cycles.
+ * \param Transport     The I2C peripheral type, replaced in the unit tests.
  * 
  *  @ingroup device
  */
-template <int numDrivers, bool persistentBufferContents = true>
+template <int  numDrivers,
+          bool persistentBufferContents = true,
+          typename Transport            = I2CHandle>
 class LedDriverPca9685
 {
   public:
@@ -50,6 +70,29 @@ class LedDriverPca9685
     /** Buffer type for the entire DMA buffer. */
     using DmaBuffer = PCA9685TransmitBuffer[numDrivers];
 
+    /** Refresh statistics, see GetStats() */
+    struct Stats
+    {
+        /** Frames swapped in and transmitted */
+        uint32_t frames_sent;
+        /** Frames submitted while the previous one was still waiting for a
+         *  Refresh(). They were merged and never sent on their own.
+         */
+        uint32_t frames_coalesced;
+        /** Refresh() calls that found a frame waiting, but the previous one
+         *  still being transmitted. The frame waits for the next Refresh().
+         */
+        uint32_t refreshes_dropped;
+        /** Chips skipped because none of their leds changed */
+        uint32_t drivers_skipped;
+        /** Failed I2C transfers. The chip is sent in full with the next
+         *  frame.
+         */
+        uint32_t transfer_errors;
+        /** Bytes transmitted, including the register addresses */
+        uint32_t bytes_sent;
+    };
+
     /** Initialises the driver. 
      * \param i2c           The I2C peripheral to use.
      * \param addresses     An array of addresses for each of the driver chips.
@@ -62,7 +105,7 @@ class LedDriverPca9685
      * \param oe_pin        If the output enable pin is used, supply its configuration here.
      *                      It will automatically be pulled low by the driver.
     */
-    void Init(I2CHandle i2c,
+    void Init(Transport i2c,
               const uint8_t (&addresses)[numDrivers],
               DmaBuffer    dma_buffer_a,
               DmaBuffer    dma_buffer_b,
@@ -73,8 +116,18 @@ class LedDriverPca9685
         transmit_buffer_ = dma_buffer_b;
         oe_pin_          = oe_pin;
         for(int d = 0; d < numDrivers; d++)
+        {
             addresses_[d] = addresses[d];
+            dirty_[d]     = 0;
+            // the chips still have their reset values, send everything
+            resend_[d] = true;
+        }
         current_driver_idx_ = -1;
+        transmitting_       = false;
+        frame_pending_      = false;
+        drawing_            = false;
+        refresh_due_        = false;
+        ResetStats();
 
         InitializeBuffers();
         InitializeDrivers();
@@ -123,70 +176,201 @@ class LedDriverPca9685
     /** Sets a single led to a raw 12bit brightness between 0 and 4095. */
     void SetLedRaw(int ledIndex, uint16_t rawBrightness)
     {
-        const auto d  = GetDriverForLed(ledIndex);
-        const auto ch = GetDriverChannelForLed(ledIndex);
+        const auto d   = GetDriverForLed(ledIndex);
+        const auto ch  = GetDriverChannelForLed(ledIndex);
+        auto&      led = draw_buffer_[d].leds[ch];
         // mask away the "full on" bit
-        const auto on                = draw_buffer_[d].leds[ch].on & (0x0FFF);
-        draw_buffer_[d].leds[ch].off = (on + rawBrightness) & (0x0FFF);
+        const uint16_t on = led.on & (0x0FFF);
+        led.off           = (on + rawBrightness) & (0x0FFF);
         // full on condition
         if(rawBrightness >= 0x0FFF)
-            draw_buffer_[d].leds[ch].on = 0x1000 | on; // set "full on" bit
+            led.on = 0x1000 | on; // set "full on" bit
         else
-            draw_buffer_[d].leds[ch].on = on; // clear "full on" bit
+            led.on = on; // clear "full on" bit
+
+        const auto& sent = transmit_buffer_[d].leds[ch];
+        if(led.on != sent.on || led.off != sent.off)
+            dirty_[d] |= 1u << ch;
     }
 
     /** Swaps the current draw buffer and the current transmit buffer and
-     *  starts transmitting the values to all chips.
+     *  starts transmitting the changed values.
+     *  Waits for the previous transmission to complete.
      */
     void SwapBuffersAndTransmit()
     {
-        // wait for current transmission to complete
-        while(current_driver_idx_ >= 0) {};
+        while(!TrySwapBuffers()) {};
+        StartTransmission();
+    }
+
+    /** Starts drawing a frame. Until SubmitFrame(), Refresh() doesn't
+     *  swap the buffers, so the leds can be set while its timer runs.
+     */
+    void BeginFrame() { drawing_ = true; }
+
+    /** Marks the draw buffer as complete and returns right away. The next
+     *  Refresh() swaps the buffers and transmits it, unless the next frame
+     *  was begun in the meantime. Then it's merged with that one. If a
+     *  Refresh() came while this frame was drawn, it is made up for here.
+     */
+    void SubmitFrame()
+    {
+        bool refresh_due;
+        {
+            ScopedIrqBlocker block;
+            if(frame_pending_)
+                stats_.frames_coalesced++;
+            frame_pending_ = true;
+            drawing_       = false;
+            refresh_due    = refresh_due_;
+            refresh_due_   = false;
+        }
+        if(refresh_due)
+            Refresh();
+    }
+
+    /** Swaps the buffers and starts transmitting, if a frame was submitted,
+     *  no frame is being drawn and the previous transmission is complete.
+     *  Call this at a fixed rate from a timer interrupt, see
+     *  RefreshCallback().
+     */
+    void Refresh()
+    {
+        if(!frame_pending_)
+            return;
+        if(drawing_)
+        {
+            // SubmitFrame() does the swap
+            refresh_due_ = true;
+            return;
+        }
+        if(!TrySwapBuffers())
+        {
+            stats_.refreshes_dropped++;
+            return;
+        }
+        StartTransmission();
+    }
+
+    /** Calls Refresh() on the driver passed in context.
+     *  Matches TimerHandle::PeriodElapsedCallback.
+     */
+    static void RefreshCallback(void* context)
+    {
+        static_cast<LedDriverPca9685*>(context)->Refresh();
+    }
+
+    /** Returns true while the transmit buffer is being sent */
+    bool IsTransmitting() const { return transmitting_; }
+
+    /** Copies the refresh statistics */
+    Stats GetStats() const
+    {
+        ScopedIrqBlocker block;
+        return stats_;
+    }
+
+    /** Resets the refresh statistics */
+    void ResetStats()
+    {
+        ScopedIrqBlocker block;
+        stats_ = Stats();
+    }
+
+  private:
+    /** Swaps the buffers unless a transmission is running.
+     *  Only the changed leds are copied to keep the settings (if required).
+     */
+    bool TrySwapBuffers()
+    {
+        ScopedIrqBlocker block;
+        if(transmitting_)
+            return false;
 
-        // swap buffers
         auto tmp         = transmit_buffer_;
         transmit_buffer_ = draw_buffer_;
         draw_buffer_     = tmp;
 
-        // copy current transmit buffer contents to the new draw buffer
-        // to keep the led settings (if required)
-        if(persistentBufferContents)
+        for(int d = 0; d < numDrivers; d++)
         {
-            for(int d = 0; d < numDrivers; d++)
+            const uint16_t changed = dirty_[d];
+            if(persistentBufferContents)
+            {
                 for(int ch = 0; ch < 16; ch++)
-                    draw_buffer_[d].leds[ch].off
-                        = transmit_buffer_[d].leds[ch].off;
+                    if(changed & (1u << ch))
+                        draw_buffer_[d].leds[ch]
+                            = transmit_buffer_[d].leds[ch];
+            }
+            transmit_dirty_[d] = resend_[d] ? 0xFFFF : changed;
+            resend_[d]         = false;
+            dirty_[d]          = 0;
         }
 
-        // start transmission
+        frame_pending_ = false;
+        transmitting_  = true;
+        stats_.frames_sent++;
+        return true;
+    }
+
+    void StartTransmission()
+    {
         current_driver_idx_ = -1;
         ContinueTransmission();
     }
 
-  private:
     void ContinueTransmission()
     {
-        current_driver_idx_ = current_driver_idx_ + 1;
-        if(current_driver_idx_ >= numDrivers)
+        // skip the drivers without changes
+        int d = current_driver_idx_ + 1;
+        while(d < numDrivers && transmit_dirty_[d] == 0)
+        {
+            stats_.drivers_skipped++;
+            d++;
+        }
+        if(d >= numDrivers)
         {
             current_driver_idx_ = -1;
+            transmitting_       = false;
             return;
         }
+        current_driver_idx_ = d;
+
+        // send the registers from the first to the last changed led. The
+        // register address goes into the byte right before them, which is
+        // restored when the transmission is done.
+        const uint32_t changed = transmit_dirty_[d];
+        const int      first   = __builtin_ctz(changed);
+        const int      last    = 31 - __builtin_clz(changed);
+        uint8_t*       data = (uint8_t*)&transmit_buffer_[d].leds[first] - 1;
+        const uint16_t size = 1 + 4 * (last - first + 1);
+        saved_byte_addr_    = data;
+        saved_byte_         = *data;
+        *data               = PCA9685_LED0 + 4 * first;
+        stats_.bytes_sent += size;
 
-        const auto    d       = current_driver_idx_;
         const uint8_t address = PCA9685_I2C_BASE_ADDRESS | addresses_[d];
-        const auto    status  = i2c_.TransmitDma(address,
-                                             (uint8_t*)&transmit_buffer_[d],
-                                             PCA9685TransmitBuffer::size,
-                                             &TxCpltCallback,
-                                             this);
-        if(status != I2CHandle::Result::OK)
+        const auto    status  = i2c_.TransmitDma(
+            address, data, size, &TxCpltCallback, this);
+        if(status != Transport::Result::OK)
         {
             // TODO: fix this :-)
             // Reinit I2C (probably a flag to kill, but hey this works fairly well for now.)
             i2c_.Init(i2c_.GetConfig());
+            TransmissionDone(false);
         }
     }
+
+    void TransmissionDone(bool success)
+    {
+        const auto d      = current_driver_idx_;
+        *saved_byte_addr_ = saved_byte_;
+        if(!success)
+        {
+            stats_.transfer_errors++;
+            resend_[d] = true;
+        }
+        ContinueTransmission();
+    }
     uint16_t GetStartCycleForLed(int ledIndex) const
     {
         return (ledIndex << 2) & 0x0FFF; // shift each led by 4 cycles
@@ -264,14 +448,14 @@ class LedDriverPca9685
 
     // an internal function to handle i2c callbacks
     // called when an I2C transmission completes and the next driver must be updated
-    static void TxCpltCallback(void* context, I2CHandle::Result result)
+    static void TxCpltCallback(void*                      context,
+                               typename Transport::Result result)
     {
-        auto drv_ptr = reinterpret_cast<
-            LedDriverPca9685<numDrivers, persistentBufferContents>*>(context);
-        drv_ptr->ContinueTransmission();
+        auto drv_ptr = reinterpret_cast<LedDriverPca9685*>(context);
+        drv_ptr->TransmissionDone(result == Transport::Result::OK);
     }
 
-    I2CHandle              i2c_;
+    Transport              i2c_;
     PCA9685TransmitBuffer* draw_buffer_;
     PCA9685TransmitBuffer* transmit_buffer_;
     uint8_t                addresses_[numDrivers];
@@ -279,6 +463,22 @@ class LedDriverPca9685
     dsy_gpio               oe_pin_gpio_;
     // index of the dirver that is currently updated.
     volatile int8_t current_driver_idx_;
+    volatile bool   transmitting_;
+    volatile bool   frame_pending_;
+    // set between BeginFrame() and SubmitFrame()
+    volatile bool drawing_;
+    // set if Refresh() found a frame while the next one was drawn
+    volatile bool refresh_due_;
+    // leds changed in the draw buffer, one bit per channel
+    uint16_t dirty_[numDrivers];
+    // leds to send from the transmit buffer
+    uint16_t transmit_dirty_[numDrivers];
+    // set if a chip has to be sent in full, e.g. after an error
+    volatile bool resend_[numDrivers];
+    // the transmit buffer byte replaced by the register address
+    uint8_t* saved_byte_addr_;
+    uint8_t  saved_byte_;
+    Stats    stats_;
     const uint16_t  gamma_table_[256] = {
         0,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
         2,    2,    2,    2,    2,    2,    2,    3,    3,    4,    4,    5,
@@ -2,6 +2,8 @@
 #ifndef DSY_MPR121_H
 #define DSY_MPR121_H
 
+#include "util/SensorPoller.h"
+
 // The default I2C address
 #define MPR121_I2CADDR_DEFAULT 0x5A        ///< default I2C address
 #define MPR121_TOUCH_THRESHOLD_DEFAULT 12  ///< default touch threshold value
@@ -73,9 +75,23 @@ class Mpr121I2CTransport
                != i2c_.ReceiveBlocking(config_.dev_addr, data, size, 10);
     }
 
+    /** Starts reading from a reg address with a DMA, see SensorPoller
+        \return false if the read couldn't be started or queued
+    */
+    bool DmaReadReg(uint8_t            reg,
+                    uint8_t           *buff,
+                    uint16_t           size,
+                    SensorPollCallback callback,
+                    void              *context)
+    {
+        return dma_reader_.ReadRegisters(
+            i2c_, config_.dev_addr, reg, buff, size, callback, context);
+    }
+
   private:
-    I2CHandle i2c_;
-    Config    config_;
+    I2CHandle           i2c_;
+    Config              config_;
+    SensorPollI2CReader dma_reader_;
 };
 
 
@@ -109,12 +125,20 @@ class Mpr121
         ERR
     };
 
+    /** Readings decoded from a SensorPoller read */
+    struct PolledData
+    {
+        uint16_t touched;      /**< touch status, see Touched() */
+        uint16_t filtered[13]; /**< filtered data, see FilteredData() */
+    };
+
     /** Initialize the MPR121 device
         \param config Configuration settings
     */
     Result Init(Config config)
     {
-        config_ = config;
+        config_          = config;
+        transport_error_ = false;
 
         SetTransportErr(transport_.Init(config_.transport_config));
 
@@ -224,6 +248,41 @@ class Mpr121
         return t & 0x0FFF;
     }
 
+    /** The touch status and the filtered data of all channels */
+    SensorPollWindow GetPollWindow() const
+    {
+        return {MPR121_TOUCHSTATUS_L, kPollWindowSize, 10};
+    }
+
+    /** Starts reading the poll window with a DMA, called by a SensorPoller */
+    bool
+    StartPollRead(uint8_t *buff, SensorPollCallback callback, void *context)
+    {
+        return transport_.DmaReadReg(
+            MPR121_TOUCHSTATUS_L, buff, kPollWindowSize, callback, context);
+    }
+
+    /** Decodes the poll window, called by a SensorPoller when the read has
+        finished. The readings are published for GetPolledData().
+    */
+    void DecodePoll(const uint8_t *regs)
+    {
+        PolledData data;
+        data.touched = (regs[0] | regs[1] << 8) & 0x0FFF;
+        for(uint8_t t = 0; t < 13; t++)
+        {
+            const uint8_t *filt = regs + MPR121_FILTDATA_0L + t * 2;
+            data.filtered[t]    = filt[0] | filt[1] << 8;
+        }
+        polled_.Write(data);
+    }
+
+    /** Get the latest readings of a SensorPoller, lock-free
+        \param data receives the readings
+        \return false if there weren't any yet
+    */
+    bool GetPolledData(PolledData &data) const { return polled_.Read(data); }
+
     /** Read the contents of an 8 bit device register.
         \param      reg the register address to read from
         \returns    the 8 bit value that was read.
@@ -335,9 +394,13 @@ class Mpr121
     };
 
   private:
-    Config    config_;
-    Transport transport_;
-    bool      transport_error_;
+    /** From the touch status up to the filtered data of channel 12 */
+    static constexpr uint8_t kPollWindowSize = MPR121_FILTDATA_0L + 13 * 2;
+
+    Config                   config_;
+    Transport                transport_;
+    bool                     transport_error_;
+    DoubleBuffer<PolledData> polled_;
 
     /** Set the global transport_error_ bool */
     void SetTransportErr(bool err) { transport_error_ |= err; }
@@ -2,6 +2,10 @@
 #ifndef DSY_NEO_PIXEL_H
 #define DSY_NEO_PIXEL_H
 
+#include "per/i2c.h"
+#include "sys/system.h"
+#include <string.h>
+
 #define NEO_TRELLIS_ADDR_NEOPIXEL (0x2E) ///< Default Neotrellis I2C address
 
 // RGB NeoPixel permutations; white and red offsets are always same
@@ -142,6 +146,28 @@ class NeoPixelI2CTransport
         Write(reg, size + 2);
     }
 
+    /** A callback for WriteDma(), success is false if the transfer failed */
+    typedef void (*DmaCallback)(void *context, bool success);
+
+    /** Writes data with DMA and returns immediately.
+        \param data the data to write, in memory the DMA can access
+        \param size the number of bytes to write
+        \param callback called from the interrupt when the write finished
+        \param context passed back to the callback
+        \return false if the write couldn't be started
+    */
+    bool WriteDma(uint8_t    *data,
+                  uint16_t    size,
+                  DmaCallback callback,
+                  void       *context)
+    {
+        dma_callback_         = callback;
+        dma_callback_context_ = context;
+        return I2CHandle::Result::OK
+               == i2c_.TransmitDma(
+                   config_.address, data, size, &DmaWriteDone, this);
+    }
+
     /**  Writes an 8 bit value
         \param reg the register address to write to
         \param value the value to write to the register
@@ -176,14 +202,30 @@ class NeoPixelI2CTransport
     }
 
   private:
+    static void DmaWriteDone(void *context, I2CHandle::Result result)
+    {
+        auto transport = static_cast<NeoPixelI2CTransport *>(context);
+        transport->dma_callback_(transport->dma_callback_context_,
+                                 result == I2CHandle::Result::OK);
+    }
+
     I2CHandle i2c_;
     Config    config_;
 
     // true if error has occured since last check
     bool error_;
+
+    DmaCallback dma_callback_;
+    void       *dma_callback_context_;
 };
 
 /** \brief Device support for Adafruit Neopixel Device
+
+    By default, every SetPixelColor() is written to the seesaw right away.
+    In frame mode (Config::frame_mode), pixel changes only go to the local
+    pixel buffer. Show() then writes the changed pixels in as few transfers
+    as possible, and Flush() does the same with DMA, in the background.
+
     @author beserge
     @date December 2021
 */
@@ -194,18 +236,43 @@ class NeoPixel
     NeoPixel() {}
     ~NeoPixel() {}
 
+    /** Size of the local pixel buffer in bytes */
+    static constexpr uint16_t kMaxBytes = 256;
+    /** Most pixels that fit into the local pixel buffer */
+    static constexpr uint16_t kMaxPixels = kMaxBytes / 3;
+    /** Most pixel bytes written to the seesaw buffer register at once */
+    static constexpr uint16_t kMaxBufWriteSize = 28;
+    /** Bytes it takes to start another write to the seesaw buffer register,
+        including the I2C address. Unchanged pixels between two changed
+        ones are rewritten if that's shorter than starting a new write.
+    */
+    static constexpr uint16_t kBufWriteOverhead = 5;
+    /** Size of a DmaBuffer: every write has 4 bytes of register address and
+        offset, and covers at least one pixel. Plus the show command.
+    */
+    static constexpr size_t kDmaBufferSize = kMaxBytes + 4 * kMaxPixels + 2;
+
+    /** A buffer for Flush(). It has to be placed in memory the DMA can
+        access, e.g. like this:
+            NeoPixelI2C::DmaBuffer DMA_BUFFER_MEM_SECTION buffer;
+    */
+    using DmaBuffer = uint8_t[kDmaBufferSize];
+
     struct Config
     {
         typename Transport::Config transport_config;
         uint16_t                   type;
         uint16_t                   numLEDs;
         int8_t                     output_pin;
+        /** Keep pixel changes local until Show() or Flush() */
+        bool frame_mode;
 
         Config()
         {
             type       = NEO_GRB + NEO_KHZ800;
             numLEDs    = 16;
             output_pin = 3;
+            frame_mode = false;
         }
     };
 
@@ -272,6 +339,15 @@ class NeoPixel
         pin     = config_.output_pin;
         pixels  = pixelsd;
 
+        // no scaling until SetBrightness() is called
+        brightness = 0;
+
+        ClearDirty();
+        show_pending_   = false;
+        flush_error_    = false;
+        flush_num_msgs_ = 0;
+        flush_next_msg_ = 0;
+
         transport_.Init(config_.transport_config);
 
         SWReset();
@@ -331,9 +407,13 @@ class NeoPixel
     void UpdateLength(uint16_t n)
     {
         // Allocate new data -- note: ALL PIXELS ARE CLEARED
-        numBytes = n * ((wOffset == rOffset) ? 3 : 4);
+        const uint16_t bytesPerPixel = (wOffset == rOffset) ? 3 : 4;
+        if(n > kMaxBytes / bytesPerPixel)
+            n = kMaxBytes / bytesPerPixel;
+        numBytes = n * bytesPerPixel;
         mymemset(pixels, 0, numBytes);
         numLEDs = n;
+        ClearDirty();
 
         uint8_t buf[] = {(uint8_t)(numBytes >> 8), (uint8_t)(numBytes & 0xFF)};
         Write(SEESAW_NEOPIXEL_BASE, SEESAW_NEOPIXEL_BUF_LENGTH, buf, 2);
@@ -360,8 +440,26 @@ class NeoPixel
 
     inline bool CanShow(void) { return (System::GetUs() - endTime) >= 300L; }
 
+    /** Shows the pixels. In frame mode, the changed pixels are written
+        first. Waits for a running Flush() to finish.
+    */
     void Show(void)
     {
+        while(IsFlushing()) {}
+        CheckFlushError();
+
+        uint8_t  writeBuf[kMaxBufWriteSize + 2];
+        uint16_t offset = 0, size;
+        while(TakeDirtySpan(offset, size))
+        {
+            writeBuf[0] = (offset >> 8);
+            writeBuf[1] = offset;
+            memcpy(&writeBuf[2], &pixels[offset], size);
+            Write(
+                SEESAW_NEOPIXEL_BASE, SEESAW_NEOPIXEL_BUF, writeBuf, size + 2);
+            offset += size;
+        }
+
         // Data latch = 300+ microsecond pause in the output stream.  Rather than
         // put a delay at the end of the function, the ending time is noted and
         // the function will simply hold off (if needed) on issuing the
@@ -373,7 +471,80 @@ class NeoPixel
 
         Write(SEESAW_NEOPIXEL_BASE, SEESAW_NEOPIXEL_SHOW, NULL, 0);
 
-        endTime = System::GetUs(); // Save EOD time for latch on next call
+        endTime       = System::GetUs(); // Save EOD time for latch on next call
+        show_pending_ = false;
+    }
+
+    /** Writes the changed pixels and shows them, with DMA in the background.
+        Only used in frame mode. The changed pixels are copied to dma_buffer
+        right away, so the next frame can be drawn while the transfer is
+        running. dma_buffer has to stay untouched until IsFlushing()
+        returns false.
+
+        Never waits for the latch time: if the last show was less than
+        300us ago, only the pixels are written, and the show is sent by a
+        later Flush(). Call it regularly, e.g. from the main loop, as long
+        as IsDirty() returns true.
+
+        \return false if the previous Flush() is still running
+    */
+    bool Flush(DmaBuffer &dma_buffer)
+    {
+        if(IsFlushing())
+            return false;
+        CheckFlushError();
+
+        uint8_t *dest   = dma_buffer;
+        size_t   num    = 0;
+        uint16_t offset = 0, size;
+        while(TakeDirtySpan(offset, size))
+        {
+            dest[0] = SEESAW_NEOPIXEL_BASE;
+            dest[1] = SEESAW_NEOPIXEL_BUF;
+            dest[2] = (offset >> 8);
+            dest[3] = offset;
+            memcpy(&dest[4], &pixels[offset], size);
+            flush_sizes_[num++] = size + 4;
+            dest += size + 4;
+            offset += size;
+            show_pending_ = true;
+        }
+
+        flush_show_ = show_pending_ && CanShow();
+        if(flush_show_)
+        {
+            dest[0]             = SEESAW_NEOPIXEL_BASE;
+            dest[1]             = SEESAW_NEOPIXEL_SHOW;
+            flush_sizes_[num++] = 2;
+        }
+
+        flush_msg_      = dma_buffer;
+        flush_next_msg_ = 0;
+        flush_num_msgs_ = num;
+        if(num > 0)
+            SendNextFlushMessage();
+        return true;
+    }
+
+    /** \return true while a Flush() is transferring */
+    bool IsFlushing() const { return flush_next_msg_ < flush_num_msgs_; }
+
+    /** \return true if there are pixel changes that weren't shown yet */
+    bool IsDirty() const
+    {
+        if(show_pending_ || flush_error_)
+            return true;
+        for(auto word : dirty_)
+            if(word)
+                return true;
+        return false;
+    }
+
+    /** Marks all pixels as changed, so they're all written again */
+    void Invalidate()
+    {
+        for(uint16_t n = 0; n < numLEDs; n++)
+            MarkDirty(n);
     }
 
     // Set the output pin number
@@ -408,15 +579,7 @@ class NeoPixel
             p[gOffset] = g;
             p[bOffset] = b;
 
-            uint8_t  len    = (wOffset == rOffset ? 3 : 4);
-            uint16_t offset = n * len;
-
-            uint8_t writeBuf[6];
-            writeBuf[0] = (offset >> 8);
-            writeBuf[1] = offset;
-            mymemcpy(&writeBuf[2], p, len);
-
-            Write(SEESAW_NEOPIXEL_BASE, SEESAW_NEOPIXEL_BUF, writeBuf, len + 2);
+            PixelChanged(n, p);
         }
     }
 
@@ -445,15 +608,7 @@ class NeoPixel
             p[gOffset] = g;
             p[bOffset] = b;
 
-            uint8_t  len    = (wOffset == rOffset ? 3 : 4);
-            uint16_t offset = n * len;
-
-            uint8_t writeBuf[6];
-            writeBuf[0] = (offset >> 8);
-            writeBuf[1] = offset;
-            mymemcpy(&writeBuf[2], p, len);
-
-            Write(SEESAW_NEOPIXEL_BASE, SEESAW_NEOPIXEL_BUF, writeBuf, len + 2);
+            PixelChanged(n, p);
         }
     }
 
@@ -484,15 +639,7 @@ class NeoPixel
             p[gOffset] = g;
             p[bOffset] = b;
 
-            uint8_t  len    = (wOffset == rOffset ? 3 : 4);
-            uint16_t offset = n * len;
-
-            uint8_t writeBuf[6];
-            writeBuf[0] = (offset >> 8);
-            writeBuf[1] = offset;
-            mymemcpy(&writeBuf[2], p, len);
-
-            Write(SEESAW_NEOPIXEL_BASE, SEESAW_NEOPIXEL_BUF, writeBuf, len + 2);
+            PixelChanged(n, p);
         }
     }
 
@@ -571,6 +718,12 @@ class NeoPixel
         // Clear local pixel buffer
         mymemset(pixels, 0, numBytes);
 
+        if(config_.frame_mode)
+        {
+            Invalidate();
+            return;
+        }
+
         // Now clear the pixels on the seesaw
         uint8_t writeBuf[32];
         mymemset(writeBuf, 0, 32);
@@ -593,25 +746,152 @@ class NeoPixel
         }
     }
 
-    void mymemset(uint8_t *addr, uint8_t val, uint8_t len)
+    void mymemset(uint8_t *addr, uint8_t val, uint16_t len)
     {
-        for(uint8_t i = 0; i < len; i++)
+        for(uint16_t i = 0; i < len; i++)
         {
             addr[i] = val;
         }
     }
 
+  protected:
+    /** Writes a changed pixel right away, or marks it for the next
+        Show() or Flush() in frame mode
+    */
+    void PixelChanged(uint16_t n, uint8_t *p)
+    {
+        if(config_.frame_mode)
+        {
+            MarkDirty(n);
+            return;
+        }
+
+        uint8_t  len    = (wOffset == rOffset ? 3 : 4);
+        uint16_t offset = n * len;
+
+        uint8_t writeBuf[6];
+        writeBuf[0] = (offset >> 8);
+        writeBuf[1] = offset;
+        mymemcpy(&writeBuf[2], p, len);
+
+        Write(SEESAW_NEOPIXEL_BASE, SEESAW_NEOPIXEL_BUF, writeBuf, len + 2);
+    }
+
+    void MarkDirty(uint16_t n) { dirty_[n / 32] |= 1u << (n % 32); }
+    void ClearDirty() { memset(dirty_, 0, sizeof(dirty_)); }
+    bool IsPixelDirty(uint16_t n) const
+    {
+        return dirty_[n / 32] & (1u << (n % 32));
+    }
+
+    /** Finds the next span of changed pixels, from byte offset on, and
+        marks it as unchanged. Spans are split to fit into one write to the
+        seesaw buffer register.
+        \param offset the byte offset to search from, receives the start of
+                      the span
+        \param size receives the size of the span in bytes
+        \return false if nothing changed after offset
+    */
+    bool TakeDirtySpan(uint16_t &offset, uint16_t &size)
+    {
+        const uint16_t bytesPerPixel = (wOffset == rOffset) ? 3 : 4;
+
+        uint16_t n = offset / bytesPerPixel;
+        while(n < numLEDs && !IsPixelDirty(n))
+            n++;
+        if(n >= numLEDs)
+            return false;
+
+        const uint16_t first = n;
+        const uint16_t start = n * bytesPerPixel;
+        uint16_t       end   = start;
+        for(; n < numLEDs; n++)
+        {
+            const uint16_t pixelEnd = (n + 1) * bytesPerPixel;
+            if(pixelEnd - start > kMaxBufWriteSize)
+                break;
+            if(IsPixelDirty(n))
+                end = pixelEnd;
+            else if(pixelEnd - end > kBufWriteOverhead)
+                break;
+        }
+
+        for(n = first; n < end / bytesPerPixel; n++)
+            dirty_[n / 32] &= ~(1u << (n % 32));
+        offset = start;
+        size   = end - start;
+        return true;
+    }
+
+    void SendNextFlushMessage()
+    {
+        if(!transport_.WriteDma(flush_msg_,
+                                flush_sizes_[flush_next_msg_],
+                                &FlushMessageSent,
+                                this))
+            AbortFlush();
+    }
+
+    void CheckFlushError()
+    {
+        // rewrite everything, the seesaw may have missed some pixels
+        if(flush_error_)
+        {
+            flush_error_  = false;
+            show_pending_ = true;
+            Invalidate();
+        }
+    }
+
+    void AbortFlush()
+    {
+        flush_error_    = true;
+        flush_next_msg_ = flush_num_msgs_;
+    }
+
+    static void FlushMessageSent(void *context, bool success)
+    {
+        auto neopixel = static_cast<NeoPixel *>(context);
+        if(!success)
+        {
+            neopixel->AbortFlush();
+            return;
+        }
+
+        const size_t msg = neopixel->flush_next_msg_;
+        neopixel->flush_msg_ += neopixel->flush_sizes_[msg];
+        if(msg + 1 == neopixel->flush_num_msgs_ && neopixel->flush_show_)
+        {
+            neopixel->endTime       = System::GetUs();
+            neopixel->show_pending_ = false;
+        }
+        neopixel->flush_next_msg_ = msg + 1;
+        if(neopixel->IsFlushing())
+            neopixel->SendNextFlushMessage();
+    }
+
     Config    config_;
     Transport transport_;
 
-  protected:
+    /** one bit per pixel, set if it changed since the last write */
+    uint32_t dirty_[(kMaxPixels + 31) / 32];
+    /** true if pixels were written, but not shown yet */
+    volatile bool show_pending_;
+
+    uint8_t        *flush_msg_;
+    uint8_t         flush_sizes_[kMaxPixels + 1];
+    volatile size_t flush_num_msgs_;
+    volatile size_t flush_next_msg_;
+    bool            flush_show_;
+    volatile bool   flush_error_;
+
     bool is800KHz,    // ...true if 800 KHz pixels
         begun;        // true if begin() previously called
     uint16_t numLEDs, // Number of RGB LEDs in strip
         numBytes;     // Size of 'pixels' buffer below (3 or 4 bytes/pixel)
     int8_t pin;
 
-    uint8_t pixelsd[256]; // hopefully we won't need more than this...
+    uint8_t pixelsd[kMaxBytes]; // hopefully we won't need more than this...
 
     uint8_t brightness,
         *pixels,      // Holds LED color values (3 or 4 bytes each)
@@ -12,27 +12,8 @@ template <size_t width, size_t height, typename Transport>
 class SH1106Driver : public SSD130xDriver<width, height, Transport>
 {
   public:
-    /**
-   * Update the display
-   */
-    void Update()
-    {
-        uint8_t i;
-        uint8_t high_column_addr;
-        switch(height)
-        {
-            case 32: high_column_addr = 0x12; break;
-
-            default: high_column_addr = 0x10; break;
-        }
-        for(i = 0; i < (height / 8); i++)
-        {
-            this->transport_.SendCommand(0xB0 + i);
-            this->transport_.SendCommand(0x02);
-            this->transport_.SendCommand(high_column_addr);
-            this->transport_.SendData(&this->buffer_[width * i], width);
-        }
-    };
+    /** The SH1106 has 132 columns of RAM, the visible ones start at 2 */
+    SH1106Driver() { this->column_offset_ += 2; }
 };
 
 /**
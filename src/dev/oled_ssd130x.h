@@ -6,6 +6,7 @@
 #include "per/spi.h"
 #include "per/gpio.h"
 #include "sys/system.h"
+#include <string.h>
 
 namespace daisy
 {
@@ -47,14 +48,23 @@ class SSD130xI2CTransport
 
     void SendData(uint8_t* buff, size_t size)
     {
-        for(size_t i = 0; i < size; i++)
+        // one transfer per chunk, with the data control byte in front
+        uint8_t buf[kMaxChunkSize + 1];
+        buf[0] = 0x40;
+        while(size > 0)
         {
-            uint8_t buf[2] = {0X40, buff[i]};
-            i2c_.TransmitBlocking(i2c_address_, buf, 2, 1000);
+            const size_t chunk_size
+                = size < kMaxChunkSize ? size : kMaxChunkSize;
+            memcpy(&buf[1], buff, chunk_size);
+            i2c_.TransmitBlocking(i2c_address_, buf, chunk_size + 1, 1000);
+            buff += chunk_size;
+            size -= chunk_size;
         }
     };
 
   private:
+    static constexpr size_t kMaxChunkSize = 128;
+
     daisy::I2CHandle i2c_;
     uint8_t          i2c_address_;
 };
@@ -131,10 +141,54 @@ class SSD130x4WireSpiTransport
         spi_.BlockingTransmit(buff, size);
     };
 
+    /** Called when a DMA transfer finished, from the SPI interrupt */
+    typedef void (*DmaCallback)(void* context, bool success);
+
+    /** Sends commands followed by data with DMA and returns right away.
+     *  Both buffers have to be in memory the DMA can access, e.g.
+     *  DMA_BUFFER_MEM_SECTION, and stay untouched until the callback.
+     *  \return false if the transfers couldn't be queued
+     */
+    bool DmaSendCommandsAndData(uint8_t*    cmds,
+                                size_t      num_cmds,
+                                uint8_t*    data,
+                                size_t      size,
+                                DmaCallback callback,
+                                void*       context)
+    {
+        dma_callback_         = callback;
+        dma_callback_context_ = context;
+        if(spi_.DmaTransmit(cmds, num_cmds, &SetDcLow, nullptr, this)
+           != SpiHandle::Result::OK)
+            return false;
+        return spi_.DmaTransmit(data, size, &SetDcHigh, &DmaDataSent, this)
+               == SpiHandle::Result::OK;
+    }
+
   private:
-    SpiHandle spi_;
-    dsy_gpio  pin_reset_;
-    dsy_gpio  pin_dc_;
+    static void SetDcLow(void* context)
+    {
+        auto transport = static_cast<SSD130x4WireSpiTransport*>(context);
+        dsy_gpio_write(&transport->pin_dc_, 0);
+    }
+    static void SetDcHigh(void* context)
+    {
+        auto transport = static_cast<SSD130x4WireSpiTransport*>(context);
+        dsy_gpio_write(&transport->pin_dc_, 1);
+    }
+    static void DmaDataSent(void* context, SpiHandle::Result result)
+    {
+        auto transport = static_cast<SSD130x4WireSpiTransport*>(context);
+        if(transport->dma_callback_)
+            transport->dma_callback_(transport->dma_callback_context_,
+                                     result == SpiHandle::Result::OK);
+    }
+
+    SpiHandle   spi_;
+    dsy_gpio    pin_reset_;
+    dsy_gpio    pin_dc_;
+    DmaCallback dma_callback_         = nullptr;
+    void*       dma_callback_context_ = nullptr;
 };
 
 /**
@@ -240,18 +294,51 @@ class SSD130x4WireSoftSpiTransport
 
 /**
  * A driver implementation for the SSD1306/SSD1309
+ *
+ * DrawPixel() and Fill() keep track of the columns that changed on each
+ * page (8 rows) of the display. Update() only sends those, so a frame in
+ * which a single value changed costs a few bytes instead of the whole
+ * buffer.
+ *
+ * FillRect() and DrawColumns() change up to 8 rows of a column at once,
+ * OledDisplay uses them for rectangles, lines and text.
  */
 template <size_t width, size_t height, typename Transport>
 class SSD130xDriver
 {
   public:
+    static_assert(width <= 128, "the display RAM is 128 columns wide");
+
+    /** Number of pages, each page holds 8 rows */
+    static constexpr size_t kNumPages = height / 8;
+    /** Number of commands in front of the data of each page */
+    static constexpr size_t kNumPageCommands = 3;
+
+    /** A buffer for UpdateAsync(). It has to be placed in memory the DMA can
+     *  access, e.g. in the D2 domain by adding the DMA_BUFFER_MEM_SECTION
+     *  attribute like this:
+     *  `SSD130x4WireSpi128x64Driver::DmaBuffer DMA_BUFFER_MEM_SECTION buffer;`
+     */
+    using DmaBuffer = uint8_t[kNumPages * (kNumPageCommands + width)];
+
     struct Config
     {
         typename Transport::Config transport_config;
     };
 
+    SSD130xDriver() : column_offset_(height == 32 ? 0x20 : 0x00)
+    {
+        for(size_t page = 0; page < kNumPages; page++)
+            ClearDirty(page);
+    }
+
     void Init(Config config)
     {
+        async_num_pages_ = 0;
+        async_next_page_ = 0;
+        async_error_     = false;
+        Invalidate();
+
         transport_.Init(config.transport_config);
 
         // Init routine...
@@ -353,45 +440,301 @@ class SSD130xDriver
     {
         if(x >= width || y >= height)
             return;
-        if(on)
-            buffer_[x + (y / 8) * width] |= (1 << (y % 8));
-        else
-            buffer_[x + (y / 8) * width] &= ~(1 << (y % 8));
+        const size_t  idx  = x + (y / 8) * width;
+        const uint8_t mask = 1 << (y % 8);
+        const uint8_t prev = buffer_[idx];
+        const uint8_t next = on ? (prev | mask) : (prev & ~mask);
+        if(next == prev)
+            return;
+        buffer_[idx] = next;
+        MarkDirty(y / 8, x, x + 1);
     }
 
     void Fill(bool on)
     {
-        for(size_t i = 0; i < sizeof(buffer_); i++)
+        const uint8_t value = on ? 0xff : 0x00;
+        for(size_t page = 0; page < kNumPages; page++)
         {
-            buffer_[i] = on ? 0xff : 0x00;
+            uint8_t* row   = &buffer_[width * page];
+            size_t   start = width;
+            size_t   end   = 0;
+            for(size_t x = 0; x < width; x++)
+            {
+                if(row[x] != value)
+                {
+                    row[x] = value;
+                    start  = start < x ? start : x;
+                    end    = x + 1;
+                }
+            }
+            if(start < end)
+                MarkDirty(page, start, end);
         }
     };
 
+    /** Sets all pixels of a rectangle, the corners included, a page at a
+     *  time. Draws nothing if x1 > x2 or y1 > y2.
+     */
+    void FillRect(uint_fast8_t x1,
+                  uint_fast8_t y1,
+                  uint_fast8_t x2,
+                  uint_fast8_t y2,
+                  bool         on)
+    {
+        if(x1 > x2 || y1 > y2 || x1 >= width || y1 >= height)
+            return;
+        const size_t num  = (x2 < width ? x2 : width - 1) - x1 + 1;
+        const size_t last = y2 < height ? y2 : height - 1;
+        for(size_t page = y1 / 8; page <= last / 8; page++)
+        {
+            // the rows of the rectangle on this page
+            const size_t  top    = page == y1 / 8 ? y1 % 8 : 0;
+            const size_t  bottom = page == last / 8 ? last % 8 : 7;
+            const uint8_t mask   = (0xff << top) & (0xff >> (7 - bottom));
+            BlendColumns(page, x1, nullptr, num, 0, mask, on);
+        }
+    }
+
+    /** Draws a bitmap in the layout of FontDef::columns, which matches the
+     *  display RAM: set bits on, the others off. Text that starts on a page
+     *  boundary changes a single page for each 8 rows, other text two.
+     *  \param x       x Coordinate of the top left corner
+     *  \param y       y Coordinate of the top left corner
+     *  \param columns width bytes for each 8 rows of the bitmap
+     *  \param w       width of the bitmap
+     *  \param h       height of the bitmap
+     *  \param on      on or off
+     */
+    void DrawColumns(uint_fast8_t   x,
+                     uint_fast8_t   y,
+                     const uint8_t* columns,
+                     uint_fast8_t   w,
+                     uint_fast8_t   h,
+                     bool           on)
+    {
+        if(x >= width || y >= height)
+            return;
+        const size_t num   = w < width - x ? w : width - x;
+        const int    shift = y % 8;
+        for(size_t row = 0; row < h; row += 8)
+        {
+            const size_t   rows = h - row < 8 ? h - row : 8;
+            const uint8_t  mask = 0xff >> (8 - rows);
+            const size_t   page = (y + row) / 8;
+            const uint8_t* src  = columns + (row / 8) * w;
+            BlendColumns(page, x, src, num, shift, mask << shift, on);
+            if(shift > 0)
+                BlendColumns(
+                    page + 1, x, src, num, shift - 8, mask >> (8 - shift), on);
+        }
+    }
+
+    /** Marks the whole display to be sent with the next update,
+     *  e.g. after the display lost its contents.
+     */
+    void Invalidate()
+    {
+        for(size_t page = 0; page < kNumPages; page++)
+            MarkDirty(page, 0, width);
+    }
+
+    /** \return true if there are changes that weren't sent yet */
+    bool IsDirty() const
+    {
+        for(size_t page = 0; page < kNumPages; page++)
+            if(IsPageDirty(page))
+                return true;
+        return false;
+    }
+
     /**
      * Update the display 
+     * Sends the changed columns of each page.
+     * Waits for a running UpdateAsync() to finish first.
     */
     void Update()
     {
-        uint8_t i;
-        uint8_t high_column_addr;
-        switch(height)
+        while(IsUpdating()) {}
+        CheckAsyncError();
+        for(size_t page = 0; page < kNumPages; page++)
+        {
+            if(!IsPageDirty(page))
+                continue;
+            const size_t start = dirty_start_[page];
+            const size_t end   = dirty_end_[page];
+            uint8_t      cmds[kNumPageCommands];
+            GetPageCommands(page, start, cmds);
+            for(size_t i = 0; i < kNumPageCommands; i++)
+                transport_.SendCommand(cmds[i]);
+            transport_.SendData(&buffer_[width * page + start], end - start);
+            ClearDirty(page);
+        }
+    };
+
+    /**
+     * Update the display with DMA, in the background.
+     * Needs a transport with DMA support, e.g. the SSD130x4WireSpiTransport.
+     * The changed columns are copied to dma_buffer right away, so drawing
+     * the next frame can start while the transfer is running. The
+     * dma_buffer has to stay untouched until IsUpdating() returns false.
+     * \return false if the previous UpdateAsync() is still running
+     */
+    bool UpdateAsync(DmaBuffer& dma_buffer)
+    {
+        if(IsUpdating())
+            return false;
+        CheckAsyncError();
+
+        uint8_t* dest = dma_buffer;
+        size_t   num  = 0;
+        for(size_t page = 0; page < kNumPages; page++)
         {
-            case 32: high_column_addr = 0x12; break;
+            if(!IsPageDirty(page))
+                continue;
+            const size_t start = dirty_start_[page];
+            const size_t size  = dirty_end_[page] - start;
+            GetPageCommands(page, start, dest);
+            memcpy(dest + kNumPageCommands,
+                   &buffer_[width * page + start],
+                   size);
+            async_pages_[num].data = dest;
+            async_pages_[num].size = size;
+            dest += kNumPageCommands + size;
+            num++;
+            ClearDirty(page);
+        }
+
+        async_next_page_ = 0;
+        async_num_pages_ = num;
+        if(num > 0)
+            SendNextAsyncPage();
+        return true;
+    }
+
+    /** \return true while an UpdateAsync() is transferring */
+    bool IsUpdating() const { return async_next_page_ < async_num_pages_; }
+
+  protected:
+    /** Builds the commands that select the page and first column */
+    void GetPageCommands(size_t page, size_t start, uint8_t* cmds) const
+    {
+        const uint8_t column = column_offset_ + start;
+        cmds[0]              = 0xB0 + page;
+        cmds[1]              = 0x00 | (column & 0x0f);
+        cmds[2]              = 0x10 | (column >> 4);
+    }
 
-            default: high_column_addr = 0x10; break;
+    /** Copies num columns into a page, moved down by shift rows (up if
+     *  negative). Only the bits in mask change. Without src, the bits in
+     *  mask are all set to on.
+     */
+    void BlendColumns(size_t         page,
+                      size_t         x,
+                      const uint8_t* src,
+                      size_t         num,
+                      int            shift,
+                      uint8_t        mask,
+                      bool           on)
+    {
+        if(page >= kNumPages || mask == 0)
+            return;
+        uint8_t* row   = &buffer_[width * page + x];
+        size_t   start = num;
+        size_t   end   = 0;
+        for(size_t i = 0; i < num; i++)
+        {
+            uint8_t bits = src ? src[i] : 0xff;
+            bits         = on ? bits : ~bits;
+            bits         = shift >= 0 ? bits << shift : bits >> -shift;
+            const uint8_t next = (row[i] & ~mask) | (bits & mask);
+            if(next != row[i])
+            {
+                row[i] = next;
+                start  = start < i ? start : i;
+                end    = i + 1;
+            }
         }
-        for(i = 0; i < (height / 8); i++)
+        if(start < end)
+            MarkDirty(page, x + start, x + end);
+    }
+
+    void MarkDirty(size_t page, size_t start, size_t end)
+    {
+        if(start < dirty_start_[page])
+            dirty_start_[page] = start;
+        if(end > dirty_end_[page])
+            dirty_end_[page] = end;
+    }
+    void ClearDirty(size_t page)
+    {
+        dirty_start_[page] = width;
+        dirty_end_[page]   = 0;
+    }
+    bool IsPageDirty(size_t page) const
+    {
+        return dirty_start_[page] < dirty_end_[page];
+    }
+
+    void SendNextAsyncPage()
+    {
+        const AsyncPage& page = async_pages_[async_next_page_];
+        if(!transport_.DmaSendCommandsAndData(page.data,
+                                              kNumPageCommands,
+                                              page.data + kNumPageCommands,
+                                              page.size,
+                                              &AsyncPageSent,
+                                              this))
+            AbortAsync();
+    }
+
+    void CheckAsyncError()
+    {
+        // resend everything, parts of the display may be outdated
+        if(async_error_)
         {
-            transport_.SendCommand(0xB0 + i);
-            transport_.SendCommand(0x00);
-            transport_.SendCommand(high_column_addr);
-            transport_.SendData(&buffer_[width * i], width);
+            async_error_ = false;
+            Invalidate();
         }
+    }
+
+    void AbortAsync()
+    {
+        async_error_     = true;
+        async_next_page_ = async_num_pages_;
+    }
+
+    static void AsyncPageSent(void* context, bool success)
+    {
+        auto driver = static_cast<SSD130xDriver*>(context);
+        if(!success)
+        {
+            driver->AbortAsync();
+            return;
+        }
+        driver->async_next_page_ = driver->async_next_page_ + 1;
+        if(driver->async_next_page_ < driver->async_num_pages_)
+            driver->SendNextAsyncPage();
+    }
+
+    struct AsyncPage
+    {
+        uint8_t* data;
+        size_t   size;
     };
 
-  protected:
     Transport transport_;
     uint8_t   buffer_[width * height / 8];
+    /** first changed column of each page, width if unchanged */
+    uint8_t dirty_start_[kNumPages];
+    /** one past the last changed column of each page */
+    uint8_t dirty_end_[kNumPages];
+    /** offset of the first visible column in the display RAM */
+    uint8_t column_offset_;
+
+    AsyncPage       async_pages_[kNumPages];
+    volatile size_t async_num_pages_ = 0;
+    volatile size_t async_next_page_ = 0;
+    volatile bool   async_error_     = false;
 };
 
 /**
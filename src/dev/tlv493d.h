@@ -2,6 +2,8 @@
 #ifndef DSY_TLV493D_H
 #define DSY_TLV493D_H
 
+#include "util/SensorPoller.h"
+
 #define TLV493D_DEFAULTMODE POWERDOWNMODE
 
 #define TLV493D_ADDRESS1 0x5E
@@ -88,6 +90,18 @@ class Tlv493dI2CTransport
                 != i2c_.ReceiveBlocking(config_.address, data, size, 10);
     }
 
+    /** Starts reading with a DMA, see SensorPoller
+        \return false if the read couldn't be started or queued
+    */
+    bool DmaRead(uint8_t           *data,
+                 uint16_t           size,
+                 SensorPollCallback callback,
+                 void              *context)
+    {
+        return dma_reader_.Read(
+            i2c_, config_.address, data, size, callback, context);
+    }
+
     bool GetError()
     {
         bool tmp = err_;
@@ -99,9 +113,10 @@ class Tlv493dI2CTransport
     uint8_t GetAddress() { return config_.address; }
 
   private:
-    I2CHandle i2c_;
-    Config    config_;
-    bool      err_;
+    I2CHandle           i2c_;
+    Config              config_;
+    bool                err_;
+    SensorPollI2CReader dma_reader_;
 };
 
 
@@ -218,6 +233,17 @@ class Tlv493d
         ERR
     };
 
+    /** Readings decoded from a SensorPoller read, in the units of GetX(),
+        GetY(), GetZ() and GetTemp()
+    */
+    struct PolledData
+    {
+        float x;
+        float y;
+        float z;
+        float temp;
+    };
+
     /** Initialize the TLV493D device
         \param config Configuration settings
     */
@@ -300,6 +326,55 @@ class Tlv493d
         }
     }
 
+    /** The measurement registers. The sensor always starts reading at the
+        first one.
+    */
+    SensorPollWindow GetPollWindow() const
+    {
+        return {0, TLV493D_MEASUREMENT_READOUT, GetMeasurementDelay()};
+    }
+
+    /** Starts reading the poll window with a DMA, called by a SensorPoller */
+    bool
+    StartPollRead(uint8_t *buff, SensorPollCallback callback, void *context)
+    {
+        return transport_.DmaRead(
+            buff, TLV493D_MEASUREMENT_READOUT, callback, context);
+    }
+
+    /** Decodes the poll window, called by a SensorPoller when the read has
+        finished. The readings are published for GetPolledData().
+    */
+    void DecodePoll(const uint8_t *regs)
+    {
+        PolledData data;
+        data.x = ConcatResults(GetFromRegs(&RegMasks[R_BX1], regs),
+                               GetFromRegs(&RegMasks[R_BX2], regs),
+                               true)
+                 * TLV493D_B_MULT;
+        data.y = ConcatResults(GetFromRegs(&RegMasks[R_BY1], regs),
+                               GetFromRegs(&RegMasks[R_BY2], regs),
+                               true)
+                 * TLV493D_B_MULT;
+        data.z = ConcatResults(GetFromRegs(&RegMasks[R_BZ1], regs),
+                               GetFromRegs(&RegMasks[R_BZ2], regs),
+                               true)
+                 * TLV493D_B_MULT;
+        const int16_t temp
+            = ConcatResults(GetFromRegs(&RegMasks[R_TEMP1], regs),
+                            GetFromRegs(&RegMasks[R_TEMP2], regs),
+                            false);
+        data.temp = static_cast<float>(temp - TLV493D_TEMP_OFFSET)
+                    * TLV493D_TEMP_MULT;
+        polled_.Write(data);
+    }
+
+    /** Get the latest readings of a SensorPoller, lock-free
+        \param data receives the readings
+        \return false if there weren't any yet
+    */
+    bool GetPolledData(PolledData &data) const { return polled_.Read(data); }
+
     void SetInterrupt(bool enable)
     {
         SetRegBits(W_INT, enable);
@@ -355,7 +430,10 @@ class Tlv493d
                           + pow(static_cast<float>(mYdata), 2)));
     }
 
-    uint16_t GetMeasurementDelay() { return accModes[mMode].measurementTime; }
+    uint16_t GetMeasurementDelay() const
+    {
+        return accModes[mMode].measurementTime;
+    }
 
     void SetAccessMode(AccessMode_e mode)
     {
@@ -389,7 +467,8 @@ class Tlv493d
         SetRegBits(W_PARITY, y & 0x01);
     }
 
-    int16_t ConcatResults(uint8_t upperByte, uint8_t lowerByte, bool upperFull)
+    int16_t
+    ConcatResults(uint8_t upperByte, uint8_t lowerByte, bool upperFull) const
     {
         //16-bit signed integer for 12-bit values of sensor
         int16_t value = 0x0000;
@@ -415,6 +494,8 @@ class Tlv493d
     int16_t   mXdata, mYdata, mZdata, mTempdata, mExpectedFrameCount, mMode;
     uint32_t  prev_sample_period_;
 
+    DoubleBuffer<PolledData> polled_;
+
     /** Get the global transport_error_ bool (as a Result), then reset it */
     Result GetTransportErr()
     {
@@ -441,7 +522,7 @@ class Tlv493d
         transport_.WriteAddress(0x00, &data, 1);
     }
 
-    uint8_t GetFromRegs(const RegMask_t *mask, uint8_t *regData)
+    uint8_t GetFromRegs(const RegMask_t *mask, const uint8_t *regData) const
     {
         return (regData[mask->byteAdress] & mask->bitMask) >> mask->shift;
     }
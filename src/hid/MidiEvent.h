@@ -1,6 +1,18 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
 // TODO: make this adjustable
 #define SYSEX_BUFFER_LEN 128
 
+/** Size of the ring shared by all SystemExclusive payloads.
+ *  Has to be a power of two, no larger than 32768.
+ */
+#ifndef SYSEX_RING_LEN
+#define SYSEX_RING_LEN 1024
+#endif
+
 namespace daisy
 {
 /** @addtogroup midi MIDI
@@ -17,7 +29,7 @@ namespace daisy
 /** Parsed from the Status Byte, these are the common Midi Messages that can be handled. \n
 At this time only 3-byte messages are correctly parsed into MidiEvents.
 */
-enum MidiMessageType
+enum MidiMessageType : uint8_t
 {
     NoteOff,               /**< & */
     NoteOn,                /**< & */
@@ -32,7 +44,7 @@ enum MidiMessageType
     MessageLast,           /**< & */
 };
 
-enum SystemCommonType
+enum SystemCommonType : uint8_t
 {
     SystemExclusive,     /**< & */
     MTCQuarterFrame,     /**< & */
@@ -45,7 +57,7 @@ enum SystemCommonType
     SystemCommonLast,    /**< & */
 };
 
-enum SystemRealTimeType
+enum SystemRealTimeType : uint8_t
 {
     TimingClock,        /**< & */
     SRTUndefined0,      /**< & */
@@ -58,7 +70,7 @@ enum SystemRealTimeType
     SystemRealTimeLast, /**< & */
 };
 
-enum ChannelModeType
+enum ChannelModeType : uint8_t
 {
     AllSoundOff,         /**< & */
     ResetAllControllers, /**< & */
@@ -234,19 +246,53 @@ struct PolyModeOnEvent
 };
 
 
+/** @brief Shared storage for the payloads of SystemExclusive MidiEvents
+ *  @details Keeps the MidiEvents small enough to be queued and copied by value:
+ *           instead of the payload, a SysEx event only carries a handle into
+ *           this ring. The ring holds the most recent SYSEX_RING_LEN bytes of
+ *           SysEx data of all parsers, so a payload has to be read before that
+ *           much newer SysEx data arrived. Older payloads read back as empty.
+ */
+class MidiSysExRing
+{
+  public:
+    /** Copies a payload into the ring.
+     *  \return the handle to read it back with
+     */
+    static uint16_t Write(const uint8_t* data, size_t len);
+
+    /** Copies a payload out of the ring.
+     *  \return false if the payload has been overwritten in the meantime
+     */
+    static bool Read(uint16_t handle, size_t len, uint8_t* dest);
+
+  private:
+    static_assert((SYSEX_RING_LEN & (SYSEX_RING_LEN - 1)) == 0,
+                  "SYSEX_RING_LEN has to be a power of two");
+    static_assert(SYSEX_RING_LEN <= 32768, "SYSEX_RING_LEN is too large");
+
+    static uint8_t           data_[SYSEX_RING_LEN];
+    static volatile uint16_t write_pos_;
+};
+
 /** Simple MidiEvent with message type, channel, and data[2] members.
+ *  Small enough (8 bytes) to be passed around by value. The payload of
+ *  SystemExclusive messages lives in the MidiSysExRing.
 */
 struct MidiEvent
 {
     // Newer ish.
-    MidiMessageType    type;                         /**< & */
-    int                channel;                      /**< & */
-    uint8_t            data[2];                      /**< & */
-    uint8_t            sysex_data[SYSEX_BUFFER_LEN]; /**< & */
-    uint8_t            sysex_message_len;
+    MidiMessageType type;    /**< & */
+    uint8_t         channel; /**< & */
+    union
+    {
+        uint8_t  data[2];      /**< & */
+        uint16_t sysex_handle; /**< Payload of a SystemExclusive message */
+    };
     SystemCommonType   sc_type;
     SystemRealTimeType srt_type;
     ChannelModeType    cm_type;
+    uint8_t            sysex_message_len;
 
     /** Returns the data within the MidiEvent as a NoteOffEvent struct */
     NoteOffEvent AsNoteOff()
@@ -330,14 +376,10 @@ struct MidiEvent
     {
         SystemExclusiveEvent m;
         m.length = sysex_message_len;
-        for(int i = 0; i < SYSEX_BUFFER_LEN; i++)
-        {
+        if(!MidiSysExRing::Read(sysex_handle, m.length, m.data))
+            m.length = 0;
+        for(int i = m.length; i < SYSEX_BUFFER_LEN; i++)
             m.data[i] = 0;
-            if(i < m.length)
-            {
-                m.data[i] = sysex_data[i];
-            }
-        }
         return m;
     }
     MTCQuarterFrameEvent AsMTCQuarterFrame()
@@ -1,4 +1,6 @@
 #include "hid/audio.h"
+#include "util/SampleConversion.h"
+#include "util/Trace.h"
 
 namespace daisy
 {
@@ -11,16 +13,27 @@ namespace daisy
 // these buffers will always be present, and usable.
 //
 static const size_t kAudioMaxBufferSize = 1024;
-static const size_t kAudioMaxChannels   = 4;
+
+// SAI peripherals available to the engine
+static const size_t kAudioMaxSai = 2;
+
+// Each pair of default buffers gets its own input section within SRAM1, so
+// that --gc-sections can drop the second pair on builds that never use two SAI.
+#define DSY_AUDIO_BUFFER_SECTION(name) \
+    __attribute__((section(".sram1_bss.dsy_audio_" name)))
 
 // Static Global Buffers
-// 8kB in SRAM1, non-cached memory
+// 8kB per SAI in SRAM1, non-cached memory
 // 1k samples in, 1k samples out, 4 bytes per sample.
 // One buffer per 2 channels (Interleaved on hardware)
-static int32_t DMA_BUFFER_MEM_SECTION
-    dsy_audio_rx_buffer[kAudioMaxChannels / 2][kAudioMaxBufferSize];
-static int32_t DMA_BUFFER_MEM_SECTION
-    dsy_audio_tx_buffer[kAudioMaxChannels / 2][kAudioMaxBufferSize];
+static int32_t DSY_AUDIO_BUFFER_SECTION("sai1")
+    dsy_audio_rx_buffer_sai1[kAudioMaxBufferSize];
+static int32_t DSY_AUDIO_BUFFER_SECTION("sai1")
+    dsy_audio_tx_buffer_sai1[kAudioMaxBufferSize];
+static int32_t DSY_AUDIO_BUFFER_SECTION("sai2")
+    dsy_audio_rx_buffer_sai2[kAudioMaxBufferSize];
+static int32_t DSY_AUDIO_BUFFER_SECTION("sai2")
+    dsy_audio_tx_buffer_sai2[kAudioMaxBufferSize];
 
 // ================================================================
 // Private Implementation Definition
@@ -32,33 +45,34 @@ class AudioHandle::Impl
     AudioHandle::Result Init(const AudioHandle::Config config, SaiHandle sai);
     AudioHandle::Result
                         Init(const AudioHandle::Config config, SaiHandle sai1, SaiHandle sai2);
+    AudioHandle::Result Init(const AudioHandle::Config config,
+                             const SaiHandle*          sai,
+                             size_t                    num_sai,
+                             int32_t* const*           buff_rx,
+                             int32_t* const*           buff_tx,
+                             size_t                    slots,
+                             size_t                    max_blocksize);
     AudioHandle::Result DeInit();
     AudioHandle::Result Start(AudioHandle::AudioCallback callback);
     AudioHandle::Result Start(AudioHandle::InterleavingAudioCallback callback);
+    AudioHandle::Result Start(AudioHandle::NativeAudioCallback callback);
     AudioHandle::Result Stop();
     AudioHandle::Result ChangeCallback(AudioHandle::AudioCallback callback);
     AudioHandle::Result
     ChangeCallback(AudioHandle::InterleavingAudioCallback callback);
+    AudioHandle::Result
+    ChangeCallback(AudioHandle::NativeAudioCallback callback);
 
-    inline size_t GetChannels() const
-    {
-        if(sai1_.IsInitialized() && sai2_.IsInitialized())
-            return 4;
-        else if(sai1_.IsInitialized() || sai2_.IsInitialized())
-            return 2;
-        else
-            return 0;
-    }
+    inline size_t GetChannels() const { return num_sai_ * slots_; }
 
     AudioHandle::Result SetBlockSize(size_t size)
     {
-        size_t maxSize    = kAudioMaxBufferSize / 4;
-        config_.blocksize = size <= maxSize ? size : maxSize;
-        return size <= maxSize ? AudioHandle::Result::OK
-                               : AudioHandle::Result::ERR;
+        config_.blocksize = size <= max_blocksize_ ? size : max_blocksize_;
+        return size <= max_blocksize_ ? AudioHandle::Result::OK
+                                      : AudioHandle::Result::ERR;
     }
 
-    float GetSampleRate() { return sai1_.GetSampleRate(); }
+    float GetSampleRate() { return sai_[0].GetSampleRate(); }
 
     AudioHandle::Result SetPostGain(float val)
     {
@@ -82,16 +96,43 @@ class AudioHandle::Impl
 
     AudioHandle::Result SetSampleRate(SaiHandle::Config::SampleRate sampelrate);
 
+    // Picks the conversion kernels for the current bit depth and slot count
+    AudioHandle::Result SelectKernels();
+
+    // Starts the DMA of all SAI, the first one drives the InternalCallback.
+    // Only the first SAI is started when first_only is set.
+    void StartDma(bool first_only);
+
+    // Returns the current DMA half of the rx/tx buffer of an SAI
+    inline int32_t* GetRxHalf(size_t idx) const
+    {
+        return buff_rx_[idx] + sai_[idx].GetOffset();
+    }
+    inline int32_t* GetTxHalf(size_t idx) const
+    {
+        return buff_tx_[idx] + sai_[idx].GetOffset();
+    }
+
     // Internal Callback
     static void InternalCallback(int32_t* in, int32_t* out, size_t size);
 
-    void *callback_, *interleaved_callback_;
+    void *callback_, *interleaved_callback_, *native_callback_;
+
+    // Conversion kernels, selected on Start()
+    SampleConversion::Kernels kernels_;
+    SampleConversion::Kernels interleaved_kernels_;
+
+    // Buffer layout reported to native callbacks, updated on Start()
+    AudioHandle::NativeFormat native_format_;
 
     // Data
     AudioHandle::Config config_;
-    SaiHandle           sai1_, sai2_;
-    int32_t*            buff_rx_[2];
-    int32_t*            buff_tx_[2];
+    SaiHandle           sai_[kAudioMaxSai];
+    size_t              num_sai_;
+    size_t              slots_;
+    size_t              max_blocksize_;
+    int32_t*            buff_rx_[kAudioMaxSai];
+    int32_t*            buff_tx_[kAudioMaxSai];
     float               postgain_recip_;
     float               output_adjust_;
 };
@@ -109,7 +150,35 @@ static AudioHandle::Impl audio_handle;
 AudioHandle::Result AudioHandle::Impl::Init(const AudioHandle::Config config,
                                             SaiHandle                 sai)
 {
-    config_ = config;
+    int32_t* rx[] = {dsy_audio_rx_buffer_sai1};
+    int32_t* tx[] = {dsy_audio_tx_buffer_sai1};
+    return Init(config, &sai, 1, rx, tx, 2, kAudioMaxBufferSize / 4);
+}
+
+AudioHandle::Result AudioHandle::Impl::Init(const AudioHandle::Config config,
+                                            SaiHandle                 sai1,
+                                            SaiHandle                 sai2)
+{
+    const SaiHandle sai[] = {sai1, sai2};
+    int32_t* rx[] = {dsy_audio_rx_buffer_sai1, dsy_audio_rx_buffer_sai2};
+    int32_t* tx[] = {dsy_audio_tx_buffer_sai1, dsy_audio_tx_buffer_sai2};
+    return Init(config, sai, 2, rx, tx, 2, kAudioMaxBufferSize / 4);
+}
+
+AudioHandle::Result AudioHandle::Impl::Init(const AudioHandle::Config config,
+                                            const SaiHandle*          sai,
+                                            size_t                    num_sai,
+                                            int32_t* const*           buff_rx,
+                                            int32_t* const*           buff_tx,
+                                            size_t                    slots,
+                                            size_t max_blocksize)
+{
+    config_        = config;
+    num_sai_       = 0;
+    slots_         = slots;
+    max_blocksize_ = max_blocksize;
+    if(config_.blocksize > max_blocksize_)
+        config_.blocksize = max_blocksize_;
 
     /** Precompute input level adjustment */
     if(config_.postgain > 0.f)
@@ -120,90 +189,117 @@ AudioHandle::Result AudioHandle::Impl::Init(const AudioHandle::Config config,
     /** Precompute output level adjustment */
     output_adjust_ = config_.postgain * config_.output_compensation;
 
-    if(sai.IsInitialized())
-    {
-        sai1_              = sai;
-        config_.samplerate = sai1_.GetConfig().sr;
-    }
-    else
-    {
+    if(num_sai == 0 || num_sai > kAudioMaxSai)
+        return Result::ERR;
+    if(!SaiHandle::Config::IsSupportedSlotCount(slots))
         return Result::ERR;
-    }
-    buff_rx_[0] = dsy_audio_rx_buffer[0];
-    buff_tx_[0] = dsy_audio_tx_buffer[0];
-    return Result::OK;
-}
 
-AudioHandle::Result AudioHandle::Impl::Init(const AudioHandle::Config config,
-                                            SaiHandle                 sai1,
-                                            SaiHandle                 sai2)
-{
-    this->Init(config, sai1);
-    sai2_       = sai2;
-    buff_rx_[1] = dsy_audio_rx_buffer[1];
-    buff_tx_[1] = dsy_audio_tx_buffer[1];
-    // How do we want to handle the rx/tx buffs for the second peripheral of audio..?
+    for(size_t i = 0; i < kAudioMaxSai; i++)
+    {
+        if(i < num_sai)
+        {
+            // All SAI have to share the frame layout of the first one
+            if(!sai[i].IsInitialized() || sai[i].GetConfig().slots != slots
+               || sai[i].GetConfig().bit_depth != sai[0].GetConfig().bit_depth)
+                return Result::ERR;
+            sai_[i]     = sai[i];
+            buff_rx_[i] = buff_rx[i];
+            buff_tx_[i] = buff_tx[i];
+        }
+        else
+        {
+            sai_[i]     = SaiHandle();
+            buff_rx_[i] = nullptr;
+            buff_tx_[i] = nullptr;
+        }
+    }
+    num_sai_           = num_sai;
+    config_.samplerate = sai_[0].GetConfig().sr;
     return Result::OK;
 }
 
 AudioHandle::Result AudioHandle::Impl::DeInit()
 {
     Stop();
-    if(sai1_.IsInitialized())
+    for(size_t i = 0; i < num_sai_; i++)
     {
-        if(sai1_.DeInit() != SaiHandle::Result::OK)
+        if(sai_[i].DeInit() != SaiHandle::Result::OK)
         {
             return Result::ERR;
         }
     }
-    if(sai2_.IsInitialized())
+    return Result::OK;
+}
+
+AudioHandle::Result AudioHandle::Impl::SelectKernels()
+{
+    if(num_sai_ == 0)
+        return Result::ERR;
+    const SaiHandle::Config::BitDepth bd = sai_[0].GetConfig().bit_depth;
+    kernels_             = SampleConversion::GetKernels(bd, slots_, false);
+    interleaved_kernels_ = SampleConversion::GetKernels(bd, slots_, true);
+    if(kernels_.in == nullptr || interleaved_kernels_.in == nullptr)
+        return Result::ERR;
+
+    native_format_.bit_depth           = bd;
+    native_format_.num_buffers         = num_sai_;
+    native_format_.channels_per_buffer = slots_;
+    return Result::OK;
+}
+
+void AudioHandle::Impl::StartDma(bool first_only)
+{
+    const size_t size = config_.blocksize * slots_ * 2;
+    if(!first_only)
     {
-        if(sai2_.DeInit() != SaiHandle::Result::OK)
-        {
-            return Result::ERR;
-        }
+        // Start streams with no callback. Data will be filled externally.
+        for(size_t i = num_sai_ - 1; i > 0; i--)
+            sai_[i].StartDma(buff_rx_[i], buff_tx_[i], size, nullptr);
     }
-    return Result::OK;
+    sai_[0].StartDma(
+        buff_rx_[0], buff_tx_[0], size, audio_handle.InternalCallback);
 }
 
 AudioHandle::Result
 AudioHandle::Impl::Start(AudioHandle::AudioCallback callback)
 {
-    // Get instance of object
-    if(sai2_.IsInitialized())
-    {
-        // Start stream with no callback. Data will be filled externally.
-        sai2_.StartDma(
-            buff_rx_[1], buff_tx_[1], config_.blocksize * 2 * 2, nullptr);
-    }
-    sai1_.StartDma(buff_rx_[0],
-                   buff_tx_[0],
-                   config_.blocksize * 2 * 2,
-                   audio_handle.InternalCallback);
+    if(SelectKernels() != Result::OK)
+        return Result::ERR;
+    StartDma(false);
     callback_             = (void*)callback;
     interleaved_callback_ = nullptr;
+    native_callback_      = nullptr;
     return Result::OK;
 }
 
 AudioHandle::Result
 AudioHandle::Impl::Start(AudioHandle::InterleavingAudioCallback callback)
 {
-    // Get instance of object
-    sai1_.StartDma(buff_rx_[0],
-                   buff_tx_[0],
-                   config_.blocksize * 2 * 2,
-                   audio_handle.InternalCallback);
+    if(SelectKernels() != Result::OK)
+        return Result::ERR;
+    StartDma(true);
     interleaved_callback_ = (void*)callback;
     callback_             = nullptr;
+    native_callback_      = nullptr;
+    return Result::OK;
+}
+
+AudioHandle::Result
+AudioHandle::Impl::Start(AudioHandle::NativeAudioCallback callback)
+{
+    if(SelectKernels() != Result::OK)
+        return Result::ERR;
+    StartDma(false);
+    native_callback_      = (void*)callback;
+    callback_             = nullptr;
+    interleaved_callback_ = nullptr;
     return Result::OK;
 }
 
 AudioHandle::Result AudioHandle::Impl::Stop()
 {
-    if(sai1_.IsInitialized())
-        sai1_.StopDma();
-    if(sai2_.IsInitialized())
-        sai2_.StopDma();
+    for(size_t i = 0; i < num_sai_; i++)
+        sai_[i].StopDma();
     return Result::OK;
 }
 
@@ -214,6 +310,7 @@ AudioHandle::Impl::ChangeCallback(AudioHandle::AudioCallback callback)
     {
         callback_             = (void*)callback;
         interleaved_callback_ = nullptr;
+        native_callback_      = nullptr;
         return Result::OK;
     }
     else
@@ -229,6 +326,7 @@ AudioHandle::Result AudioHandle::Impl::ChangeCallback(
     {
         interleaved_callback_ = (void*)callback;
         callback_             = nullptr;
+        native_callback_      = nullptr;
         return Result::OK;
     }
     else
@@ -238,27 +336,32 @@ AudioHandle::Result AudioHandle::Impl::ChangeCallback(
 }
 
 AudioHandle::Result
-AudioHandle::Impl::SetSampleRate(SaiHandle::Config::SampleRate samplerate)
+AudioHandle::Impl::ChangeCallback(AudioHandle::NativeAudioCallback callback)
 {
-    config_.samplerate = samplerate;
-    if(sai1_.IsInitialized())
+    if(callback != nullptr)
     {
-        // Set, and reinit
-        SaiHandle::Config cfg;
-        cfg    = sai1_.GetConfig();
-        cfg.sr = config_.samplerate;
-        if(sai1_.Init(cfg) != SaiHandle::Result::OK)
-        {
-            return Result::ERR;
-        }
+        native_callback_      = (void*)callback;
+        callback_             = nullptr;
+        interleaved_callback_ = nullptr;
+        return Result::OK;
     }
-    if(sai2_.IsInitialized())
+    else
+    {
+        return Result::ERR;
+    }
+}
+
+AudioHandle::Result
+AudioHandle::Impl::SetSampleRate(SaiHandle::Config::SampleRate samplerate)
+{
+    config_.samplerate = samplerate;
+    for(size_t i = 0; i < num_sai_; i++)
     {
         // Set, and reinit
         SaiHandle::Config cfg;
-        cfg    = sai2_.GetConfig();
+        cfg    = sai_[i].GetConfig();
         cfg.sr = config_.samplerate;
-        if(sai2_.Init(cfg) != SaiHandle::Result::OK)
+        if(sai_[i].Init(cfg) != SaiHandle::Result::OK)
         {
             return Result::ERR;
         }
@@ -266,218 +369,72 @@ AudioHandle::Impl::SetSampleRate(SaiHandle::Config::SampleRate samplerate)
     return Result::OK;
 }
 
-// This turned into a very large function due to the bit-depth conversions..
-// I didn't want to do a conditional conversion in a single loop because it seemed
-// far less efficient, so this is where I landed.
-//
-// Using function pointers for the x2f and f2x functions would have been ideal, but
-// wasn't possible due to the different parameter/return types for each function.
+// The bit depth and channel layout are resolved once in SelectKernels(),
+// so this only has to run one input and one output kernel per SAI buffer.
 void AudioHandle::Impl::InternalCallback(int32_t* in, int32_t* out, size_t size)
 {
+    DSY_TRACE_SCOPE(AUDIO_CALLBACK);
     // Convert from sai format to float, and call user callback
-    size_t                      chns;
-    SaiHandle::Config::BitDepth bd;
-    bd   = audio_handle.sai1_.GetConfig().bit_depth;
-    chns = audio_handle.GetChannels();
+    const size_t chns    = audio_handle.GetChannels();
+    const size_t num_sai = audio_handle.num_sai_;
+    const size_t slots   = audio_handle.slots_;
     if(chns == 0)
         return;
+    const float in_gain  = audio_handle.postgain_recip_;
+    const float out_gain = audio_handle.output_adjust_;
+    // Native callbacks work directly on the DMA buffers
+    if(audio_handle.native_callback_)
+    {
+        NativeAudioCallback cb
+            = (NativeAudioCallback)audio_handle.native_callback_;
+        const int32_t* nin[kAudioMaxSai]  = {in};
+        int32_t*       nout[kAudioMaxSai] = {out};
+        // offset needed for the other SAI
+        for(size_t i = 1; i < num_sai; i++)
+        {
+            nin[i]  = audio_handle.GetRxHalf(i);
+            nout[i] = audio_handle.GetTxHalf(i);
+        }
+        cb(nin, nout, size / slots, audio_handle.native_format_);
+    }
     // Handle Interleaved / Non Interleaved separate
-    if(audio_handle.interleaved_callback_)
+    else if(audio_handle.interleaved_callback_)
     {
         InterleavingAudioCallback cb
             = (InterleavingAudioCallback)audio_handle.interleaved_callback_;
-        float fin[size];
-        float fout[size];
-        // There _must_ be a more elegant way to do this....
-        // Convert from int to float
-        switch(bd)
-        {
-            case SaiHandle::Config::BitDepth::SAI_16BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    fin[i] = s162f(in[i]) * audio_handle.postgain_recip_;
-                    fin[i + 1]
-                        = s162f(in[i + 1]) * audio_handle.postgain_recip_;
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_24BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    fin[i] = s242f(in[i]) * audio_handle.postgain_recip_;
-                    fin[i + 1]
-                        = s242f(in[i + 1]) * audio_handle.postgain_recip_;
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_32BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    fin[i] = s322f(in[i]) * audio_handle.postgain_recip_;
-                    fin[i + 1]
-                        = s322f(in[i + 1]) * audio_handle.postgain_recip_;
-                }
-                break;
-            default: break;
-        }
+        const SampleConversion::Kernels& k = audio_handle.interleaved_kernels_;
+        float                            fin[size];
+        float                            fout[size];
+        float*                           fin_ptr  = fin;
+        const float*                     fout_ptr = fout;
+        k.in(in, &fin_ptr, size, in_gain);
         cb(fin, fout, size);
-        switch(bd)
-        {
-            case SaiHandle::Config::BitDepth::SAI_16BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    out[i] = f2s16(fout[i] * audio_handle.output_adjust_);
-                    out[i + 1]
-                        = f2s16(fout[i + 1] * audio_handle.output_adjust_);
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_24BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    out[i] = f2s24(fout[i] * audio_handle.output_adjust_);
-                    out[i + 1]
-                        = f2s24(fout[i + 1] * audio_handle.output_adjust_);
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_32BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    out[i] = f2s32(fout[i] * audio_handle.output_adjust_);
-                    out[i + 1]
-                        = f2s32(fout[i + 1] * audio_handle.output_adjust_);
-                }
-                break;
-            default: break;
-        }
+        k.out(&fout_ptr, out, size, out_gain);
     }
     else if(audio_handle.callback_)
     {
         AudioCallback cb = (AudioCallback)audio_handle.callback_;
-        // offset needed for 2nd audio codec.
-        size_t offset    = audio_handle.sai2_.GetOffset();
-        size_t buff_size = chns > 2 ? size * 2 : size;
-        float  finbuff[buff_size], foutbuff[buff_size];
-        float* fin[chns];
-        float* fout[chns];
-        fin[0]  = finbuff;
-        fin[1]  = finbuff + (buff_size / chns);
-        fout[0] = foutbuff;
-        fout[1] = foutbuff + (buff_size / chns);
-        if(chns > 2)
-        {
-            fin[2]  = fin[1] + (buff_size / chns);
-            fin[3]  = fin[2] + (buff_size / chns);
-            fout[2] = fout[1] + (buff_size / chns);
-            fout[3] = fout[2] + (buff_size / chns);
-        }
-        // Deinterleave and scale
-        switch(bd)
+        const SampleConversion::Kernels& k      = audio_handle.kernels_;
+        const size_t                     frames = size / slots;
+        float                            finbuff[frames * chns];
+        float                            foutbuff[frames * chns];
+        float*                           fin[chns];
+        float*                           fout[chns];
+        for(size_t i = 0; i < chns; i++)
         {
-            case SaiHandle::Config::BitDepth::SAI_16BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    fin[0][i / 2] = s162f(in[i]) * audio_handle.postgain_recip_;
-                    fin[1][i / 2]
-                        = s162f(in[i + 1]) * audio_handle.postgain_recip_;
-                    if(chns > 2)
-                    {
-                        fin[2][i / 2]
-                            = s162f(audio_handle.buff_rx_[1][offset + i])
-                              * audio_handle.postgain_recip_;
-                        fin[3][i / 2]
-                            = s162f(audio_handle.buff_rx_[1][offset + i + 1])
-                              * audio_handle.postgain_recip_;
-                    }
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_24BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    fin[0][i / 2] = s242f(in[i]) * audio_handle.postgain_recip_;
-                    fin[1][i / 2]
-                        = s242f(in[i + 1]) * audio_handle.postgain_recip_;
-                    if(chns > 2)
-                    {
-                        fin[2][i / 2]
-                            = s242f(audio_handle.buff_rx_[1][offset + i])
-                              * audio_handle.postgain_recip_;
-                        fin[3][i / 2]
-                            = s242f(audio_handle.buff_rx_[1][offset + i + 1])
-                              * audio_handle.postgain_recip_;
-                    }
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_32BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    fin[0][i / 2] = s322f(in[i]) * audio_handle.postgain_recip_;
-                    fin[1][i / 2]
-                        = s322f(in[i + 1]) * audio_handle.postgain_recip_;
-                    if(chns > 2)
-                    {
-                        fin[2][i / 2]
-                            = s322f(audio_handle.buff_rx_[1][offset + i])
-                              * audio_handle.postgain_recip_;
-                        fin[3][i / 2]
-                            = s322f(audio_handle.buff_rx_[1][offset + i + 1])
-                              * audio_handle.postgain_recip_;
-                    }
-                }
-                break;
-            default: break;
+            fin[i]  = finbuff + i * frames;
+            fout[i] = foutbuff + i * frames;
         }
-        cb(fin, fout, size / 2);
+        // Deinterleave and scale, all slots of an SAI in one pass
+        k.in(in, fin, frames, in_gain);
+        for(size_t i = 1; i < num_sai; i++)
+            k.in(audio_handle.GetRxHalf(i), fin + i * slots, frames, in_gain);
+        cb(fin, fout, frames);
         // Reinterleave and scale
-        switch(bd)
-        {
-            case SaiHandle::Config::BitDepth::SAI_16BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    out[i]
-                        = f2s16(fout[0][i / 2] * audio_handle.output_adjust_);
-                    out[i + 1]
-                        = f2s16(fout[1][i / 2] * audio_handle.output_adjust_);
-                    if(chns > 2)
-                    {
-                        audio_handle.buff_tx_[1][offset + i] = f2s16(
-                            fout[2][i / 2] * audio_handle.output_adjust_);
-                        audio_handle.buff_tx_[1][offset + i + 1] = f2s16(
-                            fout[3][i / 2] * audio_handle.output_adjust_);
-                    }
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_24BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    out[i]
-                        = f2s24(fout[0][i / 2] * audio_handle.output_adjust_);
-                    out[i + 1]
-                        = f2s24(fout[1][i / 2] * audio_handle.output_adjust_);
-                    if(chns > 2)
-                    {
-                        audio_handle.buff_tx_[1][offset + i] = f2s24(
-                            fout[2][i / 2] * audio_handle.output_adjust_);
-                        audio_handle.buff_tx_[1][offset + i + 1] = f2s24(
-                            fout[3][i / 2] * audio_handle.output_adjust_);
-                    }
-                }
-                break;
-            case SaiHandle::Config::BitDepth::SAI_32BIT:
-                for(size_t i = 0; i < size; i += 2)
-                {
-                    out[i]
-                        = f2s32(fout[0][i / 2] * audio_handle.output_adjust_);
-                    out[i + 1]
-                        = f2s32(fout[1][i / 2] * audio_handle.output_adjust_);
-                    if(chns > 2)
-                    {
-                        audio_handle.buff_tx_[1][offset + i] = f2s32(
-                            fout[2][i / 2] * audio_handle.output_adjust_);
-                        audio_handle.buff_tx_[1][offset + i + 1] = f2s32(
-                            fout[3][i / 2] * audio_handle.output_adjust_);
-                    }
-                }
-                break;
-            default: break;
-        }
+        k.out(fout, out, frames, out_gain);
+        for(size_t i = 1; i < num_sai; i++)
+            k.out(
+                fout + i * slots, audio_handle.GetTxHalf(i), frames, out_gain);
     }
 }
 
@@ -500,6 +457,19 @@ AudioHandle::Init(const Config& config, SaiHandle sai1, SaiHandle sai2)
     return pimpl_->Init(config, sai1, sai2);
 }
 
+AudioHandle::Result AudioHandle::Init(const Config&    config,
+                                      const SaiHandle* sai,
+                                      size_t           num_sai,
+                                      int32_t* const*  buff_rx,
+                                      int32_t* const*  buff_tx,
+                                      size_t           slots,
+                                      size_t           max_blocksize)
+{
+    pimpl_ = &audio_handle;
+    return pimpl_->Init(
+        config, sai, num_sai, buff_rx, buff_tx, slots, max_blocksize);
+}
+
 AudioHandle::Result AudioHandle::DeInit()
 {
     return pimpl_->DeInit();
@@ -541,6 +511,11 @@ AudioHandle::Result AudioHandle::Start(InterleavingAudioCallback callback)
     return pimpl_->Start(callback);
 }
 
+AudioHandle::Result AudioHandle::Start(NativeAudioCallback callback)
+{
+    return pimpl_->Start(callback);
+}
+
 AudioHandle::Result AudioHandle::Stop()
 {
     return pimpl_->Stop();
@@ -557,6 +532,11 @@ AudioHandle::ChangeCallback(InterleavingAudioCallback callback)
     return pimpl_->ChangeCallback(callback);
 }
 
+AudioHandle::Result AudioHandle::ChangeCallback(NativeAudioCallback callback)
+{
+    return pimpl_->ChangeCallback(callback);
+}
+
 AudioHandle::Result AudioHandle::SetPostGain(float val)
 {
     return pimpl_->SetPostGain(val);
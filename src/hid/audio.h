@@ -84,6 +84,63 @@ class AudioHandle
                                               InterleavingOutputBuffer out,
                                               size_t                   size);
 
+    /** Describes the layout of the buffers passed to a NativeAudioCallback */
+    struct NativeFormat
+    {
+        /** Bit depth of the samples, as configured on the SAI */
+        SaiHandle::Config::BitDepth bit_depth;
+
+        /** Number of buffers, one for each SAI in use */
+        size_t num_buffers;
+
+        /** Number of interleaved channels within each buffer */
+        size_t channels_per_buffer;
+    };
+
+    /** Native Input buffer
+     ** One pointer per SAI, directly into the DMA receive buffer.
+     ** Each is arranged as { L0, R0, L1, R1, . . . LN, RN } with the samples
+     ** right-aligned in the SAI's bit depth (e.g. 24-bit in the lower 3 bytes)
+     ** const so that the user can't modify the input
+     */
+    typedef const int32_t* const* NativeInputBuffer;
+
+    /** Native Output buffer
+     ** One pointer per SAI, directly into the DMA transmit buffer.
+     ** Arranged and formatted like the NativeInputBuffer
+     */
+    typedef int32_t* const* NativeOutputBuffer;
+
+    /** Native Audio Callback
+     ** Native audio callbacks skip all float conversion and scaling,
+     ** so neither the postgain, nor the output compensation are applied.
+     ** size is the number of frames in each buffer.
+     */
+    typedef void (*NativeAudioCallback)(NativeInputBuffer   in,
+                                        NativeOutputBuffer  out,
+                                        size_t              size,
+                                        const NativeFormat& format);
+
+    /** DMA buffers for the audio engine, sized at compile time.
+     ** Holds the double-buffered receive and transmit memory for
+     ** kNumSai SAI with kSlots channels each, at up to kMaxBlockSize frames.
+     ** Has to be placed in DMA accessible, non-cached memory, i.e.:
+     ** static AudioHandle::DmaBuffers<1, 8, 48> DMA_BUFFER_MEM_SECTION buffs;
+     */
+    template <size_t kNumSai, size_t kSlots, size_t kMaxBlockSize>
+    struct DmaBuffers
+    {
+        static_assert(kNumSai > 0 && kNumSai <= 2, "1 or 2 SAI supported");
+        static_assert(SaiHandle::Config::IsSupportedSlotCount(kSlots),
+                      "1, 2, 4, 8 or 16 slots supported");
+
+        /** Words per SAI, both halves of the double buffer */
+        static constexpr size_t kBufferSize = kMaxBlockSize * kSlots * 2;
+
+        int32_t rx[kNumSai][kBufferSize];
+        int32_t tx[kNumSai][kBufferSize];
+    };
+
     AudioHandle() : pimpl_(nullptr) {}
     ~AudioHandle() {}
 
@@ -96,6 +153,41 @@ class AudioHandle
     /** Initializes audio to run using two SAI, each configured in Stereo I2S mode. */
     Result Init(const Config& config, SaiHandle sai1, SaiHandle sai2);
 
+    /** Initializes audio to run on kNumSai SAI, using the buffers passed in
+     ** instead of the default ones.
+     ** All SAI have to be initialized with kSlots slots and the same bit depth,
+     ** which makes GetChannels() return kNumSai * kSlots.
+     ** The blocksize is limited to kMaxBlockSize.
+     */
+    template <size_t kNumSai, size_t kSlots, size_t kMaxBlockSize>
+    Result Init(const Config& config,
+                const SaiHandle (&sai)[kNumSai],
+                DmaBuffers<kNumSai, kSlots, kMaxBlockSize>& buffers)
+    {
+        int32_t* rx[kNumSai];
+        int32_t* tx[kNumSai];
+        for(size_t i = 0; i < kNumSai; i++)
+        {
+            rx[i] = buffers.rx[i];
+            tx[i] = buffers.tx[i];
+        }
+        return Init(config, sai, kNumSai, rx, tx, kSlots, kMaxBlockSize);
+    }
+
+    /** Initializes audio to run on num_sai SAI with user provided buffers.
+     ** Prefer the DmaBuffers overload, which sizes everything at compile time.
+     ** \param buff_rx one receive buffer per SAI, max_blocksize * slots * 2 words each
+     ** \param buff_tx one transmit buffer per SAI, same size
+     ** \param slots slots per SAI, 1, 2, 4, 8 or 16
+     */
+    Result Init(const Config&    config,
+                const SaiHandle* sai,
+                size_t           num_sai,
+                int32_t* const*  buff_rx,
+                int32_t* const*  buff_tx,
+                size_t           slots,
+                size_t           max_blocksize);
+
     /** Stops and deinitializes audio. */
     Result DeInit();
 
@@ -104,10 +196,9 @@ class AudioHandle
 
     /** Returns the number of channels of audio.  
      **
-     ** When using a single SAI this returns 2, when using two SAI it returns 4
+     ** This is the number of SAI times the number of slots per SAI.
+     ** When using a single SAI in I2S mode this returns 2, when using two SAI it returns 4
      ** If no SAI is initialized this returns 0
-     **
-     ** Eventually when we add non-standard I2S for each SAI this will be work differently
      */
     size_t GetChannels() const;
 
@@ -140,10 +231,15 @@ class AudioHandle
     Result Start(AudioCallback callback);
 
     /** Starts the Audio using the interleaving callback. 
-     ** For now only two channels are supported via this method. 
+     ** Only the channels of the first SAI are passed via this method.
      */
     Result Start(InterleavingAudioCallback callback);
 
+    /** Starts the Audio using the native callback.
+     ** The callback receives the DMA buffers in the SAI's integer format.
+     */
+    Result Start(NativeAudioCallback callback);
+
     /** Stop the Audio*/
     Result Stop();
 
@@ -153,6 +249,9 @@ class AudioHandle
     /** Immediatley changes the audio callback to the interleaving callback passed in. */
     Result ChangeCallback(InterleavingAudioCallback callback);
 
+    /** Immediatley changes the audio callback to the native callback passed in. */
+    Result ChangeCallback(NativeAudioCallback callback);
+
 
     class Impl;
 
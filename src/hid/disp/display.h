@@ -210,6 +210,10 @@ class OneBitGraphicsDisplay
  *          void Update() override { ... }
  *      };
  *  
+ *  Text, filled rectangles and horizontal or vertical lines are drawn with FillRect() and
+ *  DrawColumns(), which fall back to DrawPixel(). A child class with direct access to a
+ *  framebuffer can provide faster versions of these two functions, they are called the same
+ *  way as DrawPixel().
  */
 template <class ChildType>
 class OneBitGraphicsDisplayImpl : public OneBitGraphicsDisplay
@@ -231,6 +235,18 @@ class OneBitGraphicsDisplayImpl : public OneBitGraphicsDisplay
         int_fast16_t error  = deltaX - deltaY;
         int_fast16_t error2;
 
+        // horizontal and vertical lines are rectangles
+        if(x1 == x2 || y1 == y2)
+        {
+            ((ChildType*)(this))
+                ->ChildType::FillRect(x1 < x2 ? x1 : x2,
+                                      y1 < y2 ? y1 : y2,
+                                      x1 < x2 ? x2 : x1,
+                                      y1 < y2 ? y2 : y1,
+                                      on);
+            return;
+        }
+
         // If we write "ChildType::DrawPixel(x2, y2, on);", we end up with
         // all sorts of weird compiler errors when the Child class is a template
         // class. The only way around this is to use this very verbose syntax:
@@ -263,13 +279,7 @@ class OneBitGraphicsDisplayImpl : public OneBitGraphicsDisplay
     {
         if(fill)
         {
-            for(uint_fast8_t x = x1; x <= x2; x++)
-            {
-                for(uint_fast8_t y = y1; y <= y2; y++)
-                {
-                    ((ChildType*)(this))->ChildType::DrawPixel(x, y, on);
-                }
-            }
+            ((ChildType*)(this))->ChildType::FillRect(x1, y1, x2, y2, on);
         }
         else
         {
@@ -409,6 +419,22 @@ class OneBitGraphicsDisplayImpl : public OneBitGraphicsDisplay
             return 0;
         }
 
+        // Draw whole columns of the packed glyph if the font has them
+        if(font.columns != nullptr)
+        {
+            const size_t glyph_size
+                = font.FontWidth * ((font.FontHeight + 7) / 8);
+            ((ChildType*)(this))
+                ->ChildType::DrawColumns(currentX_,
+                                         currentY_,
+                                         font.columns + (ch - 32) * glyph_size,
+                                         font.FontWidth,
+                                         font.FontHeight,
+                                         on);
+            SetCursor(currentX_ + font.FontWidth, currentY_);
+            return ch;
+        }
+
         // Use the font to write
         for(i = 0; i < font.FontHeight; i++)
         {
@@ -470,6 +496,61 @@ class OneBitGraphicsDisplayImpl : public OneBitGraphicsDisplay
         return alignedRect;
     }
 
+    /**
+    Sets all pixels of a rectangle, the corners included.
+    Draws nothing if x1 > x2 or y1 > y2.
+    \param x1 x Coordinate of the top left corner
+    \param y1 y Coordinate of the top left corner
+    \param x2 x Coordinate of the bottom right corner
+    \param y2 y Coordinate of the bottom right corner
+    \param on on or off
+    */
+    void FillRect(uint_fast8_t x1,
+                  uint_fast8_t y1,
+                  uint_fast8_t x2,
+                  uint_fast8_t y2,
+                  bool         on)
+    {
+        for(uint_fast8_t x = x1; x <= x2; x++)
+        {
+            for(uint_fast8_t y = y1; y <= y2; y++)
+            {
+                ((ChildType*)(this))->ChildType::DrawPixel(x, y, on);
+            }
+        }
+    }
+
+    /**
+    Draws a bitmap in the layout of FontDef::columns: width bytes for each 8
+    rows, every byte a column of 8 pixels with the top pixel in the LSB.
+    Set bits are drawn on, the others off, like WriteChar() does.
+    \param x       x Coordinate of the top left corner
+    \param y       y Coordinate of the top left corner
+    \param columns the bitmap
+    \param width   width of the bitmap in pixels
+    \param height  height of the bitmap in pixels
+    \param on      on or off
+    */
+    void DrawColumns(uint_fast8_t   x,
+                     uint_fast8_t   y,
+                     const uint8_t* columns,
+                     uint_fast8_t   width,
+                     uint_fast8_t   height,
+                     bool           on)
+    {
+        for(uint_fast8_t row = 0; row < height; row++)
+        {
+            const uint8_t* page = columns + (row / 8) * width;
+            const uint8_t  mask = 1 << (row % 8);
+            for(uint_fast8_t col = 0; col < width; col++)
+            {
+                ((ChildType*)(this))
+                    ->ChildType::DrawPixel(
+                        x + col, y + row, (page[col] & mask) ? on : !on);
+            }
+        }
+    }
+
   private:
     uint32_t strlen(const char* string)
     {
@@ -112,6 +112,24 @@ class Rectangle
         return {int16_t(x_ + x), int16_t(y_ + y), width_, height_};
     }
 
+    /** Returns the smallest rectangle that contains both this rectangle and
+     *  the other one. Empty rectangles don't contribute to the result.
+     */
+    Rectangle UnitedWith(const Rectangle& other) const
+    {
+        if(other.IsEmpty())
+            return *this;
+        if(IsEmpty())
+            return other;
+        const auto left   = x_ < other.x_ ? x_ : other.x_;
+        const auto top    = y_ < other.y_ ? y_ : other.y_;
+        const auto right  = GetRight() > other.GetRight() ? GetRight()
+                                                          : other.GetRight();
+        const auto bottom = GetBottom() > other.GetBottom() ? GetBottom()
+                                                            : other.GetBottom();
+        return {left, top, int16_t(right - left), int16_t(bottom - top)};
+    }
+
     Rectangle WithLeft(int16_t left) const
     {
         const auto newWidth = int16_t((x_ - left) + width_);
@@ -44,6 +44,33 @@ class OledDisplay : public OneBitGraphicsDisplayImpl<OledDisplay<DisplayDriver>>
         driver_.DrawPixel(x, y, on);
     }
 
+    /**
+    Sets all pixels of a rectangle, see OneBitGraphicsDisplayImpl::FillRect().
+    Uses the driver's FillRect() if it has one, e.g. the SSD130xDriver.
+    */
+    void FillRect(uint_fast8_t x1,
+                  uint_fast8_t y1,
+                  uint_fast8_t x2,
+                  uint_fast8_t y2,
+                  bool         on)
+    {
+        FillRect(driver_, x1, y1, x2, y2, on, 0);
+    }
+
+    /**
+    Draws a bitmap, see OneBitGraphicsDisplayImpl::DrawColumns().
+    Uses the driver's DrawColumns() if it has one, e.g. the SSD130xDriver.
+    */
+    void DrawColumns(uint_fast8_t   x,
+                     uint_fast8_t   y,
+                     const uint8_t* columns,
+                     uint_fast8_t   width,
+                     uint_fast8_t   height,
+                     bool           on)
+    {
+        DrawColumns(driver_, x, y, columns, width, height, on, 0);
+    }
+
     /** 
     Writes the current display buffer to the OLED device using SPI or I2C depending on 
     how the object was initialized.
@@ -51,6 +78,58 @@ class OledDisplay : public OneBitGraphicsDisplayImpl<OledDisplay<DisplayDriver>>
     void Update() override { driver_.Update(); }
 
   private:
+    using Base = OneBitGraphicsDisplayImpl<OledDisplay<DisplayDriver>>;
+
+    // the int overloads are picked if the driver has the function
+    template <typename Driver>
+    auto FillRect(Driver&      driver,
+                  uint_fast8_t x1,
+                  uint_fast8_t y1,
+                  uint_fast8_t x2,
+                  uint_fast8_t y2,
+                  bool         on,
+                  int) -> decltype(driver.FillRect(x1, y1, x2, y2, on))
+    {
+        return driver.FillRect(x1, y1, x2, y2, on);
+    }
+    template <typename Driver>
+    void FillRect(Driver&,
+                  uint_fast8_t x1,
+                  uint_fast8_t y1,
+                  uint_fast8_t x2,
+                  uint_fast8_t y2,
+                  bool         on,
+                  long)
+    {
+        Base::FillRect(x1, y1, x2, y2, on);
+    }
+
+    template <typename Driver>
+    auto DrawColumns(Driver&        driver,
+                     uint_fast8_t   x,
+                     uint_fast8_t   y,
+                     const uint8_t* columns,
+                     uint_fast8_t   width,
+                     uint_fast8_t   height,
+                     bool           on,
+                     int)
+        -> decltype(driver.DrawColumns(x, y, columns, width, height, on))
+    {
+        return driver.DrawColumns(x, y, columns, width, height, on);
+    }
+    template <typename Driver>
+    void DrawColumns(Driver&,
+                     uint_fast8_t   x,
+                     uint_fast8_t   y,
+                     const uint8_t* columns,
+                     uint_fast8_t   width,
+                     uint_fast8_t   height,
+                     bool           on,
+                     long)
+    {
+        Base::DrawColumns(x, y, columns, width, height, on);
+    }
+
     DisplayDriver driver_;
 
     void Reset() { driver_.Reset(); };
@@ -2,8 +2,10 @@
 #include <cstdarg>
 #include <cstdio>
 #include <cassert>
+#include "stm32h7xx_hal.h"
 #include "logger.h"
 #include "sys/system.h"
+#include "util/DeferredFormat.h"
 
 namespace daisy
 {
@@ -18,10 +20,12 @@ void Logger<dest>::Print(const char* format, ...)
 template <LoggerDestination dest>
 void Logger<dest>::PrintV(const char* format, va_list va)
 {
-    tx_ptr_ += vsnprintf(
-        tx_buff_ + tx_ptr_, sizeof(tx_buff_) - tx_ptr_, format, va);
+    char   buff[LOGGER_BUFFER];
+    size_t len = vsnprintf(buff, sizeof(buff), format, va);
+    len        = Truncate(buff, len, sizeof(buff));
 
-    TransmitBuf();
+    ring_.Push(LOGGER_RECORD_TEXT, buff, len);
+    Kick();
 }
 
 template <LoggerDestination dest>
@@ -36,84 +40,206 @@ void Logger<dest>::PrintLine(const char* format, ...)
 template <LoggerDestination dest>
 void Logger<dest>::PrintLineV(const char* format, va_list va)
 {
-    tx_ptr_ += vsnprintf(
-        tx_buff_ + tx_ptr_, sizeof(tx_buff_) - tx_ptr_, format, va);
+    char   buff[LOGGER_BUFFER];
+    size_t len = vsnprintf(buff, sizeof(buff), format, va);
+    len        = AppendNewLine(buff, len, sizeof(buff));
+    len        = Truncate(buff, len, sizeof(buff));
 
-    AppendNewLine();
+    ring_.Push(LOGGER_RECORD_TEXT, buff, len);
+    Kick();
+}
 
-    TransmitBuf();
+template <LoggerDestination dest>
+void Logger<dest>::PrintDeferred(const char* format, ...)
+{
+    va_list va;
+    va_start(va, format);
+    PushDeferred(LOGGER_RECORD_DEFERRED, format, va);
+    va_end(va);
+}
+
+template <LoggerDestination dest>
+void Logger<dest>::PrintLineDeferred(const char* format, ...)
+{
+    va_list va;
+    va_start(va, format);
+    PushDeferred(LOGGER_RECORD_DEFERRED_LINE, format, va);
+    va_end(va);
+}
+
+template <LoggerDestination dest>
+void Logger<dest>::PushDeferred(LoggerRecords record,
+                                const char*   format,
+                                va_list       va)
+{
+    uint8_t      args[LOGGER_BUFFER];
+    const size_t size = DeferredFormat::Pack(format, va, args, sizeof(args));
+
+    ring_.Push(record, &format, sizeof(format), args, size);
+    Kick();
 }
 
 template <LoggerDestination dest>
 void Logger<dest>::StartLog(bool wait_for_pc)
 {
     impl_.Init();
-    /* if waiting for PC, use blocking transmission */
-    pc_sync_ = wait_for_pc ? LOGGER_SYNC_IN : LOGGER_SYNC_OUT;
-    /** transmit something to stall the UART until a terminal is connected
-     * at least two separate calls are required
-     */
+    /** send more whenever the destination has room */
+    impl_.SetTransmitCompleteCallback(&Process);
+
     PrintLine("Daisy is online");
     PrintLine("===============");
+    /** if waiting for PC, block until the greeting was taken */
+    if(wait_for_pc)
+    {
+        Flush();
+    }
     System::Delay(10);
 }
 
 template <LoggerDestination dest>
-void Logger<dest>::TransmitBuf()
+void Logger<dest>::Flush()
 {
-    /** if the buffer is full - treat as overflow */
-    if(tx_ptr_ >= sizeof(tx_buff_))
+    while(!ring_.IsEmpty() || tx_pos_ < tx_len_)
     {
-        /** indicate truncation with an unlikely character sequence "$$" */
-        tx_buff_[sizeof(tx_buff_) - 1] = '$';
-        tx_buff_[sizeof(tx_buff_) - 2] = '$';
+        impl_.Task();
+        Process();
+    }
+}
+
+template <LoggerDestination dest>
+void Logger<dest>::Kick()
+{
+    /** interrupt handlers only add to the queue,
+     *  the main loop or the transmit complete callback sends it
+     */
+    if(__get_IPSR() == 0)
+    {
+        Process();
+    }
+}
 
-        tx_ptr_ = sizeof(tx_buff_);
+template <LoggerDestination dest>
+void Logger<dest>::Process()
+{
+    /** e.g. when a transmit complete callback runs during Transmit() */
+    if(draining_.exchange(true, std::memory_order_acquire))
+    {
+        return;
     }
 
-    if(pc_sync_ >= LOGGER_SYNC_IN)
+    while(tx_pos_ < tx_len_ || Render())
     {
-        TransmitSync(tx_buff_, tx_ptr_);
-        tx_ptr_ = 0;
+        /** only send what's taken right away, the rest is sent later */
+        size_t bytes = impl_.GetTransmitSpace();
+        if(bytes > tx_len_ - tx_pos_)
+        {
+            bytes = tx_len_ - tx_pos_;
+        }
+        if(bytes == 0 || false == impl_.Transmit(tx_buff_ + tx_pos_, bytes))
+        {
+            break;
+        }
+        tx_pos_ += bytes;
+    }
+
+    draining_.store(false, std::memory_order_release);
+}
+
+template <LoggerDestination dest>
+bool Logger<dest>::Render()
+{
+    tx_pos_ = 0;
+    tx_len_ = 0;
+
+    const uint32_t dropped = ring_.GetNumDropped();
+    if(dropped != drops_reported_)
+    {
+        const int len = snprintf(tx_buff_,
+                                 sizeof(tx_buff_),
+                                 "[%lu log entries dropped]" LOGGER_NEWLINE,
+                                 (unsigned long)(dropped - drops_reported_));
+        tx_len_         = Truncate(tx_buff_, len, sizeof(tx_buff_));
+        drops_reported_ = dropped;
+        return true;
+    }
+
+    uint8_t        record;
+    const uint8_t* data;
+    size_t         size;
+    if(false == ring_.Peek(record, data, size))
+    {
+        return false;
+    }
+
+    if(record == LOGGER_RECORD_TEXT)
+    {
+        memcpy(tx_buff_, data, size);
+        tx_len_ = size;
     }
     else
     {
-        if(true == impl_.Transmit(tx_buff_, tx_ptr_))
+        const char* format;
+        memcpy(&format, data, sizeof(format));
+        size_t len = DeferredFormat::Format(tx_buff_,
+                                            sizeof(tx_buff_),
+                                            format,
+                                            data + sizeof(format),
+                                            size - sizeof(format));
+        if(record == LOGGER_RECORD_DEFERRED_LINE)
         {
-            pc_sync_++;
-            tx_ptr_ = 0;
+            len = AppendNewLine(tx_buff_, len, sizeof(tx_buff_));
         }
-        /** otherwise do not reset tx_ptr_
-         *  accumulate data while buffer size permits 
-         */
+        tx_len_ = Truncate(tx_buff_, len, sizeof(tx_buff_));
+    }
+    ring_.Pop();
+    return true;
+}
+
+template <LoggerDestination dest>
+size_t Logger<dest>::Truncate(char* buff, size_t len, size_t size)
+{
+    /** if the buffer is full - treat as overflow */
+    if(len >= size)
+    {
+        /** indicate truncation with an unlikely character sequence "$$" */
+        buff[size - 1] = '$';
+        buff[size - 2] = '$';
+
+        len = size;
     }
+    return len;
 }
 
 template <LoggerDestination dest>
-void Logger<dest>::AppendNewLine()
+size_t Logger<dest>::AppendNewLine(char* buff, size_t len, size_t size)
 {
+    if(len >= size)
+    {
+        return len;
+    }
+
     /*  trim existing control characters */
-    while(tx_ptr_ > 0
-          && (tx_buff_[tx_ptr_ - 1] == '\n' || tx_buff_[tx_ptr_ - 1] == '\r'))
+    while(len > 0 && (buff[len - 1] == '\n' || buff[len - 1] == '\r'))
     {
-        tx_ptr_--;
+        len--;
     }
 
     /* check if there's enough room for newline sequence */
     constexpr size_t eol = NewLineSeqLength();
-    if(tx_ptr_ + eol < sizeof(tx_buff_))
+    if(len + eol < size)
     {
         /* this loop will be optimized away by the compiler */
         constexpr const char* nl = LOGGER_NEWLINE;
         for(size_t i = 0; i < eol; i++)
         {
-            tx_buff_[tx_ptr_++] = nl[i];
+            buff[len++] = nl[i];
         }
     }
     else /**< trigger overflow indication */
     {
-        tx_ptr_ = sizeof(tx_buff_);
+        len = size;
     }
+    return len;
 }
 
 /** explicit forward specializations */
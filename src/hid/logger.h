@@ -5,7 +5,9 @@
 #include <cmath>
 #include <cstdarg>
 #include <cstdio>
+#include <atomic>
 #include "logger_impl.h"
+#include "util/LogRing.h"
 
 namespace daisy
 {
@@ -27,6 +29,7 @@ namespace daisy
  */
 #define LOGGER_NEWLINE "\r\n" /**< custom newline character sequence */
 #define LOGGER_BUFFER 128     /**< size in bytes */
+#define LOGGER_RING_SIZE 2048 /**< size of the queue of entries in bytes */
 
 /** 
  * Helper macros for string concatenation and macro expansion
@@ -63,6 +66,19 @@ namespace daisy
  *    @author Alexander Petrov-Savchenko (axp@soft-amp.com)
  *    @date November 2020
  *    
+ *    Entries are formatted by the caller and added to a lock-free queue,
+ *    which is sent from the main loop: right away when logging from the
+ *    main loop, and whenever the destination has room for more data, e.g.
+ *    when the USB host has read the previous data. Logging never waits
+ *    and can be done from interrupt handlers as well. Entries that don't
+ *    fit into the queue are dropped, see GetNumDroppedEntries().
+ *
+ *    PrintDeferred() goes one step further and only copies the arguments,
+ *    the text is formatted when it's sent.
+ *
+ *    If all logging is done from interrupt handlers, call Process()
+ *    regularly from the main loop.
+ *    
  *    Simple Example:
  *    @include SerialPrint.cpp
  * 
@@ -96,30 +112,67 @@ class Logger
      */
     static void PrintLineV(const char* format, va_list va);
 
+    /** Print formatted string, formatting it only when it's sent.
+     *  This only copies the arguments, strings up to 63 characters.
+     *  \param format has to stay valid, e.g. a string literal
+     */
+    static void PrintDeferred(const char* format, ...);
+
+    /** Print formatted string appending line termination sequence,
+     *  formatting it only when it's sent.
+     *  \param format has to stay valid, e.g. a string literal
+     */
+    static void PrintLineDeferred(const char* format, ...);
+
+    /** Sends as many entries as the destination takes right now.
+     *  This is done automatically when logging from the main loop and when
+     *  the destination has room for more data. Only call this from the main
+     *  loop.
+     */
+    static void Process();
+
+    /** Blocks until all entries were sent.
+     *  Only call this from the main loop.
+     */
+    static void Flush();
+
+    /** Returns the number of entries that were dropped because the queue
+     *  was full
+     */
+    static uint32_t GetNumDroppedEntries() { return ring_.GetNumDropped(); }
+
   protected:
-    /** Internal constants
+    /** Types of entries in the queue
      */
-    enum LoggerConsts
+    enum LoggerRecords
     {
-        LOGGER_SYNC_OUT = 0,
-        LOGGER_SYNC_IN  = 2 /**< successfully transmit this many packets 
-                             * before switching to blocking transfers */
+        LOGGER_RECORD_TEXT,          /**< formatted text */
+        LOGGER_RECORD_DEFERRED,      /**< format string and arguments */
+        LOGGER_RECORD_DEFERRED_LINE, /**< same, appending a newline */
     };
 
-    /** Blocking wrapper for Transmit()
+    /** Adds an entry with a format string and its arguments to the queue
      */
-    static void TransmitSync(const void* buffer, size_t bytes)
-    {
-        while(false == impl_.Transmit(buffer, bytes)) {}
-    }
+    static void
+    PushDeferred(LoggerRecords record, const char* format, va_list va);
 
-    /** Transfer accumulated data
+    /** Sends the queue, if not called from an interrupt handler
      */
-    static void TransmitBuf();
+    static void Kick();
+
+    /** Formats the oldest entry of the queue into tx_buff_
+     *  \return false if the queue is empty
+     */
+    static bool Render();
+
+    /** Clamps the length of formatted text, indicating truncation
+     */
+    static size_t Truncate(char* buff, size_t len, size_t size);
 
     /** Trim control characters and append clean newline sequence, if there's room in the buffer
+     *  \return the new length, more than size on overflow
      */
-    static void AppendNewLine();
+    static size_t AppendNewLine(char* buff, size_t len, size_t size);
 
     /** Constexpr function equivalent of strlen(LOGGER_NEWLINE)
      */
@@ -137,10 +190,13 @@ class Logger
     /** member variables
      */
 
-    static char             tx_buff_[LOGGER_BUFFER]; /**< buffer for log data */
-    static size_t           tx_ptr_;  /**< current position in the buffer */
-    static size_t           pc_sync_; /**< terminal synchronization state */
-    static LoggerImpl<dest> impl_;    /**< underlying trasnfer implementation */
+    static char     tx_buff_[LOGGER_BUFFER]; /**< entry that's being sent */
+    static size_t   tx_len_;         /**< length of the entry being sent */
+    static size_t   tx_pos_;         /**< bytes of the entry that were sent */
+    static uint32_t drops_reported_; /**< dropped entries already reported */
+    static std::atomic<bool>         draining_; /**< guards the consumer */
+    static LogRing<LOGGER_RING_SIZE> ring_;     /**< queue of entries */
+    static LoggerImpl<dest> impl_; /**< underlying trasnfer implementation */
 };
 
 /** @addtogroup logger_statics LoggerStaticMembers
@@ -153,13 +209,22 @@ class Logger
 template <LoggerDestination dest>
 char Logger<dest>::tx_buff_[LOGGER_BUFFER];
 
-/** start with non-blocking transfers to support startup-time printouts
- */
 template <LoggerDestination dest>
-size_t Logger<dest>::pc_sync_ = LOGGER_SYNC_OUT;
+size_t Logger<dest>::tx_len_ = 0;
+
+template <LoggerDestination dest>
+size_t Logger<dest>::tx_pos_ = 0;
 
 template <LoggerDestination dest>
-size_t Logger<dest>::tx_ptr_ = 0;
+uint32_t Logger<dest>::drops_reported_ = 0;
+
+template <LoggerDestination dest>
+std::atomic<bool> Logger<dest>::draining_(false);
+
+/** this needs to remain in SRAM to support startup-time printouts
+ */
+template <LoggerDestination dest>
+LogRing<LOGGER_RING_SIZE> Logger<dest>::ring_;
 
 template <LoggerDestination dest>
 LoggerImpl<dest> Logger<dest>::impl_;
@@ -178,6 +243,11 @@ class Logger<LOGGER_NONE>
     static void StartLog(bool wait_for_pc = false) {}         /**<  */
     static void PrintV(const char* format, va_list va) {}     /**<  */
     static void PrintLineV(const char* format, va_list va) {} /**<  */
+    static void PrintDeferred(const char* format, ...) {}     /**<  */
+    static void PrintLineDeferred(const char* format, ...) {} /**<  */
+    static void     Process() {}                              /**<  */
+    static void     Flush() {}                                /**<  */
+    static uint32_t GetNumDroppedEntries() { return 0; }      /**<  */
 };
 
 /** @} */
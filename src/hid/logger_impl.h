@@ -7,6 +7,9 @@
 #include "sys/system.h"
 
 
+/** Bytes a blocking destination takes at once */
+#define LOGGER_IMPL_TRANSMIT_SPACE 128
+
 namespace daisy
 {
 /** Enumeration of destination ports for debug logging
@@ -34,6 +37,18 @@ class LoggerImpl
     /** Transmit a block of data
      */
     static bool Transmit(const void* buffer, size_t bytes) { return true; }
+
+    /** Returns the number of bytes Transmit() takes right now
+     */
+    static size_t GetTransmitSpace() { return LOGGER_IMPL_TRANSMIT_SPACE; }
+
+    /** Sets the function to call when there's room for more data
+     */
+    static void SetTransmitCompleteCallback(void (*callback)()) {}
+
+    /** Runs the destination's background processing
+     */
+    static void Task() {}
 };
 
 
@@ -62,6 +77,21 @@ class LoggerImpl<LOGGER_INTERNAL>
                == usb_handle_.TransmitInternal((uint8_t*)buffer, bytes);
     }
 
+    /** Returns the number of bytes Transmit() takes right now
+     */
+    static size_t GetTransmitSpace() { return usb_handle_.GetTransmitSpace(); }
+
+    /** Sets the function to call when there's room for more data
+     */
+    static void SetTransmitCompleteCallback(void (*callback)())
+    {
+        usb_handle_.SetTransmitCompleteCallback(callback);
+    }
+
+    /** Runs the USB stack, which calls the transmit complete callback
+     */
+    static void Task() { UsbHandle::RunTask(); }
+
   protected:
     /** USB Handle for CDC transfers 
      */
@@ -94,6 +124,21 @@ class LoggerImpl<LOGGER_EXTERNAL>
                == usb_handle_.TransmitExternal((uint8_t*)buffer, bytes);
     }
 
+    /** Returns the number of bytes Transmit() takes right now
+     */
+    static size_t GetTransmitSpace() { return usb_handle_.GetTransmitSpace(); }
+
+    /** Sets the function to call when there's room for more data
+     */
+    static void SetTransmitCompleteCallback(void (*callback)())
+    {
+        usb_handle_.SetTransmitCompleteCallback(callback);
+    }
+
+    /** Runs the USB stack, which calls the transmit complete callback
+     */
+    static void Task() { UsbHandle::RunTask(); }
+
   protected:
     /** USB Handle for CDC transfers 
      */
@@ -118,6 +163,18 @@ class LoggerImpl<LOGGER_SEMIHOST>
         write(STDOUT_FILENO, buffer, bytes);
         return true;
     }
+
+    /** Returns the number of bytes Transmit() takes right now
+     */
+    static size_t GetTransmitSpace() { return LOGGER_IMPL_TRANSMIT_SPACE; }
+
+    /** Sets the function to call when there's room for more data
+     */
+    static void SetTransmitCompleteCallback(void (*callback)()) {}
+
+    /** Runs the destination's background processing
+     */
+    static void Task() {}
 };
 
 
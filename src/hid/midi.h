@@ -8,6 +8,7 @@
 #include "per/uart.h"
 #include "util/ringbuffer.h"
 #include "util/FIFO.h"
+#include "util/SpscQueue.h"
 #include "hid/midi_parser.h"
 #include "hid/usb_midi.h"
 #include "sys/dma.h"
@@ -145,6 +146,8 @@ class MidiUartTransport
     @brief Simple MIDI Handler \n
     Parses bytes from an input into valid MidiEvents. \n
     The MidiEvents fill a FIFO queue that the user can pop messages from.
+    The queue is lock-free, so the transport's interrupt can fill it while
+    the main loop pops events.
     @author shensley
     @date March 2020
     @ingroup midi
@@ -195,14 +198,20 @@ class MidiHandler
     /** Checks if there are unhandled messages in the queue
     \return True if there are events to be handled, else false.
      */
-    bool HasEvents() const { return event_q_.GetNumElements() > 0; }
+    bool HasEvents() const { return !event_q_.IsEmpty(); }
 
     bool RxActive() { return transport_.RxActive(); }
 
     /** Pops the oldest unhandled MidiEvent from the internal queue
-    \return The event to be handled
+    \return The event to be handled, a default constructed event if
+            the queue is empty
      */
-    MidiEvent PopEvent() { return event_q_.PopFront(); }
+    MidiEvent PopEvent()
+    {
+        MidiEvent event = MidiEvent();
+        event_q_.PopFront(event);
+        return event;
+    }
 
     /** SendMessage
     Send raw bytes as message
@@ -227,19 +236,28 @@ class MidiHandler
         }
     }
 
+    /** Feed in a block of bytes to the parser from an external source.
+        Populates internal FIFO queue with MIDI Messages.
+
+        \note  Normally application code won't need to use this method directly.
+        \param bytes MIDI bytes to be parsed
+        \param size  number of bytes
+    */
+    void Parse(const uint8_t* bytes, size_t size)
+    {
+        parser_.ParseBlock(bytes, size, event_q_);
+    }
+
   private:
-    Config               config_;
-    Transport            transport_;
-    MidiParser           parser_;
-    FIFO<MidiEvent, 256> event_q_;
+    Config                    config_;
+    Transport                 transport_;
+    MidiParser                parser_;
+    SpscQueue<MidiEvent, 256> event_q_;
 
     static void ParseCallback(uint8_t* data, size_t size, void* context)
     {
         MidiHandler* handler = reinterpret_cast<MidiHandler*>(context);
-        for(size_t i = 0; i < size; i++)
-        {
-            handler->Parse(data[i]);
-        }
+        handler->Parse(data, size);
     }
 };
 
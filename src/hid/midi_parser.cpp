@@ -1,7 +1,39 @@
 #include "midi_parser.h"
+#include "util/scopedirqblocker.h"
+#include <string.h>
 
 using namespace daisy;
 
+uint8_t           MidiSysExRing::data_[SYSEX_RING_LEN];
+volatile uint16_t MidiSysExRing::write_pos_ = 0;
+
+uint16_t MidiSysExRing::Write(const uint8_t* data, size_t len)
+{
+    // only the reservation has to be atomic, parsers running from
+    // different interrupts then copy to separate regions
+    uint16_t handle;
+    {
+        ScopedIrqBlocker irq_blocker;
+        handle     = write_pos_;
+        write_pos_ = uint16_t(handle + len);
+    }
+    for(size_t i = 0; i < len; i++)
+        data_[(handle + i) & (SYSEX_RING_LEN - 1)] = data[i];
+    return handle;
+}
+
+bool MidiSysExRing::Read(uint16_t handle, size_t len, uint8_t* dest)
+{
+    // positions are free running, so the distance to the write position
+    // tells whether the payload is still in the ring
+    if(uint16_t(write_pos_ - handle) > SYSEX_RING_LEN)
+        return false;
+    for(size_t i = 0; i < len; i++)
+        dest[i] = data_[(handle + i) & (SYSEX_RING_LEN - 1)];
+    // a newer payload may have been written while copying
+    return uint16_t(write_pos_ - handle) <= SYSEX_RING_LEN;
+}
+
 bool MidiParser::Parse(uint8_t byte, MidiEvent* event_out)
 {
     // reset parser when status byte is received
@@ -78,10 +110,7 @@ bool MidiParser::Parse(uint8_t byte, MidiEvent* event_out)
                 incoming_message_.type    = running_status_;
                 incoming_message_.data[0] = byte & kDataByteMask;
                 //check for single byte running status, really this only applies to channel pressure though
-                if(running_status_ == ChannelPressure
-                   || running_status_ == ProgramChange
-                   || incoming_message_.sc_type == MTCQuarterFrame
-                   || incoming_message_.sc_type == SongSelect)
+                if(HasSingleDataByte())
                 {
                     //Send the single byte update
                     pstate_ = ParserEmpty;
@@ -101,10 +130,7 @@ bool MidiParser::Parse(uint8_t byte, MidiEvent* event_out)
             if((byte & kStatusByteMask) == 0)
             {
                 incoming_message_.data[0] = byte & kDataByteMask;
-                if(running_status_ == ChannelPressure
-                   || running_status_ == ProgramChange
-                   || incoming_message_.sc_type == MTCQuarterFrame
-                   || incoming_message_.sc_type == SongSelect)
+                if(HasSingleDataByte())
                 {
                     //these are just one data byte, so we short circuit back to start
                     pstate_ = ParserEmpty;
@@ -167,6 +193,8 @@ bool MidiParser::Parse(uint8_t byte, MidiEvent* event_out)
             if(byte == 0xf7)
             {
                 pstate_ = ParserEmpty;
+                incoming_message_.sysex_handle = MidiSysExRing::Write(
+                    sysex_data_, incoming_message_.sysex_message_len);
                 if(event_out != nullptr)
                 {
                     *event_out = incoming_message_;
@@ -175,9 +203,7 @@ bool MidiParser::Parse(uint8_t byte, MidiEvent* event_out)
             }
             else if(incoming_message_.sysex_message_len < SYSEX_BUFFER_LEN)
             {
-                incoming_message_
-                    .sysex_data[incoming_message_.sysex_message_len]
-                    = byte;
+                sysex_data_[incoming_message_.sysex_message_len] = byte;
                 incoming_message_.sysex_message_len++;
             }
             break;
@@ -190,5 +216,7 @@ bool MidiParser::Parse(uint8_t byte, MidiEvent* event_out)
 void MidiParser::Reset()
 {
     pstate_                = ParserEmpty;
+    incoming_message_      = MidiEvent();
     incoming_message_.type = MessageLast;
+    running_status_        = NoteOff;
 }
@@ -33,12 +33,83 @@ class MidiParser
      */
     bool Parse(uint8_t byte, MidiEvent *event_out);
 
+    /**
+     * @brief Parse a whole block of MIDI bytes, e.g. one UART DMA transfer
+     *        or USB packet. Produces the same events as calling Parse() for
+     *        each byte, but runs of data bytes under running status are
+     *        handled in a tight loop, and the events go straight to the sink.
+     *
+     * @param data  Raw MIDI bytes to parse
+     * @param size  Number of bytes
+     * @param sink  Destination of the events. Anything with a
+     *              PushBack(const MidiEvent&) method, like a FIFO<MidiEvent, N>
+     * @return      Number of events parsed
+     */
+    template <typename EventSink>
+    size_t ParseBlock(const uint8_t *data, size_t size, EventSink &sink)
+    {
+        size_t    num_events = 0;
+        size_t    i          = 0;
+        MidiEvent event;
+        while(i < size)
+        {
+            // Fast path: data bytes under running status, from the state
+            // Parse() would handle them in one message at a time.
+            if(pstate_ == ParserEmpty && (data[i] & kStatusByteMask) == 0)
+            {
+                incoming_message_.type = running_status_;
+                if(HasSingleDataByte())
+                {
+                    while(i < size && (data[i] & kStatusByteMask) == 0)
+                    {
+                        incoming_message_.data[0] = data[i++];
+                        sink.PushBack(incoming_message_);
+                        num_events++;
+                    }
+                }
+                else
+                {
+                    while(i + 1 < size
+                          && ((data[i] | data[i + 1]) & kStatusByteMask) == 0)
+                    {
+                        incoming_message_.type    = running_status_;
+                        incoming_message_.data[0] = data[i];
+                        incoming_message_.data[1] = data[i + 1];
+                        //velocity 0 NoteOns are NoteOffs
+                        if(running_status_ == NoteOn && data[i + 1] == 0)
+                            incoming_message_.type = NoteOff;
+                        sink.PushBack(incoming_message_);
+                        num_events++;
+                        i += 2;
+                    }
+                }
+                if(i >= size)
+                    break;
+            }
+            if(Parse(data[i++], &event))
+            {
+                sink.PushBack(event);
+                num_events++;
+            }
+        }
+        return num_events;
+    }
+
     /**
      * @brief Reset parser to default state
      */
     void Reset();
 
   private:
+    /** true if the current message is complete after one data byte */
+    inline bool HasSingleDataByte() const
+    {
+        return running_status_ == ChannelPressure
+               || running_status_ == ProgramChange
+               || incoming_message_.sc_type == MTCQuarterFrame
+               || incoming_message_.sc_type == SongSelect;
+    }
+
     enum ParserState
     {
         ParserEmpty,
@@ -51,6 +122,9 @@ class MidiParser
     MidiEvent       incoming_message_;
     MidiMessageType running_status_;
 
+    // SysEx payload being received, moved to the MidiSysExRing when complete
+    uint8_t sysex_data_[SYSEX_BUFFER_LEN];
+
     // Masks to check for message type, and byte content
     const uint8_t kStatusByteMask     = 0x80;
     const uint8_t kMessageMask        = 0x70;
@@ -3,6 +3,7 @@
 #include "hid/usb.h"
 #include "sys/system.h"
 #include "util/ringbuffer.h"
+#include "util/SpscQueue.h"
 
 namespace daisy
 {
@@ -38,6 +38,8 @@ extern "C"
 
 UsbHandle::ReceiveCallback rx_callback;
 
+static UsbHandle::TransmitCompleteCallback tx_complete_callback = nullptr;
+
 static void InitFS()
 {
     rx_callback = DummyRxCallback;
@@ -405,6 +407,24 @@ void UsbHandle::SetReceiveCallback(ReceiveCallback cb, UsbPeriph dev)
     }
 }
 
+size_t UsbHandle::GetTransmitSpace()
+{
+    return tud_cdc_write_available();
+}
+
+void UsbHandle::SetTransmitCompleteCallback(TransmitCompleteCallback cb)
+{
+    tx_complete_callback = cb;
+}
+
+// Invoked by tinyusb from tud_task() when a transmission completed
+extern "C" void tud_cdc_tx_complete_cb(uint8_t itf)
+{
+    (void)itf;
+    if(tx_complete_callback != nullptr)
+        tx_complete_callback();
+}
+
 // Static Function Implementation
 static void UsbErrorHandler()
 {
@@ -37,6 +37,9 @@ class UsbHandle
     /** Function called upon reception of a buffer */
     typedef void (*ReceiveCallback)(uint8_t* buff, uint32_t* len);
 
+    /** Function called when transmitted data was sent to the host */
+    typedef void (*TransmitCompleteCallback)();
+
     UsbHandle() {}
 
     ~UsbHandle() {}
@@ -69,6 +72,18 @@ class UsbHandle
      */
     void SetReceiveCallback(ReceiveCallback cb, UsbPeriph dev);
 
+    /** Returns the number of bytes that can be transmitted right now
+     *  without anything being dropped.
+     */
+    size_t GetTransmitSpace();
+
+    /** sets the callback to be called when a transmission to the host
+    completed, i.e. when there's room for more data.
+    It's called from RunTask().
+    \param cb Function to serve as callback, or nullptr
+     */
+    void SetTransmitCompleteCallback(TransmitCompleteCallback cb);
+
     /** Calls the underlying dispatching task
      *  Without an RTOS the tinyusb middleware
      *  requires that this function be called regularly as all
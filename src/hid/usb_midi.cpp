@@ -27,7 +27,7 @@ class MidiUsbTransport::Impl
     }
 
     bool RxActive() { return rx_active_; }
-    void FlushRx() { rx_buffer_.Flush(); }
+    void FlushRx() { rx_buffer_.Clear(); }
     void Tx(uint8_t* buffer, size_t size);
 
     void UsbToMidi(uint8_t* buffer, uint8_t length);
@@ -45,9 +45,9 @@ class MidiUsbTransport::Impl
     static constexpr size_t kBufferSize = 1024;
     bool                    rx_active_;
     // This corresponds to 256 midi messages
-    RingBuffer<uint8_t, kBufferSize> rx_buffer_;
-    MidiRxParseCallback              parse_callback_;
-    void*                            parse_context_;
+    SpscQueue<uint8_t, kBufferSize> rx_buffer_;
+    MidiRxParseCallback             parse_callback_;
+    void*                           parse_context_;
 
     // simple, self-managed buffer
     uint8_t tx_buffer_[kBufferSize];
@@ -184,9 +184,7 @@ void MidiUsbTransport::Impl::UsbToMidi(uint8_t* buffer, uint8_t length)
     // Only writing as many bytes as necessary
     for(uint8_t i = 0; i < code_index_size_[code_index]; i++)
     {
-        if(rx_buffer_.writable() > 0)
-            rx_buffer_.Write(buffer[1 + i]);
-        else
+        if(!rx_buffer_.PushBack(buffer[1 + i]))
         {
             rx_active_ = false; // disable on overflow
             break;
@@ -321,13 +319,9 @@ void MidiUsbTransport::Impl::Parse()
 {
     if(parse_callback_)
     {
-        uint8_t bytes[kBufferSize];
-        size_t  i = 0;
-        while(!rx_buffer_.isEmpty())
-        {
-            bytes[i++] = rx_buffer_.Read();
-        }
-        parse_callback_(bytes, i, parse_context_);
+        uint8_t      bytes[kBufferSize];
+        const size_t size = rx_buffer_.PopFront(bytes, kBufferSize);
+        parse_callback_(bytes, size, parse_context_);
     }
 }
 
@@ -0,0 +1,282 @@
+#include <string.h>
+#include "hid/wavstreamer.h"
+#include "daisy_core.h"
+
+using namespace daisy;
+
+namespace
+{
+/** Adds frames to the outputs, one channel at a time */
+template <typename Sample>
+void AddFrames(const uint8_t* src,
+               size_t         src_channels,
+               size_t         frame_bytes,
+               float* const*  out,
+               size_t         num_channels,
+               size_t         offset,
+               size_t         frames,
+               float          gain)
+{
+    for(size_t c = 0; c < num_channels; c++)
+    {
+        // mono goes to all outputs
+        const size_t src_channel = src_channels == 1 ? 0 : c;
+        if(src_channel >= src_channels)
+            break;
+        const uint8_t* s   = src + src_channel * Sample::kBytes;
+        float*         dst = out[c] + offset;
+        for(size_t i = 0; i < frames; i++)
+        {
+            dst[i] += Sample::ToFloat(s) * gain;
+            s += frame_bytes;
+        }
+    }
+}
+} // namespace
+
+WavStreamVoice::WavStreamVoice()
+: buffer_(nullptr),
+  buffer_size_(0),
+  read_size_(0),
+  is_open_(false),
+  looping_(false),
+  file_pos_(0),
+  file_ended_(true),
+  write_pos_(0),
+  read_pos_(0),
+  ended_(true),
+  playing_(false),
+  starvation_count_(0)
+{
+    memset(&format_, 0, sizeof(format_));
+}
+
+WavStreamVoice::Result
+WavStreamVoice::Init(uint8_t* buffer, size_t size, size_t read_size)
+{
+    Close();
+    if(buffer == nullptr || size == 0 || (size & (size - 1)) != 0
+       || read_size == 0 || read_size % 512 != 0 || read_size > size / 2)
+        return Result::ERR_BUFFER;
+    buffer_      = buffer;
+    buffer_size_ = size;
+    read_size_   = read_size;
+    return Result::OK;
+}
+
+WavStreamVoice::Result WavStreamVoice::Open(const char* path, bool play)
+{
+    Close();
+    if(buffer_ == nullptr)
+        return Result::ERR_BUFFER;
+    if(f_open(&fil_, path, FA_OPEN_EXISTING | FA_READ) != FR_OK)
+        return Result::ERR_FILE;
+    is_open_ = true;
+
+    Result result = Result::ERR_FORMAT;
+    if(WavParser::ReadHeader(&fil_, format_, kMaxChannels))
+        result = Rewind();
+    if(result != Result::OK)
+    {
+        Close();
+        return result;
+    }
+    if(play)
+        Play();
+    return Result::OK;
+}
+
+void WavStreamVoice::Close()
+{
+    Stop();
+    if(is_open_)
+        f_close(&fil_);
+    is_open_    = false;
+    file_ended_ = true;
+    ended_.store(true, std::memory_order_release);
+}
+
+WavStreamVoice::Result WavStreamVoice::Restart()
+{
+    if(!is_open_)
+        return Result::ERR_FILE;
+    const bool was_playing = IsPlaying();
+    Stop();
+    const Result result = Rewind();
+    if(result == Result::OK && was_playing)
+        Play();
+    return result;
+}
+
+WavStreamVoice::Result WavStreamVoice::Rewind()
+{
+    if(f_lseek(&fil_, format_.data_offset) != FR_OK)
+        return Result::ERR_FILE;
+    file_pos_   = format_.data_offset;
+    file_ended_ = format_.data_size == 0;
+    // starting at the data offset puts the file data at the same position
+    // in the buffer as in the aligned reads
+    write_pos_.store(file_pos_, std::memory_order_relaxed);
+    read_pos_.store(file_pos_, std::memory_order_relaxed);
+    ended_.store(file_ended_, std::memory_order_release);
+
+    while(Prepare() > 0) {}
+    return Result::OK;
+}
+
+size_t WavStreamVoice::Prepare()
+{
+    if(!is_open_ || file_ended_)
+        return 0;
+
+    const uint32_t data_end = format_.data_offset + format_.data_size;
+    const uint32_t w        = write_pos_.load(std::memory_order_relaxed);
+    const uint32_t used = w - read_pos_.load(std::memory_order_acquire);
+
+    // up to the next read_size_ boundary in the file, and only when the
+    // whole read fits, so that they stay large and aligned
+    uint32_t size = read_size_ - file_pos_ % read_size_;
+    if(size > data_end - file_pos_)
+        size = data_end - file_pos_;
+    if(size > buffer_size_ - used)
+        return 0;
+    const uint32_t idx = w & (buffer_size_ - 1);
+    if(size > buffer_size_ - idx)
+        size = buffer_size_ - idx;
+
+    UINT bytes_read = 0;
+    if(f_read(&fil_, buffer_ + idx, size, &bytes_read) != FR_OK
+       || bytes_read == 0)
+    {
+        // play what's there
+        file_ended_ = true;
+        ended_.store(true, std::memory_order_release);
+        return 0;
+    }
+    file_pos_ += bytes_read;
+    write_pos_.store(w + bytes_read, std::memory_order_release);
+
+    if(file_pos_ >= data_end)
+    {
+        if(looping_ && f_lseek(&fil_, format_.data_offset) == FR_OK)
+        {
+            file_pos_ = format_.data_offset;
+        }
+        else
+        {
+            file_ended_ = true;
+            ended_.store(true, std::memory_order_release);
+        }
+    }
+    return bytes_read;
+}
+
+size_t WavStreamVoice::GetFreeSpace() const
+{
+    if(!is_open_ || file_ended_)
+        return 0;
+    return buffer_size_
+           - (write_pos_.load(std::memory_order_relaxed)
+              - read_pos_.load(std::memory_order_acquire));
+}
+
+size_t WavStreamVoice::GetBufferedFrames() const
+{
+    if(format_.block_align == 0)
+        return 0;
+    // read first, it can only fall behind the write position
+    const uint32_t r = read_pos_.load(std::memory_order_acquire);
+    return (write_pos_.load(std::memory_order_acquire) - r)
+           / format_.block_align;
+}
+
+size_t WavStreamVoice::Render(float* const* out,
+                              size_t        num_channels,
+                              size_t        frames,
+                              float         gain)
+{
+    if(!playing_.load(std::memory_order_acquire))
+        return 0;
+
+    // once ended_ is set, the write position is final
+    const bool     ended = ended_.load(std::memory_order_acquire);
+    const uint32_t r     = read_pos_.load(std::memory_order_relaxed);
+    const uint32_t w     = write_pos_.load(std::memory_order_acquire);
+    const size_t   available = (w - r) / format_.block_align;
+    const size_t   num       = frames < available ? frames : available;
+
+    DecodeFrames(r, out, num_channels, num, gain);
+    read_pos_.store(r + num * format_.block_align, std::memory_order_release);
+
+    if(num < frames)
+    {
+        if(ended)
+            Stop();
+        else
+            starvation_count_++;
+    }
+    return num;
+}
+
+void WavStreamVoice::DecodeFrames(uint32_t      pos,
+                                  float* const* out,
+                                  size_t        num_channels,
+                                  size_t        frames,
+                                  float         gain) const
+{
+    const size_t frame_bytes = format_.block_align;
+    size_t       done        = 0;
+    while(done < frames)
+    {
+        const uint32_t idx = pos & (buffer_size_ - 1);
+        const uint8_t* src = buffer_ + idx;
+        size_t         num = (buffer_size_ - idx) / frame_bytes;
+        uint8_t        frame[kMaxChannels * 4];
+        if(num == 0)
+        {
+            // the frame wraps around the end of the buffer
+            const size_t first = buffer_size_ - idx;
+            memcpy(frame, src, first);
+            memcpy(frame + first, buffer_, frame_bytes - first);
+            src = frame;
+            num = 1;
+        }
+        else if(num > frames - done)
+        {
+            num = frames - done;
+        }
+        DecodeSpan(src, out, num_channels, done, num, gain);
+        pos += num * frame_bytes;
+        done += num;
+    }
+}
+
+void WavStreamVoice::DecodeSpan(const uint8_t* src,
+                                float* const*  out,
+                                size_t         num_channels,
+                                size_t         offset,
+                                size_t         frames,
+                                float          gain) const
+{
+    const size_t chns = format_.num_channels;
+    const size_t fb   = format_.block_align;
+    switch(format_.sample_format)
+    {
+        case SampleFormat::S16:
+            AddFrames<WavParser::S16>(
+                src, chns, fb, out, num_channels, offset, frames, gain);
+            break;
+        case SampleFormat::S24:
+            AddFrames<WavParser::S24>(
+                src, chns, fb, out, num_channels, offset, frames, gain);
+            break;
+        case SampleFormat::S32:
+            AddFrames<WavParser::S32>(
+                src, chns, fb, out, num_channels, offset, frames, gain);
+            break;
+        case SampleFormat::F32:
+            AddFrames<WavParser::F32>(
+                src, chns, fb, out, num_channels, offset, frames, gain);
+            break;
+    }
+}
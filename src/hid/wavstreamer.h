@@ -0,0 +1,290 @@
+#pragma once
+#ifndef DSY_WAVSTREAMER_H
+#define DSY_WAVSTREAMER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "util/WavParser.h"
+#include "ff.h"
+
+namespace daisy
+{
+/** @brief Streams one .wav file from an SD card, for the WavStreamer
+ *  @ingroup audio
+ *
+ *  The file data is read into a ring buffer from the main loop with
+ *  Prepare(), and Render() decodes whole blocks of it to float in the
+ *  audio callback. The ring buffer holds the raw file data, so the reads
+ *  go straight from the card into it, in read_size chunks that are aligned
+ *  in the file. Put the ring buffer in the SDRAM for large buffers.
+ *
+ *  Supported are 16, 24 and 32 bit integer and 32 bit float files with
+ *  up to kMaxChannels channels, including WAVE_FORMAT_EXTENSIBLE headers.
+ *  Chunks other than "fmt " and "data" are skipped.
+ *
+ *  - Open(), Close(), Restart() and Prepare() are called from the main
+ *    loop.
+ *  - Render() is called from the audio callback.
+ *  - Play(), Stop() and SetLooping() can be called from both.
+ *
+ *  When Render() needs more frames than are buffered before the end of
+ *  the file, the missing frames are silent and the starvation counter
+ *  goes up. A non-zero GetStarvationCount() means that the SD card reads
+ *  can't keep up, e.g. because Prepare() isn't called often enough or the
+ *  buffer is too small.
+ */
+class WavStreamVoice
+{
+  public:
+    enum class Result
+    {
+        OK,
+        ERR_FILE,
+        ERR_FORMAT,
+        ERR_BUFFER,
+    };
+
+    using SampleFormat = WavParser::SampleFormat;
+    using Format       = WavParser::Format;
+
+    static constexpr size_t kMaxChannels = 8;
+
+    WavStreamVoice();
+
+    /** Initializes the voice with its ring buffer.
+     *  \param buffer ring buffer memory, 4 byte aligned
+     *  \param size size of the buffer, a power of two
+     *  \param read_size bytes per f_read(), a multiple of 512 and at most
+     *                   half the buffer size
+     */
+    Result Init(uint8_t* buffer, size_t size, size_t read_size = 8192);
+
+    /** Opens a file, reads its header and fills the ring buffer.
+     *  \param path path of the file
+     *  \param play starts playing right away if true
+     */
+    Result Open(const char* path, bool play = true);
+
+    /** Stops playing and closes the file */
+    void Close();
+
+    /** Starts playing the open file, where it was stopped */
+    void Play() { playing_.store(is_open_, std::memory_order_release); }
+
+    /** Stops playing. Render() doesn't output anything until Play(). */
+    void Stop() { playing_.store(false, std::memory_order_release); }
+
+    /** Goes back to the start of the file and fills the buffer again.
+     *  Keeps playing if it was.
+     */
+    Result Restart();
+
+    /** Sets whether the file starts over when it ends. The loop is
+     *  seamless, as the start of the file is read right after the end.
+     */
+    void SetLooping(bool loop) { looping_ = loop; }
+
+    bool GetLooping() const { return looping_; }
+
+    bool IsOpen() const { return is_open_; }
+
+    bool IsPlaying() const
+    {
+        return playing_.load(std::memory_order_acquire);
+    }
+
+    /** Returns the format of the open file */
+    const Format& GetFormat() const { return format_; }
+
+    /** Reads the next chunk of the file if there's room for it.
+     *  \return number of bytes read, 0 if there was nothing to do
+     */
+    size_t Prepare();
+
+    /** Returns the number of bytes that can be read into the buffer */
+    size_t GetFreeSpace() const;
+
+    /** Returns the number of frames in the buffer */
+    size_t GetBufferedFrames() const;
+
+    /** Decodes frames from the buffer and adds them to out.
+     *  Mono files are added to all outputs. Other files are added channel
+     *  by channel, extra channels of the file or the output are skipped.
+     *  \param out one buffer per output channel
+     *  \param num_channels number of output channels
+     *  \param frames number of frames to add
+     *  \param gain multiplied with the samples
+     *  \return number of frames added
+     */
+    size_t Render(float* const* out,
+                  size_t        num_channels,
+                  size_t        frames,
+                  float         gain = 1.0f);
+
+    /** Returns how many times Render() ran out of buffered frames */
+    uint32_t GetStarvationCount() const { return starvation_count_; }
+
+    void ResetStarvationCount() { starvation_count_ = 0; }
+
+  private:
+    /** Seeks to the start of the data and fills the buffer */
+    Result Rewind();
+
+    void DecodeFrames(uint32_t      pos,
+                      float* const* out,
+                      size_t        num_channels,
+                      size_t        frames,
+                      float         gain) const;
+
+    void DecodeSpan(const uint8_t* src,
+                    float* const*  out,
+                    size_t         num_channels,
+                    size_t         offset,
+                    size_t         frames,
+                    float          gain) const;
+
+    FIL      fil_;
+    Format   format_;
+    uint8_t* buffer_;
+    uint32_t buffer_size_;
+    uint32_t read_size_;
+    bool     is_open_;
+    bool     looping_;
+    /** main loop only: offset of the next read in the file */
+    uint32_t file_pos_;
+    bool     file_ended_;
+
+    // free running positions in the stream of file data
+    std::atomic<uint32_t> write_pos_;
+    std::atomic<uint32_t> read_pos_;
+    /** set once the last data of the file is in the buffer */
+    std::atomic<bool> ended_;
+    std::atomic<bool> playing_;
+    uint32_t          starvation_count_;
+
+    WavStreamVoice(const WavStreamVoice&) = delete;
+    WavStreamVoice& operator=(const WavStreamVoice&) = delete;
+};
+
+/** @brief Plays several .wav files from an SD card at the same time
+ *  @ingroup audio
+ *
+ *  Splits one large buffer, e.g. in the SDRAM, into the ring buffers of
+ *  kNumVoices WavStreamVoices. Call Prepare() from the main loop to keep
+ *  the buffers filled, and Render() from the audio callback to mix all
+ *  voices into the output.
+ *
+ *  \code{.cpp}
+ *  static uint8_t DSY_SDRAM_BSS stream_buffer[4 * 1024 * 1024];
+ *  WavStreamer<8> streamer;
+ *
+ *  void AudioCallback(AudioHandle::InputBuffer  in,
+ *                     AudioHandle::OutputBuffer out,
+ *                     size_t                    size)
+ *  {
+ *      streamer.Render(out, 2, size);
+ *  }
+ *
+ *  // in main()
+ *  streamer.Init(stream_buffer, sizeof(stream_buffer));
+ *  streamer.GetVoice(0).Open("0:/drums.wav");
+ *  while(1)
+ *      streamer.Prepare();
+ *  \endcode
+ *
+ *  \tparam kNumVoices number of voices
+ */
+template <size_t kNumVoices>
+class WavStreamer
+{
+  public:
+    using Result = WavStreamVoice::Result;
+
+    WavStreamer() {}
+
+    /** Initializes the voices with equal shares of a buffer.
+     *  \param buffer memory for all ring buffers, 4 byte aligned
+     *  \param size size of the buffer. Each voice gets the largest power
+     *              of two that fits into size / kNumVoices.
+     *  \param read_size bytes per f_read(), a multiple of 512
+     */
+    Result Init(uint8_t* buffer, size_t size, size_t read_size = 8192)
+    {
+        size_t voice_size = 1;
+        while(voice_size * 2 <= size / kNumVoices)
+            voice_size *= 2;
+        for(size_t i = 0; i < kNumVoices; i++)
+        {
+            uint8_t*     voice_buffer = buffer + i * voice_size;
+            const Result result
+                = voices_[i].Init(voice_buffer, voice_size, read_size);
+            if(result != Result::OK)
+                return result;
+        }
+        return Result::OK;
+    }
+
+    WavStreamVoice& GetVoice(size_t idx) { return voices_[idx]; }
+
+    constexpr size_t GetNumVoices() const { return kNumVoices; }
+
+    /** Reads one chunk for the voice with the most free space.
+     *  Call this often from the main loop.
+     *  \return true if a chunk was read
+     */
+    bool Prepare()
+    {
+        WavStreamVoice* neediest = nullptr;
+        size_t          most     = 0;
+        for(auto& voice : voices_)
+        {
+            const size_t free = voice.GetFreeSpace();
+            if(free > most)
+            {
+                most     = free;
+                neediest = &voice;
+            }
+        }
+        if(neediest != nullptr && neediest->Prepare() > 0)
+            return true;
+        // that one may be waiting for room for an aligned read
+        for(auto& voice : voices_)
+            if(&voice != neediest && voice.Prepare() > 0)
+                return true;
+        return false;
+    }
+
+    /** Clears out and mixes all playing voices into it.
+     *  \param out one buffer per output channel
+     *  \param num_channels number of output channels
+     *  \param frames number of frames
+     */
+    void Render(float* const* out, size_t num_channels, size_t frames)
+    {
+        for(size_t c = 0; c < num_channels; c++)
+            for(size_t i = 0; i < frames; i++)
+                out[c][i] = 0.0f;
+        for(auto& voice : voices_)
+            voice.Render(out, num_channels, frames);
+    }
+
+    /** Returns the starvation count of all voices together */
+    uint32_t GetStarvationCount() const
+    {
+        uint32_t count = 0;
+        for(const auto& voice : voices_)
+            count += voice.GetStarvationCount();
+        return count;
+    }
+
+  private:
+    WavStreamVoice voices_[kNumVoices];
+
+    WavStreamer(const WavStreamer&) = delete;
+    WavStreamer& operator=(const WavStreamer&) = delete;
+};
+
+} // namespace daisy
+
+#endif
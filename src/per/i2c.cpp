@@ -1,6 +1,8 @@
 #include "per/i2c.h"
 #include "sys/system.h"
 #include "util/scopedirqblocker.h"
+#include "util/FIFO.h"
+#include "util/Trace.h"
 extern "C"
 {
 #include "util/hal_map.h"
@@ -24,7 +26,8 @@ class I2CHandle::Impl
                                   uint8_t*                       data,
                                   uint16_t                       size,
                                   I2CHandle::CallbackFunctionPtr callback,
-                                  void* callback_context);
+                                  void*               callback_context,
+                                  I2CHandle::Priority priority);
 
     I2CHandle::Result ReceiveBlocking(uint16_t address,
                                       uint8_t* data,
@@ -35,7 +38,32 @@ class I2CHandle::Impl
                                  uint8_t*                       data,
                                  uint16_t                       size,
                                  I2CHandle::CallbackFunctionPtr callback,
-                                 void* callback_context);
+                                 void*               callback_context,
+                                 I2CHandle::Priority priority);
+
+    I2CHandle::Result
+    ReadRegistersDma(uint16_t                       address,
+                     uint16_t                       mem_address,
+                     uint16_t                       mem_address_size,
+                     uint8_t*                       data,
+                     uint16_t                       size,
+                     I2CHandle::CallbackFunctionPtr callback,
+                     void*                          callback_context,
+                     I2CHandle::Priority            priority);
+
+    I2CHandle::Result
+    WriteRegistersDma(uint16_t                       address,
+                      uint16_t                       mem_address,
+                      uint16_t                       mem_address_size,
+                      uint8_t*                       data,
+                      uint16_t                       size,
+                      I2CHandle::CallbackFunctionPtr callback,
+                      void*                          callback_context,
+                      I2CHandle::Priority            priority);
+
+    size_t              GetNumQueuedDmaTransfers() const;
+    I2CHandle::DmaStats GetDmaStats() const;
+    void                ResetDmaStats();
 
     I2CHandle::Result ReadDataAtAddress(uint16_t address,
                                         uint16_t mem_address,
@@ -55,28 +83,35 @@ class I2CHandle::Impl
     // scheduling and global functions
     struct DmaJob
     {
-        uint16_t                       slave_address    = 0x10;
-        uint8_t*                       data             = nullptr;
-        uint16_t                       size             = 0;
+        uint16_t slave_address = 0x10;
+        uint8_t* data          = nullptr;
+        uint16_t size          = 0;
+        /** register address written before the data, if mem_address_size
+         *  isn't 0 */
+        uint16_t                       mem_address      = 0;
+        uint16_t                       mem_address_size = 0;
         I2CHandle::CallbackFunctionPtr callback         = nullptr;
         void*                          callback_context = nullptr;
         I2CHandle::Direction direction = I2CHandle::Direction::TRANSMIT;
-
-        bool IsValidJob() const { return data != nullptr; }
-        void Invalidate() { data = nullptr; }
+        /** number of times the job was restarted after an error */
+        uint8_t retries = 0;
     };
     static void GlobalInit();
     static bool IsDmaActive();
-    static bool IsDmaTransferQueuedFor(size_t i2c_peripheral_idx);
-    static void QueueDmaTransfer(size_t i2c_peripheral_idx, const DmaJob& job);
+    static bool IsDmaTransferQueued();
     static void DmaTransferFinished(I2C_HandleTypeDef* hal_i2c_handle,
                                     I2CHandle::Result  result);
-
-    static constexpr uint8_t              kNumI2CWithDma = 3;
-    static volatile int8_t                dma_active_peripheral_;
-    static DmaJob                         queued_dma_transfers_[kNumI2CWithDma];
-    static I2CHandle::CallbackFunctionPtr next_callback_;
-    static void*                          next_callback_context_;
+    static void StartNextQueuedDmaJob();
+
+    static constexpr uint8_t kNumI2CWithDma = 3;
+    static constexpr size_t  kNumPriorities = 3;
+    static volatile int8_t   dma_active_peripheral_;
+    static int8_t            last_peripheral_;
+    static DmaJob            active_job_;
+    static uint32_t          active_job_start_;
+    static FIFO<DmaJob, I2C_DMA_QUEUE_LEN>
+        queued_dma_transfers_[kNumI2CWithDma][kNumPriorities];
+    static I2CHandle::DmaStats dma_stats_[kNumI2CWithDma];
 
     // =========================================================
     // pivate functions and member variables
@@ -84,18 +119,13 @@ class I2CHandle::Impl
     DMA_HandleTypeDef i2c_dma_tc_handle_;
     I2C_HandleTypeDef i2c_hal_handle_;
 
-    I2CHandle::Result
-    StartDmaTransmission(uint16_t                       address,
-                         uint8_t*                       data,
-                         uint16_t                       size,
-                         I2CHandle::CallbackFunctionPtr callback,
-                         void*                          callback_context);
-
-    I2CHandle::Result StartDmaReception(uint16_t                       address,
-                                        uint8_t*                       data,
-                                        uint16_t                       size,
-                                        I2CHandle::CallbackFunctionPtr callback,
-                                        void* callback_context);
+    /** Starts the job right away if the DMA is idle, or queues it.
+     *  Never waits.
+     */
+    I2CHandle::Result StartOrQueueDmaJob(const DmaJob&       job,
+                                         I2CHandle::Priority priority);
+    /** Starts a job, the DMA has to be idle */
+    I2CHandle::Result StartDmaJob(const DmaJob& job);
 
     void InitPins();
     void DeinitPins();
@@ -123,10 +153,15 @@ static I2CHandle::Impl i2c_handles[4];
 
 void I2CHandle::Impl::GlobalInit()
 {
-    // init the scheduler queue
+    // init the scheduler queues
     dma_active_peripheral_ = -1;
+    last_peripheral_       = kNumI2CWithDma - 1;
     for(int per = 0; per < kNumI2CWithDma; per++)
-        queued_dma_transfers_[per] = I2CHandle::Impl::DmaJob();
+    {
+        for(auto& queue : queued_dma_transfers_[per])
+            queue.Clear();
+        dma_stats_[per] = I2CHandle::DmaStats();
+    }
 }
 
 bool I2CHandle::Impl::IsDmaActive()
@@ -134,79 +169,168 @@ bool I2CHandle::Impl::IsDmaActive()
     return dma_active_peripheral_ >= 0;
 }
 
-bool I2CHandle::Impl::IsDmaTransferQueuedFor(size_t i2c_peripheral_idx)
+bool I2CHandle::Impl::IsDmaTransferQueued()
 {
-    return queued_dma_transfers_[i2c_peripheral_idx].IsValidJob();
+    for(const auto& queues : queued_dma_transfers_)
+        for(const auto& queue : queues)
+            if(!queue.IsEmpty())
+                return true;
+    return false;
 }
 
-void I2CHandle::Impl::QueueDmaTransfer(size_t i2c_peripheral_idx,
-                                       const I2CHandle::Impl::DmaJob& job)
+I2CHandle::Result
+I2CHandle::Impl::StartOrQueueDmaJob(const DmaJob&       job,
+                                    I2CHandle::Priority priority)
 {
-    // wait for any previous job on this peripheral to finish
-    // and the queue position to bevome free
-    while(IsDmaTransferQueuedFor(i2c_peripheral_idx)) {};
+    // I2C4 has no DMA yet.
+    const int per = int(config_.periph);
+    if(per >= kNumI2CWithDma)
+        return I2CHandle::Result::ERR;
 
-    // queue the job
-    ScopedIrqBlocker block;
-    queued_dma_transfers_[i2c_peripheral_idx] = job;
+    ScopedIrqBlocker     block;
+    I2CHandle::DmaStats& stats = dma_stats_[per];
+
+    // if dma is currently running - queue the job. Jobs that are already
+    // waiting go first, so that the priorities are kept. When the queue is
+    // full, the job is rejected instead of waiting for a free position.
+    if(IsDmaActive() || IsDmaTransferQueued())
+    {
+        if(!queued_dma_transfers_[per][size_t(priority)].PushBack(job))
+        {
+            stats.rejected++;
+            return I2CHandle::Result::ERR;
+        }
+        stats.queued++;
+        if(!IsDmaActive())
+            StartNextQueuedDmaJob();
+        // TODO: the user can't tell if he got returned "OK"
+        // because the transfer was executed or because it was queued...
+        // should we change that?
+        return I2CHandle::Result::OK;
+    }
+
+    // start transmission right away
+    const I2CHandle::Result result = StartDmaJob(job);
+    if(result == I2CHandle::Result::OK)
+        stats.queued++;
+    return result;
+}
+
+void I2CHandle::Impl::StartNextQueuedDmaJob()
+{
+    // highest priority first. Within a priority, round robin starting
+    // after the peripheral that transferred last, so that a busy peripheral
+    // can't starve the others. A job that fails to start is finished with
+    // an error and the next one is tried.
+    while(!IsDmaActive())
+    {
+        int    per   = -1;
+        size_t prio  = kNumPriorities;
+        bool   found = false;
+        while(!found && prio > 0)
+        {
+            prio--;
+            for(int i = 1; i <= kNumI2CWithDma && !found; i++)
+            {
+                per   = (last_peripheral_ + i) % kNumI2CWithDma;
+                found = !queued_dma_transfers_[per][prio].IsEmpty();
+            }
+        }
+        if(!found)
+            return;
+
+        last_peripheral_ = per;
+        const DmaJob job = queued_dma_transfers_[per][prio].PopFront();
+        if(i2c_handles[per].StartDmaJob(job) != I2CHandle::Result::OK)
+        {
+            dma_stats_[per].failed++;
+            if(job.callback != nullptr)
+                job.callback(job.callback_context, I2CHandle::Result::ERR);
+        }
+    }
 }
 
 void I2CHandle::Impl::DmaTransferFinished(I2C_HandleTypeDef* hal_i2c_handle,
                                           I2CHandle::Result  result)
 {
     ScopedIrqBlocker block;
+    DSY_TRACE_SCOPE(I2C_DMA_DONE, uint16_t(dma_active_peripheral_));
+
+    // not a transfer started by the scheduler
+    const int per = dma_active_peripheral_;
+    if(per < 0 || &i2c_handles[per].i2c_hal_handle_ != hal_i2c_handle)
+        return;
+    I2CHandle::DmaStats& stats = dma_stats_[per];
 
     // on an error, reinit the peripheral to clear any flags
     if(result != I2CHandle::Result::OK)
+    {
+        if(HAL_I2C_GetError(hal_i2c_handle) & HAL_I2C_ERROR_AF)
+            stats.nacks++;
         HAL_I2C_Init(hal_i2c_handle);
+    }
 
+    stats.busy_ticks += System::GetTick() - active_job_start_;
     dma_active_peripheral_ = -1;
 
-    if(next_callback_ != nullptr)
+    // restart failed jobs right away, before any other job gets the DMA
+    if(result != I2CHandle::Result::OK
+       && active_job_.retries < i2c_handles[per].config_.dma_retries)
     {
-        // the callback may setup another transmission, hence we shouldn't reset this to
-        // nullptr after the callback - it might overwrite the new transmission.
-        auto callback  = next_callback_;
-        next_callback_ = nullptr;
-        // make the callback
-        callback(next_callback_context_, result);
+        DmaJob job = active_job_;
+        job.retries++;
+        stats.retries++;
+        if(i2c_handles[per].StartDmaJob(job) == I2CHandle::Result::OK)
+            return;
     }
 
+    if(result == I2CHandle::Result::OK)
+        stats.completed++;
+    else
+        stats.failed++;
+
+    // the callback may setup another transmission and overwrite the job
+    const auto callback         = active_job_.callback;
+    const auto callback_context = active_job_.callback_context;
+    if(callback != nullptr)
+        callback(callback_context, result);
+
     // the callback could have started a new transmission right away...
     if(IsDmaActive())
         return;
 
-    // dma is still idle. Check if another i2c peripheral waits for a job.
-    for(int per = 0; per < kNumI2CWithDma; per++)
-        if(IsDmaTransferQueuedFor(per))
-        {
-            I2CHandle::Result result;
-            if(queued_dma_transfers_[per].direction
-               == I2CHandle::Direction::TRANSMIT)
-            {
-                result = i2c_handles[per].StartDmaTransmission(
-                    queued_dma_transfers_[per].slave_address,
-                    queued_dma_transfers_[per].data,
-                    queued_dma_transfers_[per].size,
-                    queued_dma_transfers_[per].callback,
-                    queued_dma_transfers_[per].callback_context);
-            }
-            else
-            {
-                result = i2c_handles[per].StartDmaReception(
-                    queued_dma_transfers_[per].slave_address,
-                    queued_dma_transfers_[per].data,
-                    queued_dma_transfers_[per].size,
-                    queued_dma_transfers_[per].callback,
-                    queued_dma_transfers_[per].callback_context);
-            }
-            if(result == I2CHandle::Result::OK)
-            {
-                // remove the job from the queue
-                queued_dma_transfers_[per].Invalidate();
-                return;
-            }
-        }
+    // dma is still idle. Check if another job waits.
+    StartNextQueuedDmaJob();
+}
+
+size_t I2CHandle::Impl::GetNumQueuedDmaTransfers() const
+{
+    const int per = int(config_.periph);
+    if(per >= kNumI2CWithDma)
+        return 0;
+    ScopedIrqBlocker block;
+    size_t           num = 0;
+    for(const auto& queue : queued_dma_transfers_[per])
+        num += queue.GetNumElements();
+    return num;
+}
+
+I2CHandle::DmaStats I2CHandle::Impl::GetDmaStats() const
+{
+    const int per = int(config_.periph);
+    if(per >= kNumI2CWithDma)
+        return I2CHandle::DmaStats();
+    ScopedIrqBlocker block;
+    return dma_stats_[per];
+}
+
+void I2CHandle::Impl::ResetDmaStats()
+{
+    const int per = int(config_.periph);
+    if(per >= kNumI2CWithDma)
+        return;
+    ScopedIrqBlocker block;
+    dma_stats_[per] = I2CHandle::DmaStats();
 }
 
 // ================================================================
@@ -315,37 +439,17 @@ I2CHandle::Impl::TransmitDma(uint16_t                       address,
                              uint8_t*                       data,
                              uint16_t                       size,
                              I2CHandle::CallbackFunctionPtr callback,
-                             void*                          callback_context)
+                             void*                          callback_context,
+                             I2CHandle::Priority            priority)
 {
-    // I2C4 has no DMA yet.
-    if(config_.periph == I2CHandle::Config::Peripheral::I2C_4)
-        return I2CHandle::Result::ERR;
-
-    const int i2cIdx = int(config_.periph);
-
-    I2CHandle::Direction direction = I2CHandle::Direction::TRANSMIT;
-
-    // if dma is currently running - queue a job
-    if(IsDmaActive())
-    {
-        DmaJob job;
-        job.slave_address    = address;
-        job.data             = data;
-        job.size             = size;
-        job.direction        = direction;
-        job.callback         = callback;
-        job.callback_context = callback_context;
-        // queue a job (blocks until the queue position is free)
-        QueueDmaTransfer(i2cIdx, job);
-        // TODO: the user can't tell if he got returned "OK"
-        // because the transfer was executed or because it was queued...
-        // should we change that?
-        return I2CHandle::Result::OK;
-    }
-    else
-        // start transmission right away
-        return StartDmaTransmission(
-            address, data, size, callback, callback_context);
+    DmaJob job;
+    job.slave_address    = address;
+    job.data             = data;
+    job.size             = size;
+    job.direction        = I2CHandle::Direction::TRANSMIT;
+    job.callback         = callback;
+    job.callback_context = callback_context;
+    return StartOrQueueDmaJob(job, priority);
 }
 
 I2CHandle::Result I2CHandle::Impl::ReceiveBlocking(uint16_t address,
@@ -376,37 +480,71 @@ I2CHandle::Impl::ReceiveDma(uint16_t                       address,
                             uint8_t*                       data,
                             uint16_t                       size,
                             I2CHandle::CallbackFunctionPtr callback,
-                            void*                          callback_context)
+                            void*                          callback_context,
+                            I2CHandle::Priority            priority)
 {
-    // I2C4 has no DMA yet.
-    if(config_.periph == I2CHandle::Config::Peripheral::I2C_4)
+    DmaJob job;
+    job.slave_address    = address;
+    job.data             = data;
+    job.size             = size;
+    job.direction        = I2CHandle::Direction::RECEIVE;
+    job.callback         = callback;
+    job.callback_context = callback_context;
+    return StartOrQueueDmaJob(job, priority);
+}
+
+I2CHandle::Result I2CHandle::Impl::ReadRegistersDma(
+    uint16_t                       address,
+    uint16_t                       mem_address,
+    uint16_t                       mem_address_size,
+    uint8_t*                       data,
+    uint16_t                       size,
+    I2CHandle::CallbackFunctionPtr callback,
+    void*                          callback_context,
+    I2CHandle::Priority            priority)
+{
+    // Only master devices can make requests
+    if(config_.mode != I2CHandle::Config::Mode::I2C_MASTER
+       || mem_address_size < 1 || mem_address_size > 2)
         return I2CHandle::Result::ERR;
 
-    const int i2cIdx = int(config_.periph);
+    DmaJob job;
+    job.slave_address    = address;
+    job.mem_address      = mem_address;
+    job.mem_address_size = mem_address_size;
+    job.data             = data;
+    job.size             = size;
+    job.direction        = I2CHandle::Direction::RECEIVE;
+    job.callback         = callback;
+    job.callback_context = callback_context;
+    return StartOrQueueDmaJob(job, priority);
+}
 
-    I2CHandle::Direction direction = I2CHandle::Direction::RECEIVE;
+I2CHandle::Result I2CHandle::Impl::WriteRegistersDma(
+    uint16_t                       address,
+    uint16_t                       mem_address,
+    uint16_t                       mem_address_size,
+    uint8_t*                       data,
+    uint16_t                       size,
+    I2CHandle::CallbackFunctionPtr callback,
+    void*                          callback_context,
+    I2CHandle::Priority            priority)
+{
+    // Only master devices can make requests
+    if(config_.mode != I2CHandle::Config::Mode::I2C_MASTER
+       || mem_address_size < 1 || mem_address_size > 2)
+        return I2CHandle::Result::ERR;
 
-    // if dma is currently running - queue a job
-    if(IsDmaActive())
-    {
-        DmaJob job;
-        job.slave_address    = address;
-        job.data             = data;
-        job.size             = size;
-        job.direction        = direction;
-        job.callback         = callback;
-        job.callback_context = callback_context;
-        // queue a job (blocks until the queue position is free)
-        QueueDmaTransfer(i2cIdx, job);
-        // TODO: the user can't tell if he got returned "OK"
-        // because the transfer was executed or because it was queued...
-        // should we change that?
-        return I2CHandle::Result::OK;
-    }
-    else
-        // start reception right away
-        return StartDmaReception(
-            address, data, size, callback, callback_context);
+    DmaJob job;
+    job.slave_address    = address;
+    job.mem_address      = mem_address;
+    job.mem_address_size = mem_address_size;
+    job.data             = data;
+    job.size             = size;
+    job.direction        = I2CHandle::Direction::TRANSMIT;
+    job.callback         = callback;
+    job.callback_context = callback_context;
+    return StartOrQueueDmaJob(job, priority);
 }
 
 I2CHandle::Result I2CHandle::Impl::ReadDataAtAddress(uint16_t address,
@@ -463,37 +601,34 @@ I2CHandle::Result I2CHandle::Impl::WriteDataAtAddress(uint16_t address,
     return I2CHandle::Result::OK;
 }
 
-I2CHandle::Result
-I2CHandle::Impl::StartDmaTransmission(uint16_t                       address,
-                                      uint8_t*                       data,
-                                      uint16_t                       size,
-                                      I2CHandle::CallbackFunctionPtr callback,
-                                      void* callback_context)
+I2CHandle::Result I2CHandle::Impl::StartDmaJob(const DmaJob& job)
 {
-    // this could be called from both the scheduler ISR
-    // and from user code via dsy_i2c_transmit_dma()
-    // TODO: Add some sort of locking mechanism.
-
-    // wait for previous transfer to be finished
-    while(HAL_I2C_GetState(&i2c_hal_handle_) != HAL_I2C_STATE_READY) {};
+    // this is called from both the scheduler ISR and from user code, with
+    // the DMA idle. A peripheral that is busy with a blocking transfer
+    // makes the HAL return an error instead of waiting.
+    const bool rx = job.direction == I2CHandle::Direction::RECEIVE;
 
     // reinit the DMA
     i2c_dma_tc_handle_.Instance = DMA1_Stream6;
     switch(config_.periph)
     {
         case I2CHandle::Config::Peripheral::I2C_1:
-            i2c_dma_tc_handle_.Init.Request = DMA_REQUEST_I2C1_TX;
+            i2c_dma_tc_handle_.Init.Request
+                = rx ? DMA_REQUEST_I2C1_RX : DMA_REQUEST_I2C1_TX;
             break;
         case I2CHandle::Config::Peripheral::I2C_2:
-            i2c_dma_tc_handle_.Init.Request = DMA_REQUEST_I2C2_TX;
+            i2c_dma_tc_handle_.Init.Request
+                = rx ? DMA_REQUEST_I2C2_RX : DMA_REQUEST_I2C2_TX;
             break;
         case I2CHandle::Config::Peripheral::I2C_3:
-            i2c_dma_tc_handle_.Init.Request = DMA_REQUEST_I2C3_TX;
+            i2c_dma_tc_handle_.Init.Request
+                = rx ? DMA_REQUEST_I2C3_RX : DMA_REQUEST_I2C3_TX;
             break;
         // I2C4 has no DMA yet. TODO
         default: return I2CHandle::Result::ERR;
     }
-    i2c_dma_tc_handle_.Init.Direction           = DMA_MEMORY_TO_PERIPH;
+    i2c_dma_tc_handle_.Init.Direction
+        = rx ? DMA_PERIPH_TO_MEMORY : DMA_MEMORY_TO_PERIPH;
     i2c_dma_tc_handle_.Init.PeriphInc           = DMA_PINC_DISABLE;
     i2c_dma_tc_handle_.Init.MemInc              = DMA_MINC_ENABLE;
     i2c_dma_tc_handle_.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
@@ -509,103 +644,60 @@ I2CHandle::Impl::StartDmaTransmission(uint16_t                       address,
         Error_Handler();
     }
 
-    __HAL_LINKDMA(&i2c_hal_handle_, hdmatx, i2c_dma_tc_handle_);
-
-    // start the transfer and block irq until return
-    ScopedIrqBlocker block;
-
-    dma_active_peripheral_ = int(config_.periph);
-    next_callback_         = callback;
-    next_callback_context_ = callback_context;
-
-    HAL_StatusTypeDef status;
-    if(config_.mode == I2CHandle::Config::Mode::I2C_MASTER)
+    if(rx)
     {
-        status = HAL_I2C_Master_Transmit_DMA(
-            &i2c_hal_handle_, address << 1, data, size);
+        __HAL_LINKDMA(&i2c_hal_handle_, hdmarx, i2c_dma_tc_handle_);
     }
     else
     {
-        status = HAL_I2C_Slave_Transmit_DMA(&i2c_hal_handle_, data, size);
+        __HAL_LINKDMA(&i2c_hal_handle_, hdmatx, i2c_dma_tc_handle_);
     }
 
-    if(status != HAL_OK)
-    {
-        dma_active_peripheral_ = -1;
-        next_callback_         = NULL;
-        next_callback_context_ = NULL;
-        return I2CHandle::Result::ERR;
-    }
-    return I2CHandle::Result::OK;
-}
-
-I2CHandle::Result
-I2CHandle::Impl::StartDmaReception(uint16_t                       address,
-                                   uint8_t*                       data,
-                                   uint16_t                       size,
-                                   I2CHandle::CallbackFunctionPtr callback,
-                                   void* callback_context)
-{
-    // wait for previous transfer to be finished
-    while(HAL_I2C_GetState(&i2c_hal_handle_) != HAL_I2C_STATE_READY) {};
-
-    // reinit the DMA
-    i2c_dma_tc_handle_.Instance = DMA1_Stream6;
-    switch(config_.periph)
-    {
-        case I2CHandle::Config::Peripheral::I2C_1:
-            i2c_dma_tc_handle_.Init.Request = DMA_REQUEST_I2C1_RX;
-            break;
-        case I2CHandle::Config::Peripheral::I2C_2:
-            i2c_dma_tc_handle_.Init.Request = DMA_REQUEST_I2C2_RX;
-            break;
-        case I2CHandle::Config::Peripheral::I2C_3:
-            i2c_dma_tc_handle_.Init.Request = DMA_REQUEST_I2C3_RX;
-            break;
-        // I2C4 has no DMA yet. TODO
-        default: return I2CHandle::Result::ERR;
-    }
-    i2c_dma_tc_handle_.Init.Direction           = DMA_PERIPH_TO_MEMORY;
-    i2c_dma_tc_handle_.Init.PeriphInc           = DMA_PINC_DISABLE;
-    i2c_dma_tc_handle_.Init.MemInc              = DMA_MINC_ENABLE;
-    i2c_dma_tc_handle_.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
-    i2c_dma_tc_handle_.Init.MemDataAlignment    = DMA_MDATAALIGN_BYTE;
-    i2c_dma_tc_handle_.Init.Mode                = DMA_NORMAL;
-    i2c_dma_tc_handle_.Init.Priority            = DMA_PRIORITY_LOW;
-    i2c_dma_tc_handle_.Init.FIFOMode            = DMA_FIFOMODE_DISABLE;
-    i2c_dma_tc_handle_.Init.MemBurst            = DMA_MBURST_SINGLE;
-    i2c_dma_tc_handle_.Init.PeriphBurst         = DMA_PBURST_SINGLE;
-
-    if(HAL_DMA_Init(&i2c_dma_tc_handle_) != HAL_OK)
-    {
-        Error_Handler();
-    }
-
-    __HAL_LINKDMA(&i2c_hal_handle_, hdmarx, i2c_dma_tc_handle_);
-
     // start the transfer and block irq until return
     ScopedIrqBlocker block;
 
     dma_active_peripheral_ = int(config_.periph);
-    next_callback_         = callback;
-    next_callback_context_ = callback_context;
+    active_job_            = job;
+    active_job_start_      = System::GetTick();
 
+    const bool master = config_.mode == I2CHandle::Config::Mode::I2C_MASTER;
+    const uint16_t    address = job.slave_address << 1;
     HAL_StatusTypeDef status;
-    if(config_.mode == I2CHandle::Config::Mode::I2C_MASTER)
+    if(job.mem_address_size > 0)
+    {
+        // the register address is sent before the data, with a repeated
+        // start before reading
+        status = rx ? HAL_I2C_Mem_Read_DMA(&i2c_hal_handle_,
+                                           address,
+                                           job.mem_address,
+                                           job.mem_address_size,
+                                           job.data,
+                                           job.size)
+                    : HAL_I2C_Mem_Write_DMA(&i2c_hal_handle_,
+                                            address,
+                                            job.mem_address,
+                                            job.mem_address_size,
+                                            job.data,
+                                            job.size);
+    }
+    else if(master)
     {
-        status = HAL_I2C_Master_Receive_DMA(
-            &i2c_hal_handle_, address << 1, data, size);
+        status = rx ? HAL_I2C_Master_Receive_DMA(
+                     &i2c_hal_handle_, address, job.data, job.size)
+                    : HAL_I2C_Master_Transmit_DMA(
+                        &i2c_hal_handle_, address, job.data, job.size);
     }
     else
     {
-        status = HAL_I2C_Slave_Receive_DMA(&i2c_hal_handle_, data, size);
+        status = rx ? HAL_I2C_Slave_Receive_DMA(
+                     &i2c_hal_handle_, job.data, job.size)
+                    : HAL_I2C_Slave_Transmit_DMA(
+                        &i2c_hal_handle_, job.data, job.size);
     }
 
     if(status != HAL_OK)
     {
         dma_active_peripheral_ = -1;
-        next_callback_         = NULL;
-        next_callback_context_ = NULL;
         return I2CHandle::Result::ERR;
     }
     return I2CHandle::Result::OK;
@@ -657,9 +749,12 @@ void I2CHandle::Impl::DeinitPins()
 }
 
 volatile int8_t         I2CHandle::Impl::dma_active_peripheral_;
-I2CHandle::Impl::DmaJob I2CHandle::Impl::queued_dma_transfers_[kNumI2CWithDma];
-I2CHandle::CallbackFunctionPtr I2CHandle::Impl::next_callback_;
-void*                          I2CHandle::Impl::next_callback_context_;
+int8_t                  I2CHandle::Impl::last_peripheral_;
+I2CHandle::Impl::DmaJob I2CHandle::Impl::active_job_;
+uint32_t                I2CHandle::Impl::active_job_start_;
+FIFO<I2CHandle::Impl::DmaJob, I2C_DMA_QUEUE_LEN>
+    I2CHandle::Impl::queued_dma_transfers_[kNumI2CWithDma][kNumPriorities];
+I2CHandle::DmaStats I2CHandle::Impl::dma_stats_[kNumI2CWithDma];
 
 // ======================================================================
 // HAL service functions
@@ -792,6 +887,16 @@ extern "C" void HAL_I2C_SlaveRxCpltCallback(I2C_HandleTypeDef* i2c_handle)
     I2CHandle::Impl::DmaTransferFinished(i2c_handle, I2CHandle::Result::OK);
 }
 
+extern "C" void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef* i2c_handle)
+{
+    I2CHandle::Impl::DmaTransferFinished(i2c_handle, I2CHandle::Result::OK);
+}
+
+extern "C" void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* i2c_handle)
+{
+    I2CHandle::Impl::DmaTransferFinished(i2c_handle, I2CHandle::Result::OK);
+}
+
 extern "C" void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* i2c_handle)
 {
     I2CHandle::Impl::DmaTransferFinished(i2c_handle, I2CHandle::Result::ERR);
@@ -834,20 +939,78 @@ I2CHandle::TransmitDma(uint16_t                       address,
                        uint8_t*                       data,
                        uint16_t                       size,
                        I2CHandle::CallbackFunctionPtr callback,
-                       void*                          callback_context)
+                       void*                          callback_context,
+                       I2CHandle::Priority            priority)
 {
-    return pimpl_->TransmitDma(address, data, size, callback, callback_context);
+    return pimpl_->TransmitDma(
+        address, data, size, callback, callback_context, priority);
 }
 
 I2CHandle::Result I2CHandle::ReceiveDma(uint16_t                       address,
                                         uint8_t*                       data,
                                         uint16_t                       size,
                                         I2CHandle::CallbackFunctionPtr callback,
-                                        void* callback_context)
+                                        void*               callback_context,
+                                        I2CHandle::Priority priority)
+{
+    return pimpl_->ReceiveDma(
+        address, data, size, callback, callback_context, priority);
+}
+
+I2CHandle::Result
+I2CHandle::ReadRegistersDma(uint16_t                       address,
+                            uint16_t                       mem_address,
+                            uint16_t                       mem_address_size,
+                            uint8_t*                       data,
+                            uint16_t                       size,
+                            I2CHandle::CallbackFunctionPtr callback,
+                            void*                          callback_context,
+                            I2CHandle::Priority            priority)
 {
-    return pimpl_->ReceiveDma(address, data, size, callback, callback_context);
+    return pimpl_->ReadRegistersDma(address,
+                                    mem_address,
+                                    mem_address_size,
+                                    data,
+                                    size,
+                                    callback,
+                                    callback_context,
+                                    priority);
 }
 
+I2CHandle::Result
+I2CHandle::WriteRegistersDma(uint16_t                       address,
+                             uint16_t                       mem_address,
+                             uint16_t                       mem_address_size,
+                             uint8_t*                       data,
+                             uint16_t                       size,
+                             I2CHandle::CallbackFunctionPtr callback,
+                             void*                          callback_context,
+                             I2CHandle::Priority            priority)
+{
+    return pimpl_->WriteRegistersDma(address,
+                                     mem_address,
+                                     mem_address_size,
+                                     data,
+                                     size,
+                                     callback,
+                                     callback_context,
+                                     priority);
+}
+
+size_t I2CHandle::GetNumQueuedDmaTransfers() const
+{
+    return pimpl_->GetNumQueuedDmaTransfers();
+}
+
+I2CHandle::DmaStats I2CHandle::GetDmaStats() const
+{
+    return pimpl_->GetDmaStats();
+}
+
+void I2CHandle::ResetDmaStats()
+{
+    pimpl_->ResetDmaStats();
+}
 
 I2CHandle::Result I2CHandle::ReadDataAtAddress(uint16_t address,
                                                uint16_t mem_address,
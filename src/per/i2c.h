@@ -1,6 +1,13 @@
 #pragma once
 #include "daisy_core.h"
 
+/** Number of DMA jobs that can wait per I2C peripheral and priority while
+ *  the DMA is busy. Can be overridden with a compiler flag.
+ */
+#ifndef I2C_DMA_QUEUE_LEN
+#define I2C_DMA_QUEUE_LEN 8
+#endif
+
 namespace daisy
 {
 /** A handle for interacting with an I2C peripheral. This is a dumb
@@ -64,6 +71,11 @@ class I2CHandle
         Mode  mode;  /**< & */
         // 0x10 is chosen as a default to avoid conflicts with reserved addresses
         uint8_t address = 0x10; /**< & */
+        /** Number of times a failed DMA job is restarted before its
+         *  callback is called with Result::ERR, e.g. for devices that
+         *  don't respond (NACK) while they're busy.
+         */
+        uint8_t dma_retries = 0;
     };
 
     /** Return values for I2C functions. */
@@ -79,6 +91,32 @@ class I2CHandle
         RECEIVE,  /**< & */
     };
 
+    /** Order in which waiting DMA jobs are started. Jobs of the same
+     *  priority are started in the order they were added, and
+     *  peripherals with jobs of the same priority take turns.
+     */
+    enum class Priority
+    {
+        LOW,    /**< & */
+        NORMAL, /**< & */
+        HIGH,   /**< & */
+    };
+
+    /** Counters of the DMA jobs of a peripheral, see GetDmaStats() */
+    struct DmaStats
+    {
+        uint32_t queued;    /**< jobs that were started or queued */
+        uint32_t rejected;  /**< jobs that didn't fit into the queue */
+        uint32_t completed; /**< jobs that finished successfully */
+        uint32_t failed;    /**< jobs that finished with an error */
+        uint32_t nacks;     /**< transfers the slave didn't acknowledge */
+        uint32_t retries;   /**< restarts of failed jobs */
+        /** time the DMA spent on jobs of this peripheral, in
+         *  System::GetTick() ticks
+         */
+        uint32_t busy_ticks;
+    };
+
     I2CHandle() : pimpl_(nullptr) {}
     I2CHandle(const I2CHandle& other) = default;
     I2CHandle& operator=(const I2CHandle& other) = default;
@@ -128,20 +166,22 @@ class I2CHandle
      * 
      *  A single DMA is shared across I2C1, I2C2 and I2C3. I2C4 has no DMA support (yet).
      *  If the DMA is busy with another transfer, the job will be queued and executed later.
-     *  If there is a job waiting to be executed for this I2C peripheral, this function
-     *  will block until the queue is free and the job can be queued.
+     *  This function never waits: if I2C_DMA_QUEUE_LEN jobs of this priority are already
+     *  waiting for this peripheral, it returns Result::ERR.
      * 
      *  \param address      The slave device address. Unused in slave mode.
      *  \param data         A pointer to the data to be sent.
      *  \param size         The size of the data to be sent, in bytes.
      *  \param callback     A callback to execute when the transfer finishes, or NULL.
      *  \param callback_context A pointer that will be passed back to you in the callback.      
+     *  \param priority     Order among the jobs waiting for the DMA.
      */
     Result TransmitDma(uint16_t            address,
                        uint8_t*            data,
                        uint16_t            size,
                        CallbackFunctionPtr callback,
-                       void*               callback_context);
+                       void*               callback_context,
+                       Priority            priority = Priority::NORMAL);
 
     /** Receives data with a DMA and returns immediately. Use this for larger transmissions.
      *  The pointer to data must be located in the D2 memory domain by adding the 
@@ -151,22 +191,81 @@ class I2CHandle
      *  the buffer, before initiating the dma transfer by calling 
      *  `dsy_dma_clear_cache_for_buffer(buffer, size);`
      * 
-     *  A single DMA is shared across I2C, I2C2 and I2C3. I2C4 has no DMA support (yet).
+     *  A single DMA is shared across I2C1, I2C2 and I2C3. I2C4 has no DMA support (yet).
      *  If the DMA is busy with another transfer, the job will be queued and executed later.
-     *  If there is a job waiting to be executed for this I2C peripheral, this function
-     *  will block until the queue is free and the job can be queued.
+     *  This function never waits: if I2C_DMA_QUEUE_LEN jobs of this priority are already
+     *  waiting for this peripheral, it returns Result::ERR.
      * 
      *  \param address      The slave device address. Unused in slave mode.
      *  \param data         A pointer to the data buffer.
      *  \param size         The size of the data to be received, in bytes.
      *  \param callback     A callback to execute when the transfer finishes, or NULL.
      *  \param callback_context A pointer that will be passed back to you in the callback.      
+     *  \param priority     Order among the jobs waiting for the DMA.
      */
     Result ReceiveDma(uint16_t            address,
                       uint8_t*            data,
                       uint16_t            size,
                       CallbackFunctionPtr callback,
-                      void*               callback_context);
+                      void*               callback_context,
+                      Priority            priority = Priority::NORMAL);
+
+    /** Writes a register address and then reads data from the slave, with a
+     *  repeated start in between, as a single DMA job. Master mode only.
+     *  The same rules as for ReceiveDma() apply to the data buffer and the queue.
+     * 
+     *  \param address      The slave device address, not shifted.
+     *  \param mem_address  The register address to read from.
+     *  \param mem_address_size Size of the register address, 1 or 2 bytes.
+     *  \param data         A pointer to the data buffer.
+     *  \param size         The size of the data to be received, in bytes.
+     *  \param callback     A callback to execute when the transfer finishes, or NULL.
+     *  \param callback_context A pointer that will be passed back to you in the callback.
+     *  \param priority     Order among the jobs waiting for the DMA.
+     */
+    Result ReadRegistersDma(uint16_t            address,
+                            uint16_t            mem_address,
+                            uint16_t            mem_address_size,
+                            uint8_t*            data,
+                            uint16_t            size,
+                            CallbackFunctionPtr callback,
+                            void*               callback_context,
+                            Priority            priority = Priority::NORMAL);
+
+    /** Writes a register address followed by data to the slave as a single
+     *  DMA job. Master mode only.
+     *  The same rules as for TransmitDma() apply to the data buffer and the queue.
+     * 
+     *  \param address      The slave device address, not shifted.
+     *  \param mem_address  The register address to write to.
+     *  \param mem_address_size Size of the register address, 1 or 2 bytes.
+     *  \param data         A pointer to the data to be sent.
+     *  \param size         The size of the data to be sent, in bytes.
+     *  \param callback     A callback to execute when the transfer finishes, or NULL.
+     *  \param callback_context A pointer that will be passed back to you in the callback.
+     *  \param priority     Order among the jobs waiting for the DMA.
+     */
+    Result WriteRegistersDma(uint16_t            address,
+                             uint16_t            mem_address,
+                             uint16_t            mem_address_size,
+                             uint8_t*            data,
+                             uint16_t            size,
+                             CallbackFunctionPtr callback,
+                             void*               callback_context,
+                             Priority            priority = Priority::NORMAL);
+
+    /** \return the number of DMA jobs waiting for this peripheral, at most
+     *          I2C_DMA_QUEUE_LEN per priority
+     */
+    size_t GetNumQueuedDmaTransfers() const;
+
+    /** \return the DMA job counters of this peripheral since the start or
+     *          the last ResetDmaStats()
+     */
+    DmaStats GetDmaStats() const;
+
+    /** Clears the DMA job counters of this peripheral */
+    void ResetDmaStats();
 
     /** Reads an amount of data from a specific memory address. 
     *   This method will return an error if the I2C peripheral is in slave mode. 
@@ -1,6 +1,8 @@
 #ifndef UNIT_TEST
 #include "per/qspi.h"
 #include "sys/system.h"
+#include "util/scopedirqblocker.h"
+#include "util/FlashJobQueue.h"
 #include "stm32h7xx_hal.h"
 #include "dev/flash_IS25LP080D.h"
 #include "dev/flash_IS25LP064A.h"
@@ -34,6 +36,8 @@ namespace daisy
 class QSPIHandle::Impl
 {
   public:
+    using Result = QSPIHandle::Result;
+
     QSPIHandle::Result Init(const QSPIHandle::Config& config);
 
     const QSPIHandle::Config& GetConfig() const { return config_; }
@@ -51,6 +55,53 @@ class QSPIHandle::Impl
 
     QSPIHandle::Result EraseSector(uint32_t address);
 
+    QSPIHandle::Result WriteAsync(uint32_t               address,
+                                  uint32_t               size,
+                                  uint8_t*               buffer,
+                                  EndCallbackFunctionPtr end_callback,
+                                  void*                  callback_context);
+
+    QSPIHandle::Result EraseAsync(uint32_t               start_addr,
+                                  uint32_t               end_addr,
+                                  EndCallbackFunctionPtr end_callback,
+                                  void*                  callback_context);
+
+    bool IsBusy()
+    {
+        jobs_.CheckTimeout();
+        return jobs_.IsBusy();
+    }
+
+    size_t GetNumQueuedOperations() { return jobs_.GetNumQueued(); }
+
+    // Steps the asynchronous operations, called from the HAL callbacks
+    void OnCommandDone() { jobs_.OnCommandDone(); }
+    void OnTransmitDone() { jobs_.OnTransmitDone(); }
+    void OnStatusMatch() { jobs_.OnStatusMatch(); }
+    void OnError() { jobs_.OnError(); }
+
+    // The driver interface of FlashJobQueue
+    static constexpr uint32_t kPageSize      = IS25LP080D_PAGE_SIZE;
+    static constexpr uint32_t kStepTimeoutMs = HAL_QPSI_TIMEOUT_DEFAULT_VALUE;
+
+    bool IsMemoryMapped() const
+    {
+        return config_.mode == Config::Mode::MEMORY_MAPPED;
+    }
+    bool     StartExitContinuousRead();
+    bool     StartWriteEnable();
+    bool     StartWaitWriteEnabled();
+    bool     StartWaitReady();
+    bool     StartErase(uint32_t  address,
+                        uint32_t  end_addr,
+                        uint32_t& size,
+                        uint32_t& timeout_ms);
+    bool     StartProgram(uint32_t address, uint32_t size, uint8_t* data);
+    bool     EnterMemoryMappedMode();
+    bool     Abort();
+    bool     Reinit() { return Init(config_) == Result::OK; }
+    uint32_t GetNowMs() { return System::GetNow(); }
+
     uint32_t GetPin(size_t pin);
 
     GPIO_TypeDef* GetPort(size_t pin);
@@ -67,6 +118,32 @@ class QSPIHandle::Impl
     }
 
   private:
+    using JobQueue = FlashJobQueue<Impl, QSPI_QUEUE_LEN>;
+
+    /** One of the erase granularities of the flash */
+    struct EraseStep
+    {
+        uint32_t size;
+        uint8_t  instruction;
+        uint32_t timeout;
+    };
+
+    /** Returns the largest erase step that starts at address and doesn't
+     *  erase anything beyond the 4kB sector containing end_addr - 1
+     */
+    EraseStep GetEraseStep(uint32_t address, uint32_t end_addr) const;
+
+    QSPI_CommandTypeDef GetEraseCommand(const EraseStep& step,
+                                        uint32_t         address) const;
+
+    uint32_t GetFlashSize() const;
+
+    QSPIHandle::Result CheckNotBusy();
+
+    QSPIHandle::Result QueueAsyncJob(const JobQueue::Job& job);
+
+    bool StartStatusPolling(uint8_t match, uint8_t mask);
+
     QSPIHandle::Result ResetMemory();
 
     QSPIHandle::Result DummyCyclesConfig(QSPIHandle::Config::Device device);
@@ -77,6 +154,12 @@ class QSPIHandle::Impl
 
     QSPIHandle::Result EnableMemoryMappedMode();
 
+    /** A read that ends the continuous read mode, see SwitchMode() */
+    QSPI_CommandTypeDef GetExitContinuousReadCommand() const;
+
+    /** Switches modes without reinitializing, see SetMode() */
+    QSPIHandle::Result SwitchMode(Config::Mode mode);
+
     QSPIHandle::Result AutopollingMemReady(uint32_t timeout);
 
     QSPIHandle::Result SetMode(Config::Mode mode);
@@ -92,6 +175,8 @@ class QSPIHandle::Impl
     QSPI_HandleTypeDef halqspi_;
     Status             status_;
 
+    JobQueue jobs_{*this};
+
     static constexpr size_t pin_count_
         = sizeof(QSPIHandle::Config::pin_config) / sizeof(dsy_gpio_pin);
     // Data structure for easy hal initialization
@@ -199,6 +284,7 @@ QSPIHandle::Result QSPIHandle::Impl::WritePage(uint32_t address,
                                                uint8_t* buffer,
                                                bool     reset_mode)
 {
+    RETURN_IF_ERR(CheckNotBusy());
     RETURN_IF_ERR(CheckProgramMemory());
     RETURN_IF_ERR(SetMode(Config::Mode::INDIRECT_POLLING));
 
@@ -245,6 +331,7 @@ QSPIHandle::Result QSPIHandle::Impl::WritePage(uint32_t address,
 QSPIHandle::Result
 QSPIHandle::Impl::Write(uint32_t address, uint32_t size, uint8_t* buffer)
 {
+    RETURN_IF_ERR(CheckNotBusy());
     uint32_t NumOfPage = 0, NumOfSingle = 0, Addr = 0, count = 0, temp = 0;
     uint32_t QSPI_DataNum    = 0;
     uint32_t flash_page_size = IS25LP080D_PAGE_SIZE;
@@ -330,52 +417,50 @@ QSPIHandle::Impl::Write(uint32_t address, uint32_t size, uint8_t* buffer)
 QSPIHandle::Result QSPIHandle::Impl::Erase(uint32_t start_addr,
                                            uint32_t end_addr)
 {
-    uint32_t block_addr;
-    uint32_t block_size = IS25LP080D_SECTOR_SIZE; // 4kB blocks for now.
-    // 64kB chunks for now.
-    start_addr = start_addr - (start_addr % block_size);
+    RETURN_IF_ERR(CheckNotBusy());
+    RETURN_IF_ERR(CheckProgramMemory());
+    start_addr = start_addr & 0x0FFFFFFF;
+    end_addr   = end_addr & 0x0FFFFFFF;
+    start_addr = start_addr - (start_addr % IS25LP080D_SECTOR_SIZE);
+
+    // Switch modes only once for the whole area
+    RETURN_IF_ERR(SetMode(Config::Mode::INDIRECT_POLLING));
     while(end_addr > start_addr)
     {
-        block_addr = start_addr & 0x0FFFFFFF;
-        if(EraseSector(block_addr) != QSPIHandle::Result::OK)
+        const EraseStep     step      = GetEraseStep(start_addr, end_addr);
+        QSPI_CommandTypeDef s_command = GetEraseCommand(step, start_addr);
+        if(WriteEnable() != QSPIHandle::Result::OK)
         {
             ERR_RECOVERY(Status::E_HAL_ERROR);
         }
-        start_addr += block_size;
+        if(HAL_QSPI_Command(
+               &halqspi_, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE)
+           != HAL_OK)
+        {
+            ERR_RECOVERY(Status::E_HAL_ERROR);
+        }
+        if(AutopollingMemReady(step.timeout) != QSPIHandle::Result::OK)
+        {
+            ERR_RECOVERY(Status::E_HAL_ERROR);
+        }
+        start_addr += step.size;
     }
+
+    RETURN_IF_ERR(SetMode(Config::Mode::MEMORY_MAPPED));
     return QSPIHandle::Result::OK;
 }
 
 
 QSPIHandle::Result QSPIHandle::Impl::EraseSector(uint32_t address)
 {
-    uint8_t             use_qpi = 0;
-    QSPI_CommandTypeDef s_command;
-    if(use_qpi)
-    {
-        s_command.InstructionMode = QSPI_INSTRUCTION_4_LINES;
-        s_command.Instruction     = SECTOR_ERASE_QPI_CMD;
-        s_command.AddressMode     = QSPI_ADDRESS_4_LINES;
-    }
-    else
-    {
-        s_command.InstructionMode = QSPI_INSTRUCTION_1_LINE;
-        s_command.Instruction     = SECTOR_ERASE_CMD;
-        s_command.AddressMode     = QSPI_ADDRESS_1_LINE;
-    }
-    s_command.AddressSize       = QSPI_ADDRESS_24_BITS;
-    s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
-    s_command.DataMode          = QSPI_DATA_NONE;
-    s_command.DummyCycles       = 0;
-    s_command.NbData            = 1;
-    s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
-    s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
-    s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
-    s_command.Address           = address;
+    const EraseStep     step
+        = {IS25LP080D_SECTOR_SIZE,
+           SECTOR_ERASE_CMD,
+           HAL_QPSI_TIMEOUT_DEFAULT_VALUE};
+    QSPI_CommandTypeDef s_command = GetEraseCommand(step, address);
 
+    RETURN_IF_ERR(CheckNotBusy());
     RETURN_IF_ERR(CheckProgramMemory());
-    // Erasing takes a long time anyway, so not much point trying to
-    // minimize reinitializations
     RETURN_IF_ERR(SetMode(Config::Mode::INDIRECT_POLLING));
 
     if(WriteEnable() != QSPIHandle::Result::OK)
@@ -387,8 +472,7 @@ QSPIHandle::Result QSPIHandle::Impl::EraseSector(uint32_t address)
     {
         ERR_RECOVERY(Status::E_HAL_ERROR);
     }
-    if(AutopollingMemReady(HAL_QPSI_TIMEOUT_DEFAULT_VALUE)
-       != QSPIHandle::Result::OK)
+    if(AutopollingMemReady(step.timeout) != QSPIHandle::Result::OK)
     {
         ERR_RECOVERY(Status::E_HAL_ERROR);
     }
@@ -398,6 +482,240 @@ QSPIHandle::Result QSPIHandle::Impl::EraseSector(uint32_t address)
 }
 
 
+QSPIHandle::Impl::EraseStep
+QSPIHandle::Impl::GetEraseStep(uint32_t address, uint32_t end_addr) const
+{
+    // the end of the last sector that has to be erased anyway
+    const uint32_t end = (end_addr + IS25LP080D_SECTOR_SIZE - 1)
+                         & ~uint32_t(IS25LP080D_SECTOR_SIZE - 1);
+    const uint32_t flash_size = GetFlashSize();
+    if(address == 0 && end >= flash_size)
+        return {flash_size, CHIP_ERASE_CMD, IS25LP080D_DIE_ERASE_MAX_TIME};
+
+    // IS25LP* erase times are far below the default timeout
+    static const EraseStep blocks[] = {
+        {IS25LP080D_BLOCK_SIZE,
+         BLOCK_ERASE_CMD,
+         HAL_QPSI_TIMEOUT_DEFAULT_VALUE},
+        {IS25LP080D_BLOCK_SIZE / 2,
+         BLOCK_ERASE_32K_CMD,
+         HAL_QPSI_TIMEOUT_DEFAULT_VALUE},
+        {IS25LP080D_SECTOR_SIZE,
+         SECTOR_ERASE_CMD,
+         HAL_QPSI_TIMEOUT_DEFAULT_VALUE},
+    };
+    for(const auto& block : blocks)
+    {
+        if(address % block.size == 0 && end - address >= block.size)
+            return block;
+    }
+    return blocks[2];
+}
+
+
+QSPI_CommandTypeDef
+QSPIHandle::Impl::GetEraseCommand(const EraseStep& step, uint32_t address) const
+{
+    QSPI_CommandTypeDef s_command;
+    s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+    s_command.Instruction       = step.instruction;
+    s_command.AddressMode       = step.instruction == CHIP_ERASE_CMD
+                                      ? QSPI_ADDRESS_NONE
+                                      : QSPI_ADDRESS_1_LINE;
+    s_command.AddressSize       = QSPI_ADDRESS_24_BITS;
+    s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    s_command.DataMode          = QSPI_DATA_NONE;
+    s_command.DummyCycles       = 0;
+    s_command.NbData            = 1;
+    s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
+    s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+    s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+    s_command.Address           = address;
+    return s_command;
+}
+
+
+uint32_t QSPIHandle::Impl::GetFlashSize() const
+{
+    return config_.device == QSPIHandle::Config::Device::IS25LP064A
+               ? IS25LP064A_FLASH_SIZE
+               : IS25LP080D_FLASH_SIZE;
+}
+
+
+QSPIHandle::Result QSPIHandle::Impl::CheckNotBusy()
+{
+    // the asynchronous operations own the peripheral until they're done
+    if(IsBusy())
+        return Result::ERR;
+    return jobs_.Recover();
+}
+
+
+QSPIHandle::Result
+QSPIHandle::Impl::WriteAsync(uint32_t               address,
+                             uint32_t               size,
+                             uint8_t*               buffer,
+                             EndCallbackFunctionPtr end_callback,
+                             void*                  callback_context)
+{
+    JobQueue::Job job;
+    job.erase            = false;
+    job.address          = address & 0x0FFFFFFF;
+    job.end_addr         = job.address + size;
+    job.buffer           = buffer;
+    job.end_callback     = end_callback;
+    job.callback_context = callback_context;
+    return QueueAsyncJob(job);
+}
+
+
+QSPIHandle::Result
+QSPIHandle::Impl::EraseAsync(uint32_t               start_addr,
+                             uint32_t               end_addr,
+                             EndCallbackFunctionPtr end_callback,
+                             void*                  callback_context)
+{
+    JobQueue::Job job;
+    job.erase   = true;
+    job.address = start_addr & 0x0FFFFFFF;
+    job.address = job.address - (job.address % IS25LP080D_SECTOR_SIZE);
+    job.end_addr         = end_addr & 0x0FFFFFFF;
+    job.buffer           = nullptr;
+    job.end_callback     = end_callback;
+    job.callback_context = callback_context;
+    return QueueAsyncJob(job);
+}
+
+
+QSPIHandle::Result
+QSPIHandle::Impl::QueueAsyncJob(const JobQueue::Job& job)
+{
+    RETURN_IF_ERR(CheckProgramMemory());
+    return jobs_.Queue(job);
+}
+
+
+bool QSPIHandle::Impl::StartExitContinuousRead()
+{
+    // like SwitchMode(), but without waiting for the command
+    if(HAL_QSPI_Abort(&halqspi_) != HAL_OK)
+        return false;
+    config_.mode                  = Config::Mode::INDIRECT_POLLING;
+    QSPI_CommandTypeDef s_command = GetExitContinuousReadCommand();
+    return HAL_QSPI_Command_IT(&halqspi_, &s_command) == HAL_OK;
+}
+
+
+bool QSPIHandle::Impl::StartWriteEnable()
+{
+    QSPI_CommandTypeDef s_command;
+    s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+    s_command.Instruction       = WRITE_ENABLE_CMD;
+    s_command.AddressMode       = QSPI_ADDRESS_NONE;
+    s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    s_command.DataMode          = QSPI_DATA_NONE;
+    s_command.DummyCycles       = 0;
+    s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
+    s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+    s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+    return HAL_QSPI_Command_IT(&halqspi_, &s_command) == HAL_OK;
+}
+
+
+bool QSPIHandle::Impl::StartWaitWriteEnabled()
+{
+    return StartStatusPolling(IS25LP080D_SR_WREN, IS25LP080D_SR_WREN);
+}
+
+
+bool QSPIHandle::Impl::StartWaitReady()
+{
+    return StartStatusPolling(0, IS25LP080D_SR_WIP);
+}
+
+
+bool QSPIHandle::Impl::StartErase(uint32_t  address,
+                                  uint32_t  end_addr,
+                                  uint32_t& size,
+                                  uint32_t& timeout_ms)
+{
+    const EraseStep     step      = GetEraseStep(address, end_addr);
+    QSPI_CommandTypeDef s_command = GetEraseCommand(step, address);
+    size                          = step.size;
+    timeout_ms                    = step.timeout;
+    return HAL_QSPI_Command_IT(&halqspi_, &s_command) == HAL_OK;
+}
+
+
+bool QSPIHandle::Impl::StartProgram(uint32_t address,
+                                    uint32_t size,
+                                    uint8_t* data)
+{
+    QSPI_CommandTypeDef s_command;
+    s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+    s_command.Instruction       = PAGE_PROG_CMD;
+    s_command.AddressMode       = QSPI_ADDRESS_1_LINE;
+    s_command.AddressSize       = QSPI_ADDRESS_24_BITS;
+    s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    s_command.DataMode          = QSPI_DATA_1_LINE;
+    s_command.DummyCycles       = 0;
+    s_command.NbData            = size;
+    s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
+    s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+    s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+    s_command.Address           = address;
+    // with a data phase, the command only configures the transfer
+    if(HAL_QSPI_Command_IT(&halqspi_, &s_command) != HAL_OK)
+        return false;
+    return HAL_QSPI_Transmit_IT(&halqspi_, data) == HAL_OK;
+}
+
+
+bool QSPIHandle::Impl::StartStatusPolling(uint8_t match, uint8_t mask)
+{
+    QSPI_CommandTypeDef     s_command;
+    QSPI_AutoPollingTypeDef s_config;
+
+    s_command.InstructionMode   = QSPI_INSTRUCTION_1_LINE;
+    s_command.Instruction       = READ_STATUS_REG_CMD;
+    s_command.AddressMode       = QSPI_ADDRESS_NONE;
+    s_command.AlternateByteMode = QSPI_ALTERNATE_BYTES_NONE;
+    s_command.DataMode          = QSPI_DATA_1_LINE;
+    s_command.DummyCycles       = 0;
+    s_command.DdrMode           = QSPI_DDR_MODE_DISABLE;
+    s_command.DdrHoldHalfCycle  = QSPI_DDR_HHC_ANALOG_DELAY;
+    s_command.SIOOMode          = QSPI_SIOO_INST_EVERY_CMD;
+
+    s_config.Match           = match;
+    s_config.Mask            = mask;
+    s_config.MatchMode       = QSPI_MATCH_MODE_AND;
+    s_config.Interval        = 0x10;
+    s_config.StatusBytesSize = 1;
+    s_config.AutomaticStop   = QSPI_AUTOMATIC_STOP_ENABLE;
+
+    return HAL_QSPI_AutoPolling_IT(&halqspi_, &s_command, &s_config)
+           == HAL_OK;
+}
+
+
+bool QSPIHandle::Impl::EnterMemoryMappedMode()
+{
+    return SwitchMode(Config::Mode::MEMORY_MAPPED) == Result::OK;
+}
+
+
+bool QSPIHandle::Impl::Abort()
+{
+    // This may run in the QSPI interrupt, where the blocking commands of
+    // Init() can't time out. Reinitializing is left to the main thread.
+    status_      = Status::E_HAL_ERROR;
+    config_.mode = Config::Mode::MEMORY_MAPPED;
+    return HAL_QSPI_Abort(&halqspi_) == HAL_OK
+           && EnableMemoryMappedMode() == Result::OK;
+}
+
+
 QSPIHandle::Result QSPIHandle::Impl::ResetMemory()
 {
     QSPI_CommandTypeDef s_command;
@@ -713,12 +1031,60 @@ QSPIHandle::Result QSPIHandle::Impl::AutopollingMemReady(uint32_t timeout)
     return QSPIHandle::Result::OK;
 }
 
+QSPI_CommandTypeDef QSPIHandle::Impl::GetExitContinuousReadCommand() const
+{
+    // Without an instruction, a flash in the continuous read mode takes
+    // this as a read of address 0, and the mode bits other than 0xAx end
+    // the continuous read mode. A flash that isn't in it takes the first
+    // eight bits on IO0, all zeros, as an instruction it doesn't know.
+    QSPI_CommandTypeDef s_command;
+    s_command.InstructionMode    = QSPI_INSTRUCTION_NONE;
+    s_command.Instruction        = 0;
+    s_command.AddressMode        = QSPI_ADDRESS_4_LINES;
+    s_command.AddressSize        = QSPI_ADDRESS_24_BITS;
+    s_command.Address            = 0;
+    s_command.AlternateByteMode  = QSPI_ALTERNATE_BYTES_4_LINES;
+    s_command.AlternateBytesSize = QSPI_ALTERNATE_BYTES_8_BITS;
+    s_command.AlternateBytes     = 0x00;
+    s_command.DataMode           = QSPI_DATA_NONE;
+    s_command.DummyCycles        = 6;
+    s_command.DdrMode            = QSPI_DDR_MODE_DISABLE;
+    s_command.DdrHoldHalfCycle   = QSPI_DDR_HHC_ANALOG_DELAY;
+    s_command.SIOOMode           = QSPI_SIOO_INST_EVERY_CMD;
+    return s_command;
+}
+
+QSPIHandle::Result QSPIHandle::Impl::SwitchMode(Config::Mode mode)
+{
+    // The memory doesn't need to be set up again to switch modes. Entering
+    // the memory mapped mode is only a matter of configuring the read
+    // command. Its reads leave the flash in the continuous read mode
+    // though (alternate byte 0xA0, instruction only sent once), so after
+    // aborting it, the flash has to leave that mode before it takes
+    // commands again.
+    config_.mode = mode;
+    if(mode == Config::Mode::MEMORY_MAPPED)
+        return EnableMemoryMappedMode();
+
+    if(HAL_QSPI_Abort(&halqspi_) != HAL_OK)
+    {
+        ERR_SIMPLE(Status::E_HAL_ERROR);
+    }
+    QSPI_CommandTypeDef s_command = GetExitContinuousReadCommand();
+    if(HAL_QSPI_Command(&halqspi_, &s_command, HAL_QPSI_TIMEOUT_DEFAULT_VALUE)
+       != HAL_OK)
+    {
+        ERR_SIMPLE(Status::E_HAL_ERROR);
+    }
+    return Result::OK;
+}
+
 QSPIHandle::Result QSPIHandle::Impl::SetMode(QSPIHandle::Config::Mode mode)
 {
     if(config_.mode != mode)
     {
-        config_.mode = mode;
-        if(Init(config_) != Result::OK)
+        // Reinitialize if switching doesn't work out
+        if(SwitchMode(mode) != Result::OK && Init(config_) != Result::OK)
         {
             config_.mode = Config::Mode::MEMORY_MAPPED;
             status_      = Status::E_SWITCHING_MODES;
@@ -901,6 +1267,35 @@ QSPIHandle::Result QSPIHandle::EraseSector(uint32_t address)
     return pimpl_->EraseSector(address);
 }
 
+QSPIHandle::Result QSPIHandle::WriteAsync(uint32_t               address,
+                                          uint32_t               size,
+                                          uint8_t*               buffer,
+                                          EndCallbackFunctionPtr end_callback,
+                                          void* callback_context)
+{
+    return pimpl_->WriteAsync(
+        address, size, buffer, end_callback, callback_context);
+}
+
+QSPIHandle::Result QSPIHandle::EraseAsync(uint32_t               start_addr,
+                                          uint32_t               end_addr,
+                                          EndCallbackFunctionPtr end_callback,
+                                          void* callback_context)
+{
+    return pimpl_->EraseAsync(
+        start_addr, end_addr, end_callback, callback_context);
+}
+
+bool QSPIHandle::IsBusy()
+{
+    return pimpl_->IsBusy();
+}
+
+size_t QSPIHandle::GetNumQueuedOperations()
+{
+    return pimpl_->GetNumQueuedOperations();
+}
+
 void* QSPIHandle::GetData(uint32_t offset)
 {
     return pimpl_->GetData(offset);
@@ -978,6 +1373,30 @@ extern "C" void QUADSPI_IRQHandler(void)
     HAL_QSPI_IRQHandler(qspi_impl.GetHalHandle());
 }
 
+extern "C" void HAL_QSPI_CmdCpltCallback(QSPI_HandleTypeDef* hqspi)
+{
+    (void)hqspi;
+    qspi_impl.OnCommandDone();
+}
+
+extern "C" void HAL_QSPI_TxCpltCallback(QSPI_HandleTypeDef* hqspi)
+{
+    (void)hqspi;
+    qspi_impl.OnTransmitDone();
+}
+
+extern "C" void HAL_QSPI_StatusMatchCallback(QSPI_HandleTypeDef* hqspi)
+{
+    (void)hqspi;
+    qspi_impl.OnStatusMatch();
+}
+
+extern "C" void HAL_QSPI_ErrorCallback(QSPI_HandleTypeDef* hqspi)
+{
+    (void)hqspi;
+    qspi_impl.OnError();
+}
+
 } // namespace daisy
 
 /* HAL Overwrite Implementation */
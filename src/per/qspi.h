@@ -6,6 +6,13 @@
 #include <cstdint>
 #include "daisy_core.h" // Added for dsy_gpio_pin typedef
 
+/** Maximum number of asynchronous operations waiting behind the one in
+ *  progress, see QSPIHandle::WriteAsync() and QSPIHandle::EraseAsync()
+ */
+#ifndef QSPI_QUEUE_LEN
+#define QSPI_QUEUE_LEN 8
+#endif
+
 #define DSY_QSPI_TEXT       \
     __attribute__((section( \
         ".qspiflash_text"))) /**< used for reading memory in memory_mapped mode. */
@@ -26,6 +33,29 @@ namespace daisy
  Driver for QSPI peripheral to interface with external flash memory. \n 
     Currently supported QSPI Devices: \n 
     * IS25LP080D
+
+    Besides the blocking Write() and Erase(), the flash can be programmed
+    and erased in the background with WriteAsync() and EraseAsync(). These
+    queue the operation and return right away, the QSPI interrupt then
+    steps through the pages and erase blocks, and calls the end callback.
+    The memory mapped mode is only left while an operation is running, and
+    restored before its callback, so the memory can't be read while
+    IsBusy() returns true. If the peripheral has to be reinitialized after
+    a failed operation, that's done by the next call of a blocking function,
+    WriteAsync() or EraseAsync(), not in the interrupt. Operations queued
+    until then fail. Queueing the next buffer while the previous one is
+    programmed keeps the flash busy while the next one is prepared:
+
+    \code{.cpp}
+    qspi.EraseAsync(address, address + bank_size);
+    for(uint32_t i = 0; i < bank_size; i += chunk_size)
+    {
+        // the write two chunks back is done once nothing is waiting
+        while(qspi.GetNumQueuedOperations() > 0) {}
+        FillChunk(buffers[i / chunk_size % 2], i);
+        qspi.WriteAsync(address + i, chunk_size, buffers[i / chunk_size % 2]);
+    }
+    \endcode
 */
 class QSPIHandle
 {
@@ -53,6 +83,11 @@ class QSPIHandle
         E_INVALID_MODE,
     };
 
+    /** Called from the QSPI interrupt when an asynchronous operation is
+     *  done, with Result::ERR if it failed.
+     */
+    typedef void (*EndCallbackFunctionPtr)(void* context, Result result);
+
     /** Configuration structure for interfacing with QSPI Driver */
     struct Config
     {
@@ -133,7 +168,9 @@ class QSPIHandle
 
     /** 
         Erases the area specified on the chip.
-        Erasures will happen by 4K, 32K or 64K increments.
+        Erasures will happen by 4K, 32K or 64K increments, using the largest
+        block that fits the rest of the area, or the whole chip at once if
+        the area covers all of it.
         Smallest erase possible is 4kB at a time. (on IS25LP*)
         \param start_addr Address to begin erasing from
         \param end_addr  Address to stop erasing at
@@ -141,6 +178,50 @@ class QSPIHandle
         */
     Result Erase(uint32_t start_addr, uint32_t end_addr);
 
+    /** Queues writing size bytes from buffer to the chip, starting at
+        address, and returns right away. Like Write(), the area should be
+        erased before.
+        \param address Address to write to
+        \param size Buffer size
+        \param buffer Buffer to write. Must stay valid until the end callback.
+        \param end_callback Called from the QSPI interrupt when done, or nullptr
+        \param callback_context Passed to the end callback
+        \return Result::ERR if QSPI_QUEUE_LEN operations are already waiting
+        */
+    Result WriteAsync(uint32_t               address,
+                      uint32_t               size,
+                      uint8_t*               buffer,
+                      EndCallbackFunctionPtr end_callback     = nullptr,
+                      void*                  callback_context = nullptr);
+
+    /** Queues erasing an area of the chip and returns right away.
+        The same erase blocks as with Erase() are used.
+        \param start_addr Address to begin erasing from
+        \param end_addr  Address to stop erasing at
+        \param end_callback Called from the QSPI interrupt when done, or nullptr
+        \param callback_context Passed to the end callback
+        \return Result::ERR if QSPI_QUEUE_LEN operations are already waiting
+        */
+    Result EraseAsync(uint32_t               start_addr,
+                      uint32_t               end_addr,
+                      EndCallbackFunctionPtr end_callback     = nullptr,
+                      void*                  callback_context = nullptr);
+
+    /** Returns true while an asynchronous operation is running or queued.
+     *  The memory can't be read and the blocking functions return
+     *  Result::ERR in the meantime.
+     *  As the status polling of the peripheral doesn't time out on its own,
+     *  this also fails the running operation with Result::ERR once its
+     *  current step takes longer than the flash is specified for, so poll
+     *  it while waiting for the end callback.
+     */
+    bool IsBusy();
+
+    /** Returns the number of asynchronous operations waiting behind the
+     *  one in progress
+     */
+    size_t GetNumQueuedOperations();
+
     /**  
          Erases a single sector of the chip.  
         TODO: Document the size of this function. 
@@ -180,6 +261,7 @@ class QSPIHandle
 #else
 
 #include <cstdint>
+#include <cassert>
 #include "../tests/TestIsolator.h"
 
 namespace daisy
@@ -210,29 +292,31 @@ class QSPIHandle
     }
 
 
+    /** Like on the hardware, writing can only clear bits. Writing to
+     *  memory that wasn't erased ANDs the data with its contents.
+     */
     static Result Write(uint32_t address, uint32_t size, uint8_t* buffer)
     {
-        // 256-byte aligned, normalized address value
-        uint32_t adjusted_addr = (address) & (uint32_t)(~0xff);
+        assert(address + size <= kMaxAdjustedAddr);
         // Make sure memory is of approriate size
-        uint32_t total_bytes = adjusted_addr + size;
-        AdaptToSize(total_bytes);
-        // Copy data into vector
+        AdaptToSize(address + size);
         uint8_t* dest = testIsolator_.GetStateForCurrentTest()->memory_.data();
-        std::copy(&buffer[adjusted_addr],
-                  &buffer[adjusted_addr + size],
-                  &dest[adjusted_addr]);
+        for(uint32_t i = 0; i < size; i++)
+            dest[address + i] &= buffer[i];
         return Result::OK;
     }
 
+    /** Erases in 256 byte steps, a partial step at the end is erased
+     *  completely.
+     */
     static Result Erase(uint32_t start_addr, uint32_t end_addr)
     {
         uint32_t adjusted_start_addr = (start_addr) & (uint32_t)(~0xff);
-        uint32_t adjusted_end_addr   = (end_addr) & (uint32_t)(~0xff);
+        uint32_t adjusted_end_addr   = (end_addr + 0xff) & (uint32_t)(~0xff);
 
         // guard addresses
         assert(adjusted_start_addr < kMaxAdjustedAddr);
-        assert(adjusted_end_addr < kMaxAdjustedAddr);
+        assert(adjusted_end_addr <= kMaxAdjustedAddr);
 
         // Make sure vector is of appropriate size
         // size should be at least (adjusted_end_addr)
@@ -243,12 +327,58 @@ class QSPIHandle
         return Result::OK;
     }
 
+    typedef void (*EndCallbackFunctionPtr)(void* context, Result result);
+
+    /** Writes right away, then calls the end callback */
+    static Result WriteAsync(uint32_t               address,
+                             uint32_t               size,
+                             uint8_t*               buffer,
+                             EndCallbackFunctionPtr end_callback     = nullptr,
+                             void*                  callback_context = nullptr)
+    {
+        const Result result = Write(address, size, buffer);
+        if(end_callback)
+            end_callback(callback_context, result);
+        return Result::OK;
+    }
+
+    /** Erases right away, then calls the end callback */
+    static Result EraseAsync(uint32_t               start_addr,
+                             uint32_t               end_addr,
+                             EndCallbackFunctionPtr end_callback     = nullptr,
+                             void*                  callback_context = nullptr)
+    {
+        const Result result = Erase(start_addr, end_addr);
+        if(end_callback)
+            end_callback(callback_context, result);
+        return Result::OK;
+    }
+
+    static bool IsBusy()
+    {
+        return testIsolator_.GetStateForCurrentTest()->busy_;
+    }
+
+    /** Makes IsBusy() return busy, as if another asynchronous operation
+     *  was running.
+     *
+     *  This is not in the hardware class its just for testing purposes
+     */
+    static void SetBusyForUnitTest(bool busy)
+    {
+        testIsolator_.GetStateForCurrentTest()->busy_ = busy;
+    }
+
+    static size_t GetNumQueuedOperations() { return 0; }
+
     /** Returns a pointer to the actual memory used 
+     *  Like the memory mapped flash, the entire memory can be read
+     *  through it.
     */
     static void* GetData(uint32_t offset = 0)
     {
         assert(offset < kMaxAdjustedAddr);
-        AdaptToSize(offset + 1); /**< Make sure it's not empty */
+        AdaptToSize(kMaxAdjustedAddr);
         return (void*)(testIsolator_.GetStateForCurrentTest()->memory_.data()
                        + offset);
     }
@@ -276,6 +406,7 @@ class QSPIHandle
     {
         // Emulate the byte-memory of the QSPI flash
         std::vector<uint8_t> memory_;
+        bool                 busy_ = false;
     };
     static TestIsolator<QSPIState> testIsolator_;
 };
@@ -1,12 +1,17 @@
 #include "per/sai.h"
 #include "daisy_core.h"
+#include "util/Trace.h"
+#ifndef UNIT_TEST
 extern "C"
 {
 #include "util/hal_map.h"
 }
+#endif
 
 namespace daisy
 {
+#ifndef UNIT_TEST // for unit tests, a dummy implementation is provided below
+
 class SaiHandle::Impl
 {
   public:
@@ -172,6 +177,13 @@ SaiHandle::Result SaiHandle::Impl::Init(const SaiHandle::Config& config)
         default: break;
     }
 
+    // Anything other than a stereo frame runs as TDM
+    const uint32_t nbslot = config.slots;
+    if(!Config::IsSupportedSlotCount(nbslot))
+        return Result::ERR;
+    if(nbslot != 2)
+        protocol = SAI_PCM_SHORT;
+
     // Generic Inits that we don't have API control over.
     // A
     sai_a_handle_.Init.OutputDrive    = SAI_OUTPUTDRIVE_DISABLE;
@@ -189,13 +201,13 @@ SaiHandle::Result SaiHandle::Impl::Init(const SaiHandle::Config& config)
     sai_b_handle_.Init.MonoStereoMode = SAI_STEREOMODE;
     sai_b_handle_.Init.CompandingMode = SAI_NOCOMPANDING;
     sai_b_handle_.Init.TriState       = SAI_OUTPUT_NOTRELEASED;
-    if(HAL_SAI_InitProtocol(&sai_a_handle_, protocol, bd, 2) != HAL_OK)
+    if(HAL_SAI_InitProtocol(&sai_a_handle_, protocol, bd, nbslot) != HAL_OK)
     {
         Error_Handler();
         return Result::ERR;
     }
 
-    if(HAL_SAI_InitProtocol(&sai_b_handle_, protocol, bd, 2) != HAL_OK)
+    if(HAL_SAI_InitProtocol(&sai_b_handle_, protocol, bd, nbslot) != HAL_OK)
     {
         Error_Handler();
         return Result::ERR;
@@ -351,8 +363,8 @@ float SaiHandle::Impl::GetSampleRate()
 }
 size_t SaiHandle::Impl::GetBlockSize()
 {
-    // Buffer handled in halves, 2 samples per frame (1 per channel)
-    return buff_size_ / 2 / 2;
+    // Buffer handled in halves, 1 sample per slot in each frame
+    return buff_size_ / 2 / config_.slots;
 }
 float SaiHandle::Impl::GetBlockRate()
 {
@@ -508,11 +520,13 @@ extern "C" void HAL_SAI_RxHalfCpltCallback(SAI_HandleTypeDef* hsai)
 {
     if(hsai->Instance == SAI1_Block_A || hsai->Instance == SAI1_Block_B)
     {
+        DSY_TRACE_SCOPE(SAI_DMA_HALF, 1);
         sai_handles[0].dma_offset = 0;
         sai_handles[0].InternalCallback(0);
     }
     else if(hsai->Instance == SAI2_Block_A || hsai->Instance == SAI2_Block_B)
     {
+        DSY_TRACE_SCOPE(SAI_DMA_HALF, 2);
         sai_handles[1].dma_offset = 0;
         sai_handles[1].InternalCallback(0);
     }
@@ -522,16 +536,98 @@ extern "C" void HAL_SAI_RxCpltCallback(SAI_HandleTypeDef* hsai)
 {
     if(hsai->Instance == SAI1_Block_A || hsai->Instance == SAI1_Block_B)
     {
+        DSY_TRACE_SCOPE(SAI_DMA_COMPLETE, 1);
         sai_handles[0].dma_offset = sai_handles[0].buff_size_ / 2;
         sai_handles[0].InternalCallback(sai_handles[0].dma_offset);
     }
     else if(hsai->Instance == SAI2_Block_A || hsai->Instance == SAI2_Block_B)
     {
+        DSY_TRACE_SCOPE(SAI_DMA_COMPLETE, 2);
         sai_handles[1].dma_offset = sai_handles[1].buff_size_ / 2;
         sai_handles[1].InternalCallback(sai_handles[1].dma_offset);
     }
 }
 
+#else // ifndef UNIT_TEST
+
+/** This is a dummy implementation for use in unit tests.
+ *  It only keeps track of the configuration and the buffers passed to
+ *  StartDma(). Tests can then call TriggerDmaCallbackForUnitTest() to
+ *  emulate the half/complete DMA interrupts.
+ */
+class SaiHandle::Impl
+{
+  public:
+    SaiHandle::Result Init(const SaiHandle::Config& config)
+    {
+        if(!SaiHandle::Config::IsSupportedSlotCount(config.slots))
+            return SaiHandle::Result::ERR;
+        config_    = config;
+        buff_rx_   = nullptr;
+        buff_tx_   = nullptr;
+        buff_size_ = 0;
+        callback_  = nullptr;
+        dma_offset = 0;
+        return SaiHandle::Result::OK;
+    }
+    SaiHandle::Result        DeInit() { return StopDmaTransfer(); }
+    const SaiHandle::Config& GetConfig() const { return config_; }
+
+    SaiHandle::Result StartDmaTransfer(int32_t*                       buffer_rx,
+                                       int32_t*                       buffer_tx,
+                                       size_t                         size,
+                                       SaiHandle::CallbackFunctionPtr callback)
+    {
+        buff_rx_   = buffer_rx;
+        buff_tx_   = buffer_tx;
+        buff_size_ = size;
+        callback_  = callback;
+        return SaiHandle::Result::OK;
+    }
+    SaiHandle::Result StopDmaTransfer()
+    {
+        callback_ = nullptr;
+        return SaiHandle::Result::OK;
+    }
+
+    float GetSampleRate()
+    {
+        switch(config_.sr)
+        {
+            case Config::SampleRate::SAI_8KHZ: return 8000.f;
+            case Config::SampleRate::SAI_16KHZ: return 16000.f;
+            case Config::SampleRate::SAI_32KHZ: return 32000.f;
+            case Config::SampleRate::SAI_48KHZ: return 48000.f;
+            case Config::SampleRate::SAI_96KHZ: return 96000.f;
+            default: return 48000.f;
+        }
+    }
+    size_t GetBlockSize() { return buff_size_ / 2 / config_.slots; }
+    float  GetBlockRate() { return GetSampleRate() / GetBlockSize(); }
+
+    void InternalCallback(size_t offset)
+    {
+        if(callback_)
+            callback_(buff_rx_ + offset, buff_tx_ + offset, buff_size_ / 2);
+    }
+
+    SaiHandle::Config              config_;
+    int32_t *                      buff_rx_, *buff_tx_;
+    size_t                         buff_size_;
+    SaiHandle::CallbackFunctionPtr callback_;
+    size_t                         dma_offset;
+};
+
+static SaiHandle::Impl sai_handles[2];
+
+void SaiHandle::TriggerDmaCallbackForUnitTest(bool second_half)
+{
+    pimpl_->dma_offset = second_half ? pimpl_->buff_size_ / 2 : 0;
+    pimpl_->InternalCallback(pimpl_->dma_offset);
+}
+
+#endif // ifndef UNIT_TEST
+
 // ================================================================
 // SaiHandle -> SaiHandle::Pimpl
 // ================================================================
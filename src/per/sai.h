@@ -7,7 +7,7 @@
 namespace daisy
 {
 /** 
- * Support for I2S Audio Protocol with different bit-depth, samplerate options
+ * Support for I2S and TDM Audio Protocols with different bit-depth, samplerate options
  * Allows for master or slave, as well as freedom of selecting direction, 
  * and other behavior for each peripheral, and block.
  * 
@@ -96,6 +96,22 @@ class SaiHandle
         BitDepth   bit_depth;
         Sync       a_sync, b_sync;
         Direction  a_dir, b_dir;
+
+        /** Number of slots (channels) per frame on each data line.
+         ** 2 is standard stereo I2S. The other supported counts (1, 4, 8
+         ** and 16) set both blocks up for TDM, with a frame sync pulse of
+         ** one bit clock (PCM short).
+         */
+        uint8_t slots = 2;
+
+        /** Returns true for the slot counts that the audio engine has
+         ** conversion kernels for: 1, 2, 4, 8 and 16.
+         */
+        static constexpr bool IsSupportedSlotCount(size_t num_slots)
+        {
+            return num_slots == 1 || num_slots == 2 || num_slots == 4
+                   || num_slots == 8 || num_slots == 16;
+        }
     };
 
     /** Return values for SAI functions */
@@ -142,7 +158,7 @@ class SaiHandle
     float GetSampleRate();
 
     /** Returns the number of samples per audio block 
-     ** Calculated as Buffer Size / 2 / number of channels */
+     ** Calculated as Buffer Size / 2 / number of slots */
     size_t GetBlockSize();
 
     /** Returns the Block Rate of the current stream based on the size 
@@ -158,6 +174,14 @@ class SaiHandle
         return pimpl_ == nullptr ? false : true;
     }
 
+#ifdef UNIT_TEST
+    /** Emulates the DMA half complete (or complete) interrupt by calling
+     ** the callback passed to StartDma(). Only available in unit tests.
+     ** \param second_half true to emulate the transfer complete interrupt
+     */
+    void TriggerDmaCallbackForUnitTest(bool second_half);
+#endif
+
     class Impl; /**< Private Implementation class */
 
   private:
@@ -1,5 +1,7 @@
 #include "per/spi.h"
 #include "util/scopedirqblocker.h"
+#include "util/DmaJobScheduler.h"
+#include "util/Trace.h"
 
 extern "C"
 {
@@ -24,20 +26,35 @@ class SpiHandle::Impl
   public:
     struct SpiDmaJob
     {
-        uint8_t*                            data_rx          = nullptr;
-        uint8_t*                            data_tx          = nullptr;
-        uint16_t                            size             = 0;
+        /** the only segment of a single transfer, unused for chains */
+        SpiHandle::DmaSegment               segment          = {};
+        const SpiHandle::DmaSegment*        chain            = nullptr;
+        size_t                              num_segments     = 0;
         SpiHandle::StartCallbackFunctionPtr start_callback   = nullptr;
         SpiHandle::EndCallbackFunctionPtr   end_callback     = nullptr;
         void*                               callback_context = nullptr;
-        SpiHandle::DmaDirection direction = SpiHandle::DmaDirection::TX;
 
-        bool IsValidJob() const
+        const SpiHandle::DmaSegment& GetSegment(size_t idx) const
         {
-            return data_rx != nullptr && data_tx != nullptr;
+            return chain != nullptr ? chain[idx] : segment;
         }
-        void Invalidate() { data_rx = data_tx = nullptr; }
     };
+
+    /** The state of a pair of DMA streams, shared by all SPI peripherals
+     *  configured to use them. Which peripheral owns them is tracked by
+     *  the dma_scheduler_.
+     */
+    struct DmaStreamState
+    {
+        DMA_Stream_TypeDef* rx_instance;
+        DMA_Stream_TypeDef* tx_instance;
+        /** index of the peripheral the streams are initialized for, or -1 */
+        int8_t initialized_for;
+        /** the job in progress, and its segment in progress */
+        SpiDmaJob job;
+        size_t    segment_idx;
+    };
+
     Result Init(const Config& config);
 
     const SpiHandle::Config& GetConfig() const { return config_; }
@@ -66,45 +83,54 @@ class SpiHandle::Impl
                           SpiHandle::StartCallbackFunctionPtr start_callback,
                           SpiHandle::EndCallbackFunctionPtr   end_callback,
                           void*                               callback_context);
+    Result DmaTransferChain(const SpiHandle::DmaSegment*        segments,
+                            size_t                              num_segments,
+                            SpiHandle::StartCallbackFunctionPtr start_callback,
+                            SpiHandle::EndCallbackFunctionPtr   end_callback,
+                            void* callback_context);
+    size_t GetNumQueuedDmaTransfers() const;
 
 
     Result InitPins();
     Result DeInitPins();
 
-    Result StartDmaTx(uint8_t*                            buff,
-                      size_t                              size,
-                      SpiHandle::StartCallbackFunctionPtr start_callback,
-                      SpiHandle::EndCallbackFunctionPtr   end_callback,
-                      void*                               callback_context);
-
-    Result StartDmaRx(uint8_t*                            buff,
-                      size_t                              size,
-                      SpiHandle::StartCallbackFunctionPtr start_callback,
-                      SpiHandle::EndCallbackFunctionPtr   end_callback,
-                      void*                               callback_context);
-    Result StartDmaRxTx(uint8_t*                            tx_buff,
-                        uint8_t*                            rx_buff,
-                        size_t                              size,
-                        SpiHandle::StartCallbackFunctionPtr start_callback,
-                        SpiHandle::EndCallbackFunctionPtr   end_callback,
-                        void*                               callback_context);
+    /** Starts the job right away if the DMA streams are idle, or queues
+     *  it. Never waits.
+     */
+    Result StartOrQueueDmaJob(const SpiDmaJob& job);
+    /** Starts the first segment of a job. The streams have to be claimed
+     *  for this peripheral already.
+     */
+    Result StartDmaJob(const SpiDmaJob& job);
+    Result StartDmaSegment(const SpiHandle::DmaSegment& segment);
+    /** Starts the queued jobs of the streams after a blocking transfer,
+     *  they wait while the peripheral is busy.
+     */
+    void RestartQueuedDmaJobs();
+
+    size_t GetDmaStreamIdx() const { return size_t(config_.dma_stream); }
+    bool   IsReadyForDma()
+    {
+        return HAL_SPI_GetState(&hspi_) == HAL_SPI_STATE_READY;
+    }
 
     static void GlobalInit();
-    static bool IsDmaBusy();
     static void DmaTransferFinished(SPI_HandleTypeDef* hspi,
                                     SpiHandle::Result  result);
-
-    static void QueueDmaTransfer(size_t spi_idx, const SpiDmaJob& job);
-    static bool IsDmaTransferQueuedFor(size_t spi_idx);
+    static void StartNextQueuedDmaJob(size_t stream_idx);
+    static void DmaStreamIrqHandler(size_t stream_idx, bool rx);
 
     Result SetDmaPeripheral();
     Result InitDma();
 
-    static constexpr uint8_t kNumSpiWithDma = 4;
-    static volatile int8_t   dma_active_peripheral_;
-    static SpiDmaJob         queued_dma_transfers_[kNumSpiWithDma];
-    static SpiHandle::EndCallbackFunctionPtr next_end_callback_;
-    static void*                             next_callback_context_;
+    static constexpr uint8_t kNumSpiWithDma = 5;
+    static constexpr size_t  kNumDmaStreams = 3;
+    using Scheduler = DmaJobScheduler<SpiDmaJob,
+                                      kNumSpiWithDma,
+                                      kNumDmaStreams,
+                                      SPI_DMA_QUEUE_LEN>;
+    static DmaStreamState dma_streams_[kNumDmaStreams];
+    static Scheduler      dma_scheduler_;
 
     SpiHandle::Config config_;
     SPI_HandleTypeDef hspi_;
@@ -137,14 +163,33 @@ SpiHandle::Impl* MapInstanceToHandle(SPI_TypeDef* instance)
 
 void SpiHandle::Impl::GlobalInit()
 {
-    // init the scheduler queue
-    dma_active_peripheral_ = -1;
-    for(int per = 0; per < kNumSpiWithDma; per++)
-        queued_dma_transfers_[per] = SpiHandle::Impl::SpiDmaJob();
+    // init the scheduler state and queues
+    DMA_Stream_TypeDef* const rx_instances[kNumDmaStreams]
+        = {DMA2_Stream2, DMA2_Stream5, DMA1_Stream7};
+    DMA_Stream_TypeDef* const tx_instances[kNumDmaStreams]
+        = {DMA2_Stream3, DMA2_Stream6, DMA2_Stream7};
+    for(size_t i = 0; i < kNumDmaStreams; i++)
+    {
+        DmaStreamState& stream = dma_streams_[i];
+        stream.rx_instance     = rx_instances[i];
+        stream.tx_instance     = tx_instances[i];
+        stream.initialized_for = -1;
+        stream.job             = SpiDmaJob();
+        stream.segment_idx     = 0;
+    }
+    dma_scheduler_.Init();
 }
 
 SpiHandle::Result SpiHandle::Impl::Init(const Config& config)
 {
+    // the DMA configuration may change, so the streams have to be
+    // initialized again before the next transfer of this peripheral
+    for(size_t i = 0; i < kNumDmaStreams; i++)
+    {
+        if(dma_streams_[i].initialized_for == int8_t(config.periph))
+            dma_streams_[i].initialized_for = -1;
+    }
+
     config_ = config;
 
     SPI_TypeDef* periph;
@@ -318,7 +363,14 @@ SpiHandle::Result SpiHandle::Impl::SetDmaPeripheral()
 
 SpiHandle::Result SpiHandle::Impl::InitDma()
 {
-    hdma_spi_rx_.Instance                 = DMA2_Stream2;
+    DmaStreamState& stream = dma_streams_[GetDmaStreamIdx()];
+
+    // consecutive transfers of the same peripheral, e.g. the segments of
+    // a chain, can reuse the streams' configuration
+    if(stream.initialized_for == int8_t(config_.periph))
+        return SpiHandle::Result::OK;
+
+    hdma_spi_rx_.Instance                 = stream.rx_instance;
     hdma_spi_rx_.Init.PeriphInc           = DMA_PINC_DISABLE;
     hdma_spi_rx_.Init.MemInc              = DMA_MINC_ENABLE;
     hdma_spi_rx_.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
@@ -330,7 +382,7 @@ SpiHandle::Result SpiHandle::Impl::InitDma()
     hdma_spi_rx_.Init.MemBurst            = DMA_MBURST_SINGLE;
     hdma_spi_rx_.Init.PeriphBurst         = DMA_PBURST_SINGLE;
 
-    hdma_spi_tx_.Instance                 = DMA2_Stream3;
+    hdma_spi_tx_.Instance                 = stream.tx_instance;
     hdma_spi_tx_.Init.PeriphInc           = DMA_PINC_DISABLE;
     hdma_spi_tx_.Init.MemInc              = DMA_MINC_ENABLE;
     hdma_spi_tx_.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
@@ -341,7 +393,8 @@ SpiHandle::Result SpiHandle::Impl::InitDma()
     hdma_spi_tx_.Init.FIFOThreshold       = DMA_FIFO_THRESHOLD_FULL;
     hdma_spi_tx_.Init.MemBurst            = DMA_MBURST_SINGLE;
     hdma_spi_tx_.Init.PeriphBurst         = DMA_PBURST_SINGLE;
-    SetDmaPeripheral();
+    if(SetDmaPeripheral() != SpiHandle::Result::OK)
+        return SpiHandle::Result::ERR;
 
     hdma_spi_rx_.Init.Direction = DMA_PERIPH_TO_MEMORY;
     hdma_spi_tx_.Init.Direction = DMA_MEMORY_TO_PERIPH;
@@ -360,6 +413,7 @@ SpiHandle::Result SpiHandle::Impl::InitDma()
     __HAL_LINKDMA(&hspi_, hdmarx, hdma_spi_rx_);
     __HAL_LINKDMA(&hspi_, hdmatx, hdma_spi_tx_);
 
+    stream.initialized_for = int8_t(config_.periph);
     return SpiHandle::Result::OK;
 }
 
@@ -369,238 +423,215 @@ void SpiHandle::Impl::DmaTransferFinished(SPI_HandleTypeDef* hspi,
 {
     ScopedIrqBlocker block;
 
+    SpiHandle::Impl* handle     = MapInstanceToHandle(hspi->Instance);
+    const size_t     stream_idx = handle->GetDmaStreamIdx();
+    DmaStreamState&  stream     = dma_streams_[stream_idx];
+    DSY_TRACE_SCOPE(SPI_DMA_DONE, uint16_t(handle->config_.periph));
+
     // on an error, reinit the peripheral to clear any flags
     if(result != SpiHandle::Result::OK)
+    {
         HAL_SPI_Init(hspi);
+        stream.initialized_for = -1;
+    }
 
-    dma_active_peripheral_ = -1;
+    // not a transfer started by the scheduler
+    if(dma_scheduler_.GetActivePeripheral(stream_idx)
+       != int(handle->config_.periph))
+        return;
 
-    if(next_end_callback_ != nullptr)
+    // continue with the next segment of a chain right away
+    if(result == SpiHandle::Result::OK
+       && ++stream.segment_idx < stream.job.num_segments)
     {
-        // the callback may setup another transmission, hence we shouldn't reset this to
-        // nullptr after the callback - it might overwrite the new transmission.
-        auto callback      = next_end_callback_;
-        next_end_callback_ = nullptr;
-        // make the callback
-        callback(next_callback_context_, result);
+        if(handle->StartDmaSegment(stream.job.GetSegment(stream.segment_idx))
+           == SpiHandle::Result::OK)
+            return;
+        result = SpiHandle::Result::ERR;
     }
 
+    dma_scheduler_.Release(stream_idx);
+
+    // the callback may setup another transmission and overwrite the job
+    const auto callback         = stream.job.end_callback;
+    const auto callback_context = stream.job.callback_context;
+    if(callback != nullptr)
+        callback(callback_context, result);
+
     // the callback could have started a new transmission right away...
-    if(IsDmaBusy())
+    if(dma_scheduler_.IsBusy(stream_idx))
         return;
 
-    // dma is still idle. Check if another SPI peripheral waits for a job.
-    for(int per = 0; per < kNumSpiWithDma; per++)
-        if(IsDmaTransferQueuedFor(per))
+    // the streams are still idle. Check if another SPI peripheral waits for a job.
+    StartNextQueuedDmaJob(stream_idx);
+}
+
+void SpiHandle::Impl::StartNextQueuedDmaJob(size_t stream_idx)
+{
+    // round robin over the peripherals waiting for these streams.
+    // A job that fails to start releases the streams again, so it's
+    // dropped and the next one is tried. A peripheral that is busy with a
+    // blocking transfer keeps its job, RestartQueuedDmaJobs() starts it.
+    size_t    per;
+    SpiDmaJob job;
+    size_t    num_waiting = 0;
+    while(num_waiting < kNumSpiWithDma
+          && dma_scheduler_.ClaimNext(stream_idx, per, job))
+    {
+        if(spi_handles[per].IsReadyForDma())
+            spi_handles[per].StartDmaJob(job);
+        else
         {
-            SpiHandle::Result result;
-            if(queued_dma_transfers_[per].direction
-               == SpiHandle::DmaDirection::TX)
-            {
-                result = spi_handles[per].StartDmaTx(
-                    queued_dma_transfers_[per].data_tx,
-                    queued_dma_transfers_[per].size,
-                    queued_dma_transfers_[per].start_callback,
-                    queued_dma_transfers_[per].end_callback,
-                    queued_dma_transfers_[per].callback_context);
-            }
-            else if(queued_dma_transfers_[per].direction
-                    == SpiHandle::DmaDirection::RX)
-            {
-                result = spi_handles[per].StartDmaRx(
-                    queued_dma_transfers_[per].data_rx,
-                    queued_dma_transfers_[per].size,
-                    queued_dma_transfers_[per].start_callback,
-                    queued_dma_transfers_[per].end_callback,
-                    queued_dma_transfers_[per].callback_context);
-            }
-            else
-            {
-                result = spi_handles[per].StartDmaRxTx(
-                    queued_dma_transfers_[per].data_rx,
-                    queued_dma_transfers_[per].data_tx,
-                    queued_dma_transfers_[per].size,
-                    queued_dma_transfers_[per].start_callback,
-                    queued_dma_transfers_[per].end_callback,
-                    queued_dma_transfers_[per].callback_context);
-            }
-            if(result == SpiHandle::Result::OK)
-            {
-                // remove the job from the queue
-                queued_dma_transfers_[per].Invalidate();
-                return;
-            }
+            dma_scheduler_.Requeue(per, stream_idx, job);
+            num_waiting++;
         }
+    }
 }
 
-
-int SpiHandle::Impl::CheckError()
+void SpiHandle::Impl::RestartQueuedDmaJobs()
 {
-    return HAL_SPI_GetError(&hspi_);
+    if(int(config_.periph) >= kNumSpiWithDma)
+        return;
+    ScopedIrqBlocker block;
+    const size_t     stream_idx = GetDmaStreamIdx();
+    if(!dma_scheduler_.IsBusy(stream_idx))
+        StartNextQueuedDmaJob(stream_idx);
 }
 
 
-bool SpiHandle::Impl::IsDmaBusy()
+int SpiHandle::Impl::CheckError()
 {
-    return dma_active_peripheral_ >= 0;
+    return HAL_SPI_GetError(&hspi_);
 }
 
-bool SpiHandle::Impl::IsDmaTransferQueuedFor(size_t spi_idx)
+
+size_t SpiHandle::Impl::GetNumQueuedDmaTransfers() const
 {
-    return queued_dma_transfers_[spi_idx].IsValidJob();
+    const int per = int(config_.periph);
+    if(per >= kNumSpiWithDma)
+        return 0;
+    ScopedIrqBlocker block;
+    return dma_scheduler_.GetNumQueued(per);
 }
 
-void SpiHandle::Impl::QueueDmaTransfer(size_t spi_idx, const SpiDmaJob& job)
+SpiHandle::Result SpiHandle::Impl::StartOrQueueDmaJob(const SpiDmaJob& job)
 {
-    // wait for any previous job on this peripheral to finish
-    // and the queue position to become free
-    while(IsDmaTransferQueuedFor(spi_idx))
+    const int per = int(config_.periph);
+    if(per >= kNumSpiWithDma || job.num_segments == 0)
     {
-        continue;
-    };
+        if(job.end_callback)
+            job.end_callback(job.callback_context, SpiHandle::Result::ERR);
+        return SpiHandle::Result::ERR;
+    }
 
-    // queue the job
-    ScopedIrqBlocker block;
-    queued_dma_transfers_[spi_idx] = job;
-}
+    const size_t stream_idx = GetDmaStreamIdx();
+    {
+        ScopedIrqBlocker block;
 
+        // if dma is currently running - queue the job behind the others
+        // of this peripheral. When the queue is full, the job is rejected
+        // instead of waiting for a free position.
+        switch(dma_scheduler_.Submit(per, stream_idx, job))
+        {
+            case Scheduler::Submission::REJECTED:
+                return SpiHandle::Result::ERR;
+            case Scheduler::Submission::QUEUED:
+                StartNextQueuedDmaJob(stream_idx);
+                return SpiHandle::Result::OK;
+            case Scheduler::Submission::START: break;
+        }
 
-SpiHandle::Result
-SpiHandle::Impl::DmaTransmit(uint8_t*                            buff,
-                             size_t                              size,
-                             SpiHandle::StartCallbackFunctionPtr start_callback,
-                             SpiHandle::EndCallbackFunctionPtr   end_callback,
-                             void* callback_context)
-{
-    // if dma is currently running - queue a job
-    if(IsDmaBusy())
-    {
-        SpiDmaJob job;
-        job.data_tx          = buff;
-        job.size             = size;
-        job.direction        = SpiHandle::DmaDirection::TX;
-        job.start_callback   = start_callback;
-        job.end_callback     = end_callback;
-        job.callback_context = callback_context;
-
-        const int spi_idx = int(config_.periph);
-
-        // queue a job (blocks until the queue position is free)
-        QueueDmaTransfer(spi_idx, job);
-        // TODO: the user can't tell if he got returned "OK"
-        // because the transfer was executed or because it was queued...
-        // should we change that?
-        return SpiHandle::Result::OK;
+        // busy with a blocking transfer, which starts the job when it's
+        // done. The queue was empty, so there's room.
+        if(!IsReadyForDma())
+        {
+            dma_scheduler_.Requeue(per, stream_idx, job);
+            return SpiHandle::Result::OK;
+        }
     }
 
-    return StartDmaTx(
-        buff, size, start_callback, end_callback, callback_context);
+    return StartDmaJob(job);
 }
 
-SpiHandle::Result
-SpiHandle::Impl::StartDmaTx(uint8_t*                            buff,
-                            size_t                              size,
-                            SpiHandle::StartCallbackFunctionPtr start_callback,
-                            SpiHandle::EndCallbackFunctionPtr   end_callback,
-                            void* callback_context)
+SpiHandle::Result SpiHandle::Impl::StartDmaJob(const SpiDmaJob& job)
 {
-    while(HAL_SPI_GetState(&hspi_) != HAL_SPI_STATE_READY) {};
-
-    if(InitDma() != SpiHandle::Result::OK)
-    {
-        if(end_callback)
-            end_callback(callback_context, SpiHandle::Result::ERR);
-        return SpiHandle::Result::ERR;
-    }
+    DmaStreamState& stream = dma_streams_[GetDmaStreamIdx()];
 
     ScopedIrqBlocker block;
 
-    dma_active_peripheral_ = int(config_.periph);
-    next_end_callback_     = end_callback;
-    next_callback_context_ = callback_context;
+    stream.job         = job;
+    stream.segment_idx = 0;
 
-    if(start_callback)
-        start_callback(callback_context);
+    if(job.start_callback)
+        job.start_callback(job.callback_context);
 
-    if(HAL_SPI_Transmit_DMA(&hspi_, buff, size) != HAL_OK)
+    if(StartDmaSegment(job.GetSegment(0)) != SpiHandle::Result::OK)
     {
-        dma_active_peripheral_ = -1;
-        next_end_callback_     = NULL;
-        next_callback_context_ = NULL;
-        if(end_callback)
-            end_callback(callback_context, SpiHandle::Result::ERR);
+        dma_scheduler_.Release(GetDmaStreamIdx());
+        if(job.end_callback)
+            job.end_callback(job.callback_context, SpiHandle::Result::ERR);
         return SpiHandle::Result::ERR;
     }
     return SpiHandle::Result::OK;
 }
 
 SpiHandle::Result
-SpiHandle::Impl::DmaReceive(uint8_t*                            buff,
-                            size_t                              size,
-                            SpiHandle::StartCallbackFunctionPtr start_callback,
-                            SpiHandle::EndCallbackFunctionPtr   end_callback,
-                            void* callback_context)
+SpiHandle::Impl::StartDmaSegment(const SpiHandle::DmaSegment& segment)
 {
-    // if dma is currently running - queue a job
-    if(IsDmaBusy())
-    {
-        SpiDmaJob job;
-        job.data_rx          = buff;
-        job.size             = size;
-        job.direction        = SpiHandle::DmaDirection::RX;
-        job.start_callback   = start_callback;
-        job.end_callback     = end_callback;
-        job.callback_context = callback_context;
-
-        const int spi_idx = int(config_.periph);
-
-        // queue a job (blocks until the queue position is free)
-        QueueDmaTransfer(spi_idx, job);
-        // TODO: the user can't tell if he got returned "OK"
-        // because the transfer was executed or because it was queued...
-        // should we change that?
-        return SpiHandle::Result::OK;
-    }
+    // never wait here, this runs with the interrupts disabled
+    if(!IsReadyForDma())
+        return SpiHandle::Result::ERR;
 
-    return StartDmaRx(
-        buff, size, start_callback, end_callback, callback_context);
+    if(InitDma() != SpiHandle::Result::OK)
+        return SpiHandle::Result::ERR;
+
+    HAL_StatusTypeDef status;
+    if(segment.tx_buff != nullptr && segment.rx_buff != nullptr)
+        status = HAL_SPI_TransmitReceive_DMA(
+            &hspi_, segment.tx_buff, segment.rx_buff, segment.size);
+    else if(segment.tx_buff != nullptr)
+        status = HAL_SPI_Transmit_DMA(&hspi_, segment.tx_buff, segment.size);
+    else if(segment.rx_buff != nullptr)
+        status = HAL_SPI_Receive_DMA(&hspi_, segment.rx_buff, segment.size);
+    else
+        return SpiHandle::Result::ERR;
+
+    return status == HAL_OK ? SpiHandle::Result::OK : SpiHandle::Result::ERR;
+}
+
+
+SpiHandle::Result
+SpiHandle::Impl::DmaTransmit(uint8_t*                            buff,
+                             size_t                              size,
+                             SpiHandle::StartCallbackFunctionPtr start_callback,
+                             SpiHandle::EndCallbackFunctionPtr   end_callback,
+                             void* callback_context)
+{
+    SpiDmaJob job;
+    job.segment.tx_buff  = buff;
+    job.segment.size     = size;
+    job.num_segments     = 1;
+    job.start_callback   = start_callback;
+    job.end_callback     = end_callback;
+    job.callback_context = callback_context;
+    return StartOrQueueDmaJob(job);
 }
 
 SpiHandle::Result
-SpiHandle::Impl::StartDmaRx(uint8_t*                            buff,
+SpiHandle::Impl::DmaReceive(uint8_t*                            buff,
                             size_t                              size,
                             SpiHandle::StartCallbackFunctionPtr start_callback,
                             SpiHandle::EndCallbackFunctionPtr   end_callback,
                             void* callback_context)
 {
-    while(HAL_SPI_GetState(&hspi_) != HAL_SPI_STATE_READY) {};
-
-    if(InitDma() != SpiHandle::Result::OK)
-    {
-        if(end_callback)
-            end_callback(callback_context, SpiHandle::Result::ERR);
-        return SpiHandle::Result::ERR;
-    }
-
-    ScopedIrqBlocker block;
-
-    dma_active_peripheral_ = int(config_.periph);
-    next_end_callback_     = end_callback;
-    next_callback_context_ = callback_context;
-
-    if(start_callback)
-        start_callback(callback_context);
-
-    if(HAL_SPI_Receive_DMA(&hspi_, buff, size) != HAL_OK)
-    {
-        dma_active_peripheral_ = -1;
-        next_end_callback_     = NULL;
-        next_callback_context_ = NULL;
-        if(end_callback)
-            end_callback(callback_context, SpiHandle::Result::ERR);
-        return SpiHandle::Result::ERR;
-    }
-    return SpiHandle::Result::OK;
+    SpiDmaJob job;
+    job.segment.rx_buff  = buff;
+    job.segment.size     = size;
+    job.num_segments     = 1;
+    job.start_callback   = start_callback;
+    job.end_callback     = end_callback;
+    job.callback_context = callback_context;
+    return StartOrQueueDmaJob(job);
 }
 
 SpiHandle::Result SpiHandle::Impl::DmaTransmitAndReceive(
@@ -611,75 +642,41 @@ SpiHandle::Result SpiHandle::Impl::DmaTransmitAndReceive(
     SpiHandle::EndCallbackFunctionPtr   end_callback,
     void*                               callback_context)
 {
-    // if dma is currently running - queue a job
-    if(IsDmaBusy())
-    {
-        SpiDmaJob job;
-        job.data_rx          = rx_buff;
-        job.data_tx          = tx_buff;
-        job.size             = size;
-        job.direction        = SpiHandle::DmaDirection::RX_TX;
-        job.start_callback   = start_callback;
-        job.end_callback     = end_callback;
-        job.callback_context = callback_context;
-
-        const int spi_idx = int(config_.periph);
-
-        // queue a job (blocks until the queue position is free)
-        QueueDmaTransfer(spi_idx, job);
-        // TODO: the user can't tell if he got returned "OK"
-        // because the transfer was executed or because it was queued...
-        // should we change that?
-        return SpiHandle::Result::OK;
-    }
-
-    return StartDmaRxTx(
-        rx_buff, tx_buff, size, start_callback, end_callback, callback_context);
+    SpiDmaJob job;
+    job.segment.tx_buff  = tx_buff;
+    job.segment.rx_buff  = rx_buff;
+    job.segment.size     = size;
+    job.num_segments     = 1;
+    job.start_callback   = start_callback;
+    job.end_callback     = end_callback;
+    job.callback_context = callback_context;
+    return StartOrQueueDmaJob(job);
 }
 
-SpiHandle::Result SpiHandle::Impl::StartDmaRxTx(
-    uint8_t*                            rx_buff,
-    uint8_t*                            tx_buff,
-    size_t                              size,
+SpiHandle::Result SpiHandle::Impl::DmaTransferChain(
+    const SpiHandle::DmaSegment*        segments,
+    size_t                              num_segments,
     SpiHandle::StartCallbackFunctionPtr start_callback,
     SpiHandle::EndCallbackFunctionPtr   end_callback,
     void*                               callback_context)
 {
-    while(HAL_SPI_GetState(&hspi_) != HAL_SPI_STATE_READY) {};
-
-    if(InitDma() != SpiHandle::Result::OK)
-    {
-        if(end_callback)
-            end_callback(callback_context, SpiHandle::Result::ERR);
-        return SpiHandle::Result::ERR;
-    }
-
-    ScopedIrqBlocker block;
-
-    dma_active_peripheral_ = int(config_.periph);
-    next_end_callback_     = end_callback;
-    next_callback_context_ = callback_context;
-
-    if(start_callback)
-        start_callback(callback_context);
-
-    if(HAL_SPI_TransmitReceive_DMA(&hspi_, tx_buff, rx_buff, size) != HAL_OK)
-    {
-        dma_active_peripheral_ = -1;
-        next_end_callback_     = NULL;
-        next_callback_context_ = NULL;
-        if(end_callback)
-            end_callback(callback_context, SpiHandle::Result::ERR);
-        return SpiHandle::Result::ERR;
-    }
-    return SpiHandle::Result::OK;
+    SpiDmaJob job;
+    job.chain            = segments;
+    job.num_segments     = segments != nullptr ? num_segments : 0;
+    job.start_callback   = start_callback;
+    job.end_callback     = end_callback;
+    job.callback_context = callback_context;
+    return StartOrQueueDmaJob(job);
 }
 
 
 SpiHandle::Result
 SpiHandle::Impl::BlockingTransmit(uint8_t* buff, size_t size, uint32_t timeout)
 {
-    if(HAL_SPI_Transmit(&hspi_, buff, size, timeout) != HAL_OK)
+    const HAL_StatusTypeDef status
+        = HAL_SPI_Transmit(&hspi_, buff, size, timeout);
+    RestartQueuedDmaJobs();
+    if(status != HAL_OK)
     {
         return SpiHandle::Result::ERR;
     }
@@ -690,7 +687,10 @@ SpiHandle::Result SpiHandle::Impl::BlockingReceive(uint8_t* buffer,
                                                    uint16_t size,
                                                    uint32_t timeout)
 {
-    if(HAL_SPI_Receive(&hspi_, buffer, size, timeout) != HAL_OK)
+    const HAL_StatusTypeDef status
+        = HAL_SPI_Receive(&hspi_, buffer, size, timeout);
+    RestartQueuedDmaJobs();
+    if(status != HAL_OK)
     {
         return Result::ERR;
     }
@@ -702,8 +702,10 @@ SpiHandle::Result SpiHandle::Impl::BlockingTransmitAndReceive(uint8_t* tx_buff,
                                                               size_t   size,
                                                               uint32_t timeout)
 {
-    if(HAL_SPI_TransmitReceive(&hspi_, tx_buff, rx_buff, size, timeout)
-       != HAL_OK)
+    const HAL_StatusTypeDef status
+        = HAL_SPI_TransmitReceive(&hspi_, tx_buff, rx_buff, size, timeout);
+    RestartQueuedDmaJobs();
+    if(status != HAL_OK)
     {
         return SpiHandle::Result::ERR;
     }
@@ -973,12 +975,10 @@ SpiHandle::Result SpiHandle::Impl::DeInitPins()
     return Result::OK;
 }
 
-volatile int8_t SpiHandle::Impl::dma_active_peripheral_;
-SpiHandle::Impl::SpiDmaJob
-    SpiHandle::Impl::queued_dma_transfers_[kNumSpiWithDma];
+SpiHandle::Impl::DmaStreamState
+    SpiHandle::Impl::dma_streams_[kNumDmaStreams];
 
-SpiHandle::EndCallbackFunctionPtr SpiHandle::Impl::next_end_callback_;
-void*                             SpiHandle::Impl::next_callback_context_;
+SpiHandle::Impl::Scheduler SpiHandle::Impl::dma_scheduler_;
 
 void HAL_SPI_MspInit(SPI_HandleTypeDef* spiHandle)
 {
@@ -1103,27 +1103,43 @@ extern "C" void SPI5_IRQHandler(void)
     HAL_SPI_IRQHandler(&spi_handles[4].hspi_);
 }
 
-void HalSpiDmaRxStreamCallback(void)
+void SpiHandle::Impl::DmaStreamIrqHandler(size_t stream_idx, bool rx)
 {
     ScopedIrqBlocker block;
-    if(SpiHandle::Impl::dma_active_peripheral_ >= 0)
-        HAL_DMA_IRQHandler(
-            &spi_handles[SpiHandle::Impl::dma_active_peripheral_].hdma_spi_rx_);
+    const int        per = dma_scheduler_.GetActivePeripheral(stream_idx);
+    if(per >= 0)
+        HAL_DMA_IRQHandler(rx ? &spi_handles[per].hdma_spi_rx_
+                              : &spi_handles[per].hdma_spi_tx_);
 }
+
+// shared streams
 extern "C" void DMA2_Stream2_IRQHandler(void)
 {
-    HalSpiDmaRxStreamCallback();
+    SpiHandle::Impl::DmaStreamIrqHandler(0, true);
 }
-void HalSpiDmaTxStreamCallback(void)
+extern "C" void DMA2_Stream3_IRQHandler(void)
 {
-    ScopedIrqBlocker block;
-    if(SpiHandle::Impl::dma_active_peripheral_ >= 0)
-        HAL_DMA_IRQHandler(
-            &spi_handles[SpiHandle::Impl::dma_active_peripheral_].hdma_spi_tx_);
+    SpiHandle::Impl::DmaStreamIrqHandler(0, false);
 }
-extern "C" void DMA2_Stream3_IRQHandler(void)
+
+// dedicated streams 1
+extern "C" void DMA2_Stream5_IRQHandler(void)
+{
+    SpiHandle::Impl::DmaStreamIrqHandler(1, true);
+}
+extern "C" void DMA2_Stream6_IRQHandler(void)
+{
+    SpiHandle::Impl::DmaStreamIrqHandler(1, false);
+}
+
+// dedicated streams 2
+extern "C" void DMA1_Stream7_IRQHandler(void)
+{
+    SpiHandle::Impl::DmaStreamIrqHandler(2, true);
+}
+extern "C" void DMA2_Stream7_IRQHandler(void)
 {
-    HalSpiDmaTxStreamCallback();
+    SpiHandle::Impl::DmaStreamIrqHandler(2, false);
 }
 
 extern "C" void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* hspi)
@@ -1202,15 +1218,31 @@ SpiHandle::DmaReceive(uint8_t*                            buff,
         buff, size, start_callback, end_callback, callback_context);
 }
 SpiHandle::Result SpiHandle::DmaTransmitAndReceive(
-    uint8_t*                            rx_buff,
     uint8_t*                            tx_buff,
+    uint8_t*                            rx_buff,
     size_t                              size,
     SpiHandle::StartCallbackFunctionPtr start_callback,
     SpiHandle::EndCallbackFunctionPtr   end_callback,
     void*                               callback_context)
 {
     return pimpl_->DmaTransmitAndReceive(
-        rx_buff, tx_buff, size, start_callback, end_callback, callback_context);
+        tx_buff, rx_buff, size, start_callback, end_callback, callback_context);
+}
+
+SpiHandle::Result
+SpiHandle::DmaTransferChain(const DmaSegment*                   segments,
+                            size_t                              num_segments,
+                            SpiHandle::StartCallbackFunctionPtr start_callback,
+                            SpiHandle::EndCallbackFunctionPtr   end_callback,
+                            void* callback_context)
+{
+    return pimpl_->DmaTransferChain(
+        segments, num_segments, start_callback, end_callback, callback_context);
+}
+
+size_t SpiHandle::GetNumQueuedDmaTransfers() const
+{
+    return pimpl_->GetNumQueuedDmaTransfers();
 }
 
 SpiHandle::Result SpiHandle::BlockingTransmitAndReceive(uint8_t* tx_buff,
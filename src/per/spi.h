@@ -4,6 +4,14 @@
 
 #include "daisy_core.h"
 
+/** Number of DMA jobs that can wait per SPI peripheral while the DMA
+ *  stream or the peripheral is busy, e.g. with a blocking transfer.
+ *  Can be overridden with a compiler flag.
+ */
+#ifndef SPI_DMA_QUEUE_LEN
+#define SPI_DMA_QUEUE_LEN 8
+#endif
+
 /* TODO:
 - Add documentation
 - Add IT
@@ -76,6 +84,18 @@ class SpiHandle
             PS_256,
         };
 
+        /** The DMA streams used for DMA transfers.
+         *  Peripherals using the same streams take turns, each transfer
+         *  has to wait until the previous one is finished. Peripherals
+         *  on different streams transfer at the same time.
+         */
+        enum class DmaStream
+        {
+            SHARED,      /**< DMA2 stream 2 (rx) and 3 (tx), the default */
+            DEDICATED_1, /**< DMA2 stream 5 (rx) and 6 (tx) */
+            DEDICATED_2, /**< DMA1 stream 7 (rx) and DMA2 stream 7 (tx) */
+        };
+
         struct
         {
             dsy_gpio_pin sclk; /**< & */
@@ -91,6 +111,7 @@ class SpiHandle
             clock_polarity = ClockPolarity::LOW;
             clock_phase    = ClockPhase::ONE_EDGE;
             baud_prescaler = BaudPrescaler::PS_8;
+            dma_stream     = DmaStream::SHARED;
         }
 
         Peripheral    periph;
@@ -101,6 +122,7 @@ class SpiHandle
         ClockPhase    clock_phase;
         NSS           nss;
         BaudPrescaler baud_prescaler;
+        DmaStream     dma_stream;
     };
 
     SpiHandle() : pimpl_(nullptr) {}
@@ -132,6 +154,16 @@ class SpiHandle
     /** A callback to be executed after a dma transfer is completed. */
     typedef void (*EndCallbackFunctionPtr)(void* context, Result result);
 
+    /** One buffer of a chained DMA transfer, see DmaTransferChain().
+     *  Set tx_buff, rx_buff or both, the other one to nullptr.
+     */
+    struct DmaSegment
+    {
+        uint8_t* tx_buff;
+        uint8_t* rx_buff;
+        size_t   size;
+    };
+
 
     /** Blocking transmit 
     \param buff input buffer
@@ -169,7 +201,8 @@ class SpiHandle
     \param end_callback     A callback to execute when the transfer finishes, or NULL.
                             The callback is called from an interrupt, so keep it fast.
     \param callback_context A pointer that will be passed back to you in the callbacks.     
-    \return Whether the transmit was successful or not
+    \return OK if the transfer was started or queued. ERR if it failed to start, or if
+            SPI_DMA_QUEUE_LEN transfers are already waiting. Never waits for the DMA.
     */
     Result DmaTransmit(uint8_t*                            buff,
                        size_t                              size,
@@ -185,7 +218,8 @@ class SpiHandle
     \param end_callback     A callback to execute when the transfer finishes, or NULL.
                             The callback is called from an interrupt, so keep it fast.
     \param callback_context A pointer that will be passed back to you in the callbacks.    
-    \return Whether the receive was successful or not
+    \return OK if the transfer was started or queued. ERR if it failed to start, or if
+            SPI_DMA_QUEUE_LEN transfers are already waiting. Never waits for the DMA.
     */
     Result DmaReceive(uint8_t*                            buff,
                       size_t                              size,
@@ -202,7 +236,8 @@ class SpiHandle
     \param end_callback     A callback to execute when the transfer finishes, or NULL.
                             The callback is called from an interrupt, so keep it fast.
     \param callback_context A pointer that will be passed back to you in the callbacks.    
-    \return Whether the receive was successful or not
+    \return OK if the transfer was started or queued. ERR if it failed to start, or if
+            SPI_DMA_QUEUE_LEN transfers are already waiting. Never waits for the DMA.
     */
     Result
     DmaTransmitAndReceive(uint8_t*                            tx_buff,
@@ -212,6 +247,32 @@ class SpiHandle
                           SpiHandle::EndCallbackFunctionPtr   end_callback,
                           void*                               callback_context);
 
+    /** Chained DMA transfer
+    Transfers all segments back to back, without another peripheral's
+    transfer in between, e.g. a command followed by a block of data from
+    another buffer. The segments are read when they are started, so the
+    array has to stay valid until the end callback is called.
+    \param segments         the buffers to transfer, in order
+    \param num_segments     number of segments
+    \param start_callback   A callback to execute before the first segment starts, or NULL.
+                            The callback is called from an interrupt, so keep it fast.
+    \param end_callback     A callback to execute when the last segment finished or a
+                            segment failed, or NULL.
+                            The callback is called from an interrupt, so keep it fast.
+    \param callback_context A pointer that will be passed back to you in the callbacks.
+    \return OK if the transfer was started or queued, see DmaTransmit()
+    */
+    Result DmaTransferChain(const DmaSegment*                   segments,
+                            size_t                              num_segments,
+                            SpiHandle::StartCallbackFunctionPtr start_callback,
+                            SpiHandle::EndCallbackFunctionPtr   end_callback,
+                            void* callback_context);
+
+    /** \return the number of DMA transfers waiting for this peripheral,
+     *          at most SPI_DMA_QUEUE_LEN
+     */
+    size_t GetNumQueuedDmaTransfers() const;
+
     /** \return the result of HAL_SPI_GetError() to the user. */
     int CheckError();
 
@@ -48,6 +48,16 @@ extern "C"
         HAL_NVIC_EnableIRQ(DMA2_Stream2_IRQn);
         HAL_NVIC_SetPriority(DMA2_Stream3_IRQn, 0, 0);
         HAL_NVIC_EnableIRQ(DMA2_Stream3_IRQn);
+        // DMA2_Stream5_IRQn and DMA2_Stream6_IRQn interrupt configuration for SPI (dedicated 1)
+        HAL_NVIC_SetPriority(DMA2_Stream5_IRQn, 0, 0);
+        HAL_NVIC_EnableIRQ(DMA2_Stream5_IRQn);
+        HAL_NVIC_SetPriority(DMA2_Stream6_IRQn, 0, 0);
+        HAL_NVIC_EnableIRQ(DMA2_Stream6_IRQn);
+        // DMA1_Stream7_IRQn and DMA2_Stream7_IRQn interrupt configuration for SPI (dedicated 2)
+        HAL_NVIC_SetPriority(DMA1_Stream7_IRQn, 0, 0);
+        HAL_NVIC_EnableIRQ(DMA1_Stream7_IRQn);
+        HAL_NVIC_SetPriority(DMA2_Stream7_IRQn, 0, 0);
+        HAL_NVIC_EnableIRQ(DMA2_Stream7_IRQn);
     }
 
     void dsy_dma_deinit(void)
@@ -80,6 +90,12 @@ extern "C"
         // DMA2_Stream2_IRQn and DMA2_Stream3_IRQn interrupt configuration for SPI
         HAL_NVIC_DisableIRQ(DMA2_Stream2_IRQn);
         HAL_NVIC_DisableIRQ(DMA2_Stream3_IRQn);
+        // DMA2_Stream5_IRQn and DMA2_Stream6_IRQn interrupt configuration for SPI (dedicated 1)
+        HAL_NVIC_DisableIRQ(DMA2_Stream5_IRQn);
+        HAL_NVIC_DisableIRQ(DMA2_Stream6_IRQn);
+        // DMA1_Stream7_IRQn and DMA2_Stream7_IRQn interrupt configuration for SPI (dedicated 2)
+        HAL_NVIC_DisableIRQ(DMA1_Stream7_IRQn);
+        HAL_NVIC_DisableIRQ(DMA2_Stream7_IRQn);
     }
 
     void dsy_dma_clear_cache_for_buffer(uint8_t* buffer, size_t size)
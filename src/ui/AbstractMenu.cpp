@@ -150,6 +150,19 @@ void AbstractMenu::OnShow()
     selectedItemIdx_  = 0;
 }
 
+void AbstractMenu::CheckForDamage()
+{
+    const auto itemValuesState = GetItemValuesState();
+    if(selectedItemIdx_ == lastSelectedItemIdx_ && isEditing_ == lastIsEditing_
+       && itemValuesState == lastItemValuesState_)
+        return;
+
+    lastSelectedItemIdx_ = selectedItemIdx_;
+    lastIsEditing_       = isEditing_;
+    lastItemValuesState_ = itemValuesState;
+    Invalidate();
+}
+
 void AbstractMenu::Init(const ItemConfig* items,
                         uint16_t          numItems,
                         Orientation       orientation,
@@ -163,6 +176,9 @@ void AbstractMenu::Init(const ItemConfig* items,
     selectedItemIdx_  = 0;
     isEditing_        = false;
     isFuncButtonDown_ = false;
+
+    // the items may have changed entirely
+    Invalidate();
 }
 
 bool AbstractMenu::CanItemBeEnteredForEditing(uint16_t itemIdx)
@@ -209,6 +225,7 @@ void AbstractMenu::ModifyItemValue(uint16_t itemIdx,
         case ItemType::customItem:
             item.asCustomItem.itemObject->ModifyValue(
                 increments, stepsPerRevolution, isFunctionButtonPressed);
+            Invalidate();
             break;
     }
 }
@@ -237,6 +254,7 @@ void AbstractMenu::ModifyItemValue(uint16_t itemIdx,
         case ItemType::customItem:
             item.asCustomItem.itemObject->ModifyValue(valueSliderPosition0To1,
                                                       isFunctionButtonPressed);
+            Invalidate();
             break;
     }
 }
@@ -268,8 +286,26 @@ void AbstractMenu::TriggerItemAction(uint16_t itemIdx)
             break;
         case ItemType::customItem:
             item.asCustomItem.itemObject->OnOkayButton();
+            Invalidate();
             break;
     }
 }
 
+uint32_t AbstractMenu::GetItemValuesState() const
+{
+    // combines the values that the items display, the MappedValues
+    // provide a counter that changes along with the value
+    uint32_t state = 0;
+    for(uint16_t i = 0; i < numItems_; i++)
+    {
+        const auto& item = items_[i];
+        if(item.type == ItemType::checkboxItem)
+            state = state * 31 + (*item.asCheckboxItem.valueToModify ? 1 : 0);
+        else if(item.type == ItemType::valueItem)
+            state = state * 31
+                    + item.asMappedValueItem.valueToModify->GetChangeCounter();
+    }
+    return state;
+}
+
 } // namespace daisy
\ No newline at end of file
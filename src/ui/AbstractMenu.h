@@ -51,6 +51,13 @@ namespace daisy
  * - Value potentiometer/slider: Edits value of selected item
  * - Function button: Uses an alternate step size when modifying the value with encoders
  *                    or buttons while pressed
+ * 
+ * The menu invalidates itself when the selection, the editing state or the value of a
+ * checkbox or value item changes, including values that were changed by the application.
+ * Custom items are invalidated when the menu modifies them; call `Invalidate()` when
+ * they change otherwise (FullScreenItemMenu redraws a selected custom item with every
+ * update). Return true from `TracksDamage()` in your child class if
+ * nothing else affects what it draws.
  */
 class AbstractMenu : public UiPage
 {
@@ -210,6 +217,7 @@ class AbstractMenu : public UiPage
                               uint16_t stepsPerRevolution) override;
     bool OnValuePotMoved(float newPosition) override;
     void OnShow() override;
+    void CheckForDamage() override;
 
   protected:
     /** Call this from your child class to initialize the menu. It's okay to
@@ -266,7 +274,14 @@ class AbstractMenu : public UiPage
                          bool     isFunctionButtonPressed);
     void TriggerItemAction(uint16_t itemIdx);
 
+    uint32_t GetItemValuesState() const;
+
     bool isFuncButtonDown_ = false;
+
+    // the state when CheckForDamage() was called the last time
+    int16_t  lastSelectedItemIdx_ = -1;
+    bool     lastIsEditing_       = false;
+    uint32_t lastItemValuesState_ = 0;
 };
 
 
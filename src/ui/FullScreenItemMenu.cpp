@@ -15,6 +15,14 @@ void FullScreenItemMenu::SetOneBitGraphicsDisplayToDrawTo(uint16_t canvasId)
     canvasIdToDrawTo_ = canvasId;
 }
 
+void FullScreenItemMenu::CheckForDamage()
+{
+    AbstractMenu::CheckForDamage();
+    if((selectedItemIdx_ >= 0) && (selectedItemIdx_ < numItems_)
+       && (items_[selectedItemIdx_].type == ItemType::customItem))
+        Invalidate();
+}
+
 void FullScreenItemMenu::Draw(const UiCanvasDescriptor& canvas)
 {
     // no items or out of bounds??!
@@ -56,6 +56,15 @@ class FullScreenItemMenu : public AbstractMenu
     // inherited from UiPage
     void Draw(const UiCanvasDescriptor& canvas) override;
 
+    // inherited from UiPage, the menu is only redrawn when it changed
+    bool TracksDamage() const override { return true; }
+
+    /** Invalidates the menu when it changed, see AbstractMenu. A selected
+     *  custom item is redrawn with every update, as it may show data that
+     *  changes without the menu knowing about it.
+     */
+    void CheckForDamage() override;
+
   private:
     uint16_t canvasIdToDrawTo_ = UI::invalidCanvasId;
 
@@ -9,6 +9,18 @@ void UiPage::Close()
         parent_->ClosePage(*this);
 }
 
+void UiPage::Invalidate()
+{
+    if(parent_ != nullptr)
+        parent_->Invalidate();
+}
+
+void UiPage::Invalidate(uint16_t canvasId, const Rectangle& area)
+{
+    if(parent_ != nullptr)
+        parent_->Invalidate(canvasId, area);
+}
+
 // =========================================================================
 
 // =========================================================================
@@ -26,9 +38,14 @@ void UI::Init(UiEventQueue&                             inputQueue,
     specialControlIds_              = specialControlIds;
     canvases_                       = decltype(canvases_)(canvases);
     primaryOneBitGraphicsDisplayId_ = primaryOneBitGraphicsDisplayId;
+    lastEventTime_                  = System::GetNow();
 
     for(int i = 0; i < kMaxNumCanvases; i++)
+    {
         lastUpdateTimes_[i] = 0;
+        needsRedraw_[i]     = true;
+        damagedAreas_[i]    = Rectangle();
+    }
 }
 
 UI::~UI()
@@ -81,15 +98,19 @@ void UI::Process()
            || currentTimeInMs - lastEventTime_
                   < canvases_[i].screenSaverTimeOut)
         {
+            canvases_[i].screenSaverOn = false;
             const uint32_t timeDiff = currentTimeInMs - lastUpdateTimes_[i];
             if(timeDiff > canvases_[i].updateRateMs_)
                 RedrawCanvas(i, currentTimeInMs);
         }
-        else
+        else if(!canvases_[i].screenSaverOn)
         { // turn off oled
+            canvases_[i].damagedArea_ = Rectangle();
             canvases_[i].clearFunction_(canvases_[i]);
             canvases_[i].flushFunction_(canvases_[i]);
             canvases_[i].screenSaverOn = true;
+            // redraw everything when it's turned on again
+            AddDamage(i, Rectangle());
         }
     }
 }
@@ -125,6 +146,8 @@ void UI::OpenPage(UiPage& page)
         // Remove focus
         pages_[pages_.GetNumElements() - 2]->OnFocusLost();
     page.OnFocusGained();
+
+    Invalidate();
 }
 
 /** Called to close a page: */
@@ -160,6 +183,23 @@ void UI::ClosePage(UiPage& page)
     // close the page
     page.OnHide();
     page.parent_ = nullptr;
+
+    Invalidate();
+}
+
+void UI::Invalidate()
+{
+    for(uint32_t i = 0; i < canvases_.GetNumElements(); i++)
+        AddDamage(i, Rectangle());
+}
+
+void UI::Invalidate(uint16_t canvasId, const Rectangle& area)
+{
+    for(uint32_t i = 0; i < canvases_.GetNumElements(); i++)
+    {
+        if(canvases_[i].id_ == canvasId)
+            AddDamage(i, area);
+    }
 }
 
 void UI::ProcessEvent(const UiEventQueue::Event& e)
@@ -269,6 +309,24 @@ void UI::RedrawCanvas(uint8_t index, uint32_t currentTimeInSysticks)
     if(firstToDraw < 0)
         firstToDraw = 0;
 
+    // pages that don't track their damage are redrawn entirely
+    for(uint32_t i = firstToDraw; i < pages_.GetNumElements(); i++)
+    {
+        if(pages_[i]->TracksDamage())
+            pages_[i]->CheckForDamage();
+        else
+            AddDamage(index, Rectangle());
+    }
+
+    lastUpdateTimes_[index] = currentTimeInSysticks;
+    if(!needsRedraw_[index])
+        return;
+
+    // damage that's added while drawing is drawn with the next update
+    canvas.damagedArea_  = damagedAreas_[index];
+    needsRedraw_[index]  = false;
+    damagedAreas_[index] = Rectangle();
+
     // clear canvas
     canvas.clearFunction_(canvas);
 
@@ -280,7 +338,18 @@ void UI::RedrawCanvas(uint8_t index, uint32_t currentTimeInSysticks)
 
     // flush canvas to the hardware
     canvas.flushFunction_(canvas);
-    lastUpdateTimes_[index] = currentTimeInSysticks;
+}
+
+void UI::AddDamage(uint8_t index, const Rectangle& area)
+{
+    // an empty area stands for the entire canvas
+    if(area.IsEmpty())
+        damagedAreas_[index] = Rectangle();
+    else if(!needsRedraw_[index])
+        damagedAreas_[index] = area;
+    else if(!damagedAreas_[index].IsEmpty())
+        damagedAreas_[index] = damagedAreas_[index].UnitedWith(area);
+    needsRedraw_[index] = true;
 }
 
 void UI::ForwardToButtonHandler(const uint16_t buttonID,
@@ -2,6 +2,7 @@
 #include <initializer_list>
 #include "UiEventQueue.h"
 #include "../util/Stack.h"
+#include "../hid/disp/graphics_common.h"
 
 namespace daisy
 {
@@ -63,6 +64,17 @@ struct UiCanvasDescriptor
      */
     using FlushFuncPtr = void (*)(const UiCanvasDescriptor& canvasToFlush);
     FlushFuncPtr flushFunction_;
+
+    /** The area that is redrawn, set by the UI before it calls the clear
+     *  function, the Draw() functions of the UiPages and the flush function.
+     *  They can limit themselves to this area, e.g. clear only this part of
+     *  the display or send only this part of the display buffer to the
+     *  hardware. An empty rectangle means that the entire canvas is redrawn.
+     */
+    Rectangle damagedArea_;
+
+    /** Returns true if the entire canvas is redrawn. */
+    bool IsFullRedraw() const { return damagedArea_.IsEmpty(); }
 };
 
 class OneBitGraphicsLookAndFeel;
@@ -329,6 +341,28 @@ class UiPage
      */
     virtual void Draw(const UiCanvasDescriptor& canvas) = 0;
 
+    /** Returns true if the page calls Invalidate() whenever its appearance
+     *  changes. As long as all visible pages on a canvas do that, the UI only
+     *  redraws the canvas when something was invalidated. Pages that return
+     *  false (the default) are redrawn with the update rate of the canvas.
+     */
+    virtual bool TracksDamage() const { return false; }
+
+    /** Called by the UI before it redraws a canvas that this page is visible
+     *  on. Override this to look for changes that didn't happen through the
+     *  page itself, e.g. values that were modified by the application, and
+     *  call Invalidate() if the page must be redrawn.
+     */
+    virtual void CheckForDamage(){};
+
+    /** Marks all canvases to be redrawn entirely. */
+    void Invalidate();
+
+    /** Marks an area of a canvas to be redrawn. An empty area marks the
+     *  entire canvas.
+     */
+    void Invalidate(uint16_t canvasId, const Rectangle& area);
+
     /** Returns a reference to the parent UI object, or nullptr if not added to any UI at the moment. */
     UI* GetParentUI() { return parent_; }
     /** Returns a reference to the parent UI object, or nullptr if not added to any UI at the moment. */
@@ -357,6 +391,13 @@ class UiPage
  *  LEDs, alphanumeric displays, etc. The UI system makes sure that drawing 
  *  is executed with a constant refresh rate that can be individually 
  *  specified for each canvas.
+ * 
+ *  Pages that track their damage (see UiPage::TracksDamage()) mark the
+ *  areas that changed with UiPage::Invalidate(). A canvas that only shows
+ *  such pages is only redrawn when an area of it was invalidated, and
+ *  UiCanvasDescriptor::damagedArea_ tells the clear function, the pages
+ *  and the flush function which area that is. Opening or closing a page
+ *  invalidates all canvases.
  */
 class UI
 {
@@ -430,6 +471,14 @@ class UI
     /** Called to close a page. */
     void ClosePage(UiPage& page);
 
+    /** Marks all canvases to be redrawn entirely. */
+    void Invalidate();
+
+    /** Marks an area of a canvas to be redrawn with the next update of the
+     *  canvas. An empty area marks the entire canvas.
+     */
+    void Invalidate(uint16_t canvasId, const Rectangle& area);
+
     /** If this UI has a canvas that uses a OneBitGraphicsDisplay AND this canvas should be used 
      *  as the main display for menus, etc. then this function returns the canvas ID of this display.
      *  If no such canvas exists, this function returns UI::invalidCanvasId.
@@ -453,6 +502,8 @@ class UI
     Stack<UiPage*, kMaxNumPages>               pages_;
     Stack<UiCanvasDescriptor, kMaxNumCanvases> canvases_;
     uint32_t          lastUpdateTimes_[kMaxNumCanvases];
+    bool              needsRedraw_[kMaxNumCanvases];
+    Rectangle         damagedAreas_[kMaxNumCanvases];
     uint32_t          lastEventTime_;
     UiEventQueue*     eventQueue_;
     SpecialControlIds specialControlIds_;
@@ -463,6 +514,7 @@ class UI
     void AddPage(UiPage* p);
     void ProcessEvent(const UiEventQueue::Event& m);
     void RedrawCanvas(uint8_t index, uint32_t currentTimeInMs);
+    void AddDamage(uint8_t index, const Rectangle& area);
     void ForwardToButtonHandler(uint16_t buttonID,
                                 uint8_t  numberOfPresses,
                                 bool     isRetriggering);
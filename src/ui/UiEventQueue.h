@@ -1,7 +1,6 @@
 #pragma once
 #include <stdint.h>
-#include "../util/FIFO.h"
-#include "../util/scopedirqblocker.h"
+#include "../util/SpscQueue.h"
 
 namespace daisy
 {
@@ -11,8 +10,10 @@ namespace daisy
  * 
  * A queue that holds user interface events such as button presses or encoder turns.
  * The queue can be filled from hardware drivers and read from a UI object.
- * Access to the queue is protected by a ScopedIrqBlocker - that means it's safe to add
- * events from interrupt handlers.
+ * The queue is lock-free and never disables interrupts. Events must be added from a
+ * single context (e.g. the main loop or one interrupt handler) and read from a single
+ * other or the same context. If an interrupt handler adds events, all other events
+ * must be added from that interrupt handler as well.
  */
 class UiEventQueue
 {
@@ -123,7 +124,6 @@ class UiEventQueue
         e.asButtonPressed.id = buttonID;
         e.asButtonPressed.numSuccessivePresses = numSuccessivePresses;
         e.asButtonPressed.isRetriggering       = isRetriggering;
-        ScopedIrqBlocker sIrqBl;
         events_.PushBack(e);
     }
 
@@ -133,7 +133,6 @@ class UiEventQueue
         Event m;
         m.type                = Event::EventType::buttonReleased;
         m.asButtonReleased.id = buttonID;
-        ScopedIrqBlocker sIrqBl;
         events_.PushBack(m);
     }
 
@@ -147,7 +146,6 @@ class UiEventQueue
         e.asEncoderTurned.id          = encoderID;
         e.asEncoderTurned.increments  = increments;
         e.asEncoderTurned.stepsPerRev = stepsPerRev;
-        ScopedIrqBlocker sIrqBl;
         events_.PushBack(e);
     }
 
@@ -160,7 +158,6 @@ class UiEventQueue
         e.asEncoderActivityChanged.newActivityType
             = isActive ? Event::ActivityType::active
                        : Event::ActivityType::inactive;
-        ScopedIrqBlocker sIrqBl;
         events_.PushBack(e);
     }
 
@@ -171,7 +168,6 @@ class UiEventQueue
         e.type                   = Event::EventType::potMoved;
         e.asPotMoved.id          = potId;
         e.asPotMoved.newPosition = newPosition;
-        ScopedIrqBlocker sIrqBl;
         events_.PushBack(e);
     }
 
@@ -184,35 +180,26 @@ class UiEventQueue
         e.asPotActivityChanged.newActivityType
             = isActive ? Event::ActivityType::active
                        : Event::ActivityType::inactive;
-        ScopedIrqBlocker sIrqBl;
         events_.PushBack(e);
     }
 
     /** Removes and returns an event from the queue. */
     Event GetAndRemoveNextEvent()
     {
-        ScopedIrqBlocker sIrqBl;
-        if(events_.IsEmpty())
-        {
-            Event m;
-            m.type = Event::EventType::invalid;
-            return m;
-        }
-        else
-        {
-            return events_.PopFront();
-        }
+        Event e;
+        if(!events_.PopFront(e))
+            e.type = Event::EventType::invalid;
+        return e;
     }
 
     /** Returns true, if the queue is empty. */
     bool IsQueueEmpty()
     {
-        ScopedIrqBlocker sIrqBl;
         return events_.IsEmpty();
     }
 
   private:
-    FIFO<Event, 256> events_;
+    SpscQueue<Event, 256> events_;
 };
 
 } // namespace daisy
\ No newline at end of file
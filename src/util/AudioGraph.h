@@ -0,0 +1,401 @@
+#pragma once
+
+#include "hid/audio.h"
+#include "util/CpuLoadMeter.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <initializer_list>
+
+namespace daisy
+{
+/** @brief A processing stage of an AudioGraph
+ *  @addtogroup audio
+ *
+ *  Derive from this and implement Process(). The node gets one buffer
+ *  pointer per port it was registered with. When an input and an output
+ *  port were registered with the same buffer, the pointers are identical
+ *  and the node has to process in place.
+ */
+class AudioGraphNode
+{
+  public:
+    virtual ~AudioGraphNode() {}
+
+    /** Processes one block.
+     *  @param in   one buffer per input port, size samples each
+     *  @param out  one buffer per output port, size samples each
+     *  @param size number of samples in each buffer
+     */
+    virtual void
+    Process(const float* const* in, float* const* out, size_t size) = 0;
+};
+
+/** @brief Memory for the internal buffers of an AudioGraph
+ *  @addtogroup audio
+ *
+ *  Place it in the memory the graph should run from, e.g.:
+ *      static AudioGraphArena<8, 48> DTCM_MEM_SECTION arena;
+ *  or
+ *      static AudioGraphArena<64, 256> DSY_SDRAM_BSS arena;
+ */
+template <size_t kNumBuffers, size_t kMaxBlockSize>
+struct AudioGraphArena
+{
+    static constexpr size_t kNumBuffersMax = kNumBuffers;
+    static constexpr size_t kBlockSizeMax  = kMaxBlockSize;
+
+    float data[kNumBuffers * kMaxBlockSize];
+};
+
+/** @brief Static audio processing graph
+ *  @addtogroup audio
+ *
+ *  Composes AudioGraphNodes into one audio callback, without any
+ *  allocation or copying at runtime:
+ *  - the engine's input and output channels are buffers of the graph,
+ *    so the first and last nodes work directly on the AudioHandle's buffers
+ *  - internal buffers are carved from a user provided AudioGraphArena once,
+ *    when they are added
+ *  - the execution order is sorted once in Finalize(), after that
+ *    Process() only walks the sorted node list
+ *  - each node is timed with its own CpuLoadMeter, so it's easy to see
+ *    which stage eats up the block deadline.
+ *
+ *  A node depends on every node that writes a buffer it reads.
+ *  Nodes that read and write the same buffer (in place) run in the order
+ *  they were added. Outputs that no node writes are cleared every block.
+ *
+ *  Usage:
+ *  @code
+ *  static AudioGraphArena<4, 48> DTCM_MEM_SECTION arena;
+ *  static AudioGraph<8, 16>                      graph;
+ *
+ *  void AudioCallback(AudioHandle::InputBuffer  in,
+ *                     AudioHandle::OutputBuffer out,
+ *                     size_t                    size)
+ *  {
+ *      graph.Process(in, out, size);
+ *  }
+ *
+ *  graph.Init(arena, 2, 2);
+ *  const int bus = graph.AddBuffer();
+ *  graph.AddNode(filter, {graph.Input(0)}, {bus});
+ *  graph.AddNode(drive, {bus}, {bus}); // in place
+ *  graph.AddNode(reverb, {bus}, {graph.Output(0), graph.Output(1)});
+ *  graph.Finalize(hw.AudioSampleRate(), hw.AudioBlockSize());
+ *  hw.StartAudio(AudioCallback);
+ *  @endcode
+ *
+ *  @tparam kMaxNodes   maximum number of nodes
+ *  @tparam kMaxBuffers maximum number of buffers, including the engine's
+ *                      input and output channels
+ *  @tparam kMaxPorts   maximum number of inputs or outputs of a node
+ */
+template <size_t kMaxNodes, size_t kMaxBuffers, size_t kMaxPorts = 4>
+class AudioGraph
+{
+  public:
+    enum class Result
+    {
+        OK,
+        ERR,
+    };
+
+    AudioGraph() : ready_(false), num_nodes_(0), num_buffers_(0) {}
+
+    /** Initializes the graph and removes all nodes and buffers.
+     *  @param arena       memory to allocate the internal buffers from
+     *  @param num_inputs  number of input channels of the audio engine
+     *  @param num_outputs number of output channels of the audio engine
+     */
+    template <size_t kNumBuffers, size_t kMaxBlockSize>
+    Result Init(AudioGraphArena<kNumBuffers, kMaxBlockSize>& arena,
+                size_t                                      num_inputs,
+                size_t                                      num_outputs)
+    {
+        return Init(arena.data,
+                    kNumBuffers * kMaxBlockSize,
+                    kMaxBlockSize,
+                    num_inputs,
+                    num_outputs);
+    }
+
+    /** Initializes the graph with a plain float array as arena.
+     *  Prefer the AudioGraphArena overload.
+     *  @param arena         memory to allocate the internal buffers from
+     *  @param arena_size    size of the arena in floats
+     *  @param max_blocksize largest blocksize Process() will be called with
+     *  @param num_inputs    number of input channels of the audio engine
+     *  @param num_outputs   number of output channels of the audio engine
+     */
+    Result Init(float* arena,
+                size_t arena_size,
+                size_t max_blocksize,
+                size_t num_inputs,
+                size_t num_outputs)
+    {
+        ready_         = false;
+        num_nodes_     = 0;
+        num_buffers_   = 0;
+        arena_         = arena;
+        arena_size_    = arena_size;
+        arena_used_    = 0;
+        max_blocksize_ = max_blocksize;
+        num_inputs_    = num_inputs;
+        num_outputs_   = num_outputs;
+        if(num_inputs + num_outputs > kMaxBuffers)
+            return Result::ERR;
+        // the engine's channels are resolved in every Process() call
+        for(size_t i = 0; i < num_inputs + num_outputs; i++)
+            buffers_[num_buffers_++] = nullptr;
+        return Result::OK;
+    }
+
+    /** Returns the buffer id of an input channel of the audio engine.
+     *  These buffers are read-only.
+     */
+    int Input(size_t channel) const
+    {
+        return channel < num_inputs_ ? int(channel) : -1;
+    }
+
+    /** Returns the buffer id of an output channel of the audio engine */
+    int Output(size_t channel) const
+    {
+        return channel < num_outputs_ ? int(num_inputs_ + channel) : -1;
+    }
+
+    /** Allocates an internal buffer from the arena.
+     *  @return the buffer id, or -1 if there is no more memory or
+     *          the graph was already finalized
+     */
+    int AddBuffer()
+    {
+        if(ready_ || num_buffers_ >= kMaxBuffers
+           || arena_used_ + max_blocksize_ > arena_size_)
+            return -1;
+        float* buff = arena_ + arena_used_;
+        for(size_t i = 0; i < max_blocksize_; i++)
+            buff[i] = 0.0f;
+        arena_used_ += max_blocksize_;
+        buffers_[num_buffers_] = buff;
+        return int(num_buffers_++);
+    }
+
+    /** Adds a node to the graph.
+     *  The node has to stay alive as long as the graph is used.
+     *  @param node    the node
+     *  @param inputs  buffer ids for the input ports of the node
+     *  @param outputs buffer ids for the output ports of the node.
+     *                 Reusing one of the input buffers processes in place.
+     *  @return the node index, used for GetNodeLoadMeter(), or -1 on
+     *          invalid buffers, too many nodes or ports, or if the graph
+     *          was already finalized
+     */
+    int AddNode(AudioGraphNode&            node,
+                std::initializer_list<int> inputs,
+                std::initializer_list<int> outputs)
+    {
+        if(ready_ || num_nodes_ >= kMaxNodes || inputs.size() > kMaxPorts
+           || outputs.size() > kMaxPorts)
+            return -1;
+        NodeEntry& entry = nodes_[num_nodes_];
+        entry.node       = &node;
+        entry.num_in     = 0;
+        entry.num_out    = 0;
+        for(int id : inputs)
+        {
+            if(id < 0 || size_t(id) >= num_buffers_)
+                return -1;
+            entry.in[entry.num_in++] = uint8_t(id);
+        }
+        for(int id : outputs)
+        {
+            // engine inputs are read-only
+            if(id < int(num_inputs_) || size_t(id) >= num_buffers_)
+                return -1;
+            entry.out[entry.num_out++] = uint8_t(id);
+        }
+        return int(num_nodes_++);
+    }
+
+    /** Sorts the nodes into their execution order and prepares the
+     *  load meters. Call this once, after all nodes were added.
+     *  @return ERR if the graph contains a cycle
+     */
+    Result Finalize(float samplerate, size_t blocksize)
+    {
+        ready_ = false;
+        if(blocksize > max_blocksize_)
+            return Result::ERR;
+
+        // Kahn's algorithm, picking the lowest index among the ready nodes
+        // so that nodes without dependencies keep their order.
+        size_t num_deps[kMaxNodes];
+        bool   done[kMaxNodes];
+        for(size_t j = 0; j < num_nodes_; j++)
+        {
+            num_deps[j] = 0;
+            done[j]     = false;
+            for(size_t i = 0; i < num_nodes_; i++)
+                if(DependsOn(j, i))
+                    num_deps[j]++;
+        }
+        for(size_t n = 0; n < num_nodes_; n++)
+        {
+            size_t next = num_nodes_;
+            for(size_t j = 0; j < num_nodes_ && next == num_nodes_; j++)
+                if(!done[j] && num_deps[j] == 0)
+                    next = j;
+            if(next == num_nodes_)
+                return Result::ERR;
+            done[next] = true;
+            order_[n]  = uint8_t(next);
+            for(size_t j = 0; j < num_nodes_; j++)
+                if(!done[j] && DependsOn(j, next))
+                    num_deps[j]--;
+        }
+
+        // outputs nobody writes to have to be cleared
+        for(size_t o = 0; o < num_outputs_; o++)
+        {
+            unwritten_[o] = true;
+            for(size_t n = 0; n < num_nodes_; n++)
+                if(Writes(n, num_inputs_ + o))
+                    unwritten_[o] = false;
+        }
+
+        for(size_t n = 0; n < num_nodes_; n++)
+            meters_[n].Init(samplerate, blocksize);
+        graph_meter_.Init(samplerate, blocksize);
+        ready_ = true;
+        return Result::OK;
+    }
+
+    /** Runs all nodes. Call this from the AudioHandle::AudioCallback.
+     *  Does nothing but clear the outputs if the graph wasn't finalized or
+     *  size is larger than the arena's blocksize.
+     */
+    void Process(AudioHandle::InputBuffer  in,
+                 AudioHandle::OutputBuffer out,
+                 size_t                    size)
+    {
+        if(!ready_ || size > max_blocksize_)
+        {
+            for(size_t o = 0; o < num_outputs_; o++)
+                for(size_t i = 0; i < size; i++)
+                    out[o][i] = 0.0f;
+            return;
+        }
+
+        graph_meter_.OnBlockStart();
+        // the engine's buffers are only written through out, the cast
+        // just lets them share the table with the internal buffers
+        for(size_t i = 0; i < num_inputs_; i++)
+            buffers_[i] = const_cast<float*>(in[i]);
+        for(size_t o = 0; o < num_outputs_; o++)
+        {
+            buffers_[num_inputs_ + o] = out[o];
+            if(unwritten_[o])
+                for(size_t i = 0; i < size; i++)
+                    out[o][i] = 0.0f;
+        }
+
+        const float* node_in[kMaxPorts];
+        float*       node_out[kMaxPorts];
+        for(size_t n = 0; n < num_nodes_; n++)
+        {
+            const size_t     idx   = order_[n];
+            const NodeEntry& entry = nodes_[idx];
+            for(size_t p = 0; p < entry.num_in; p++)
+                node_in[p] = buffers_[entry.in[p]];
+            for(size_t p = 0; p < entry.num_out; p++)
+                node_out[p] = buffers_[entry.out[p]];
+
+            meters_[idx].OnBlockStart();
+            entry.node->Process(node_in, node_out, size);
+            meters_[idx].OnBlockEnd();
+        }
+        graph_meter_.OnBlockEnd();
+    }
+
+    /** Returns the load meter of a node, by the index returned from AddNode() */
+    CpuLoadMeter& GetNodeLoadMeter(size_t node) { return meters_[node]; }
+
+    /** Returns the load meter of the whole graph */
+    CpuLoadMeter& GetLoadMeter() { return graph_meter_; }
+
+    /** Returns the node index at the given position in the execution order */
+    size_t GetExecutionOrder(size_t position) const { return order_[position]; }
+
+    size_t GetNumNodes() const { return num_nodes_; }
+    bool   IsFinalized() const { return ready_; }
+
+  private:
+    struct NodeEntry
+    {
+        AudioGraphNode* node;
+        uint8_t         num_in;
+        uint8_t         num_out;
+        uint8_t         in[kMaxPorts];
+        uint8_t         out[kMaxPorts];
+    };
+
+    static_assert(kMaxBuffers <= 256, "buffer ids are stored as uint8_t");
+    static_assert(kMaxNodes <= 256, "node indices are stored as uint8_t");
+
+    bool Reads(size_t node, size_t buffer) const
+    {
+        for(size_t p = 0; p < nodes_[node].num_in; p++)
+            if(nodes_[node].in[p] == buffer)
+                return true;
+        return false;
+    }
+
+    bool Writes(size_t node, size_t buffer) const
+    {
+        for(size_t p = 0; p < nodes_[node].num_out; p++)
+            if(nodes_[node].out[p] == buffer)
+                return true;
+        return false;
+    }
+
+    /** true if node a has to run after node b */
+    bool DependsOn(size_t a, size_t b) const
+    {
+        if(a == b)
+            return false;
+        for(size_t p = 0; p < nodes_[b].num_out; p++)
+        {
+            const size_t buff = nodes_[b].out[p];
+            if(!Reads(a, buff))
+                continue;
+            // in place on both sides, the order they were added decides
+            if(Writes(a, buff) && Reads(b, buff) && a < b)
+                continue;
+            return true;
+        }
+        return false;
+    }
+
+    bool         ready_;
+    size_t       num_nodes_;
+    size_t       num_buffers_;
+    size_t       num_inputs_;
+    size_t       num_outputs_;
+    float*       arena_;
+    size_t       arena_size_;
+    size_t       arena_used_;
+    size_t       max_blocksize_;
+    NodeEntry    nodes_[kMaxNodes];
+    uint8_t      order_[kMaxNodes];
+    float*       buffers_[kMaxBuffers];
+    bool         unwritten_[kMaxBuffers];
+    CpuLoadMeter meters_[kMaxNodes];
+    CpuLoadMeter graph_meter_;
+
+    AudioGraph(const AudioGraph&) = delete;
+    AudioGraph& operator=(const AudioGraph&) = delete;
+};
+
+} // namespace daisy
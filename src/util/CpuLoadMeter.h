@@ -55,6 +55,7 @@ class CpuLoadMeter
         const auto ticksPassed = end - currentBlockStartTicks_;
         const auto currentBlockLoad
             = float(ticksPassed) * ticksPerBlockInv_; // usPassed / usPerBlock
+        last_ = currentBlockLoad;
 
         if(firstCycle_)
         {
@@ -79,14 +80,19 @@ class CpuLoadMeter
     float GetMinCpuLoad() const { return min_; }
     /** Returns the maximum CPU load observed since the last call to Reset(). */
     float GetMaxCpuLoad() const { return max_; }
+    /** Returns the CPU load of the most recent block. */
+    float GetLastCpuLoad() const { return last_; }
 
     /** Resets the minimun, maximum and average load readings. */
     void Reset()
     {
         firstCycle_ = true;
-        avg_ = max_ = min_ = NAN;
+        avg_ = max_ = min_ = last_ = NAN;
     }
 
+    /** Returns the tick at which the current (or most recent) block started */
+    uint32_t GetBlockStartTicks() const { return currentBlockStartTicks_; }
+
   private:
     bool     firstCycle_;
     float    ticksPerBlockInv_;
@@ -94,6 +100,7 @@ class CpuLoadMeter
     float    min_;
     float    max_;
     float    avg_;
+    float    last_;
     float    smoothingConstant_;
 
     CpuLoadMeter(const CpuLoadMeter&) = delete;
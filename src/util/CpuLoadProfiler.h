@@ -0,0 +1,239 @@
+#pragma once
+
+#include "util/CpuLoadMeter.h"
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+
+namespace daisy
+{
+/** @brief CPU load metering with a load histogram and overrun tracking
+ *  @addtogroup utility
+ *
+ *  Adds to the readings of a CpuLoadMeter what's needed to judge a
+ *  firmware in the field, where the worst case ever seen isn't enough:
+ *  - a histogram of the block load, with logarithmic buckets
+ *  - a counter of blocks that came close to the deadline
+ *  - a counter of overruns (load > 1.0), and the ticks at which the last
+ *    kNumOverrunTimestamps of them started
+ *
+ *  OnBlockStart() and OnBlockEnd() are used exactly like with the
+ *  CpuLoadMeter, from within the audio callback. The meter is a member,
+ *  not a base class, so that the profiler can't be passed as a
+ *  CpuLoadMeter& whose OnBlockEnd() skips the counters. GetSnapshot() copies
+ *  all readings consistently and can be called from the main loop while
+ *  the audio interrupt keeps writing, without disabling interrupts.
+ *
+ *  The histogram has kBucketsPerOctave buckets per octave of load, from
+ *  2^-(kNumOctaves - 1) up to 2.0. Everything below goes to the first
+ *  bucket, everything above to the last one.
+ *
+ *  @tparam kNumOverrunTimestamps number of overruns to keep the ticks for
+ */
+template <size_t kNumOverrunTimestamps = 8>
+class CpuLoadProfiler
+{
+  public:
+    static constexpr size_t kNumOctaves       = 8;
+    static constexpr size_t kSubBucketBits    = 2;
+    static constexpr size_t kBucketsPerOctave = 1u << kSubBucketBits;
+    static constexpr size_t kNumBuckets = kNumOctaves * kBucketsPerOctave;
+
+    /** A consistent copy of all readings, see GetSnapshot() */
+    struct Snapshot
+    {
+        /** Number of blocks measured since the last Reset() */
+        uint32_t num_blocks;
+        /** Number of blocks with a load > 1.0 */
+        uint32_t num_overruns;
+        /** Number of blocks with a load between the near deadline
+         *  threshold and 1.0, overruns excluded
+         */
+        uint32_t num_near_deadline;
+        /** Block counts per bucket, see GetBucketLowerBound() */
+        uint32_t histogram[kNumBuckets];
+        /** GetTick() at the start of the most recent overruns, oldest first */
+        uint32_t overrun_ticks[kNumOverrunTimestamps];
+        /** Number of valid entries in overrun_ticks */
+        size_t num_overrun_ticks;
+        float  min;
+        float  max;
+        float  avg;
+        float  last;
+    };
+
+    CpuLoadProfiler() {}
+
+    /** Initializes the meter for a particular sample rate and block size.
+     *  @param sampleRateInHz           The sample rate in Hz
+     *  @param blockSizeInSamples       The block size in samples
+     *  @param nearDeadlineThreshold    Blocks with a load of at least this
+     *                                  count as close to the deadline
+     *  @param smoothingFilterCutoffHz  The cutoff frequency of the smoothing
+     *                                  filter for the average CPU load.
+     */
+    void Init(float sampleRateInHz,
+              int   blockSizeInSamples,
+              float nearDeadlineThreshold   = 0.95f,
+              float smoothingFilterCutoffHz = 1.0f)
+    {
+        nearDeadline_ = nearDeadlineThreshold;
+        meter_.Init(
+            sampleRateInHz, blockSizeInSamples, smoothingFilterCutoffHz);
+        Reset();
+    }
+
+    /** Call this at the beginning of your audio callback */
+    void OnBlockStart() { meter_.OnBlockStart(); }
+
+    /** Call this at the end of your audio callback */
+    void OnBlockEnd()
+    {
+        BeginWrite();
+        meter_.OnBlockEnd();
+        const float load = meter_.GetLastCpuLoad();
+        numBlocks_++;
+        histogram_[GetBucket(load)]++;
+        if(load > 1.0f)
+        {
+            numOverruns_++;
+            overrunTicks_[overrunHead_] = meter_.GetBlockStartTicks();
+            overrunHead_ = (overrunHead_ + 1) % kNumOverrunTimestamps;
+        }
+        else if(load >= nearDeadline_)
+        {
+            numNearDeadline_++;
+        }
+        EndWrite();
+    }
+
+    /** Resets all readings.
+     *  Not safe against a concurrent OnBlockEnd(), so call it from the
+     *  audio callback, or while the audio isn't running.
+     */
+    void Reset()
+    {
+        BeginWrite();
+        meter_.Reset();
+        numBlocks_       = 0;
+        numOverruns_     = 0;
+        numNearDeadline_ = 0;
+        overrunHead_     = 0;
+        memset(histogram_, 0, sizeof(histogram_));
+        memset(overrunTicks_, 0, sizeof(overrunTicks_));
+        EndWrite();
+    }
+
+    /** Copies all readings into snapshot.
+     *  Safe to call from a context that can be interrupted by the one
+     *  calling OnBlockEnd(), e.g. the main loop. If the copy gets
+     *  interrupted by a new measurement, it's simply taken again.
+     */
+    void GetSnapshot(Snapshot& snapshot) const
+    {
+        uint32_t seq;
+        do
+        {
+            seq = seq_;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            snapshot.num_blocks        = numBlocks_;
+            snapshot.num_overruns      = numOverruns_;
+            snapshot.num_near_deadline = numNearDeadline_;
+            memcpy(snapshot.histogram, histogram_, sizeof(histogram_));
+            snapshot.min  = meter_.GetMinCpuLoad();
+            snapshot.max  = meter_.GetMaxCpuLoad();
+            snapshot.avg  = meter_.GetAvgCpuLoad();
+            snapshot.last = meter_.GetLastCpuLoad();
+
+            // unroll the ring buffer, oldest first
+            const size_t num = numOverruns_ < kNumOverrunTimestamps
+                                   ? numOverruns_
+                                   : kNumOverrunTimestamps;
+            const size_t first
+                = (overrunHead_ + kNumOverrunTimestamps - num)
+                  % kNumOverrunTimestamps;
+            for(size_t i = 0; i < num; i++)
+                snapshot.overrun_ticks[i]
+                    = overrunTicks_[(first + i) % kNumOverrunTimestamps];
+            snapshot.num_overrun_ticks = num;
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+        } while((seq & 1u) != 0 || seq != seq_);
+    }
+
+    /** Returns the number of overruns since the last Reset() */
+    uint32_t GetNumOverruns() const { return numOverruns_; }
+
+    /** Returns the smoothed average CPU load, see CpuLoadMeter */
+    float GetAvgCpuLoad() const { return meter_.GetAvgCpuLoad(); }
+    /** Returns the minimum CPU load since the last Reset() */
+    float GetMinCpuLoad() const { return meter_.GetMinCpuLoad(); }
+    /** Returns the maximum CPU load since the last Reset() */
+    float GetMaxCpuLoad() const { return meter_.GetMaxCpuLoad(); }
+    /** Returns the CPU load of the last block */
+    float GetLastCpuLoad() const { return meter_.GetLastCpuLoad(); }
+
+    /** Returns the histogram bucket a load value is counted in */
+    static size_t GetBucket(float load)
+    {
+        // exponent and the top mantissa bits of the float make up a
+        // logarithmic bucket index without any math library call
+        uint32_t bits;
+        memcpy(&bits, &load, sizeof(bits));
+        if(bits & 0x80000000u)
+            return 0;
+        const int exponent = int((bits >> 23) & 0xff) - 127;
+        const int sub
+            = int((bits >> (23 - kSubBucketBits)) & (kBucketsPerOctave - 1));
+        const int idx
+            = (exponent + int(kNumOctaves) - 1) * int(kBucketsPerOctave) + sub;
+        if(idx < 0)
+            return 0;
+        if(idx >= int(kNumBuckets))
+            return kNumBuckets - 1;
+        return size_t(idx);
+    }
+
+    /** Returns the smallest load counted in a bucket.
+     *  The bucket spans up to the lower bound of the next one.
+     */
+    static float GetBucketLowerBound(size_t bucket)
+    {
+        if(bucket == 0)
+            return 0.0f;
+        const int octave
+            = int(bucket / kBucketsPerOctave) - int(kNumOctaves) + 1;
+        const float mantissa
+            = 1.0f + float(bucket % kBucketsPerOctave) / kBucketsPerOctave;
+        return octave >= 0 ? mantissa * float(1u << octave)
+                           : mantissa / float(1u << -octave);
+    }
+
+  private:
+    static_assert(kNumOverrunTimestamps > 0, "need room for one timestamp");
+
+    /** The sequence counter is odd while the readings are being updated */
+    void BeginWrite()
+    {
+        seq_ = seq_ + 1;
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+    void EndWrite()
+    {
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        seq_ = seq_ + 1;
+    }
+
+    CpuLoadMeter      meter_;
+    volatile uint32_t seq_ = 0;
+    float             nearDeadline_;
+    uint32_t          numBlocks_;
+    uint32_t          numOverruns_;
+    uint32_t          numNearDeadline_;
+    size_t            overrunHead_;
+    uint32_t          histogram_[kNumBuckets];
+    uint32_t          overrunTicks_[kNumOverrunTimestamps];
+
+    CpuLoadProfiler(const CpuLoadProfiler&) = delete;
+    CpuLoadProfiler& operator=(const CpuLoadProfiler&) = delete;
+};
+} // namespace daisy
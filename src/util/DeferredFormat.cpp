@@ -0,0 +1,362 @@
+#include <stdio.h>
+#include <string.h>
+#include "util/DeferredFormat.h"
+
+using namespace daisy;
+
+namespace
+{
+/** The type of the argument of a conversion */
+enum class ArgType
+{
+    NONE, // %%
+    INT,
+    LONG,
+    LONG_LONG,
+    INTMAX,
+    SIZE,
+    PTRDIFF,
+    DOUBLE,
+    POINTER,
+    STRING,
+    UNSUPPORTED,
+};
+
+/** A parsed conversion specification */
+struct Spec
+{
+    const char* end;       /**< first character after the specification */
+    int         num_stars; /**< number of int arguments for width/precision */
+    ArgType     type;
+};
+
+bool IsDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+/** Parses the conversion specification at spec, which starts at the '%' */
+Spec ParseSpec(const char* spec)
+{
+    Spec result = {spec + 1, 0, ArgType::UNSUPPORTED};
+    const char*& p = result.end;
+    while(*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+        p++;
+    if(*p == '*')
+    {
+        result.num_stars++;
+        p++;
+    }
+    while(IsDigit(*p))
+        p++;
+    if(*p == '.')
+    {
+        p++;
+        if(*p == '*')
+        {
+            result.num_stars++;
+            p++;
+        }
+        while(IsDigit(*p))
+            p++;
+    }
+
+    ArgType integer = ArgType::INT;
+    switch(*p)
+    {
+        case 'h':
+            // char and short are promoted to int
+            p += p[1] == 'h' ? 2 : 1;
+            break;
+        case 'l':
+            integer = p[1] == 'l' ? ArgType::LONG_LONG : ArgType::LONG;
+            p += p[1] == 'l' ? 2 : 1;
+            break;
+        case 'j':
+            integer = ArgType::INTMAX;
+            p++;
+            break;
+        case 'z':
+            integer = ArgType::SIZE;
+            p++;
+            break;
+        case 't':
+            integer = ArgType::PTRDIFF;
+            p++;
+            break;
+        case 'L': return result;
+        default: break;
+    }
+
+    switch(*p)
+    {
+        case 'd':
+        case 'i':
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X': result.type = integer; break;
+        // wint_t is promoted to int as well
+        case 'c': result.type = ArgType::INT; break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A': result.type = ArgType::DOUBLE; break;
+        case 'p': result.type = ArgType::POINTER; break;
+        case 's':
+            if(integer == ArgType::INT)
+                result.type = ArgType::STRING;
+            break;
+        case '%': result.type = ArgType::NONE; break;
+        default: return result;
+    }
+    p++;
+    return result;
+}
+
+/** Writes packed arguments */
+class Writer
+{
+  public:
+    Writer(uint8_t* out, size_t size) : out_(out), size_(size), used_(0) {}
+
+    template <typename T>
+    bool Put(T value)
+    {
+        if(size_ - used_ < sizeof(value))
+            return false;
+        memcpy(out_ + used_, &value, sizeof(value));
+        used_ += sizeof(value);
+        return true;
+    }
+
+    /** Strings are stored as their length and the characters */
+    bool PutString(const char* str)
+    {
+        if(str == nullptr)
+            str = "(null)";
+        if(size_ - used_ < 1)
+            return false;
+        size_t len = strlen(str);
+        if(len > DeferredFormat::kMaxStringLength)
+            len = DeferredFormat::kMaxStringLength;
+        if(len > size_ - used_ - 1)
+            len = size_ - used_ - 1;
+        out_[used_] = uint8_t(len);
+        memcpy(out_ + used_ + 1, str, len);
+        used_ += 1 + len;
+        return true;
+    }
+
+    size_t GetUsed() const { return used_; }
+
+  private:
+    uint8_t* out_;
+    size_t   size_;
+    size_t   used_;
+};
+
+/** Reads packed arguments */
+class Reader
+{
+  public:
+    Reader(const uint8_t* args, size_t size) : args_(args), size_(size), pos_(0)
+    {
+    }
+
+    template <typename T>
+    bool Get(T& value)
+    {
+        if(size_ - pos_ < sizeof(value))
+            return false;
+        memcpy(&value, args_ + pos_, sizeof(value));
+        pos_ += sizeof(value);
+        return true;
+    }
+
+    /** \param str receives the null terminated string */
+    bool GetString(char* str)
+    {
+        if(size_ - pos_ < 1 || size_ - pos_ - 1 < args_[pos_])
+            return false;
+        const size_t len = args_[pos_];
+        memcpy(str, args_ + pos_ + 1, len);
+        str[len] = '\0';
+        pos_ += 1 + len;
+        return true;
+    }
+
+  private:
+    const uint8_t* args_;
+    size_t         size_;
+    size_t         pos_;
+};
+
+/** Renders a single conversion with its width/precision arguments */
+template <typename T>
+int Print(char*       out,
+          size_t      size,
+          const char* spec,
+          const int*  stars,
+          int         num_stars,
+          T           value)
+{
+    switch(num_stars)
+    {
+        case 0: return snprintf(out, size, spec, value);
+        case 1: return snprintf(out, size, spec, stars[0], value);
+        default: return snprintf(out, size, spec, stars[0], stars[1], value);
+    }
+}
+
+template <typename T>
+int Print(char*       out,
+          size_t      size,
+          const char* spec,
+          const int*  stars,
+          int         num_stars,
+          Reader&     reader)
+{
+    T value;
+    if(!reader.Get(value))
+        return -1;
+    return Print(out, size, spec, stars, num_stars, value);
+}
+
+/** Renders a conversion from the packed arguments
+ *  \return the length of the text, or -1 if the arguments are missing
+ */
+int PrintSpec(char*       out,
+              size_t      size,
+              const char* spec,
+              const Spec& parsed,
+              Reader&     reader)
+{
+    int stars[2];
+    for(int i = 0; i < parsed.num_stars; i++)
+        if(!reader.Get(stars[i]))
+            return -1;
+    const int n = parsed.num_stars;
+    switch(parsed.type)
+    {
+        case ArgType::INT:
+            return Print<int>(out, size, spec, stars, n, reader);
+        case ArgType::LONG:
+            return Print<long>(out, size, spec, stars, n, reader);
+        case ArgType::LONG_LONG:
+            return Print<long long>(out, size, spec, stars, n, reader);
+        case ArgType::INTMAX:
+            return Print<intmax_t>(out, size, spec, stars, n, reader);
+        case ArgType::SIZE:
+            return Print<size_t>(out, size, spec, stars, n, reader);
+        case ArgType::PTRDIFF:
+            return Print<ptrdiff_t>(out, size, spec, stars, n, reader);
+        case ArgType::DOUBLE:
+            return Print<double>(out, size, spec, stars, n, reader);
+        case ArgType::POINTER:
+            return Print<const void*>(out, size, spec, stars, n, reader);
+        case ArgType::STRING:
+        {
+            char str[DeferredFormat::kMaxStringLength + 1];
+            if(!reader.GetString(str))
+                return -1;
+            return Print<const char*>(out, size, spec, stars, n, str);
+        }
+        default: return -1;
+    }
+}
+} // namespace
+
+size_t
+DeferredFormat::Pack(const char* format, va_list va, uint8_t* out, size_t size)
+{
+    Writer writer(out, size);
+    for(const char* p = format; *p != '\0'; p++)
+    {
+        if(*p != '%')
+            continue;
+        const Spec spec = ParseSpec(p);
+        if(spec.type == ArgType::UNSUPPORTED)
+            break;
+        p = spec.end - 1;
+
+        bool ok = true;
+        for(int i = 0; i < spec.num_stars; i++)
+            ok = ok && writer.Put(va_arg(va, int));
+        switch(spec.type)
+        {
+            case ArgType::INT: ok = ok && writer.Put(va_arg(va, int)); break;
+            case ArgType::LONG: ok = ok && writer.Put(va_arg(va, long)); break;
+            case ArgType::LONG_LONG:
+                ok = ok && writer.Put(va_arg(va, long long));
+                break;
+            case ArgType::INTMAX:
+                ok = ok && writer.Put(va_arg(va, intmax_t));
+                break;
+            case ArgType::SIZE:
+                ok = ok && writer.Put(va_arg(va, size_t));
+                break;
+            case ArgType::PTRDIFF:
+                ok = ok && writer.Put(va_arg(va, ptrdiff_t));
+                break;
+            case ArgType::DOUBLE:
+                ok = ok && writer.Put(va_arg(va, double));
+                break;
+            case ArgType::POINTER:
+                ok = ok && writer.Put(va_arg(va, const void*));
+                break;
+            case ArgType::STRING:
+                ok = ok && writer.PutString(va_arg(va, const char*));
+                break;
+            default: break;
+        }
+        if(!ok)
+            break;
+    }
+    return writer.GetUsed();
+}
+
+size_t DeferredFormat::Format(char*          out,
+                              size_t         size,
+                              const char*    format,
+                              const uint8_t* args,
+                              size_t         args_size)
+{
+    Reader reader(args, args_size);
+    size_t len = 0;
+    for(const char* p = format; *p != '\0';)
+    {
+        if(*p != '%' || p[1] == '%')
+        {
+            if(len + 1 < size)
+                out[len] = *p;
+            len++;
+            p += *p == '%' ? 2 : 1;
+            continue;
+        }
+
+        const Spec parsed = ParseSpec(p);
+        char       spec[16];
+        const auto spec_len = size_t(parsed.end - p);
+        if(parsed.type == ArgType::UNSUPPORTED || spec_len >= sizeof(spec))
+            break;
+        memcpy(spec, p, spec_len);
+        spec[spec_len] = '\0';
+
+        // snprintf() only measures once the buffer is full
+        char*     dst = len < size ? out + len : nullptr;
+        const int n
+            = PrintSpec(dst, len < size ? size - len : 0, spec, parsed, reader);
+        if(n < 0)
+            break;
+        len += n;
+        p = parsed.end;
+    }
+    if(size > 0)
+        out[len < size ? len : size - 1] = '\0';
+    return len;
+}
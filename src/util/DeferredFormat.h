@@ -0,0 +1,63 @@
+#pragma once
+#ifndef DSY_DEFERRED_FORMAT_H
+#define DSY_DEFERRED_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+
+namespace daisy
+{
+/** @brief Splits printf-style formatting into a cheap and an expensive part
+ *  @ingroup utility
+ *
+ *  Pack() only copies the arguments that a format string refers to into a
+ *  byte buffer, which takes a fraction of the time of formatting them.
+ *  Later, e.g. in the main loop, Format() renders the text from the format
+ *  string and the packed arguments.
+ *
+ *  The format string itself isn't copied, so it has to stay valid until
+ *  Format() is called, e.g. a string literal. Strings passed for %s are
+ *  copied, up to kMaxStringLength characters.
+ *
+ *  All conversions of printf() are supported, except %n and long double
+ *  arguments (L). Formatting stops at the first one of those.
+ */
+class DeferredFormat
+{
+  public:
+    /** Maximum number of characters that are copied for a %s argument */
+    static constexpr size_t kMaxStringLength = 63;
+
+    /** Copies the arguments of a format string into a buffer
+     *  \param format printf-style format string
+     *  \param va the arguments
+     *  \param out buffer for the packed arguments
+     *  \param size size of the buffer. If not all arguments fit, only the
+     *         ones that do are packed and Format() stops at the first one
+     *         that's missing.
+     *  \return the number of bytes used in the buffer
+     */
+    static size_t
+    Pack(const char* format, va_list va, uint8_t* out, size_t size);
+
+    /** Renders the text of a format string and arguments from Pack()
+     *  \param out buffer for the text, always null terminated
+     *  \param size size of the buffer
+     *  \param format the format string that was passed to Pack()
+     *  \param args the packed arguments
+     *  \param args_size number of bytes returned by Pack()
+     *  \return the length of the text, without the terminator. Like for
+     *          snprintf(), this can be more than size - 1 when the text
+     *          was truncated.
+     */
+    static size_t Format(char*          out,
+                         size_t         size,
+                         const char*    format,
+                         const uint8_t* args,
+                         size_t         args_size);
+};
+
+} // namespace daisy
+
+#endif
@@ -0,0 +1,153 @@
+#pragma once
+
+#include "util/FIFO.h"
+#include <stdint.h>
+#include <stddef.h>
+
+namespace daisy
+{
+/** @brief Schedules the DMA jobs of several peripherals on shared streams
+ *  @ingroup utility
+ *
+ *  Keeps a queue of waiting jobs for each peripheral, and which peripheral
+ *  currently owns each DMA stream. A peripheral uses one stream at a time,
+ *  several peripherals may share a stream. When a stream becomes idle,
+ *  the peripherals waiting for it are served round robin, starting after
+ *  the one that was served last, so that a busy peripheral can't starve
+ *  the others.
+ *
+ *  This only does the bookkeeping, starting and finishing the transfers
+ *  is up to the driver. It isn't thread safe, so the driver has to
+ *  disable interrupts around calls that can race with the completion
+ *  interrupt.
+ *
+ *  @tparam Job             the job description, has to be copy assignable
+ *  @tparam kNumPeripherals number of peripherals
+ *  @tparam kNumStreams     number of DMA streams (or pairs of streams)
+ *  @tparam kQueueLen       number of jobs that can wait per peripheral
+ */
+template <typename Job,
+          size_t kNumPeripherals,
+          size_t kNumStreams,
+          size_t kQueueLen>
+class DmaJobScheduler
+{
+  public:
+    /** What to do with a job passed to Submit() */
+    enum class Submission
+    {
+        /** The stream was claimed for the peripheral, start the job now */
+        START,
+        /** The job waits in the queue of the peripheral */
+        QUEUED,
+        /** The queue of the peripheral is full, the job was dropped */
+        REJECTED,
+    };
+
+    DmaJobScheduler() { Init(); }
+
+    /** Releases all streams and drops all queued jobs */
+    void Init()
+    {
+        for(size_t i = 0; i < kNumStreams; i++)
+        {
+            active_peripheral_[i] = -1;
+            last_peripheral_[i]   = -1;
+        }
+        for(size_t per = 0; per < kNumPeripherals; per++)
+        {
+            stream_of_[per] = 0;
+            queues_[per].Clear();
+        }
+    }
+
+    /** Claims the stream for the peripheral if the stream is idle and
+     *  the peripheral has no jobs waiting, or queues the job otherwise.
+     *  Never waits.
+     *  A queued job may be the next in line for an idle stream, so call
+     *  ClaimNext() if the stream isn't busy afterwards.
+     */
+    Submission Submit(size_t per, size_t stream, const Job& job)
+    {
+        stream_of_[per] = stream;
+        if(IsBusy(stream) || !queues_[per].IsEmpty())
+        {
+            return queues_[per].PushBack(job) ? Submission::QUEUED
+                                              : Submission::REJECTED;
+        }
+        Claim(per, stream);
+        return Submission::START;
+    }
+
+    /** Claims an idle stream for the next peripheral waiting for it.
+     *  @param stream       the stream to claim
+     *  @param per          returns the peripheral that got the stream
+     *  @param job          returns the job to start, removed from the queue
+     *  @return false if the stream is busy or no peripheral is waiting
+     */
+    bool ClaimNext(size_t stream, size_t& per, Job& job)
+    {
+        if(IsBusy(stream))
+            return false;
+        size_t candidate = size_t(last_peripheral_[stream] + 1);
+        for(size_t i = 0; i < kNumPeripherals; i++, candidate++)
+        {
+            candidate %= kNumPeripherals;
+            if(stream_of_[candidate] != stream
+               || queues_[candidate].IsEmpty())
+                continue;
+            Claim(candidate, stream);
+            per = candidate;
+            job = queues_[candidate].PopFront();
+            return true;
+        }
+        return false;
+    }
+
+    /** Marks a stream as idle, after its job finished or failed to start */
+    void Release(size_t stream) { active_peripheral_[stream] = -1; }
+
+    /** Releases the stream and puts a claimed job back at the front of
+     *  the queue of its peripheral, e.g. because the peripheral is busy
+     *  with a transfer outside the scheduler. ClaimNext() claims it again.
+     *  @return false if the queue is full and the job was dropped
+     */
+    bool Requeue(size_t per, size_t stream, const Job& job)
+    {
+        Release(stream);
+        stream_of_[per] = stream;
+        return queues_[per].Insert(0, job);
+    }
+
+    /** @return true if a peripheral owns the stream */
+    bool IsBusy(size_t stream) const
+    {
+        return active_peripheral_[stream] >= 0;
+    }
+
+    /** @return the peripheral that owns the stream, or -1 */
+    int GetActivePeripheral(size_t stream) const
+    {
+        return active_peripheral_[stream];
+    }
+
+    /** @return the number of jobs waiting for the peripheral */
+    size_t GetNumQueued(size_t per) const
+    {
+        return queues_[per].GetNumElements();
+    }
+
+  private:
+    void Claim(size_t per, size_t stream)
+    {
+        active_peripheral_[stream] = int8_t(per);
+        last_peripheral_[stream]   = int8_t(per);
+    }
+
+    volatile int8_t      active_peripheral_[kNumStreams];
+    int8_t               last_peripheral_[kNumStreams];
+    size_t               stream_of_[kNumPeripherals];
+    FIFO<Job, kQueueLen> queues_[kNumPeripherals];
+};
+
+} // namespace daisy
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+namespace daisy
+{
+/** @brief Lock-free single-writer, single-reader value with two buffers
+ *  @ingroup utility
+ *
+ *  Hands the latest value of something from one writer to one reader,
+ *  e.g. the readings a sensor driver decodes in a DMA interrupt to the
+ *  main loop, without ever disabling interrupts.
+ *
+ *  The writer fills the buffer that isn't published, then publishes it
+ *  with a single atomic store. The reader copies the published buffer and
+ *  checks the sequence counter afterwards: only when the writer started
+ *  to overwrite that very buffer in the meantime, i.e. wrote twice while
+ *  the reader was copying, the copy is repeated. Writing never waits.
+ *
+ *  @tparam T value type, has to be trivially copyable
+ */
+template <typename T>
+class DoubleBuffer
+{
+  public:
+    DoubleBuffer() : seq_(0) {}
+
+    /** Publishes a new value. Writer only. */
+    void Write(const T& value)
+    {
+        // an odd sequence marks a write in progress
+        const uint32_t seq = seq_.load(std::memory_order_relaxed);
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        buffers_[((seq >> 1) + 1) & 1] = value;
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    /** Gets the latest value. Reader only.
+     *  @param value receives the value
+     *  @return false if nothing was written yet
+     */
+    bool Read(T& value) const
+    {
+        while(true)
+        {
+            const uint32_t seq = seq_.load(std::memory_order_acquire);
+            if(seq < 2)
+                return false;
+            // the buffer that was published last
+            value = buffers_[(seq >> 1) & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // it's only overwritten by the second write after it
+            if(seq_.load(std::memory_order_relaxed) - (seq & ~1u) < 3)
+                return true;
+        }
+    }
+
+    /** Returns the number of values written so far, e.g. to tell if
+     *  there is a new one
+     */
+    uint32_t GetNumWrites() const
+    {
+        return seq_.load(std::memory_order_acquire) >> 1;
+    }
+
+  private:
+    T                     buffers_[2];
+    std::atomic<uint32_t> seq_;
+};
+
+} // namespace daisy
@@ -0,0 +1,348 @@
+#pragma once
+
+#include "util/FIFO.h"
+#include "util/scopedirqblocker.h"
+#include <stdint.h>
+#include <stddef.h>
+
+namespace daisy
+{
+/** @brief Steps queued erase and program jobs through an interrupt driven
+ *  NOR flash driver
+ *  @ingroup utility
+ *
+ *  Each erase block or page takes a write enable command, polling for the
+ *  write enable latch, the erase command or page program, and polling
+ *  until the flash is ready again. The driver starts each of these
+ *  without waiting and reports back from its interrupt with
+ *  OnCommandDone(), OnTransmitDone(), OnStatusMatch() or OnError().
+ *  Jobs queued while one is running are started after it.
+ *
+ *  Every step has a deadline, as the status polling of the peripheral
+ *  doesn't time out on its own. CheckTimeout() fails the job once it
+ *  passed, the driver calls it whenever it is asked whether it's busy.
+ *
+ *  The Flash type is the driver, it has to provide:
+ *  - `Result` with the enumerators `OK` and `ERR`
+ *  - `kPageSize` and `kStepTimeoutMs`, the deadline of all steps but the
+ *    erase itself
+ *  - `bool IsMemoryMapped()`
+ *  - `bool StartExitContinuousRead()`, which leaves the memory mapped mode
+ *  - `bool StartWriteEnable()`
+ *  - `bool StartWaitWriteEnabled()` and `bool StartWaitReady()`
+ *  - `bool StartErase(uint32_t address, uint32_t end_addr,
+ *    uint32_t& size, uint32_t& timeout_ms)`, which picks the erase block
+ *    at address and its deadline
+ *  - `bool StartProgram(uint32_t address, uint32_t size, uint8_t* data)`
+ *  - `bool EnterMemoryMappedMode()`
+ *  - `bool Abort()`, which returns to memory mapped mode after a failed
+ *    step, and returns false if the peripheral has to be reinitialized
+ *  - `bool Reinit()`, which blocks
+ *  - `uint32_t GetNowMs()`
+ *
+ *  The Start functions return false if the step couldn't be started.
+ *
+ *  @tparam Flash     the driver
+ *  @tparam kQueueLen number of jobs that can wait behind the running one
+ */
+template <typename Flash, size_t kQueueLen>
+class FlashJobQueue
+{
+  public:
+    using Result         = typename Flash::Result;
+    using EndCallbackPtr = void (*)(void* context, Result result);
+
+    /** An erase or program job */
+    struct Job
+    {
+        bool erase;
+        /** the next address to erase or program, and the end of the area */
+        uint32_t address;
+        uint32_t end_addr;
+        /** the data left to program */
+        uint8_t*       buffer;
+        EndCallbackPtr end_callback;
+        void*          callback_context;
+    };
+
+    explicit FlashJobQueue(Flash& flash) : flash_(flash) {}
+
+    /** Starts the job right away, or queues it behind the running one.
+     *  Blocks if the peripheral has to be reinitialized first.
+     *  \return Result::ERR if the queue is full or the job couldn't be
+     *          started
+     */
+    Result Queue(const Job& job)
+    {
+        if(job.address >= job.end_addr)
+        {
+            // nothing to do
+            if(job.end_callback)
+                job.end_callback(job.callback_context, Result::OK);
+            return Result::OK;
+        }
+
+        CheckTimeout();
+        {
+            ScopedIrqBlocker block;
+            // queue the job behind the others if an operation is running.
+            // When the queue is full, the job is rejected
+            if(IsBusy())
+                return queued_jobs_.PushBack(job) ? Result::OK : Result::ERR;
+        }
+        if(Recover() != Result::OK)
+            return Result::ERR;
+        {
+            ScopedIrqBlocker block;
+            // an interrupt may have queued a job in the meantime
+            if(IsBusy())
+                return queued_jobs_.PushBack(job) ? Result::OK : Result::ERR;
+            Enter(State::WRITE_ENABLE, Flash::kStepTimeoutMs);
+        }
+
+        if(!StartJob(job))
+        {
+            Abort();
+            StartNextJob();
+            return Result::ERR;
+        }
+        return Result::OK;
+    }
+
+    /** Returns true while a job is running or queued */
+    bool IsBusy() const { return state_ != State::IDLE; }
+
+    /** Returns the number of jobs waiting behind the running one */
+    size_t GetNumQueued()
+    {
+        ScopedIrqBlocker block;
+        return queued_jobs_.GetNumElements();
+    }
+
+    /** Returns true if a failed job left the peripheral to be reinitialized
+     *  by Recover(). Queued jobs fail until then.
+     */
+    bool IsRecoveryPending() const { return recovery_pending_; }
+
+    /** Reinitializes the peripheral if a failed job left it in an unknown
+     *  state. Blocks, so it's only called from the main thread.
+     */
+    Result Recover()
+    {
+        if(!recovery_pending_)
+            return Result::OK;
+        recovery_pending_ = false;
+        if(!flash_.Reinit())
+        {
+            recovery_pending_ = true;
+            return Result::ERR;
+        }
+        return Result::OK;
+    }
+
+    /** Fails the running job if its current step is past the deadline.
+     *  The queued jobs are started afterwards, as usual.
+     */
+    void CheckTimeout()
+    {
+        {
+            ScopedIrqBlocker block;
+            if(state_ == State::IDLE || state_ == State::FINISHING
+               || flash_.GetNowMs() - step_start_ms_ < step_timeout_ms_)
+                return;
+            // the interrupts of the step are ignored from here on
+            state_ = State::FINISHING;
+        }
+        FinishJob(Result::ERR);
+    }
+
+    /** Called by the driver when a command without data phase was sent */
+    void OnCommandDone()
+    {
+        bool ok;
+        if(state_ == State::EXIT_CONTINUOUS_READ)
+        {
+            ok = StartStep();
+        }
+        else if(state_ == State::WRITE_ENABLE)
+        {
+            Enter(State::WAIT_WRITE_ENABLED, Flash::kStepTimeoutMs);
+            ok = flash_.StartWaitWriteEnabled();
+        }
+        else if(state_ == State::OPERATION && job_.erase)
+        {
+            Enter(State::WAIT_READY, erase_timeout_ms_);
+            ok = flash_.StartWaitReady();
+        }
+        else
+            return;
+
+        if(!ok)
+            FinishJob(Result::ERR);
+    }
+
+    /** Called by the driver when the data of a page was sent */
+    void OnTransmitDone()
+    {
+        if(state_ != State::OPERATION)
+            return;
+        Enter(State::WAIT_READY, Flash::kStepTimeoutMs);
+        if(!flash_.StartWaitReady())
+            FinishJob(Result::ERR);
+    }
+
+    /** Called by the driver when the polled status matched */
+    void OnStatusMatch()
+    {
+        bool ok;
+        if(state_ == State::WAIT_WRITE_ENABLED)
+        {
+            ok = StartOperation();
+        }
+        else if(state_ == State::WAIT_READY)
+        {
+            job_.address += step_size_;
+            if(!job_.erase)
+                job_.buffer += step_size_;
+            if(job_.address >= job_.end_addr)
+            {
+                FinishJob(Result::OK);
+                return;
+            }
+            ok = StartStep();
+        }
+        else
+            return;
+
+        if(!ok)
+            FinishJob(Result::ERR);
+    }
+
+    /** Called by the driver when a transfer failed */
+    void OnError()
+    {
+        if(IsBusy() && state_ != State::FINISHING)
+            FinishJob(Result::ERR);
+    }
+
+  private:
+    enum class State
+    {
+        IDLE,
+        /** leaving the continuous read mode of the memory mapped mode */
+        EXIT_CONTINUOUS_READ,
+        /** write enable command sent */
+        WRITE_ENABLE,
+        /** polling for the write enable latch */
+        WAIT_WRITE_ENABLED,
+        /** erase command or page program in progress */
+        OPERATION,
+        /** polling until the flash is done with the erase or program */
+        WAIT_READY,
+        /** the end callback is running, new jobs are queued */
+        FINISHING,
+    };
+
+    /** Switches to the next step, which has to be done within timeout_ms */
+    void Enter(State state, uint32_t timeout_ms)
+    {
+        step_start_ms_   = flash_.GetNowMs();
+        step_timeout_ms_ = timeout_ms;
+        state_           = state;
+    }
+
+    bool StartJob(const Job& job)
+    {
+        job_ = job;
+        if(!flash_.IsMemoryMapped())
+            return StartStep();
+        Enter(State::EXIT_CONTINUOUS_READ, Flash::kStepTimeoutMs);
+        return flash_.StartExitContinuousRead();
+    }
+
+    /** Starts the write enable for the next erase block or page */
+    bool StartStep()
+    {
+        Enter(State::WRITE_ENABLE, Flash::kStepTimeoutMs);
+        return flash_.StartWriteEnable();
+    }
+
+    /** Sends the erase command or programs the next page */
+    bool StartOperation()
+    {
+        Enter(State::OPERATION, Flash::kStepTimeoutMs);
+        if(job_.erase)
+            return flash_.StartErase(
+                job_.address, job_.end_addr, step_size_, erase_timeout_ms_);
+
+        // up to the end of the page
+        const uint32_t page_left
+            = Flash::kPageSize - job_.address % Flash::kPageSize;
+        const uint32_t left = job_.end_addr - job_.address;
+        step_size_          = left < page_left ? left : page_left;
+        return flash_.StartProgram(job_.address, step_size_, job_.buffer);
+    }
+
+    void Abort()
+    {
+        if(!flash_.Abort())
+            recovery_pending_ = true;
+    }
+
+    void FinishJob(Result result)
+    {
+        // back to memory mapped mode before the callback, so it can read the
+        // memory. New jobs from the callback are queued behind the others.
+        if(result != Result::OK || !flash_.EnterMemoryMappedMode())
+        {
+            result = Result::ERR;
+            Abort();
+        }
+        state_ = State::FINISHING;
+
+        if(job_.end_callback)
+            job_.end_callback(job_.callback_context, result);
+        StartNextJob();
+    }
+
+    void StartNextJob()
+    {
+        while(true)
+        {
+            Job job;
+            {
+                ScopedIrqBlocker block;
+                if(queued_jobs_.IsEmpty())
+                {
+                    state_ = State::IDLE;
+                    return;
+                }
+                job = queued_jobs_.PopFront();
+                Enter(State::WRITE_ENABLE, Flash::kStepTimeoutMs);
+            }
+            // until Recover() ran, the jobs fail without touching the flash
+            if(!recovery_pending_)
+            {
+                if(StartJob(job))
+                    return;
+                Abort();
+            }
+            state_ = State::FINISHING;
+            if(job.end_callback)
+                job.end_callback(job.callback_context, Result::ERR);
+        }
+    }
+
+    Flash&   flash_;
+    Job      job_;
+    uint32_t step_size_        = 0;
+    uint32_t erase_timeout_ms_ = 0;
+    uint32_t step_start_ms_    = 0;
+    uint32_t step_timeout_ms_  = 0;
+
+    volatile State       state_            = State::IDLE;
+    volatile bool        recovery_pending_ = false;
+    FIFO<Job, kQueueLen> queued_jobs_;
+};
+
+} // namespace daisy
@@ -0,0 +1,173 @@
+#pragma once
+#ifndef DSY_LOG_RING_H
+#define DSY_LOG_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+namespace daisy
+{
+/** @brief Lock-free multi-producer, single-consumer ring of byte records
+ *  @ingroup utility
+ *
+ *  Holds variable sized records, e.g. log messages, that can be added from
+ *  any context - the main loop as well as interrupt handlers of any
+ *  priority - without disabling interrupts or ever waiting.
+ *
+ *  - Push() can be called from anywhere. When there's no room, the record
+ *    is dropped and counted instead.
+ *  - Only the consumer may call Peek() and Pop().
+ *
+ *  Producers claim space by advancing the reserve position with a
+ *  compare-and-swap, copy their record and then publish its header. The
+ *  consumer only takes records whose header is published, in order, so a
+ *  producer that's interrupted while copying holds back the records after
+ *  it, but never corrupts them.
+ *
+ *  @tparam kSize size of the ring in bytes, a power of two. Each record
+ *          takes a 4 byte header plus its size, rounded up to 4 bytes.
+ */
+template <size_t kSize>
+class LogRing
+{
+  public:
+    static_assert(kSize >= 64 && (kSize & (kSize - 1)) == 0,
+                  "kSize has to be a power of two");
+
+    /** Largest record that can be added */
+    static constexpr size_t kMaxRecordSize = kSize / 4;
+
+    LogRing() : reserve_(0), read_(0), dropped_(0)
+    {
+        memset(words_, 0, sizeof(words_));
+    }
+
+    /** Adds a record made of up to two parts.
+     *  Safe to call from any context.
+     *  \param tag user defined type of the record, 0 to 127
+     *  \return false if the record was dropped
+     */
+    bool Push(uint8_t     tag,
+              const void* data,
+              size_t      size,
+              const void* data2 = nullptr,
+              size_t      size2 = 0)
+    {
+        const size_t payload = size + size2;
+        const size_t total   = kHeaderSize + RoundUp(payload);
+        if(payload > kMaxRecordSize || tag >= kPaddingTag)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        uint32_t pos, pad;
+        do
+        {
+            pos             = reserve_.load(std::memory_order_relaxed);
+            const size_t at = pos & kMask;
+            // records don't wrap, the end of the ring is skipped instead
+            pad = kSize - at < total ? kSize - at : 0;
+            if(pos + pad + total - read_.load(std::memory_order_acquire)
+               > kSize)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while(!reserve_.compare_exchange_weak(
+            pos, pos + pad + total, std::memory_order_relaxed));
+
+        if(pad > 0)
+        {
+            Publish(pos, kPaddingTag, pad - kHeaderSize);
+            pos += pad;
+        }
+        uint8_t* dst = Bytes() + (pos & kMask) + kHeaderSize;
+        memcpy(dst, data, size);
+        if(size2 > 0)
+            memcpy(dst + size, data2, size2);
+        Publish(pos, tag, payload);
+        return true;
+    }
+
+    /** Returns the oldest record, if it's complete. Consumer only.
+     *  \param tag receives the tag
+     *  \param data receives a pointer to the data, valid until Pop()
+     *  \param size receives the size of the data
+     *  \return false if there's no complete record
+     */
+    bool Peek(uint8_t& tag, const uint8_t*& data, size_t& size)
+    {
+        while(true)
+        {
+            const uint32_t pos = read_.load(std::memory_order_relaxed);
+            if(pos == reserve_.load(std::memory_order_acquire))
+                return false;
+            const uint32_t header = __atomic_load_n(&words_[(pos & kMask) / 4],
+                                                    __ATOMIC_ACQUIRE);
+            if((header & kPublished) == 0)
+                return false;
+            tag  = (header >> 16) & 0x7f;
+            size = header & 0xffff;
+            if(tag != kPaddingTag)
+            {
+                data = Bytes() + (pos & kMask) + kHeaderSize;
+                return true;
+            }
+            Pop();
+        }
+    }
+
+    /** Removes the oldest record. Consumer only, after Peek() returned true */
+    void Pop()
+    {
+        const uint32_t pos    = read_.load(std::memory_order_relaxed);
+        const size_t   at     = pos & kMask;
+        const uint32_t header = words_[at / 4];
+        const size_t   total  = kHeaderSize + RoundUp(header & 0xffff);
+        // the whole record, so that no stale data looks like a header later
+        memset(Bytes() + at, 0, total);
+        read_.store(pos + total, std::memory_order_release);
+    }
+
+    /** Returns true if nothing was added that wasn't removed yet */
+    bool IsEmpty() const
+    {
+        return read_.load(std::memory_order_acquire)
+               == reserve_.load(std::memory_order_acquire);
+    }
+
+    /** Returns the number of records that were dropped */
+    uint32_t GetNumDropped() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    static constexpr size_t   kHeaderSize = 4;
+    static constexpr size_t   kMask       = kSize - 1;
+    static constexpr uint8_t  kPaddingTag = 0x7f;
+    static constexpr uint32_t kPublished  = 0x80000000;
+
+    static constexpr size_t RoundUp(size_t size) { return (size + 3) & ~3u; }
+
+    uint8_t* Bytes() { return reinterpret_cast<uint8_t*>(words_); }
+
+    void Publish(uint32_t pos, uint8_t tag, size_t size)
+    {
+        const uint32_t header = kPublished | (uint32_t(tag) << 16) | size;
+        __atomic_store_n(&words_[(pos & kMask) / 4], header, __ATOMIC_RELEASE);
+    }
+
+    /** headers are read and written with atomic operations */
+    uint32_t              words_[kSize / 4];
+    std::atomic<uint32_t> reserve_;
+    std::atomic<uint32_t> read_;
+    std::atomic<uint32_t> dropped_;
+};
+
+} // namespace daisy
+
+#endif
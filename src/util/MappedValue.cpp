@@ -28,7 +28,7 @@ MappedFloatValue::MappedFloatValue(float       min,
 
 void MappedFloatValue::Set(float newValue)
 {
-    value_ = std::max(min_, std::min(max_, newValue));
+    SetValue(std::max(min_, std::min(max_, newValue)));
 }
 
 void MappedFloatValue::AppentToString(FixedCapStrBase<char>& string) const
@@ -39,7 +39,7 @@ void MappedFloatValue::AppentToString(FixedCapStrBase<char>& string) const
 
 void MappedFloatValue::ResetToDefault()
 {
-    value_ = default_;
+    SetValue(default_);
 }
 
 float MappedFloatValue::GetAs0to1() const
@@ -81,9 +81,9 @@ void MappedFloatValue::SetFrom0to1(float normalizedValue0to1)
             v                   = min_ + valueSq * (max_ - min_);
         }
         break;
-        default: value_ = 0.0f; return;
+        default: SetValue(0.0f); return;
     }
-    value_ = std::max(min_, std::min(max_, v));
+    SetValue(std::max(min_, std::min(max_, v)));
 }
 
 void MappedFloatValue::Step(int16_t numSteps, bool useCoarseStepSize)
@@ -95,6 +95,14 @@ void MappedFloatValue::Step(int16_t numSteps, bool useCoarseStepSize)
     SetFrom0to1(std::max(0.0f, std::min(mapped + step, 1.0f)));
 }
 
+void MappedFloatValue::SetValue(float newValue)
+{
+    if(newValue == value_)
+        return;
+    value_ = newValue;
+    MarkChanged();
+}
+
 // ==========================================================================
 
 // ==========================================================================
@@ -119,7 +127,7 @@ MappedIntValue::MappedIntValue(int         min,
 
 void MappedIntValue::Set(int newValue)
 {
-    value_ = std::max(min_, std::min(max_, newValue));
+    SetValue(std::max(min_, std::min(max_, newValue)));
 }
 
 void MappedIntValue::AppentToString(FixedCapStrBase<char>& string) const
@@ -130,7 +138,7 @@ void MappedIntValue::AppentToString(FixedCapStrBase<char>& string) const
 
 void MappedIntValue::ResetToDefault()
 {
-    value_ = default_;
+    SetValue(default_);
 }
 
 float MappedIntValue::GetAs0to1() const
@@ -141,14 +149,22 @@ float MappedIntValue::GetAs0to1() const
 void MappedIntValue::SetFrom0to1(float normalizedValue0to1)
 {
     const auto v = int(normalizedValue0to1 * (max_ - min_) + 0.5f) + min_;
-    value_       = std::max(min_, std::min(max_, v));
+    SetValue(std::max(min_, std::min(max_, v)));
 }
 
 
 void MappedIntValue::Step(int16_t numStepsUp, bool useCoarseStepSize)
 {
     const auto stepsize = useCoarseStepSize ? stepSizeCoarse_ : stepSizeFine_;
-    value_ = std::max(min_, std::min(max_, value_ + numStepsUp * stepsize));
+    SetValue(std::max(min_, std::min(max_, value_ + numStepsUp * stepsize)));
+}
+
+void MappedIntValue::SetValue(int newValue)
+{
+    if(newValue == value_)
+        return;
+    value_ = newValue;
+    MarkChanged();
 }
 
 // ==========================================================================
@@ -166,7 +182,7 @@ MappedStringListValue::MappedStringListValue(const char** itemStrings,
 
 void MappedStringListValue::SetIndex(uint32_t index)
 {
-    index_ = std::min(uint32_t(numItems_ - 1), index);
+    SetIndexValue(std::min(uint32_t(numItems_ - 1), index));
 }
 
 void MappedStringListValue::AppentToString(FixedCapStrBase<char>& string) const
@@ -176,7 +192,7 @@ void MappedStringListValue::AppentToString(FixedCapStrBase<char>& string) const
 
 void MappedStringListValue::ResetToDefault()
 {
-    index_ = defaultIndex_;
+    SetIndexValue(defaultIndex_);
 }
 
 float MappedStringListValue::GetAs0to1() const
@@ -186,8 +202,8 @@ float MappedStringListValue::GetAs0to1() const
 
 void MappedStringListValue::SetFrom0to1(float normalizedValue0to1)
 {
-    index_ = std::max(
-        0, std::min(int(normalizedValue0to1 * numItems_), numItems_ - 1));
+    SetIndexValue(std::max(
+        0, std::min(int(normalizedValue0to1 * numItems_), numItems_ - 1)));
 }
 
 void MappedStringListValue::Step(int16_t numStepsUp, bool useCoarseStepSize)
@@ -195,17 +211,26 @@ void MappedStringListValue::Step(int16_t numStepsUp, bool useCoarseStepSize)
     if(numStepsUp > 0)
     {
         if(useCoarseStepSize)
-            index_ = numItems_ - 1;
+            SetIndexValue(numItems_ - 1);
         else
-            index_ = std::min(uint32_t(numItems_ - 1), index_ + numStepsUp);
+            SetIndexValue(
+                std::min(uint32_t(numItems_ - 1), index_ + numStepsUp));
     }
     else
     {
         if(useCoarseStepSize)
-            index_ = 0;
+            SetIndexValue(0);
         else
-            index_ = uint32_t(std::max(0, int(index_) + numStepsUp));
+            SetIndexValue(uint32_t(std::max(0, int(index_) + numStepsUp)));
     }
 }
 
+void MappedStringListValue::SetIndexValue(uint32_t newIndex)
+{
+    if(newIndex == index_)
+        return;
+    index_ = newIndex;
+    MarkChanged();
+}
+
 } // namespace daisy
\ No newline at end of file
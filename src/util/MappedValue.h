@@ -32,6 +32,18 @@ class MappedValue
      *  to increment/decrement the value with buttons/encoders while making use 
      *  of the specific mapping. */
     virtual void Step(int16_t numStepsUp, bool useCoarseStepSize) = 0;
+
+    /** Returns a counter that is incremented whenever the value changes.
+     *  Compare it with an earlier reading to find out if the value was
+     *  changed in the meantime, e.g. to redraw it only when necessary. */
+    uint32_t GetChangeCounter() const { return changeCounter_; }
+
+  protected:
+    /** Child classes call this whenever the value has changed. */
+    void MarkChanged() { changeCounter_++; }
+
+  private:
+    uint32_t changeCounter_ = 0;
 };
 
 /** @brief A `MappedValue` that maps a float value using various mapping functions.
@@ -112,6 +124,8 @@ class MappedFloatValue : public MappedValue
     void Step(int16_t numStepsUp, bool useCoarseStepSize) override;
 
   private:
+    void SetValue(float newValue);
+
     float                  value_;
     const float            min_;
     const float            max_;
@@ -186,6 +200,8 @@ class MappedIntValue : public MappedValue
     void Step(int16_t numStepsUp, bool useCoarseStepSize) override;
 
   private:
+    void SetValue(int newValue);
+
     int         value_;
     const int   min_;
     const int   max_;
@@ -255,6 +271,8 @@ class MappedStringListValue : public MappedValue
     void Step(int16_t numStepsUp, bool useCoarseStepSize) override;
 
   private:
+    void SetIndexValue(uint32_t newIndex);
+
     uint32_t     index_;
     const char** itemStrings_;
     const int    numItems_;
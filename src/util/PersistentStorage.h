@@ -3,6 +3,7 @@
 #include "daisy_core.h"
 #include "per/qspi.h"
 #include "sys/dma.h"
+#include <string.h>
 
 namespace daisy
 {
@@ -12,9 +13,17 @@ namespace daisy
  *  Storage occupied by the struct will be one word larger than 
  *  the SettingStruct used. The extra word is used to store the
  *  state of the data, and whether it's been overwritten or not.
- * 
- *  \todo - Make Save() non-blocking
- *  \todo - Add wear leveling
+ *
+ *  In the log-structured mode (Init() with num_log_sectors > 1), every
+ *  Save() appends a new record with a sequence number and a CRC to a
+ *  ring of 4kB flash sectors, instead of erasing and rewriting the same
+ *  location. Init() recovers the latest valid record. This spreads the
+ *  wear over all sectors, and a save that's interrupted by a power loss
+ *  leaves the previous settings intact.
+ *  Save() only queues the record, call Process() regularly from the main
+ *  loop to write it. Process() also erases the next sector ahead of time,
+ *  in the background with QSPIHandle::EraseAsync(), so saving never has
+ *  to wait for an erase.
  * 
  **/
 template <typename SettingStruct>
@@ -41,6 +50,9 @@ class PersistentStorage
         USER    = 2,
     };
 
+    /** Size of the flash sectors used in the log-structured mode */
+    static constexpr uint32_t kSectorSize = 4096;
+
     /** Constructor for storage class 
      *  \param qspi reference to the hardware qspi peripheral.
      */
@@ -49,7 +61,10 @@ class PersistentStorage
       address_offset_(0),
       default_settings_(),
       settings_(),
-      state_(State::UNKNOWN)
+      state_(State::UNKNOWN),
+      num_log_sectors_(0),
+      save_pending_(false),
+      erase_state_(EraseState::IDLE)
     {
     }
 
@@ -62,12 +77,27 @@ class PersistentStorage
      *      this will be updated to contain the stored data.
      *  \param address_offset offset for location on the QSPI chip (offset to base address of device).
      *      This defaults to the first address on the chip, and will be masked to the nearest multiple of 256
+     *      (of kSectorSize in the log-structured mode)
+     *  \param num_log_sectors number of sectors for the log-structured mode,
+     *      starting at address_offset.
+     *      Defaults to 0, which stores the settings in a single place instead.
      **/
-    void Init(const SettingStruct &defaults, uint32_t address_offset = 0)
+    void Init(const SettingStruct &defaults,
+              uint32_t             address_offset  = 0,
+              uint32_t             num_log_sectors = 0)
     {
         default_settings_ = defaults;
         settings_         = defaults;
-        address_offset_   = address_offset & (uint32_t)(~0xff);
+        num_log_sectors_  = num_log_sectors > 1 ? num_log_sectors : 0;
+        save_pending_     = false;
+        if(num_log_sectors_ > 0)
+        {
+            address_offset_ = address_offset & ~(kSectorSize - 1);
+            InitLog();
+            return;
+        }
+
+        address_offset_ = address_offset & (uint32_t)(~0xff);
         auto storage_data
             = reinterpret_cast<SaveStruct *>(qspi_.GetData(address_offset_));
 
@@ -92,7 +122,10 @@ class PersistentStorage
     /** Returns a reference to the setting struct */
     SettingStruct &GetSettings() { return settings_; }
 
-    /** Performs the save operation, storing the storage */
+    /** Performs the save operation, storing the storage
+     *  In the log-structured mode, this only queues the settings, and the
+     *  next Process() writes them.
+     */
     void Save()
     {
         state_ = State::USER;
@@ -107,6 +140,63 @@ class PersistentStorage
         StoreSettingsIfChanged();
     }
 
+    /** Does the flash work of the log-structured mode: writes a queued
+     *  save, or erases the next sector ahead of time. Does at most one
+     *  flash operation per call. Call this regularly from the main loop.
+     *  Does nothing in the default mode, or while the QSPIHandle is busy
+     *  with an asynchronous operation, as the flash can't be read then.
+     *  Only the erases run in the background. A record is programmed with
+     *  the blocking QSPIHandle::Write(), which stalls the main loop for
+     *  the page program time of the flash.
+     */
+    void Process()
+    {
+        if(num_log_sectors_ == 0 || qspi_.IsBusy() || !HandleEraseResult())
+            return;
+
+        if(save_pending_)
+        {
+            if(next_slot_ >= kSlotsPerSector)
+            {
+                if(!latest_in_current_)
+                {
+                    // nothing valid in here, e.g. after write errors
+                    EraseCurrentSector();
+                    return;
+                }
+                // the current sector is full, the next one must be erased
+                if(!next_sector_erased_)
+                {
+                    EraseNextSector();
+                    return;
+                }
+                current_sector_     = GetNextSector();
+                next_slot_          = 0;
+                next_sector_erased_ = false;
+                latest_in_current_  = false;
+            }
+            WritePendingRecord();
+            return;
+        }
+
+        // erase the next sector once the current one has the latest record
+        if(!next_sector_erased_ && latest_in_current_)
+            EraseNextSector();
+    }
+
+    /** Writes a queued save right away, erasing a sector if needed.
+     *  This blocks until the settings are in the flash, including any
+     *  asynchronous QSPIHandle operations running in the meantime.
+     */
+    void Flush()
+    {
+        while(save_pending_)
+            Process();
+    }
+
+    /** Returns true if a Save() hasn't been written to the flash yet */
+    bool IsSavePending() const { return save_pending_; }
+
   private:
     struct SaveStruct
     {
@@ -114,13 +204,25 @@ class PersistentStorage
         SettingStruct user_data;
     };
 
-    void StoreSettingsIfChanged()
+    /** A record in the log-structured mode */
+    struct LogRecord
     {
-        SaveStruct s;
-        s.storage_state = state_;
-        s.user_data     = settings_;
+        uint32_t   magic;
+        uint32_t   sequence;
+        SaveStruct data;
+        /** CRC-32 of everything above, written last */
+        uint32_t crc;
+    };
 
-        void *data_ptr = qspi_.GetData(address_offset_);
+    static constexpr uint32_t kRecordMagic    = 0x4c505344; // "DSPL"
+    static constexpr uint32_t kSlotsPerSector = kSectorSize / sizeof(LogRecord);
+    static_assert(kSlotsPerSector > 0,
+                  "SettingStruct is too big for the log-structured mode");
+
+    /** Returns a pointer to the stored data, with the cache invalidated */
+    const uint8_t *GetStoredData(uint32_t address, uint32_t size)
+    {
+        void *data_ptr = qspi_.GetData(address);
 
 #if !UNIT_TEST
         // Caching behavior is different when running programs outside internal flash
@@ -129,14 +231,31 @@ class PersistentStorage
         if(System::GetProgramMemoryRegion()
            != System::MemoryRegion::INTERNAL_FLASH)
         {
-            dsy_dma_invalidate_cache_for_buffer((uint8_t *)data_ptr, sizeof(s));
+            dsy_dma_invalidate_cache_for_buffer((uint8_t *)data_ptr, size);
         }
+#else
+        (void)size;
 #endif
+        return (const uint8_t *)data_ptr;
+    }
+
+    void StoreSettingsIfChanged()
+    {
+        if(num_log_sectors_ > 0)
+        {
+            QueueRecord();
+            return;
+        }
+
+        SaveStruct s;
+        s.storage_state = state_;
+        s.user_data     = settings_;
 
         // Only actually save if the new data is different
         // Use the `==operator` in custom SettingStruct to fine tune
         // what may or may not trigger the erase/save.
-        auto storage_data = reinterpret_cast<SaveStruct *>(data_ptr);
+        auto storage_data = reinterpret_cast<const SaveStruct *>(
+            GetStoredData(address_offset_, sizeof(s)));
         if(settings_ != storage_data->user_data)
         {
             qspi_.Erase(address_offset_, address_offset_ + sizeof(s));
@@ -144,11 +263,223 @@ class PersistentStorage
         }
     }
 
+    static uint32_t Crc32(const uint8_t *data, size_t size)
+    {
+        uint32_t crc = 0xffffffff;
+        for(size_t i = 0; i < size; i++)
+        {
+            crc ^= data[i];
+            for(int bit = 0; bit < 8; bit++)
+                crc = (crc >> 1) ^ (0xedb88320 & (0u - (crc & 1)));
+        }
+        return ~crc;
+    }
+
+    uint32_t GetSlotAddress(uint32_t sector, uint32_t slot) const
+    {
+        return address_offset_ + sector * kSectorSize
+               + slot * sizeof(LogRecord);
+    }
+
+    uint32_t GetNextSector() const
+    {
+        return (current_sector_ + 1) % num_log_sectors_;
+    }
+
+    bool IsErased(uint32_t address, uint32_t size)
+    {
+        const uint8_t *data = GetStoredData(address, size);
+        for(uint32_t i = 0; i < size; i++)
+            if(data[i] != 0xff)
+                return false;
+        return true;
+    }
+
+    /** Returns the record at address, or nullptr if it isn't valid */
+    const LogRecord *GetValidRecord(uint32_t address)
+    {
+        auto record = reinterpret_cast<const LogRecord *>(
+            GetStoredData(address, sizeof(LogRecord)));
+        if(record->magic != kRecordMagic
+           || (record->data.storage_state != State::FACTORY
+               && record->data.storage_state != State::USER))
+            return nullptr;
+        if(GetCrc(*record) != record->crc)
+            return nullptr;
+        return record;
+    }
+
+    static uint32_t GetCrc(const LogRecord &record)
+    {
+        const uint8_t *data = (const uint8_t *)&record;
+        return Crc32(data, (const uint8_t *)&record.crc - data);
+    }
+
+    /** Finds the latest valid record and the slot to write next */
+    void InitLog()
+    {
+        const LogRecord *latest        = nullptr;
+        uint32_t         latest_sector = 0;
+        uint32_t         latest_slot   = 0;
+        for(uint32_t sector = 0; sector < num_log_sectors_; sector++)
+            for(uint32_t slot = 0; slot < kSlotsPerSector; slot++)
+            {
+                auto record = GetValidRecord(GetSlotAddress(sector, slot));
+                if(record == nullptr)
+                    continue;
+                // sequence numbers may wrap around
+                if(latest == nullptr
+                   || int32_t(record->sequence - latest->sequence) > 0)
+                {
+                    latest        = record;
+                    latest_sector = sector;
+                    latest_slot   = slot;
+                }
+            }
+
+        if(latest == nullptr)
+        {
+            // Initialize the Data store State::FACTORY, and the DefaultSettings
+            state_             = State::FACTORY;
+            sequence_          = 0;
+            current_sector_    = 0;
+            next_slot_         = 0;
+            latest_in_current_ = false;
+            if(!IsErased(GetSlotAddress(0, 0), kSectorSize))
+                qspi_.Erase(GetSlotAddress(0, 0),
+                            GetSlotAddress(0, 0) + kSectorSize);
+            next_sector_erased_ = IsErased(GetSlotAddress(1, 0), kSectorSize);
+            QueueRecord();
+            Flush();
+            return;
+        }
+
+        state_             = latest->data.storage_state;
+        settings_          = latest->data.user_data;
+        stored_            = *latest;
+        sequence_          = latest->sequence;
+        current_sector_    = latest_sector;
+        latest_in_current_ = true;
+        // skip slots that were written partially
+        next_slot_ = latest_slot + 1;
+        while(next_slot_ < kSlotsPerSector
+              && !IsErased(GetSlotAddress(current_sector_, next_slot_),
+                           sizeof(LogRecord)))
+            next_slot_++;
+        next_sector_erased_
+            = IsErased(GetSlotAddress(GetNextSector(), 0), kSectorSize);
+    }
+
+    /** Queues a record with the current settings, unless they're stored */
+    void QueueRecord()
+    {
+        // Only actually save if the new data is different
+        // Use the `==operator` in custom SettingStruct to fine tune
+        // what may or may not trigger the save.
+        if(sequence_ != 0 && state_ == stored_.data.storage_state
+           && !(settings_ != stored_.data.user_data))
+        {
+            save_pending_ = false;
+            return;
+        }
+
+        // zero the padding as well, it's part of the CRC
+        memset((void *)&pending_, 0, sizeof(pending_));
+        pending_.magic              = kRecordMagic;
+        pending_.sequence           = sequence_ + 1;
+        pending_.data.storage_state = state_;
+        pending_.data.user_data     = settings_;
+        pending_.crc                = GetCrc(pending_);
+        save_pending_               = true;
+    }
+
+    /** Programs the record with the blocking QSPIHandle::Write(). It's a
+     *  page at most, and the record is checked right after.
+     */
+    void WritePendingRecord()
+    {
+        const uint32_t address = GetSlotAddress(current_sector_, next_slot_);
+        qspi_.Write(address, sizeof(LogRecord), (uint8_t *)&pending_);
+        next_slot_++;
+
+        // a bad slot is skipped, the record goes to the next one
+        const LogRecord *record = GetValidRecord(address);
+        if(record == nullptr || record->sequence != pending_.sequence)
+            return;
+        stored_            = pending_;
+        sequence_          = pending_.sequence;
+        save_pending_      = false;
+        latest_in_current_ = true;
+    }
+
+    /** Erases in the background, see HandleEraseResult() */
+    void StartErase(uint32_t sector)
+    {
+        const uint32_t address = GetSlotAddress(sector, 0);
+        erase_sector_          = sector;
+        erase_state_           = EraseState::BUSY;
+        if(qspi_.EraseAsync(
+               address, address + kSectorSize, &EraseEndCallback, this)
+           != QSPIHandle::Result::OK)
+            erase_state_ = EraseState::IDLE;
+    }
+
+    void EraseNextSector() { StartErase(GetNextSector()); }
+
+    void EraseCurrentSector() { StartErase(current_sector_); }
+
+    static void EraseEndCallback(void *context, QSPIHandle::Result result)
+    {
+        auto storage          = static_cast<PersistentStorage *>(context);
+        storage->erase_state_ = result == QSPIHandle::Result::OK
+                                    ? EraseState::DONE
+                                    : EraseState::IDLE;
+    }
+
+    /** Takes note of a finished erase.
+     *  \return false while the erase is still running
+     */
+    bool HandleEraseResult()
+    {
+        if(erase_state_ == EraseState::BUSY)
+            return false;
+        if(erase_state_ == EraseState::DONE)
+        {
+            erase_state_ = EraseState::IDLE;
+            if(erase_sector_ == current_sector_)
+                next_slot_ = 0;
+            else
+                next_sector_erased_ = IsErased(
+                    GetSlotAddress(erase_sector_, 0), kSectorSize);
+        }
+        return true;
+    }
+
     QSPIHandle &  qspi_;
     uint32_t      address_offset_;
     SettingStruct default_settings_;
     SettingStruct settings_;
     State         state_;
+
+    // log-structured mode
+    uint32_t  num_log_sectors_;
+    uint32_t  current_sector_;
+    uint32_t  next_slot_;
+    bool      next_sector_erased_;
+    bool      latest_in_current_;
+    uint32_t  sequence_;
+    bool      save_pending_;
+    LogRecord pending_;
+    LogRecord stored_;
+
+    enum class EraseState
+    {
+        IDLE,
+        BUSY,
+        DONE,
+    };
+    volatile EraseState erase_state_;
+    uint32_t            erase_sector_;
 };
 
 } // namespace daisy
\ No newline at end of file
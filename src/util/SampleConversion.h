@@ -0,0 +1,382 @@
+#pragma once
+#ifndef DSY_SAMPLE_CONVERSION_H
+#define DSY_SAMPLE_CONVERSION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "daisy_core.h"
+#include "per/sai.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#define DSY_SAMPLE_CONVERSION_SSE2 1 /**< packed 4-lane float path */
+#endif
+
+namespace daisy
+{
+/** @brief Block based conversion between SAI integer samples and float audio
+ *  @ingroup audio
+ *
+ *  The audio engine picks one input kernel (int -> float, deinterleave, scale)
+ *  and one output kernel (float -> int, scale, saturate, reinterleave) when it
+ *  is started, based on the bit depth, the number of channels per hardware
+ *  buffer, and whether the user callback is interleaving.
+ *  This keeps all format decisions out of the per-sample loops.
+ *
+ *  The results are bit-exact with the scalar helpers in daisy_core.h
+ *  (s162f/s242f/s322f and f2s16/f2s24/f2s32). Gain is applied as a separate
+ *  multiplication in the same order as the scalar code.
+ *
+ *  When compiled for a target with packed float SIMD (SSE2 on host builds)
+ *  four samples are converted per instruction. The Cortex-M7 FPU has no packed
+ *  float instructions, so on the Daisy the portable path is used, with the gain
+ *  hoisted out of the loop and all channels of a frame converted per iteration.
+ */
+class SampleConversion
+{
+  public:
+    /** Converts `frames` frames of interleaved integer samples from `in` to
+     *  one float buffer per channel in `out`, multiplying each by `gain`.
+     *  For interleaving layouts, out[0] receives all samples in order and
+     *  `frames` is the total number of samples.
+     */
+    typedef void (*InputKernel)(const int32_t* in,
+                                float* const*  out,
+                                size_t         frames,
+                                float          gain);
+
+    /** Converts `frames` frames from one float buffer per channel in `in` to
+     *  interleaved integer samples in `out`, multiplying each by `gain` before
+     *  saturating to the output format.
+     *  For interleaving layouts, in[0] holds all samples in order and
+     *  `frames` is the total number of samples.
+     */
+    typedef void (*OutputKernel)(const float* const* in,
+                                 int32_t*            out,
+                                 size_t              frames,
+                                 float               gain);
+
+    /** Pair of kernels for a particular sample layout */
+    struct Kernels
+    {
+        InputKernel  in;
+        OutputKernel out;
+    };
+
+    /** Returns the kernels for a layout.
+     *  \param bd bit depth of the samples in the hardware buffer
+     *  \param chns interleaved channels per hardware buffer (1, 2, 4, 8, 16)
+     *  \param interleaved true if the float buffer stays interleaved
+     *  \return kernels, both nullptr if the layout is not supported
+     */
+    static Kernels
+    GetKernels(SaiHandle::Config::BitDepth bd, size_t chns, bool interleaved)
+    {
+        // Interleaved float buffers are a straight copy of the hardware buffer.
+        const size_t layout = interleaved ? 0 : LayoutIndex(chns);
+        const size_t fmt    = static_cast<size_t>(bd);
+        if(layout >= kNumLayouts || fmt >= kNumFormats)
+            return {nullptr, nullptr};
+
+        static const Kernels table[kNumFormats][kNumLayouts] = {
+            {MakeKernels<S16, 1>(),
+             MakeKernels<S16, 2>(),
+             MakeKernels<S16, 4>(),
+             MakeKernels<S16, 8>(),
+             MakeKernels<S16, 16>()},
+            {MakeKernels<S24, 1>(),
+             MakeKernels<S24, 2>(),
+             MakeKernels<S24, 4>(),
+             MakeKernels<S24, 8>(),
+             MakeKernels<S24, 16>()},
+            {MakeKernels<S32, 1>(),
+             MakeKernels<S32, 2>(),
+             MakeKernels<S32, 4>(),
+             MakeKernels<S32, 8>(),
+             MakeKernels<S32, 16>()},
+        };
+        return table[fmt][layout];
+    }
+
+    /** Deinterleaves, converts and scales a block. See InputKernel. */
+    template <typename Format, size_t kChans>
+    static void Deinterleave(const int32_t* in,
+                             float* const*  out,
+                             size_t         frames,
+                             float          gain)
+    {
+        size_t i = Packed<Format, kChans>::Deinterleave(in, out, frames, gain);
+        in += i * kChans;
+        for(; i < frames; i++)
+        {
+            for(size_t c = 0; c < kChans; c++)
+                out[c][i] = Format::ToFloat(in[c]) * gain;
+            in += kChans;
+        }
+    }
+
+    /** Scales, saturates, converts and interleaves a block. See OutputKernel */
+    template <typename Format, size_t kChans>
+    static void Interleave(const float* const* in,
+                           int32_t*            out,
+                           size_t              frames,
+                           float               gain)
+    {
+        size_t i = Packed<Format, kChans>::Interleave(in, out, frames, gain);
+        out += i * kChans;
+        for(; i < frames; i++)
+        {
+            for(size_t c = 0; c < kChans; c++)
+                out[c] = Format::FromFloat(in[c][i] * gain);
+            out += kChans;
+        }
+    }
+
+    /** 16-bit samples in the lower half of each word */
+    struct S16
+    {
+        static FORCE_INLINE float   ToFloat(int32_t x) { return s162f(x); }
+        static FORCE_INLINE int32_t FromFloat(float x) { return f2s16(x); }
+#ifdef DSY_SAMPLE_CONVERSION_SSE2
+        static FORCE_INLINE __m128 ToFloat(__m128i x)
+        {
+            // truncate to int16_t, like the implicit cast in s162f
+            x = _mm_srai_epi32(_mm_slli_epi32(x, 16), 16);
+            return _mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(S162F_SCALE));
+        }
+        static FORCE_INLINE __m128i FromFloat(__m128 x)
+        {
+            const __m128 scale = _mm_set1_ps(F2S16_SCALE);
+            return _mm_cvttps_epi32(_mm_mul_ps(Clamp(x), scale));
+        }
+#endif
+    };
+
+    /** 24-bit samples in the lower three bytes of each word */
+    struct S24
+    {
+        static FORCE_INLINE float   ToFloat(int32_t x) { return s242f(x); }
+        static FORCE_INLINE int32_t FromFloat(float x) { return f2s24(x); }
+#ifdef DSY_SAMPLE_CONVERSION_SSE2
+        static FORCE_INLINE __m128 ToFloat(__m128i x)
+        {
+            const __m128i sign = _mm_set1_epi32(S24SIGN);
+            x = _mm_sub_epi32(_mm_xor_si128(x, sign), sign);
+            return _mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(S242F_SCALE));
+        }
+        static FORCE_INLINE __m128i FromFloat(__m128 x)
+        {
+            const __m128 scale = _mm_set1_ps(F2S24_SCALE);
+            return _mm_cvttps_epi32(_mm_mul_ps(Clamp(x), scale));
+        }
+#endif
+    };
+
+    /** Full 32-bit samples */
+    struct S32
+    {
+        static FORCE_INLINE float   ToFloat(int32_t x) { return s322f(x); }
+        static FORCE_INLINE int32_t FromFloat(float x) { return f2s32(x); }
+#ifdef DSY_SAMPLE_CONVERSION_SSE2
+        static FORCE_INLINE __m128 ToFloat(__m128i x)
+        {
+            return _mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(S322F_SCALE));
+        }
+        static FORCE_INLINE __m128i FromFloat(__m128 x)
+        {
+            const __m128 scale = _mm_set1_ps(F2S32_SCALE);
+            return _mm_cvttps_epi32(_mm_mul_ps(Clamp(x), scale));
+        }
+#endif
+    };
+
+  private:
+    static constexpr size_t kNumFormats = 3;
+    static constexpr size_t kNumLayouts = 5;
+
+    static constexpr size_t LayoutIndex(size_t chns)
+    {
+        return chns == 1    ? 0
+               : chns == 2  ? 1
+               : chns == 4  ? 2
+               : chns == 8  ? 3
+               : chns == 16 ? 4
+                            : kNumLayouts;
+    }
+
+    template <typename Format, size_t kChans>
+    static constexpr Kernels MakeKernels()
+    {
+        return {&Deinterleave<Format, kChans>, &Interleave<Format, kChans>};
+    }
+
+#ifdef DSY_SAMPLE_CONVERSION_SSE2
+    static FORCE_INLINE __m128 Clamp(__m128 x)
+    {
+        x = _mm_max_ps(x, _mm_set1_ps(FBIPMIN));
+        return _mm_min_ps(x, _mm_set1_ps(FBIPMAX));
+    }
+
+    /** Packed path for layouts that map onto 4-lane vectors.
+     *  Both functions return the number of frames they processed,
+     *  the remainder is handled by the scalar loop.
+     */
+    template <typename Format, size_t kChans>
+    struct Packed
+    {
+        static_assert(kChans % 4 == 0, "unsupported packed layout");
+
+        static size_t Deinterleave(const int32_t* in,
+                                   float* const*  out,
+                                   size_t         frames,
+                                   float          gain)
+        {
+            const __m128 g = _mm_set1_ps(gain);
+            size_t       i = 0;
+            for(; i + 4 <= frames; i += 4)
+            {
+                for(size_t grp = 0; grp < kChans; grp += 4)
+                {
+                    const int32_t* src = in + i * kChans + grp;
+                    __m128         r0  = Load(src, g);
+                    __m128         r1  = Load(src + kChans, g);
+                    __m128         r2  = Load(src + 2 * kChans, g);
+                    __m128         r3  = Load(src + 3 * kChans, g);
+                    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                    _mm_storeu_ps(out[grp] + i, r0);
+                    _mm_storeu_ps(out[grp + 1] + i, r1);
+                    _mm_storeu_ps(out[grp + 2] + i, r2);
+                    _mm_storeu_ps(out[grp + 3] + i, r3);
+                }
+            }
+            return i;
+        }
+
+        static size_t Interleave(const float* const* in,
+                                 int32_t*            out,
+                                 size_t              frames,
+                                 float               gain)
+        {
+            const __m128 g = _mm_set1_ps(gain);
+            size_t       i = 0;
+            for(; i + 4 <= frames; i += 4)
+            {
+                for(size_t grp = 0; grp < kChans; grp += 4)
+                {
+                    int32_t* dst = out + i * kChans + grp;
+                    __m128   r0  = _mm_loadu_ps(in[grp] + i);
+                    __m128   r1  = _mm_loadu_ps(in[grp + 1] + i);
+                    __m128   r2  = _mm_loadu_ps(in[grp + 2] + i);
+                    __m128   r3  = _mm_loadu_ps(in[grp + 3] + i);
+                    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                    Store(dst, r0, g);
+                    Store(dst + kChans, r1, g);
+                    Store(dst + 2 * kChans, r2, g);
+                    Store(dst + 3 * kChans, r3, g);
+                }
+            }
+            return i;
+        }
+
+        static FORCE_INLINE __m128 Load(const int32_t* src, __m128 g)
+        {
+            return _mm_mul_ps(
+                Format::ToFloat(_mm_loadu_si128((const __m128i*)src)), g);
+        }
+
+        static FORCE_INLINE void Store(int32_t* dst, __m128 x, __m128 g)
+        {
+            _mm_storeu_si128((__m128i*)dst,
+                             Format::FromFloat(_mm_mul_ps(x, g)));
+        }
+    };
+
+    template <typename Format>
+    struct Packed<Format, 1>
+    {
+        static size_t
+        Deinterleave(const int32_t* in, float* const* out, size_t n, float gain)
+        {
+            const __m128 g = _mm_set1_ps(gain);
+            size_t       i = 0;
+            for(; i + 4 <= n; i += 4)
+                _mm_storeu_ps(out[0] + i,
+                              Packed<Format, 4>::Load(in + i, g));
+            return i;
+        }
+
+        static size_t
+        Interleave(const float* const* in, int32_t* out, size_t n, float gain)
+        {
+            const __m128 g = _mm_set1_ps(gain);
+            size_t       i = 0;
+            for(; i + 4 <= n; i += 4)
+                Packed<Format, 4>::Store(out + i, _mm_loadu_ps(in[0] + i), g);
+            return i;
+        }
+    };
+
+    template <typename Format>
+    struct Packed<Format, 2>
+    {
+        static size_t Deinterleave(const int32_t* in,
+                                   float* const*  out,
+                                   size_t         frames,
+                                   float          gain)
+        {
+            const __m128 g = _mm_set1_ps(gain);
+            size_t       i = 0;
+            for(; i + 4 <= frames; i += 4)
+            {
+                // { L0 R0 L1 R1 } { L2 R2 L3 R3 }
+                const __m128 a = Packed<Format, 4>::Load(in + i * 2, g);
+                const __m128 b = Packed<Format, 4>::Load(in + i * 2 + 4, g);
+                _mm_storeu_ps(out[0] + i,
+                              _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+                _mm_storeu_ps(out[1] + i,
+                              _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+            }
+            return i;
+        }
+
+        static size_t Interleave(const float* const* in,
+                                 int32_t*            out,
+                                 size_t              frames,
+                                 float               gain)
+        {
+            const __m128 g = _mm_set1_ps(gain);
+            size_t       i = 0;
+            for(; i + 4 <= frames; i += 4)
+            {
+                const __m128 l = _mm_loadu_ps(in[0] + i);
+                const __m128 r = _mm_loadu_ps(in[1] + i);
+                Packed<Format, 4>::Store(out + i * 2, _mm_unpacklo_ps(l, r), g);
+                Packed<Format, 4>::Store(
+                    out + i * 2 + 4, _mm_unpackhi_ps(l, r), g);
+            }
+            return i;
+        }
+    };
+#else
+    /** No packed float support on this target, everything is scalar */
+    template <typename Format, size_t kChans>
+    struct Packed
+    {
+        static FORCE_INLINE size_t
+        Deinterleave(const int32_t*, float* const*, size_t, float)
+        {
+            return 0;
+        }
+        static FORCE_INLINE size_t
+        Interleave(const float* const*, int32_t*, size_t, float)
+        {
+            return 0;
+        }
+    };
+#endif
+};
+
+} // namespace daisy
+
+#endif
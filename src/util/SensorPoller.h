@@ -0,0 +1,286 @@
+#pragma once
+#ifndef DSY_SENSOR_POLLER_H
+#define DSY_SENSOR_POLLER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "per/i2c.h"
+#include "util/DoubleBuffer.h"
+#include "sys/system.h"
+
+namespace daisy
+{
+/** The registers a driver reads in a single burst when it's polled */
+struct SensorPollWindow
+{
+    uint8_t  reg;       /**< first register */
+    uint8_t  size;      /**< number of bytes */
+    uint32_t period_ms; /**< time between two reads the driver suggests */
+};
+
+/** Called by a transport when a read of a poll window finished.
+ *  \param context the context that was passed when starting the read
+ *  \param success false if the read failed
+ */
+typedef void (*SensorPollCallback)(void* context, bool success);
+
+/** @brief Reads poll windows of an I2C device with queued DMA jobs
+ *  @ingroup utility
+ *
+ *  A helper for the I2C transports of the sensor drivers, it adapts the
+ *  I2CHandle DMA callback to a SensorPollCallback. Only one read can be
+ *  pending at a time, which SensorPoller takes care of.
+ */
+class SensorPollI2CReader
+{
+  public:
+    SensorPollI2CReader() : callback_(nullptr), context_(nullptr) {}
+
+    /** Reads size bytes starting at reg, see I2CHandle::ReadRegistersDma()
+     *  \return false if the read couldn't be started or queued
+     */
+    bool ReadRegisters(I2CHandle&         i2c,
+                       uint8_t            address,
+                       uint8_t            reg,
+                       uint8_t*           buff,
+                       uint16_t           size,
+                       SensorPollCallback callback,
+                       void*              context)
+    {
+        callback_ = callback;
+        context_  = context;
+        return i2c.ReadRegistersDma(
+                   address, reg, 1, buff, size, &ReadFinished, this)
+               == I2CHandle::Result::OK;
+    }
+
+    /** Reads size bytes without sending a register address first, for
+     *  devices that always start at the first register
+     *  \return false if the read couldn't be started or queued
+     */
+    bool Read(I2CHandle&         i2c,
+              uint8_t            address,
+              uint8_t*           buff,
+              uint16_t           size,
+              SensorPollCallback callback,
+              void*              context)
+    {
+        callback_ = callback;
+        context_  = context;
+        return i2c.ReceiveDma(address, buff, size, &ReadFinished, this)
+               == I2CHandle::Result::OK;
+    }
+
+  private:
+    static void ReadFinished(void* context, I2CHandle::Result result)
+    {
+        auto reader = static_cast<SensorPollI2CReader*>(context);
+        reader->callback_(reader->context_, result == I2CHandle::Result::OK);
+    }
+
+    SensorPollCallback callback_;
+    void*              context_;
+};
+
+/** @brief Polls sensors with non-blocking burst reads
+ *  @ingroup utility
+ *
+ *  Reading a sensor with blocking transfers stalls the main loop for the
+ *  whole transfer. The SensorPoller instead starts a DMA read of each
+ *  sensor's register window when it's due, and the driver decodes the
+ *  registers when the read has finished, usually in the DMA interrupt.
+ *  The drivers publish the result in a DoubleBuffer, so the application
+ *  reads the latest values lock-free, whenever it likes.
+ *
+ *  Reads of sensors on the same I2C bus, or on different busses that share
+ *  the DMA, are queued by the I2CHandle.
+ *
+ *  A driver that can be polled provides
+ *  - `SensorPollWindow GetPollWindow()`, the registers and the period,
+ *  - `bool StartPollRead(uint8_t* buff, SensorPollCallback callback,
+ *    void* context)`, which starts reading the window into buff and
+ *    returns false if that's not possible,
+ *  - `void DecodePoll(const uint8_t* regs)`, which decodes the window.
+ *
+ *  The window buffers are DMA targets, so the buffer passed to Init() must
+ *  be located in the D2 memory domain:
+ *
+ *      SensorPoller<>::DmaBuffer DMA_BUFFER_MEM_SECTION poll_buffer;
+ *      SensorPoller<> poller;
+ *      ...
+ *      poller.Init(poll_buffer);
+ *      poller.Add(dps310);
+ *      while(1)
+ *      {
+ *          poller.Process();
+ *          Dps310I2C::PolledData data;
+ *          if(dps310.GetPolledData(data))
+ *              ...
+ *      }
+ *
+ *  Don't use the blocking functions of a driver while it's polled.
+ *
+ *  @tparam kMaxSensors number of sensors that can be added
+ *  @tparam kBufferSize size of the DMA buffer, shared by all windows
+ */
+template <size_t kMaxSensors = 4, size_t kBufferSize = 128>
+class SensorPoller
+{
+  public:
+    /** A buffer for the windows of all sensors */
+    using DmaBuffer = uint8_t[kBufferSize];
+
+    enum class Result
+    {
+        OK,  /**< & */
+        ERR, /**< & */
+    };
+
+    SensorPoller()
+    : buffer_(nullptr),
+      buffer_used_(0),
+      num_sensors_(0),
+      num_errors_(0),
+      num_overruns_(0)
+    {
+    }
+
+    /** Initializes the poller and removes all sensors
+     *  \param buffer a buffer in the D2 memory domain
+     */
+    void Init(DmaBuffer& buffer)
+    {
+        buffer_      = buffer;
+        buffer_used_ = 0;
+        num_sensors_ = 0;
+        num_errors_.store(0, std::memory_order_relaxed);
+        num_overruns_ = 0;
+    }
+
+    /** Adds a sensor. It's read for the first time on the next Process().
+     *  \param sensor an initialized driver, see the class description
+     *  \param period_ms time between two reads, 0 for the period the
+     *         driver suggests
+     *  \return Result::ERR if the poller is full or its buffer is too small
+     */
+    template <typename Sensor>
+    Result Add(Sensor& sensor, uint32_t period_ms = 0)
+    {
+        const SensorPollWindow window = sensor.GetPollWindow();
+        if(buffer_ == nullptr || num_sensors_ >= kMaxSensors
+           || window.size > kBufferSize - buffer_used_)
+            return Result::ERR;
+
+        Slot& slot     = slots_[num_sensors_];
+        slot.sensor    = &sensor;
+        slot.start     = &StartRead<Sensor>;
+        slot.decode    = &Decode<Sensor>;
+        slot.poller    = this;
+        slot.buffer    = buffer_ + buffer_used_;
+        slot.period_ms = period_ms > 0 ? period_ms : window.period_ms;
+        slot.next_ms   = System::GetNow();
+        slot.busy.store(false, std::memory_order_relaxed);
+        buffer_used_ += window.size;
+        num_sensors_++;
+        return Result::OK;
+    }
+
+    /** Starts the reads that are due and returns right away. Call this
+     *  regularly, e.g. from the main loop or a timer interrupt.
+     */
+    void Process()
+    {
+        const uint32_t now = System::GetNow();
+        for(size_t i = 0; i < num_sensors_; i++)
+        {
+            Slot& slot = slots_[i];
+            if(int32_t(now - slot.next_ms) < 0)
+                continue;
+
+            // keep the period, unless the poller fell behind by a period
+            slot.next_ms += slot.period_ms;
+            if(int32_t(now - slot.next_ms) >= 0)
+                slot.next_ms = now + slot.period_ms;
+
+            if(slot.busy.load(std::memory_order_acquire))
+            {
+                num_overruns_++;
+                continue;
+            }
+            slot.busy.store(true, std::memory_order_relaxed);
+            if(!slot.start(slot.sensor, slot.buffer, &ReadFinished, &slot))
+            {
+                slot.busy.store(false, std::memory_order_relaxed);
+                num_errors_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /** Returns the number of sensors that were added */
+    size_t GetNumSensors() const { return num_sensors_; }
+
+    /** Returns the number of reads that couldn't be started or failed */
+    uint32_t GetNumErrors() const
+    {
+        return num_errors_.load(std::memory_order_relaxed);
+    }
+
+    /** Returns the number of reads that were skipped because the previous
+     *  read of the sensor didn't finish in time
+     */
+    uint32_t GetNumOverruns() const { return num_overruns_; }
+
+  private:
+    struct Slot
+    {
+        void* sensor;
+        bool (*start)(void*              sensor,
+                      uint8_t*           buff,
+                      SensorPollCallback callback,
+                      void*              context);
+        void (*decode)(void* sensor, const uint8_t* regs);
+        SensorPoller*     poller;
+        uint8_t*          buffer;
+        uint32_t          period_ms;
+        uint32_t          next_ms;
+        std::atomic<bool> busy;
+    };
+
+    template <typename Sensor>
+    static bool StartRead(void*              sensor,
+                          uint8_t*           buff,
+                          SensorPollCallback callback,
+                          void*              context)
+    {
+        return static_cast<Sensor*>(sensor)->StartPollRead(
+            buff, callback, context);
+    }
+
+    template <typename Sensor>
+    static void Decode(void* sensor, const uint8_t* regs)
+    {
+        static_cast<Sensor*>(sensor)->DecodePoll(regs);
+    }
+
+    static void ReadFinished(void* context, bool success)
+    {
+        Slot& slot = *static_cast<Slot*>(context);
+        if(success)
+            slot.decode(slot.sensor, slot.buffer);
+        else
+            slot.poller->num_errors_.fetch_add(1, std::memory_order_relaxed);
+        slot.busy.store(false, std::memory_order_release);
+    }
+
+    Slot                  slots_[kMaxSensors];
+    uint8_t*              buffer_;
+    size_t                buffer_used_;
+    size_t                num_sensors_;
+    std::atomic<uint32_t> num_errors_;
+    uint32_t              num_overruns_;
+};
+
+} // namespace daisy
+
+#endif
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace daisy
+{
+/** @brief Lock-free single-producer, single-consumer queue
+ *  @ingroup utility
+ *
+ *  A queue for handing data from exactly one producer to exactly one
+ *  consumer, e.g. from an interrupt handler to the main loop, without
+ *  ever disabling interrupts.
+ *
+ *  - Only the producer may call PushBack().
+ *  - Only the consumer may call PopFront(), Peek() and Clear().
+ *  - The other functions can be called from both sides, but the result
+ *    may be outdated by the time it's used.
+ *
+ *  The read and write positions are atomics, and the elements are
+ *  published with release/acquire ordering, which makes this safe with
+ *  the Cortex-M7's memory model as well as between host threads.
+ *
+ *  @tparam T         element type, has to be copy assignable
+ *  @tparam kCapacity maximum number of elements, a power of two
+ */
+template <typename T, size_t kCapacity>
+class SpscQueue
+{
+  public:
+    static_assert(kCapacity > 0 && (kCapacity & (kCapacity - 1)) == 0,
+                  "kCapacity has to be a power of two");
+
+    SpscQueue() : write_(0), read_(0) {}
+
+    /** Adds an element to the back of the queue.
+     *  Producer only.
+     *  @return false if the queue is full
+     */
+    bool PushBack(const T& element)
+    {
+        const uint32_t w = write_.load(std::memory_order_relaxed);
+        if(w - read_.load(std::memory_order_acquire) >= kCapacity)
+            return false;
+        buffer_[w & kMask] = element;
+        write_.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Adds up to num elements to the back of the queue at once.
+     *  Producer only.
+     *  @return the number of elements added, less than num if the queue
+     *          ran full
+     */
+    size_t PushBack(const T* elements, size_t num)
+    {
+        const uint32_t w    = write_.load(std::memory_order_relaxed);
+        const uint32_t r    = read_.load(std::memory_order_acquire);
+        const size_t   free = kCapacity - (w - r);
+        if(num > free)
+            num = free;
+        for(size_t i = 0; i < num; i++)
+            buffer_[(w + i) & kMask] = elements[i];
+        write_.store(w + uint32_t(num), std::memory_order_release);
+        return num;
+    }
+
+    /** Removes the element at the front of the queue.
+     *  Consumer only.
+     *  @param element receives the element
+     *  @return false if the queue was empty
+     */
+    bool PopFront(T& element)
+    {
+        const uint32_t r = read_.load(std::memory_order_relaxed);
+        if(write_.load(std::memory_order_acquire) == r)
+            return false;
+        element = buffer_[r & kMask];
+        read_.store(r + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Removes up to max_num elements from the front of the queue at once.
+     *  Consumer only.
+     *  @param elements receives the elements
+     *  @param max_num  maximum number of elements to remove
+     *  @return the number of elements removed
+     */
+    size_t PopFront(T* elements, size_t max_num)
+    {
+        const uint32_t r   = read_.load(std::memory_order_relaxed);
+        size_t         num = write_.load(std::memory_order_acquire) - r;
+        if(num > max_num)
+            num = max_num;
+        for(size_t i = 0; i < num; i++)
+            elements[i] = buffer_[(r + i) & kMask];
+        read_.store(r + uint32_t(num), std::memory_order_release);
+        return num;
+    }
+
+    /** Copies the element at the front of the queue without removing it.
+     *  Consumer only.
+     *  @return false if the queue is empty
+     */
+    bool Peek(T& element) const
+    {
+        const uint32_t r = read_.load(std::memory_order_relaxed);
+        if(write_.load(std::memory_order_acquire) == r)
+            return false;
+        element = buffer_[r & kMask];
+        return true;
+    }
+
+    /** Removes all elements. Consumer only. */
+    void Clear()
+    {
+        read_.store(write_.load(std::memory_order_acquire),
+                    std::memory_order_release);
+    }
+
+    /** Returns the number of elements in the queue */
+    size_t GetNumElements() const
+    {
+        // read first, it can only fall behind the write position
+        const uint32_t r = read_.load(std::memory_order_acquire);
+        return write_.load(std::memory_order_acquire) - r;
+    }
+
+    /** Returns true if the queue is empty */
+    bool IsEmpty() const { return GetNumElements() == 0; }
+
+    /** Returns true if the queue is full */
+    bool IsFull() const { return GetNumElements() >= kCapacity; }
+
+    /** Returns the total capacity */
+    constexpr size_t GetCapacity() const { return kCapacity; }
+
+  private:
+    static constexpr uint32_t kMask = kCapacity - 1;
+
+    // free running positions, their difference is the number of elements
+    std::atomic<uint32_t> write_;
+    std::atomic<uint32_t> read_;
+    T                     buffer_[kCapacity];
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+};
+
+} // namespace daisy
@@ -0,0 +1,311 @@
+#pragma once
+#ifndef DSY_TRACE_H
+#define DSY_TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <atomic>
+#include "sys/system.h"
+
+/** Set to 1 to record the trace events of the library, e.g. with
+ *  -DDSY_TRACE=1. When 0, the DSY_TRACE_ macros compile to nothing.
+ */
+#ifndef DSY_TRACE
+#define DSY_TRACE 0
+#endif
+
+/** Number of records kept, a power of two. Each takes 8 bytes. */
+#ifndef DSY_TRACE_SIZE
+#define DSY_TRACE_SIZE 1024
+#endif
+
+/** Events recorded by the library */
+#define DSY_TRACE_EVENTS(X) \
+    X(AUDIO_CALLBACK)       \
+    X(SAI_DMA_HALF)         \
+    X(SAI_DMA_COMPLETE)     \
+    X(SPI_DMA_DONE)         \
+    X(I2C_DMA_DONE)
+
+/** Additional events of the application, defined for the whole build, e.g.
+ *  -D'DSY_TRACE_USER_EVENTS(X)=X(UI_UPDATE) X(SENSOR_READ)'
+ */
+#ifndef DSY_TRACE_USER_EVENTS
+#define DSY_TRACE_USER_EVENTS(X)
+#endif
+
+namespace daisy
+{
+/** IDs of the events that can be traced
+ *  @ingroup utility
+ */
+enum class TraceEvent : uint8_t
+{
+#define DSY_TRACE_ENUM(name) name,
+    DSY_TRACE_EVENTS(DSY_TRACE_ENUM) DSY_TRACE_USER_EVENTS(DSY_TRACE_ENUM)
+#undef DSY_TRACE_ENUM
+        NUM_EVENTS,
+};
+
+/** @brief Records timestamped events into a ring of binary records
+ *  @ingroup utility
+ *
+ *  Meant for instrumenting interrupt handlers and the audio callback,
+ *  where printing isn't an option: recording an event takes a few
+ *  instructions, a timestamp from System::GetTick() and an 8 byte store.
+ *  When the ring is full, the oldest records are overwritten, so the ring
+ *  always holds the most recent history.
+ *
+ *  Begin()/End() mark the duration of something, e.g. a callback,
+ *  Instant() a point in time and Counter() a value over time. All of them
+ *  can be called from any context.
+ *
+ *  Dump() stops recording and sends the records as text over a Logger,
+ *  ci/trace_decode.py turns a capture of that into a Chrome trace / Perfetto
+ *  timeline.
+ *
+ *  The library records its own events when built with DSY_TRACE=1, the
+ *  DSY_TRACE_ macros record only then as well.
+ *
+ *  @tparam kNumRecords number of records in the ring, a power of two
+ */
+template <size_t kNumRecords = DSY_TRACE_SIZE>
+class Tracer
+{
+  public:
+    static_assert((kNumRecords & (kNumRecords - 1)) == 0,
+                  "kNumRecords has to be a power of two");
+
+    /** What a record marks, the Chrome trace event phase */
+    enum class Phase : uint8_t
+    {
+        BEGIN   = 'B',
+        END     = 'E',
+        INSTANT = 'i',
+        COUNTER = 'C',
+    };
+
+    /** A single record */
+    struct Record
+    {
+        uint32_t tick;
+        uint8_t  event;
+        Phase    phase;
+        uint16_t value;
+    };
+
+    /** Marks the start of a duration */
+    static void Begin(TraceEvent event, uint16_t value = 0)
+    {
+        Write(event, Phase::BEGIN, value);
+    }
+
+    /** Marks the end of the duration started last */
+    static void End(TraceEvent event) { Write(event, Phase::END, 0); }
+
+    /** Marks a point in time */
+    static void Instant(TraceEvent event, uint16_t value = 0)
+    {
+        Write(event, Phase::INSTANT, value);
+    }
+
+    /** Records a value */
+    static void Counter(TraceEvent event, uint16_t value)
+    {
+        Write(event, Phase::COUNTER, value);
+    }
+
+    /** (Re)starts recording, the ring is emptied */
+    static void Start()
+    {
+        head_.store(0, std::memory_order_relaxed);
+        running_.store(true, std::memory_order_release);
+    }
+
+    /** Stops recording, e.g. to dump the ring */
+    static void Stop() { running_.store(false, std::memory_order_release); }
+
+    /** Returns true while recording */
+    static bool IsRunning() { return running_.load(std::memory_order_relaxed); }
+
+    /** Returns the number of records in the ring */
+    static size_t GetNumRecords()
+    {
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        return head < kNumRecords ? head : kNumRecords;
+    }
+
+    /** Returns the number of records that were overwritten */
+    static uint32_t GetNumOverwritten()
+    {
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        return head < kNumRecords ? 0 : head - kNumRecords;
+    }
+
+    /** Returns a record, 0 being the oldest one in the ring */
+    static const Record& GetRecord(size_t idx)
+    {
+        return records_[(GetNumOverwritten() + idx) & (kNumRecords - 1)];
+    }
+
+    /** Returns the name of an event, "" for unknown IDs */
+    static const char* GetEventName(uint8_t event)
+    {
+        static const char* const names[] = {
+#define DSY_TRACE_NAME(name) #name,
+            DSY_TRACE_EVENTS(DSY_TRACE_NAME)
+                DSY_TRACE_USER_EVENTS(DSY_TRACE_NAME)
+#undef DSY_TRACE_NAME
+        };
+        return event < uint8_t(TraceEvent::NUM_EVENTS) ? names[event] : "";
+    }
+
+    /** Formats a line of the dump. Recording should be stopped.
+     *  \param line index of the line, from 0
+     *  \param out receives the text, without a newline
+     *  \param size size of out, at least kDumpLineSize
+     *  \return false if there are no more lines
+     */
+    static bool GetDumpLine(size_t line, char* out, size_t size)
+    {
+        const size_t num_events = size_t(TraceEvent::NUM_EVENTS);
+        const size_t num_data
+            = (GetNumRecords() + kRecordsPerLine - 1) / kRecordsPerLine;
+        if(line == 0)
+        {
+            snprintf(out,
+                     size,
+                     "#trace start %lu %lu %lu",
+                     (unsigned long)System::GetTickFreq(),
+                     (unsigned long)GetNumRecords(),
+                     (unsigned long)GetNumOverwritten());
+            return true;
+        }
+        line--;
+        if(line < num_events)
+        {
+            snprintf(out,
+                     size,
+                     "#trace event %u %s",
+                     unsigned(line),
+                     GetEventName(line));
+            return true;
+        }
+        line -= num_events;
+        if(line < num_data)
+        {
+            // tick, event, phase and value as fixed width hex
+            int len = snprintf(out, size, "#trace data ");
+            for(size_t i = line * kRecordsPerLine;
+                i < (line + 1) * kRecordsPerLine && i < GetNumRecords();
+                i++)
+            {
+                const Record& record = GetRecord(i);
+                len += snprintf(out + len,
+                                size - len,
+                                "%08lx%02x%02x%04x",
+                                (unsigned long)record.tick,
+                                record.event,
+                                unsigned(record.phase),
+                                record.value);
+            }
+            return true;
+        }
+        if(line == num_data)
+        {
+            snprintf(out, size, "#trace end");
+            return true;
+        }
+        return false;
+    }
+
+    /** Stops recording and sends the ring over a Logger, e.g.
+     *  Trace::Dump<DaisySeed::Log>(). Blocks until everything was sent,
+     *  only call it from the main loop.
+     */
+    template <typename Log>
+    static void Dump()
+    {
+        Stop();
+        char line[kDumpLineSize];
+        for(size_t i = 0; GetDumpLine(i, line, sizeof(line)); i++)
+        {
+            Log::PrintLine("%s", line);
+            // the queue of the Logger never has to drop a line
+            Log::Flush();
+        }
+    }
+
+    /** Number of records per line of a dump */
+    static constexpr size_t kRecordsPerLine = 6;
+    /** Size of the longest line of a dump, with the terminator */
+    static constexpr size_t kDumpLineSize = 12 + 16 * kRecordsPerLine + 1;
+
+  private:
+    static void Write(TraceEvent event, Phase phase, uint16_t value)
+    {
+        if(!running_.load(std::memory_order_relaxed))
+            return;
+        const uint32_t tick = System::GetTick();
+        const uint32_t idx  = head_.fetch_add(1, std::memory_order_relaxed);
+        Record&        record = records_[idx & (kNumRecords - 1)];
+        record.tick           = tick;
+        record.event          = uint8_t(event);
+        record.phase          = phase;
+        record.value          = value;
+    }
+
+    static Record                records_[kNumRecords];
+    static std::atomic<uint32_t> head_;
+    static std::atomic<bool>     running_;
+};
+
+template <size_t kNumRecords>
+typename Tracer<kNumRecords>::Record Tracer<kNumRecords>::records_[kNumRecords];
+
+template <size_t kNumRecords>
+std::atomic<uint32_t> Tracer<kNumRecords>::head_(0);
+
+template <size_t kNumRecords>
+std::atomic<bool> Tracer<kNumRecords>::running_(false);
+
+/** The trace the library records to */
+using Trace = Tracer<>;
+
+/** Records the duration of the enclosing scope */
+class TraceScope
+{
+  public:
+    TraceScope(TraceEvent event, uint16_t value = 0) : event_(event)
+    {
+        Trace::Begin(event, value);
+    }
+    ~TraceScope() { Trace::End(event_); }
+
+  private:
+    TraceEvent event_;
+};
+
+} // namespace daisy
+
+#if DSY_TRACE
+#define DSY_TRACE_CONCAT_NX(A, B) A##B
+#define DSY_TRACE_CONCAT(A, B) DSY_TRACE_CONCAT_NX(A, B)
+/** Records the duration of the enclosing scope, with an optional value */
+#define DSY_TRACE_SCOPE(event, ...)                             \
+    daisy::TraceScope DSY_TRACE_CONCAT(dsy_trace_, __LINE__)( \
+        daisy::TraceEvent::event, ##__VA_ARGS__)
+/** Records a point in time, with an optional value */
+#define DSY_TRACE_INSTANT(event, ...) \
+    daisy::Trace::Instant(daisy::TraceEvent::event, ##__VA_ARGS__)
+/** Records a value */
+#define DSY_TRACE_COUNTER(event, value) \
+    daisy::Trace::Counter(daisy::TraceEvent::event, value)
+#else
+#define DSY_TRACE_SCOPE(event, ...)
+#define DSY_TRACE_INSTANT(event, ...)
+#define DSY_TRACE_COUNTER(event, value)
+#endif
+
+#endif
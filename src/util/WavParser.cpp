@@ -0,0 +1,122 @@
+#include "util/WavParser.h"
+
+using namespace daisy;
+
+namespace
+{
+uint16_t GetU16(const uint8_t* src)
+{
+    return uint16_t(src[0] | (src[1] << 8));
+}
+
+uint32_t GetU32(const uint8_t* src)
+{
+    return uint32_t(GetU16(src)) | (uint32_t(GetU16(src + 2)) << 16);
+}
+
+template <typename Sample>
+void DecodeSamples(const uint8_t* src, float* dst, size_t num_samples)
+{
+    for(size_t i = 0; i < num_samples; i++)
+    {
+        dst[i] = Sample::ToFloat(src);
+        src += Sample::kBytes;
+    }
+}
+} // namespace
+
+bool WavParser::ReadHeader(FIL* fil, Format& format, size_t max_channels)
+{
+    uint8_t header[12];
+    UINT    bytes_read;
+    if(f_read(fil, header, sizeof(header), &bytes_read) != FR_OK
+       || bytes_read != sizeof(header) || GetU32(header) != kWavFileChunkId
+       || GetU32(header + 8) != kWavFileWaveId)
+        return false;
+
+    // walk the chunks up to the data
+    bool has_format = false;
+    while(true)
+    {
+        if(f_read(fil, header, 8, &bytes_read) != FR_OK || bytes_read != 8)
+            return false;
+        const uint32_t id         = GetU32(header);
+        const uint32_t chunk_size = GetU32(header + 4);
+        const uint32_t chunk_pos  = f_tell(fil);
+
+        if(id == kWavFileSubChunk1Id)
+        {
+            uint8_t fmt[40] = {};
+            if(chunk_size < 16
+               || f_read(fil,
+                         fmt,
+                         chunk_size < sizeof(fmt) ? chunk_size : sizeof(fmt),
+                         &bytes_read)
+                      != FR_OK)
+                return false;
+
+            uint16_t       code     = GetU16(fmt);
+            const uint16_t channels = GetU16(fmt + 2);
+            const uint16_t bits     = GetU16(fmt + 14);
+            // the sub format GUID starts with the format code
+            if(code == WAVE_FORMAT_EXTENSIBLE && bytes_read >= 26)
+                code = GetU16(fmt + 24);
+
+            if(code == WAVE_FORMAT_PCM && bits == 16)
+                format.sample_format = SampleFormat::S16;
+            else if(code == WAVE_FORMAT_PCM && bits == 24)
+                format.sample_format = SampleFormat::S24;
+            else if(code == WAVE_FORMAT_PCM && bits == 32)
+                format.sample_format = SampleFormat::S32;
+            else if(code == WAVE_FORMAT_IEEE_FLOAT && bits == 32)
+                format.sample_format = SampleFormat::F32;
+            else
+                return false;
+
+            format.num_channels = channels;
+            format.samplerate   = GetU32(fmt + 4);
+            format.block_align  = GetU16(fmt + 12);
+            if(channels == 0 || channels > max_channels
+               || format.block_align != channels * (bits / 8))
+                return false;
+            has_format = true;
+        }
+        else if(id == kWavFileSubChunk2Id)
+        {
+            if(!has_format)
+                return false;
+            // files that weren't closed properly may have a wrong size
+            const uint32_t in_file = f_size(fil) - chunk_pos;
+            const uint32_t size = chunk_size < in_file ? chunk_size : in_file;
+            format.data_offset  = chunk_pos;
+            format.data_size    = size - size % format.block_align;
+            return true;
+        }
+
+        // chunks are padded to an even size
+        if(f_lseek(fil, chunk_pos + chunk_size + (chunk_size & 1)) != FR_OK)
+            return false;
+    }
+}
+
+void WavParser::Decode(SampleFormat   format,
+                       const uint8_t* src,
+                       float*         dst,
+                       size_t         num_samples)
+{
+    switch(format)
+    {
+        case SampleFormat::S16:
+            DecodeSamples<S16>(src, dst, num_samples);
+            break;
+        case SampleFormat::S24:
+            DecodeSamples<S24>(src, dst, num_samples);
+            break;
+        case SampleFormat::S32:
+            DecodeSamples<S32>(src, dst, num_samples);
+            break;
+        case SampleFormat::F32:
+            DecodeSamples<F32>(src, dst, num_samples);
+            break;
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+#ifndef DSY_WAV_PARSER_H
+#define DSY_WAV_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "daisy_core.h"
+#include "util/wav_format.h"
+#include "ff.h"
+
+namespace daisy
+{
+/** @brief Reads the format and the audio data of .wav files
+ *  @ingroup utility
+ *
+ *  ReadHeader() walks the RIFF chunks of a file up to the "data" chunk, so
+ *  files with "LIST", "fact" or other chunks before the data are read
+ *  correctly. The sample decoders convert the little endian file data to
+ *  float, bit-exact with s162f/s242f/s322f.
+ *
+ *  Supported are 16, 24 and 32 bit integer and 32 bit float data,
+ *  including WAVE_FORMAT_EXTENSIBLE headers.
+ */
+class WavParser
+{
+  public:
+    enum class SampleFormat
+    {
+        S16,
+        S24,
+        S32,
+        F32,
+    };
+
+    /** Format and location of the audio data of a file */
+    struct Format
+    {
+        SampleFormat sample_format;
+        uint16_t     num_channels;
+        /** bytes per frame */
+        uint16_t block_align;
+        uint32_t samplerate;
+        /** where the audio data starts in the file, and its size in bytes */
+        uint32_t data_offset;
+        uint32_t data_size;
+    };
+
+    /** Reads the header of a file opened for reading, and leaves the file
+     *  at the start of the audio data.
+     *  The data size is limited to the whole frames in the file, for files
+     *  that weren't closed properly.
+     *  \param fil the file, at its start
+     *  \param format filled in with the format of the file
+     *  \param max_channels files with more channels are rejected
+     *  \return false if the file isn't a supported .wav file
+     */
+    static bool ReadHeader(FIL* fil, Format& format, size_t max_channels);
+
+    /** Returns the size of one sample in the file */
+    static size_t GetSampleSize(SampleFormat format)
+    {
+        return format == SampleFormat::S16   ? S16::kBytes
+               : format == SampleFormat::S24 ? S24::kBytes
+                                             : S32::kBytes;
+    }
+
+    /** Converts a block of samples to float, keeping their order.
+     *  \param format format of the samples
+     *  \param src file data, num_samples * GetSampleSize() bytes
+     *  \param dst num_samples floats
+     *  \param num_samples number of samples
+     */
+    static void Decode(SampleFormat   format,
+                       const uint8_t* src,
+                       float*         dst,
+                       size_t         num_samples);
+
+    // Decoding of one sample from the little endian file data
+
+    struct S16
+    {
+        static constexpr size_t kBytes = 2;
+        static FORCE_INLINE float ToFloat(const uint8_t* src)
+        {
+            int16_t x;
+            memcpy(&x, src, sizeof(x));
+            return s162f(x);
+        }
+    };
+
+    struct S24
+    {
+        static constexpr size_t kBytes = 3;
+        static FORCE_INLINE float ToFloat(const uint8_t* src)
+        {
+            return s242f(int32_t(src[0] | (src[1] << 8) | (src[2] << 16)));
+        }
+    };
+
+    struct S32
+    {
+        static constexpr size_t kBytes = 4;
+        static FORCE_INLINE float ToFloat(const uint8_t* src)
+        {
+            int32_t x;
+            memcpy(&x, src, sizeof(x));
+            return s322f(x);
+        }
+    };
+
+    struct F32
+    {
+        static constexpr size_t kBytes = 4;
+        static FORCE_INLINE float ToFloat(const uint8_t* src)
+        {
+            float x;
+            memcpy(&x, src, sizeof(x));
+            return x;
+        }
+    };
+};
+
+} // namespace daisy
+
+#endif
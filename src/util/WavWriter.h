@@ -1,41 +1,54 @@
 #pragma once
-#pragma once
-#include "fatfs.h"
+#include <string.h>
+#include <stddef.h>
+#include <atomic>
+#include "ff.h"
+#include "util/wav_format.h"
+#include "util/SampleConversion.h"
 
 namespace daisy
 {
 /** Audio Recording Module
- ** 
- ** Record audio into a working buffer that is gradually written to a WAV file on an SD Card. 
  **
- ** Recordings are made with floating point input, and will be converted to the 
- ** specified bits per sample internally 
+ ** Record audio into a working buffer that is gradually written to a WAV file on an SD Card.
  **
- ** For now only 16-bit and 32-bit (signed int) formats are supported
- ** f32 and s24 formats will be added next
+ ** Recordings are made with floating point input, and will be converted to the
+ ** specified format internally: 16, 24 or 32-bit signed int, or 32-bit float.
+ ** Whole blocks are converted with the same kernels as the audio engine.
+ ** Float files get the extended fmt chunk and the fact chunk that the WAV
+ ** format requires for anything but PCM.
  **
- ** The transfer size determines the amount of internal memory used, and can have an
- ** effect on the performance of the streaming behavior of the WavWriter.
- ** Memory use can be calculated as: (2 * transfer_size) bytes
+ ** The audio is collected in a ring of num_chunks chunks of transfer_size bytes.
+ ** Full chunks wait for Write() while the next one is filled, so with more
+ ** chunks the recording survives longer SD card stalls. If all other chunks
+ ** are still waiting when one is full, that chunk is dropped instead, and
+ ** counted in GetDroppedChunks().
+ ** Memory use can be calculated as: (num_chunks * transfer_size + 1024) bytes
  ** Performance optimal with sizes: 16384, 32768
- ** 
+ **
  ** To use:
  ** 1. Create a WavWriter<size> object (e.g. WavWriter<32768> writer)
  ** 2. Configure the settings as desired by creating a WavWriter<32768>::Config struct and setting the settings.
  ** 3. Initialize the object with the configuration struct.
  ** 4. Open a new file for writing with: writer.OpenFile("FileName.wav")
- ** 5. Write to it within your audio callback using: writer.Sample(value)
+ ** 5. Write to it within your audio callback using: writer.SampleBlock(in, size)
+ **    or one frame at a time with writer.Sample(value)
  ** 6. Fill the Wav File on the SD Card with data from your main loop by running: writer.Write()
  ** 7. When finished with the recording finalize, and close the file with: writer.SaveFile();
- ** 
+ **
  ** */
-template <size_t transfer_size>
+template <size_t transfer_size, size_t num_chunks = 2>
 class WavWriter
 {
   public:
+    static_assert(num_chunks >= 2, "at least two chunks are needed");
+
     WavWriter() {}
     ~WavWriter() {}
 
+    /** Maximum number of channels */
+    static constexpr size_t kMaxChannels = 16;
+
     /** Return values for write related functions */
     enum class Result
     {
@@ -48,125 +61,154 @@ class WavWriter
     struct Config
     {
         float   samplerate;
+        /** 1 to kMaxChannels */
         int32_t channels;
+        /** 16, 24 or 32 */
         int32_t bitspersample;
+        /** writes 32-bit float samples, ignoring bitspersample */
+        bool floatingpoint = false;
     };
 
-    /** State of the internal Writing mechanism. 
-     ** When the buffer is a certain amount full one section will write its contents
-     ** while the other is still being written to. This is performed circularly
-     ** so that audio will be uninterrupted during writing. */
-    enum class BufferState
+    /**  Initializes the WavFile header, and prepares the object for recording.
+     **  \return ERROR if the channels or bitspersample aren't supported, or
+     **  while recording. OpenFile() fails until the next successful Init(). */
+    Result Init(const Config &cfg)
     {
-        IDLE,
-        FLUSH0,
-        FLUSH1,
-    };
+        if(IsRecording())
+            return Result::ERROR;
+        const int32_t bits = cfg.floatingpoint ? 32 : cfg.bitspersample;
+        if(cfg.channels < 1 || cfg.channels > int32_t(kMaxChannels)
+           || (bits != 16 && bits != 24 && bits != 32)
+           || size_t(cfg.channels * bits / 8) > transfer_size)
+        {
+            block_align_ = 0;
+            return Result::ERROR;
+        }
+        cfg_               = cfg;
+        cfg_.bitspersample = bits;
 
-    /**  Initializes the WavFile header, and prepares the object for recording. */
-    void Init(const Config &cfg)
-    {
-        cfg_       = cfg;
-        num_samps_ = 0;
+        num_samps_   = 0;
+        data_bytes_  = 0;
+        block_align_ = cfg_.channels * cfg_.bitspersample / 8;
+        // chunks hold whole frames, so dropping one keeps the channels in order
+        chunk_bytes_ = transfer_size - transfer_size % block_align_;
+        kernel_      = GetKernel();
         // Prep the wav header according to config.
         // Certain things (i.e. Size, etc. will have to wait until the finalization of the file, or be updated while streaming).
         wavheader_.ChunkId       = kWavFileChunkId;     /** "RIFF" */
         wavheader_.FileFormat    = kWavFileWaveId;      /** "WAVE" */
         wavheader_.SubChunk1ID   = kWavFileSubChunk1Id; /** "fmt " */
-        wavheader_.SubChunk1Size = 16;                  // for PCM
-        wavheader_.AudioFormat   = WAVE_FORMAT_PCM;
+        wavheader_.SubChunk1Size = cfg_.floatingpoint ? 18 : 16;
+        wavheader_.AudioFormat   = cfg_.floatingpoint ? WAVE_FORMAT_IEEE_FLOAT
+                                                      : WAVE_FORMAT_PCM;
         wavheader_.NbrChannels   = cfg.channels;
         wavheader_.SampleRate    = static_cast<int>(cfg.samplerate);
         wavheader_.ByteRate      = CalcByteRate();
-        wavheader_.BlockAlign    = cfg_.channels * cfg_.bitspersample / 8;
+        wavheader_.BlockAlign    = block_align_;
         wavheader_.BitPerSample  = cfg_.bitspersample;
         wavheader_.SubChunk2ID   = kWavFileSubChunk2Id; /** "data" */
         /** Also calcs SubChunk2Size */
         wavheader_.FileSize = CalcFileSize();
         // This is calculated as part of the subchunk size
+        return Result::OK;
+    }
+
+    /** Records a block of samples into the working buffer,
+     ** queues writes to media when necessary.
+     **
+     ** \param in one buffer per channel
+     ** \param frames number of samples in each buffer */
+    void SampleBlock(const float *const *in, size_t frames)
+    {
+        if(!IsRecording())
+            return;
+        const size_t max_frames = kScratchSamples / cfg_.channels;
+        const float *chans[kMaxChannels];
+        size_t       done = 0;
+        while(done < frames)
+        {
+            size_t num = (chunk_bytes_ - fill_pos_) / block_align_;
+            if(num > frames - done)
+                num = frames - done;
+            if(num > max_frames)
+                num = max_frames;
+            for(int32_t c = 0; c < cfg_.channels; c++)
+                chans[c] = in[c] + done;
+            uint8_t *dst = GetChunk(filled_.load(std::memory_order_relaxed));
+            Convert(chans, dst + fill_pos_, num);
+            fill_pos_ += num * block_align_;
+            num_samps_ += num;
+            done += num;
+            if(fill_pos_ == chunk_bytes_)
+                QueueChunk();
+        }
     }
 
     /** Records the current sample into the working buffer,
-     ** queues writes to media when necessary. 
-     ** 
+     ** queues writes to media when necessary.
+     **
      ** \param in should be a pointer to an array of samples */
     void Sample(const float *in)
     {
-        for(size_t i = 0; i < cfg_.channels; i++)
-        {
-            switch(cfg_.bitspersample)
-            {
-                case 16:
-                {
-                    int16_t *tp;
-                    tp            = (int16_t *)transfer_buff;
-                    tp[wptr_ + i] = f2s16(in[i]);
-                }
-                break;
-                case 32: transfer_buff[wptr_ + i] = f2s32(in[i]); break;
-                default: break;
-            }
-        }
-        num_samps_++;
-        wptr_ += cfg_.channels;
-        size_t cap_point
-            = cfg_.bitspersample == 16 ? kTransferSamps * 2 : kTransferSamps;
-        if(wptr_ == cap_point)
-        {
-            bstate_ = BufferState::FLUSH0;
-        }
-        if(wptr_ >= cap_point * 2)
-        {
-            wptr_   = 0;
-            bstate_ = BufferState::FLUSH1;
-        }
+        const float *chans[kMaxChannels];
+        for(int32_t c = 0; c < cfg_.channels; c++)
+            chans[c] = &in[c];
+        SampleBlock(chans, 1);
     }
 
-    /** Check buffer state and write */
+    /** Writes all full chunks to the file.
+     ** Call this from the main loop often enough to keep up with the audio. */
     void Write()
     {
-        if(bstate_ != BufferState::IDLE && IsRecording())
-        {
-            uint32_t     offset;
-            unsigned int bw = 0;
-            //offset          = bstate_ == BufferState::FLUSH0 ? 0 : transfer_size;
-            offset  = bstate_ == BufferState::FLUSH0 ? 0 : kTransferSamps;
-            bstate_ = BufferState::IDLE;
-            f_write(&fp_, &transfer_buff[offset], transfer_size, &bw);
-        }
+        if(IsRecording())
+            WriteFullChunks();
     }
 
     /** Finalizes the writing of the WAV file.
-     ** This overwrites the WAV Header with the correct
-     ** final size, and closes the fptr. */
-    void SaveFile()
+     ** This writes the remaining audio, overwrites the WAV Header with the
+     ** correct final size, and closes the fptr. */
+    Result SaveFile()
     {
-        unsigned int bw = 0;
-        recording_      = false;
-        // We _should_ flush whatever's left in the transfer buff
-        // TODO: that.
-        wavheader_.FileSize = CalcFileSize();
-        f_lseek(&fp_, 0);
-        f_write(&fp_, &wavheader_, sizeof(wavheader_), &bw);
-        f_close(&fp_);
+        if(!IsRecording())
+            return Result::ERROR;
+        // the audio callback doesn't add anything from here on
+        recording_.store(false, std::memory_order_release);
+        WriteFullChunks();
+        if(fill_pos_ > 0)
+            WriteChunk(GetChunk(filled_.load(std::memory_order_relaxed)),
+                       fill_pos_);
+
+        const bool ok = f_lseek(&fp_, 0) == FR_OK && WriteHeader();
+        return f_close(&fp_) == FR_OK && ok ? Result::OK : Result::ERROR;
     }
 
-    /** Opens a file for writing. Writes the initial WAV Header, and gets ready for stream-based recording. */
-    void OpenFile(const char *name)
+    /** Opens a file for writing. Writes the initial WAV Header, and gets ready for stream-based recording.
+     ** Fails without a successful Init(). */
+    Result OpenFile(const char *name)
     {
-        if(f_open(&fp_, name, FA_WRITE | FA_CREATE_ALWAYS) == FR_OK)
+        if(IsRecording() || block_align_ == 0
+           || f_open(&fp_, name, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK)
+            return Result::ERROR;
+        num_samps_  = 0;
+        data_bytes_ = 0;
+        if(!WriteHeader())
         {
-            unsigned int bw = 0;
-            if(f_write(&fp_, &wavheader_, sizeof(wavheader_), &bw) == FR_OK)
-            {
-                recording_ = true;
-                num_samps_ = 0;
-            }
+            f_close(&fp_);
+            return Result::ERROR;
         }
+        fill_pos_ = 0;
+        filled_.store(0, std::memory_order_relaxed);
+        written_.store(0, std::memory_order_relaxed);
+        dropped_chunks_.store(0, std::memory_order_relaxed);
+        recording_.store(true, std::memory_order_release);
+        return Result::OK;
     }
 
     /** Returns whether recording is currently active or not. */
-    inline bool IsRecording() const { return recording_; }
+    inline bool IsRecording() const
+    {
+        return recording_.load(std::memory_order_acquire);
+    }
 
     /** Returns the current length in samples of the recording. */
     inline uint32_t GetLengthSamps() { return num_samps_; }
@@ -177,13 +219,52 @@ class WavWriter
         return (float)num_samps_ / (float)cfg_.samplerate;
     }
 
+    /** Returns the number of chunks that were lost since OpenFile(),
+     ** because the SD card couldn't keep up or a write failed. */
+    inline uint32_t GetDroppedChunks() const
+    {
+        return dropped_chunks_.load(std::memory_order_relaxed);
+    }
+
   private:
-    /** Calculate the file size based on current recording */
+    /** Calculate the file size based on what's been written */
     inline uint32_t CalcFileSize()
     {
-        wavheader_.SubCHunk2Size
-            = num_samps_ * cfg_.channels * cfg_.bitspersample / 8;
-        return 36 + wavheader_.SubCHunk2Size;
+        wavheader_.SubCHunk2Size = data_bytes_;
+        return GetHeaderSize() - 8 + wavheader_.SubCHunk2Size;
+    }
+
+    size_t GetHeaderSize() const
+    {
+        return cfg_.floatingpoint ? kFloatHeaderSize : sizeof(wavheader_);
+    }
+
+    /** Writes the header with the sizes of what's been written */
+    bool WriteHeader()
+    {
+        wavheader_.FileSize = CalcFileSize();
+
+        // up to the data chunk, the PCM header is the same
+        const size_t fmt_end = offsetof(WAV_FormatTypeDef, SubChunk2ID);
+        uint8_t      header[kFloatHeaderSize];
+        size_t       pos = fmt_end;
+        memcpy(header, &wavheader_, fmt_end);
+        if(cfg_.floatingpoint)
+        {
+            // no format extension, then the number of frames
+            const uint16_t cb_size = 0;
+            const uint32_t fact[3]
+                = {kWavFileFactId, 4, data_bytes_ / uint32_t(block_align_)};
+            memcpy(header + pos, &cb_size, sizeof(cb_size));
+            pos += sizeof(cb_size);
+            memcpy(header + pos, fact, sizeof(fact));
+            pos += sizeof(fact);
+        }
+        memcpy(header + pos, (const uint8_t *)&wavheader_ + fmt_end, 8);
+
+        unsigned int bw   = 0;
+        const size_t size = GetHeaderSize();
+        return f_write(&fp_, header, size, &bw) == FR_OK && bw == size;
     }
 
     /** Compute the byte rate given the user settings. */
@@ -192,15 +273,130 @@ class WavWriter
         return cfg_.samplerate * cfg_.channels * cfg_.bitspersample / 8;
     }
 
-    static constexpr int kTransferSamps = transfer_size / sizeof(int32_t);
+    /** Returns the kernel for the integer formats, or nullptr if there's none
+     ** for the channel count */
+    SampleConversion::OutputKernel GetKernel() const
+    {
+        if(cfg_.floatingpoint)
+            return nullptr;
+        const auto bd = cfg_.bitspersample == 16
+                            ? SaiHandle::Config::BitDepth::SAI_16BIT
+                        : cfg_.bitspersample == 24
+                            ? SaiHandle::Config::BitDepth::SAI_24BIT
+                            : SaiHandle::Config::BitDepth::SAI_32BIT;
+        return SampleConversion::GetKernels(bd, cfg_.channels, false).out;
+    }
+
+    /** Converts and interleaves frames into the file format */
+    void Convert(const float *const *in, uint8_t *dst, size_t frames)
+    {
+        const size_t chns = cfg_.channels;
+        if(cfg_.floatingpoint)
+        {
+            for(size_t i = 0; i < frames; i++)
+                for(size_t c = 0; c < chns; c++)
+                {
+                    memcpy(dst, &in[c][i], sizeof(float));
+                    dst += sizeof(float);
+                }
+            return;
+        }
+
+        int32_t *words = scratch_;
+        if(kernel_ != nullptr)
+            kernel_(in, words, frames, 1.0f);
+        else if(cfg_.bitspersample == 16)
+            Interleave<SampleConversion::S16>(in, words, frames);
+        else if(cfg_.bitspersample == 24)
+            Interleave<SampleConversion::S24>(in, words, frames);
+        else
+            Interleave<SampleConversion::S32>(in, words, frames);
+
+        const size_t bytes = cfg_.bitspersample / 8;
+        if(bytes == 4)
+        {
+            // the chunks don't have to be 4 byte aligned
+            memcpy(dst, words, frames * chns * sizeof(int32_t));
+            return;
+        }
+        for(size_t i = 0; i < frames * chns; i++)
+        {
+            // little endian, lowest bytes of the word
+            const int32_t x = words[i];
+            dst[0]          = x;
+            dst[1]          = x >> 8;
+            if(bytes == 3)
+                dst[2] = x >> 16;
+            dst += bytes;
+        }
+    }
+
+    /** Fallback for channel counts without a kernel */
+    template <typename Format>
+    void Interleave(const float *const *in, int32_t *out, size_t frames)
+    {
+        for(size_t i = 0; i < frames; i++)
+            for(int32_t c = 0; c < cfg_.channels; c++)
+                *out++ = Format::FromFloat(in[c][i]);
+    }
+
+    uint8_t *GetChunk(uint32_t idx) { return chunks_[idx % num_chunks]; }
+
+    /** Hands the full chunk over to Write(), or drops it if there's no
+     ** other chunk to fill. Called from the audio callback. */
+    void QueueChunk()
+    {
+        const uint32_t filled = filled_.load(std::memory_order_relaxed);
+        if(filled + 1 - written_.load(std::memory_order_acquire) < num_chunks)
+        {
+            filled_.store(filled + 1, std::memory_order_release);
+        }
+        else
+        {
+            dropped_chunks_.fetch_add(1, std::memory_order_relaxed);
+            num_samps_ -= chunk_bytes_ / block_align_;
+        }
+        fill_pos_ = 0;
+    }
+
+    void WriteFullChunks()
+    {
+        uint32_t written = written_.load(std::memory_order_relaxed);
+        while(written != filled_.load(std::memory_order_acquire))
+        {
+            WriteChunk(GetChunk(written), chunk_bytes_);
+            written_.store(++written, std::memory_order_release);
+        }
+    }
+
+    void WriteChunk(const uint8_t *chunk, size_t size)
+    {
+        unsigned int bw = 0;
+        if(f_write(&fp_, chunk, size, &bw) == FR_OK && bw == size)
+            data_bytes_ += size;
+        else
+            dropped_chunks_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static constexpr size_t kScratchSamples = 256;
+    /** the PCM header, the format extension size and the fact chunk */
+    static constexpr size_t kFloatHeaderSize = sizeof(WAV_FormatTypeDef) + 14;
 
-    WAV_FormatTypeDef wavheader_;
-    uint32_t          num_samps_, wptr_;
-    Config            cfg_;
-    int32_t           transfer_buff[kTransferSamps * 2];
-    BufferState       bstate_;
-    bool              recording_;
-    FIL               fp_;
+    WAV_FormatTypeDef              wavheader_;
+    uint32_t                       num_samps_, data_bytes_;
+    Config                         cfg_;
+    size_t                         block_align_ = 0, chunk_bytes_ = 0;
+    SampleConversion::OutputKernel kernel_;
+    uint8_t                        chunks_[num_chunks][transfer_size];
+    int32_t                        scratch_[kScratchSamples];
+    /** audio callback only: write position in the chunk being filled */
+    size_t fill_pos_;
+    // free running chunk counts
+    std::atomic<uint32_t> filled_{0};
+    std::atomic<uint32_t> written_{0};
+    std::atomic<uint32_t> dropped_chunks_{0};
+    std::atomic<bool>     recording_{false};
+    FIL                   fp_;
 };
 
 } // namespace daisy
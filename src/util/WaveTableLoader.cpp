@@ -1,13 +1,30 @@
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
 #include "WaveTableLoader.h"
 #include "daisy_core.h"
 namespace daisy
 {
+namespace
+{
+bool IsWavFile(const char *name)
+{
+    const size_t len = strlen(name);
+    if(len < 4 || name[len - 4] != '.')
+        return false;
+    const char *ext = name + len - 3;
+    return tolower(ext[0]) == 'w' && tolower(ext[1]) == 'a'
+           && tolower(ext[2]) == 'v';
+}
+} // namespace
+
 void WaveTableLoader::Init(float *mem, size_t mem_size)
 {
     buf_             = mem;
     buf_size_        = mem_size;
     samps_per_table_ = 256;
     num_tables_      = 1;
+    memset(&format_, 0, sizeof(format_));
 }
 
 WaveTableLoader::Result WaveTableLoader::SetWaveTableInfo(size_t samps,
@@ -20,51 +37,185 @@ WaveTableLoader::Result WaveTableLoader::SetWaveTableInfo(size_t samps,
     return Result::OK;
 }
 
-WaveTableLoader::Result WaveTableLoader::Import(const char *filename)
+WaveTableLoader::Result WaveTableLoader::Import(const char *filename,
+                                                size_t      first_table,
+                                                size_t     *tables_loaded)
+{
+    if(tables_loaded != nullptr)
+        *tables_loaded = 0;
+    const size_t offset = first_table * samps_per_table_;
+    if(offset >= buf_size_)
+        return Result::ERR_TABLE_INFO_OVERFLOW;
+    if(f_open(&fp_, filename, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+        return Result::ERR_FILE_READ;
+
+    size_t       num_samples = 0;
+    const Result result      = ReadData(offset, &num_samples);
+    f_close(&fp_);
+
+    // clear the rest of the last table
+    const size_t num_tables
+        = (num_samples + samps_per_table_ - 1) / samps_per_table_;
+    size_t end = offset + num_tables * samps_per_table_;
+    if(end > buf_size_)
+        end = buf_size_;
+    for(size_t i = offset + num_samples; i < end; i++)
+        buf_[i] = 0.0f;
+    if(tables_loaded != nullptr)
+        *tables_loaded = num_tables;
+    return result;
+}
+
+WaveTableLoader::Result WaveTableLoader::ReadData(size_t  offset,
+                                                  size_t *num_samples)
 {
-    if(f_open(&fp_, filename, FA_READ | FA_OPEN_EXISTING) == FR_OK)
+    if(!WavParser::ReadHeader(&fp_, format_, kMaxChannels))
+        return Result::ERR_FORMAT;
+
+    const size_t sample_size = WavParser::GetSampleSize(format_.sample_format);
+    const size_t in_file     = format_.data_size / sample_size;
+    const size_t total
+        = in_file < buf_size_ - offset ? in_file : buf_size_ - offset;
+    // whole samples per read, the workspace is converted as a block
+    const size_t max_read = sizeof(workspace) / sample_size;
+
+    float *dst  = buf_ + offset;
+    size_t done = 0;
+    while(done < total)
+    {
+        const size_t num = total - done < max_read ? total - done : max_read;
+        UINT         br  = 0;
+        if(f_read(&fp_, workspace, num * sample_size, &br) != FR_OK)
+            break;
+        // only what was actually read
+        const size_t num_read = br / sample_size;
+        WavParser::Decode(format_.sample_format,
+                          reinterpret_cast<const uint8_t *>(workspace),
+                          dst + done,
+                          num_read);
+        done += num_read;
+        if(num_read < num)
+            break;
+    }
+    *num_samples = done;
+    if(done < total)
+        return Result::ERR_FILE_READ;
+    return total < in_file ? Result::ERR_TABLE_INFO_OVERFLOW : Result::OK;
+}
+
+WaveTableLoader::Result WaveTableLoader::ImportDirectory(const char *path,
+                                                         size_t first_table,
+                                                         size_t *tables_loaded)
+{
+    if(tables_loaded != nullptr)
+        *tables_loaded = 0;
+    DIR dir;
+    if(f_opendir(&dir, path) != FR_OK)
+        return Result::ERR_FILE_READ;
+
+    // sorted without keeping the whole listing in memory: each pass over
+    // the directory collects the next batch of names in order, so a
+    // directory that fits into one batch is read only once
+    NameBatch batch;
+    char      last[_MAX_LFN + 1] = "";
+    char      file_path[2 * (_MAX_LFN + 1)];
+    size_t    table  = first_table;
+    Result    result = ReadNextNames(&dir, last, batch);
+    while(result == Result::OK && batch.GetNumNames() > 0)
     {
-        // First Grab the Wave header info
-        unsigned int br;
-        f_read(&fp_, &header_, sizeof(header_), &br);
-        uint32_t wptr = 0;
-        do
+        for(size_t i = 0; i < batch.GetNumNames() && result == Result::OK;
+            i++)
         {
-            f_read(&fp_, workspace, kWorkspaceSize * sizeof(workspace[0]), &br);
-            // Fill mem
-            switch(header_.BitPerSample)
+            if(snprintf(file_path,
+                        sizeof(file_path),
+                        "%s/%s",
+                        path,
+                        batch.GetName(i))
+               >= int(sizeof(file_path)))
             {
-                case 16:
-                {
-                    int16_t *wsp;
-                    wsp = (int16_t *)workspace;
-                    for(size_t i = 0; i < kWorkspaceSize * 2; i++)
-                    {
-                        buf_[wptr] = s162f(wsp[i]);
-                        wptr++;
-                    }
-                }
+                result = Result::ERR_GENERIC;
                 break;
-                case 32:
-                {
-                    float *wsp;
-                    wsp = (float *)workspace;
-                    for(size_t i = 0; i < kWorkspaceSize; i++)
-                    {
-                        buf_[wptr] = wsp[i];
-                    }
-                }
-                break;
-                default: break;
             }
-        } while(!f_eof(&fp_) || wptr <= buf_size_ - 1);
-        f_close(&fp_);
+            size_t num_tables = 0;
+            result            = Import(file_path, table, &num_tables);
+            table += num_tables;
+        }
+        if(result != Result::OK || !batch.IsTruncated())
+            break;
+        strcpy(last, batch.GetName(batch.GetNumNames() - 1));
+        result = ReadNextNames(&dir, last, batch);
     }
-    else
-    {
+    f_closedir(&dir);
+    if(tables_loaded != nullptr)
+        *tables_loaded = table - first_table;
+    return result;
+}
+
+WaveTableLoader::Result
+WaveTableLoader::ReadNextNames(DIR *dir, const char *last, NameBatch &batch)
+{
+    FILINFO info;
+    batch.Clear();
+    if(f_readdir(dir, nullptr) != FR_OK)
         return Result::ERR_FILE_READ;
+    while(true)
+    {
+        if(f_readdir(dir, &info) != FR_OK)
+            return Result::ERR_FILE_READ;
+        if(info.fname[0] == '\0')
+            return Result::OK;
+        if((info.fattrib & AM_DIR) || !IsWavFile(info.fname))
+            continue;
+        if(strcmp(info.fname, last) > 0)
+            batch.Insert(info.fname);
     }
-    return Result::OK;
+}
+
+void WaveTableLoader::NameBatch::Clear()
+{
+    num_names_ = 0;
+    pool_used_ = 0;
+    truncated_ = false;
+}
+
+void WaveTableLoader::NameBatch::Insert(const char *name)
+{
+    const size_t len = strlen(name) + 1;
+    size_t       pos = num_names_;
+    while(pos > 0 && strcmp(name, GetName(pos - 1)) < 0)
+        pos--;
+
+    // make room by dropping the names at the end, they come again with
+    // the next batch
+    while(num_names_ == kMaxNames || pool_used_ + len > kPoolSize)
+    {
+        truncated_ = true;
+        if(pos == num_names_)
+            return;
+        RemoveLast();
+    }
+
+    memcpy(&pool_[pool_used_], name, len);
+    memmove(&offsets_[pos + 1],
+            &offsets_[pos],
+            (num_names_ - pos) * sizeof(offsets_[0]));
+    offsets_[pos] = uint16_t(pool_used_);
+    pool_used_ += len;
+    num_names_++;
+}
+
+void WaveTableLoader::NameBatch::RemoveLast()
+{
+    num_names_--;
+    const size_t offset = offsets_[num_names_];
+    const size_t len    = strlen(&pool_[offset]) + 1;
+    memmove(&pool_[offset],
+            &pool_[offset + len],
+            pool_used_ - offset - len);
+    pool_used_ -= len;
+    for(size_t i = 0; i < num_names_; i++)
+        if(offsets_[i] > offset)
+            offsets_[i] -= uint16_t(len);
 }
 
 /** Returns pointer to specific table start or nullptr if invalid idx */
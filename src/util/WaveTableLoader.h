@@ -1,14 +1,21 @@
 #pragma once
-#include "fatfs.h"
-#include "util/wav_format.h"
+#include "ff.h"
+#include "util/WavParser.h"
 namespace daisy
 {
-/** Loads a bank of wavetables into memory. 
- ** Pointers to the start of each waveform will be provided, 
+/** Loads a bank of wavetables into memory.
+ ** Pointers to the start of each waveform will be provided,
  ** but the user can do whatever they want with the data once
- ** it's imported. 
+ ** it's imported.
  **
- ** A internal 4kB workspace is used for reading from the file, and conveting to the correct memory location. 
+ ** 16, 24 and 32-bit integer and 32-bit float files are supported. The
+ ** audio data is found by walking the chunks of the file, so files with
+ ** extra chunks before the data are loaded correctly.
+ ** A single file can hold a whole bank of tables, back to back, or
+ ** ImportDirectory() loads one file after another into consecutive tables,
+ ** e.g. into a buffer in the SDRAM.
+ **
+ ** A internal 4kB workspace is used for reading from the file, and conveting to the correct memory location.
  ** */
 class WaveTableLoader
 {
@@ -19,6 +26,7 @@ class WaveTableLoader
         ERR_TABLE_INFO_OVERFLOW,
         ERR_FILE_READ,
         ERR_GENERIC,
+        ERR_FORMAT,
     };
     WaveTableLoader() {}
     ~WaveTableLoader() {}
@@ -29,29 +37,97 @@ class WaveTableLoader
     /** Sets the size of the tables to allow access to the specific waveforms */
     Result SetWaveTableInfo(size_t samps, size_t count);
 
-    /** Opens and loads the file 
+    /** Opens and loads the file
      ** The data will be converted from its original type to float
-     ** And the wavheader data will be stored internally to the class, 
+     ** And the format will be stored internally to the class (GetFormat()),
      ** but will not be stored in the user-provided buffer.
      **
-     ** Currently only 16-bit and 32-bit data is supported.
-     ** The importer also assumes data is mono so stereo data will be loaded as-is 
+     ** The importer assumes data is mono so stereo data will be loaded as-is
      ** (i.e. interleaved)
+     **
+     ** \param filename path of the file
+     ** \param first_table index of the table the data starts at
+     ** \param tables_loaded if not nullptr, set to the number of tables
+     **        that were filled. The rest of a partly filled table is cleared.
+     ** \return ERR_TABLE_INFO_OVERFLOW if only the start of the data fit into
+     **         the memory
+     ** */
+    Result Import(const char *filename,
+                  size_t      first_table   = 0,
+                  size_t     *tables_loaded = nullptr);
+
+    /** Loads all .wav files of a directory in alphabetical order, each
+     ** starting at the table after the previous one.
+     ** Stops at the first file that can't be loaded.
+     ** The names are sorted in batches of up to 32 files, using about
+     ** 1kB of stack, so the directory is read once per 32 files.
+     **
+     ** \param path path of the directory
+     ** \param first_table index of the table the first file starts at
+     ** \param tables_loaded if not nullptr, set to the number of tables
+     **        that were filled
+     ** \return ERR_TABLE_INFO_OVERFLOW if not all files fit into the memory
      ** */
-    Result Import(const char *filename);
+    Result ImportDirectory(const char *path,
+                           size_t      first_table   = 0,
+                           size_t     *tables_loaded = nullptr);
 
     /** Returns pointer to specific table start or nullptr if invalid idx */
     float *GetTable(size_t idx);
 
+    /** Returns the format of the file that was loaded last */
+    const WavParser::Format &GetFormat() const { return format_; }
+
   private:
-    static constexpr int kWorkspaceSize = 1024;
-    float *              buf_;
-    size_t               buf_size_;
-    WAV_FormatTypeDef    header_;
-    size_t               samps_per_table_;
-    size_t               num_tables_;
-    int32_t              workspace[kWorkspaceSize];
-    FIL                  fp_;
+    /** Reads the data of the open file into the memory, at the offset */
+    Result ReadData(size_t offset, size_t *num_samples);
+
+    /** The alphabetically first file names of a directory */
+    class NameBatch
+    {
+      public:
+        void Clear();
+
+        /** Adds the name in order. When the batch is full, the last name
+         ** is dropped and the batch is marked as truncated. */
+        void Insert(const char *name);
+
+        size_t      GetNumNames() const { return num_names_; }
+        const char *GetName(size_t idx) const
+        {
+            return &pool_[offsets_[idx]];
+        }
+
+        /** Returns true if names were left out since Clear() */
+        bool IsTruncated() const { return truncated_; }
+
+      private:
+        void RemoveLast();
+
+        static constexpr size_t kMaxNames = 32;
+        static constexpr size_t kPoolSize = 1024;
+        static_assert(kPoolSize >= _MAX_LFN + 1, "a name has to fit");
+
+        uint16_t offsets_[kMaxNames];
+        char     pool_[kPoolSize];
+        size_t   num_names_ = 0;
+        size_t   pool_used_ = 0;
+        bool     truncated_ = false;
+    };
+
+    /** Reads the directory from the start and collects the first .wav
+     ** files whose names come after last, in alphabetical order */
+    Result ReadNextNames(DIR *dir, const char *last, NameBatch &batch);
+
+    static constexpr int    kWorkspaceSize = 1024;
+    static constexpr size_t kMaxChannels   = 16;
+    float *                 buf_;
+    size_t                  buf_size_;
+    WavParser::Format       format_;
+    size_t                  samps_per_table_;
+    size_t                  num_tables_;
+    int32_t                 workspace[kWorkspaceSize];
+    FIL                     fp_;
 };
 
 } // namespace daisy
@@ -18,6 +18,12 @@ typedef struct
     const uint8_t   FontWidth;  /*!< Font width in pixels */
     uint8_t         FontHeight; /*!< Font height in pixels */
     const uint16_t *data;       /*!< Pointer to data font data array */
+    /** Optional: the glyphs in the layout of the display RAM of SSD130x
+     *  displays, for fast drawing. Each glyph is FontWidth bytes for each
+     *  8 rows of FontHeight, every byte a column of 8 pixels with the top
+     *  pixel in the LSB. nullptr if not available.
+     */
+    const uint8_t *columns;
 } FontDef;
 
 
@@ -0,0 +1,103 @@
+#include "util/oled_fonts_packed.h"
+
+static const uint16_t Font4x8[] = {
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, // Space
+    0x0000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, 0x0000, 0x4000, // !
+    0x0000, 0xA000, 0xA000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, // "
+    0x0000, 0x4000, 0x4000, 0xE000, 0x4000, 0xE000, 0x4000, 0x4000, // #
+    0x0000, 0x4000, 0x6000, 0xC000, 0xC000, 0x6000, 0x6000, 0xC000, // $
+    0x0000, 0xA000, 0x2000, 0x4000, 0x4000, 0x4000, 0x8000, 0xA000, // %
+    0x0000, 0x4000, 0xA000, 0xA000, 0x4000, 0xA000, 0xA000, 0x6000, // &
+    0x0000, 0x4000, 0x4000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, // '
+    0x0000, 0x2000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, 0x2000, // (
+    0x0000, 0x8000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, 0x8000, // )
+    0x0000, 0x4000, 0xE000, 0x4000, 0x0000, 0x0000, 0x0000, 0x0000, // *
+    0x0000, 0x0000, 0x0000, 0x4000, 0xE000, 0x4000, 0x0000, 0x0000, // +
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x4000, 0x8000, // ,
+    0x0000, 0x0000, 0x0000, 0x0000, 0xE000, 0x0000, 0x0000, 0x0000, // -
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x4000, // .
+    0x0000, 0x8000, 0x8000, 0x4000, 0x4000, 0x4000, 0x2000, 0x2000, // /
+    0x0000, 0x4000, 0xA000, 0xA000, 0xA000, 0xA000, 0xA000, 0x4000, // 0
+    0x0000, 0x4000, 0xC000, 0x4000, 0x4000, 0x4000, 0x4000, 0xE000, // 1
+    0x0000, 0x4000, 0xA000, 0x2000, 0x2000, 0x4000, 0x8000, 0xE000, // 2
+    0x0000, 0xC000, 0x2000, 0x2000, 0xC000, 0x2000, 0x2000, 0xC000, // 3
+    0x0000, 0x8000, 0x8000, 0x8000, 0xE000, 0x4000, 0x4000, 0x4000, // 4
+    0x0000, 0xE000, 0x8000, 0x8000, 0xC000, 0x2000, 0x2000, 0xC000, // 5
+    0x0000, 0x4000, 0x8000, 0x8000, 0xC000, 0xA000, 0xA000, 0x4000, // 6
+    0x0000, 0xE000, 0x2000, 0x2000, 0x4000, 0x8000, 0x8000, 0x8000, // 7
+    0x0000, 0x4000, 0xA000, 0xA000, 0x4000, 0xA000, 0xA000, 0x4000, // 8
+    0x0000, 0x4000, 0xA000, 0xA000, 0x6000, 0x2000, 0x2000, 0x4000, // 9
+    0x0000, 0x0000, 0x0000, 0x4000, 0x0000, 0x0000, 0x4000, 0x0000, // :
+    0x0000, 0x0000, 0x0000, 0x4000, 0x0000, 0x0000, 0x4000, 0x8000, // ;
+    0x0000, 0x0000, 0x2000, 0x4000, 0x8000, 0x4000, 0x2000, 0x0000, // <
+    0x0000, 0x0000, 0x0000, 0xE000, 0x0000, 0xE000, 0x0000, 0x0000, // =
+    0x0000, 0x0000, 0x8000, 0x4000, 0x2000, 0x4000, 0x8000, 0x0000, // >
+    0x0000, 0x4000, 0xA000, 0x2000, 0x2000, 0x4000, 0x0000, 0x4000, // ?
+    0x0000, 0x4000, 0xA000, 0x2000, 0x2000, 0xE000, 0xE000, 0x4000, // @
+    0x0000, 0x4000, 0xA000, 0xA000, 0xA000, 0xE000, 0xA000, 0xA000, // A
+    0x0000, 0xC000, 0xA000, 0xA000, 0xC000, 0xA000, 0xA000, 0xE000, // B
+    0x0000, 0x6000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x6000, // C
+    0x0000, 0xC000, 0xA000, 0xA000, 0xA000, 0xA000, 0xA000, 0xC000, // D
+    0x0000, 0xE000, 0x8000, 0x8000, 0xC000, 0x8000, 0x8000, 0xE000, // E
+    0x0000, 0xE000, 0x8000, 0x8000, 0xC000, 0x8000, 0x8000, 0x8000, // F
+    0x0000, 0x4000, 0xA000, 0x8000, 0x8000, 0xA000, 0xA000, 0x6000, // G
+    0x0000, 0xA000, 0xA000, 0xA000, 0xE000, 0xA000, 0xA000, 0xA000, // H
+    0x0000, 0xE000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, 0xE000, // I
+    0x0000, 0xE000, 0x2000, 0x2000, 0x2000, 0x2000, 0x2000, 0xC000, // J
+    0x0000, 0xA000, 0xA000, 0xA000, 0xC000, 0xA000, 0xA000, 0xA000, // K
+    0x0000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000, 0xE000, // L
+    0x0000, 0xA000, 0xE000, 0xE000, 0xA000, 0xA000, 0xA000, 0xA000, // M
+    0x0000, 0xC000, 0xA000, 0xA000, 0xA000, 0xA000, 0xA000, 0xA000, // N
+    0x0000, 0xE000, 0xA000, 0xA000, 0xA000, 0xA000, 0xA000, 0xE000, // O
+    0x0000, 0xC000, 0xA000, 0xA000, 0xA000, 0xC000, 0x8000, 0x8000, // P
+    0x0000, 0x4000, 0xA000, 0xA000, 0xA000, 0xA000, 0xC000, 0x2000, // Q
+    0x0000, 0xC000, 0xA000, 0xA000, 0xC000, 0xA000, 0xA000, 0xA000, // R
+    0x0000, 0x6000, 0x8000, 0x8000, 0x4000, 0x2000, 0x2000, 0xC000, // S
+    0x0000, 0xE000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, // T
+    0x0000, 0xA000, 0xA000, 0xA000, 0xA000, 0xA000, 0xA000, 0xC000, // U
+    0x0000, 0xA000, 0xA000, 0xA000, 0xA000, 0xA000, 0x4000, 0x4000, // V
+    0x0000, 0xA000, 0xA000, 0xA000, 0xA000, 0xE000, 0xE000, 0xA000, // W
+    0x0000, 0xA000, 0xA000, 0x4000, 0x4000, 0x4000, 0xA000, 0xA000, // X
+    0x0000, 0xA000, 0xA000, 0xA000, 0xA000, 0x4000, 0x4000, 0x4000, // Y
+    0x0000, 0xE000, 0x2000, 0x4000, 0x4000, 0x4000, 0x8000, 0xE000, // Z
+    0x0000, 0x6000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, 0x6000, // [
+    0x0000, 0x2000, 0x2000, 0x4000, 0x4000, 0x4000, 0x8000, 0x8000, // backslash
+    0x0000, 0xC000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, 0xC000, // ]
+    0x0000, 0x4000, 0xA000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, // ^
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xE000, // _ underscore
+    0x0000, 0x4000, 0x2000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, // ` backtick
+    0x0000, 0x0000, 0xC000, 0x2000, 0x6000, 0xA000, 0xA000, 0xE000, // a
+    0x0000, 0x8000, 0x8000, 0xC000, 0xA000, 0xA000, 0xA000, 0xC000, // b
+    0x0000, 0x0000, 0x4000, 0xA000, 0x8000, 0x8000, 0xA000, 0x4000, // c
+    0x0000, 0x2000, 0x6000, 0xA000, 0xA000, 0xA000, 0xA000, 0x6000, // d
+    0x0000, 0x0000, 0x4000, 0xA000, 0xA000, 0xE000, 0x8000, 0x6000, // e
+    0x0000, 0x6000, 0x4000, 0xE000, 0x4000, 0x4000, 0x4000, 0x4000, // f
+    0x0000, 0x0000, 0x4000, 0xA000, 0xA000, 0xE000, 0x2000, 0x6000, // g
+    0x0000, 0x8000, 0x8000, 0xC000, 0xA000, 0xA000, 0xA000, 0xA000, // h
+    0x0000, 0x4000, 0x0000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, // i
+    0x0000, 0x4000, 0x0000, 0x4000, 0x4000, 0x4000, 0x4000, 0x8000, // j
+    0x0000, 0x8000, 0x8000, 0xA000, 0xA000, 0xC000, 0xA000, 0xA000, // k
+    0x0000, 0xC000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, // l
+    0x0000, 0x0000, 0xC000, 0xE000, 0xE000, 0xA000, 0xA000, 0xA000, // m
+    0x0000, 0x0000, 0xC000, 0xA000, 0xA000, 0xA000, 0xA000, 0xA000, // n
+    0x0000, 0x0000, 0x4000, 0xA000, 0xA000, 0xA000, 0xA000, 0x4000, // o
+    0x0000, 0x0000, 0xC000, 0xA000, 0xA000, 0xA000, 0xC000, 0x8000, // p
+    0x0000, 0x0000, 0x6000, 0xA000, 0xA000, 0xA000, 0x6000, 0x2000, // q
+    0x0000, 0x0000, 0x6000, 0x8000, 0x8000, 0x8000, 0x8000, 0x8000, // r
+    0x0000, 0x0000, 0x6000, 0x8000, 0x8000, 0x4000, 0x2000, 0xC000, // s
+    0x0000, 0x4000, 0xE000, 0x4000, 0x4000, 0x4000, 0x4000, 0x2000, // t
+    0x0000, 0x0000, 0xA000, 0xA000, 0xA000, 0xA000, 0xA000, 0xC000, // u
+    0x0000, 0x0000, 0xA000, 0xA000, 0xA000, 0xA000, 0x4000, 0x4000, // v
+    0x0000, 0x0000, 0xA000, 0xA000, 0xA000, 0xE000, 0xE000, 0xC000, // w
+    0x0000, 0x0000, 0xA000, 0xA000, 0x4000, 0x4000, 0xA000, 0xA000, // x
+    0x0000, 0x0000, 0xA000, 0xA000, 0xA000, 0x6000, 0x2000, 0x6000, // y
+    0x0000, 0x0000, 0xE000, 0x2000, 0x4000, 0x4000, 0x8000, 0xE000, // z
+    0x0000, 0x2000, 0x4000, 0x4000, 0xC000, 0x4000, 0x4000, 0x2000, // {
+    0x0000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, // |
+    0x0000, 0x8000, 0x4000, 0x4000, 0x6000, 0x4000, 0x4000, 0x8000, // }
+    0x0000, 0x0000, 0x0000, 0x2000, 0xE000, 0x8000, 0x0000, 0x0000, // ~ Tilde
+};
+
+static constexpr auto Font4x8Packed = PackFont<4, 8>(Font4x8);
+
+FontDef Font_4x8 = {4, 8, Font4x8, Font4x8Packed.columns};
@@ -0,0 +1,103 @@
+#include "util/oled_fonts_packed.h"
+
+static const uint16_t Font6x7[] = {
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, // Space
+    0x0000, 0x0000, 0x4000, 0x4000, 0x4000, 0x0000, 0x4000, // !
+    0x0000, 0x0000, 0xA000, 0xA000, 0x0000, 0x0000, 0x0000, // "
+    0x0000, 0x0000, 0x6000, 0xF000, 0x6000, 0xF000, 0x6000, // #
+    0x0000, 0x0000, 0x7000, 0xC000, 0xE000, 0x5000, 0xE000, // $
+    0x0000, 0x0000, 0x9000, 0x2000, 0x4000, 0x4000, 0x9000, // %
+    0x0000, 0x0000, 0x4000, 0xA000, 0x4000, 0xB000, 0x6000, // &
+    0x0000, 0x0000, 0x4000, 0x4000, 0x0000, 0x0000, 0x0000, // '
+    0x0000, 0x0000, 0x1000, 0x2000, 0x2000, 0x2000, 0x1000, // (
+    0x0000, 0x0000, 0x8000, 0x4000, 0x4000, 0x4000, 0x8000, // )
+    0x0000, 0x0000, 0xA000, 0x4000, 0xA000, 0x0000, 0x0000, // *
+    0x0000, 0x0000, 0x0000, 0x4000, 0xE000, 0x4000, 0x0000, // +
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x4000, 0x8000, // ,
+    0x0000, 0x0000, 0x0000, 0x0000, 0xF000, 0x0000, 0x0000, // -
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x4000, // .
+    0x0000, 0x0000, 0x2000, 0x2000, 0x2000, 0x4000, 0x4000, // /
+    0x0000, 0x0000, 0x6000, 0x9000, 0xB000, 0xD000, 0x6000, // 0
+    0x0000, 0x0000, 0x2000, 0x6000, 0x2000, 0x2000, 0x7000, // 1
+    0x0000, 0x0000, 0x6000, 0x9000, 0x2000, 0x4000, 0xF000, // 2
+    0x0000, 0x0000, 0xE000, 0x1000, 0x6000, 0x1000, 0xE000, // 3
+    0x0000, 0x0000, 0x2000, 0x6000, 0xA000, 0xF000, 0x2000, // 4
+    0x0000, 0x0000, 0xF000, 0x8000, 0xE000, 0x1000, 0xE000, // 5
+    0x0000, 0x0000, 0x6000, 0x8000, 0xE000, 0x9000, 0x6000, // 6
+    0x0000, 0x0000, 0xF000, 0x1000, 0x2000, 0x4000, 0x8000, // 7
+    0x0000, 0x0000, 0x6000, 0x9000, 0x6000, 0x9000, 0x6000, // 8
+    0x0000, 0x0000, 0x6000, 0x9000, 0x7000, 0x1000, 0x6000, // 9
+    0x0000, 0x0000, 0x0000, 0x4000, 0x0000, 0x4000, 0x0000, // :
+    0x0000, 0x0000, 0x0000, 0x4000, 0x0000, 0x4000, 0x8000, // ;
+    0x0000, 0x0000, 0x1000, 0x2000, 0x4000, 0x2000, 0x1000, // <
+    0x0000, 0x0000, 0x0000, 0xF000, 0x0000, 0xF000, 0x0000, // =
+    0x0000, 0x0000, 0x8000, 0x4000, 0x2000, 0x4000, 0x8000, // >
+    0x0000, 0x0000, 0xE000, 0x1000, 0x6000, 0x0000, 0x4000, // ?
+    0x0000, 0x0000, 0xE000, 0x1000, 0x5000, 0xB000, 0x6000, // @
+    0x0000, 0x0000, 0x6000, 0x9000, 0x9000, 0xF000, 0x9000, // A
+    0x0000, 0x0000, 0xE000, 0x9000, 0xE000, 0x9000, 0xE000, // B
+    0x0000, 0x0000, 0x7000, 0x8000, 0x8000, 0x8000, 0x7000, // C
+    0x0000, 0x0000, 0xE000, 0x9000, 0x9000, 0x9000, 0xE000, // D
+    0x0000, 0x0000, 0xF000, 0x8000, 0xE000, 0x8000, 0xF000, // E
+    0x0000, 0x0000, 0xF000, 0x8000, 0xE000, 0x8000, 0x8000, // F
+    0x0000, 0x0000, 0x7000, 0x8000, 0xB000, 0x9000, 0x6000, // G
+    0x0000, 0x0000, 0x9000, 0x9000, 0xF000, 0x9000, 0x9000, // H
+    0x0000, 0x0000, 0xE000, 0x4000, 0x4000, 0x4000, 0xE000, // I
+    0x0000, 0x0000, 0xF000, 0x2000, 0x2000, 0x2000, 0xC000, // J
+    0x0000, 0x0000, 0x9000, 0xA000, 0xC000, 0xA000, 0x9000, // K
+    0x0000, 0x0000, 0x8000, 0x8000, 0x8000, 0x8000, 0xF000, // L
+    0x0000, 0x0000, 0xE000, 0xB000, 0xB000, 0x9000, 0x9000, // M
+    0x0000, 0x0000, 0x9000, 0xD000, 0xB000, 0x9000, 0x9000, // N
+    0x0000, 0x0000, 0x6000, 0x9000, 0x9000, 0x9000, 0x6000, // O
+    0x0000, 0x0000, 0xF000, 0x9000, 0x9000, 0xE000, 0x8000, // P
+    0x0000, 0x0000, 0x6000, 0x9000, 0x9000, 0xA000, 0x5000, // Q
+    0x0000, 0x0000, 0xE000, 0x9000, 0x9000, 0xE000, 0x9000, // R
+    0x0000, 0x0000, 0x7000, 0x8000, 0x6000, 0x1000, 0xE000, // S
+    0x0000, 0x0000, 0xE000, 0x4000, 0x4000, 0x4000, 0x4000, // T
+    0x0000, 0x0000, 0x9000, 0x9000, 0x9000, 0x9000, 0x6000, // U
+    0x0000, 0x0000, 0x9000, 0x9000, 0x9000, 0x6000, 0x2000, // V
+    0x0000, 0x0000, 0x9000, 0x9000, 0xB000, 0xB000, 0xD000, // W
+    0x0000, 0x0000, 0x9000, 0x9000, 0x6000, 0x6000, 0x9000, // X
+    0x0000, 0x0000, 0x9000, 0x9000, 0x7000, 0x2000, 0x2000, // Y
+    0x0000, 0x0000, 0xF000, 0x2000, 0x4000, 0x8000, 0xF000, // Z
+    0x0000, 0x0000, 0x3000, 0x2000, 0x2000, 0x2000, 0x3000, // [
+    0x0000, 0x0000, 0x8000, 0x4000, 0x4000, 0x2000, 0x1000, // backslash
+    0x0000, 0x0000, 0xC000, 0x4000, 0x4000, 0x4000, 0xC000, // ]
+    0x0000, 0x0000, 0x6000, 0x9000, 0x0000, 0x0000, 0x0000, // ^
+    0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0xF000, // _ underscore
+    0x0000, 0x0000, 0x4000, 0x2000, 0x0000, 0x0000, 0x0000, // ` backtick
+    0x0000, 0x0000, 0x6000, 0x1000, 0x7000, 0x9000, 0x7000, // a
+    0x0000, 0x0000, 0x8000, 0xE000, 0x9000, 0x9000, 0xE000, // b
+    0x0000, 0x0000, 0x0000, 0x7000, 0x8000, 0x8000, 0x7000, // c
+    0x0000, 0x0000, 0x1000, 0x7000, 0x9000, 0x9000, 0x7000, // d
+    0x0000, 0x0000, 0x6000, 0x9000, 0xF000, 0x8000, 0x7000, // e
+    0x0000, 0x0000, 0x6000, 0x4000, 0xE000, 0x4000, 0x4000, // f
+    0x0000, 0x0000, 0x6000, 0x9000, 0xF000, 0x1000, 0x3000, // g
+    0x0000, 0x0000, 0x8000, 0x8000, 0xE000, 0x9000, 0x9000, // h
+    0x0000, 0x0000, 0x4000, 0x0000, 0x4000, 0x4000, 0x4000, // i
+    0x0000, 0x0000, 0x4000, 0x0000, 0x4000, 0x4000, 0x8000, // j
+    0x0000, 0x0000, 0x8000, 0xA000, 0xA000, 0xC000, 0xA000, // k
+    0x0000, 0x0000, 0xC000, 0x4000, 0x4000, 0x4000, 0x4000, // l
+    0x0000, 0x0000, 0x0000, 0xE000, 0xF000, 0x9000, 0x9000, // m
+    0x0000, 0x0000, 0x0000, 0xA000, 0xD000, 0x9000, 0x9000, // n
+    0x0000, 0x0000, 0x0000, 0x6000, 0x9000, 0x9000, 0x6000, // o
+    0x0000, 0x0000, 0x0000, 0xE000, 0x9000, 0xE000, 0x8000, // p
+    0x0000, 0x0000, 0x0000, 0x7000, 0x9000, 0x7000, 0x1000, // q
+    0x0000, 0x0000, 0x0000, 0xB000, 0xC000, 0x8000, 0x8000, // r
+    0x0000, 0x0000, 0x0000, 0x7000, 0xE000, 0x1000, 0xE000, // s
+    0x0000, 0x0000, 0x4000, 0xE000, 0x4000, 0x4000, 0x2000, // t
+    0x0000, 0x0000, 0x0000, 0x9000, 0x9000, 0x9000, 0x7000, // u
+    0x0000, 0x0000, 0x0000, 0x9000, 0x9000, 0x5000, 0x2000, // v
+    0x0000, 0x0000, 0x0000, 0x9000, 0x9000, 0xB000, 0x7000, // w
+    0x0000, 0x0000, 0x0000, 0x9000, 0x6000, 0x6000, 0x9000, // x
+    0x0000, 0x0000, 0x0000, 0x9000, 0xF000, 0x1000, 0x7000, // y
+    0x0000, 0x0000, 0x0000, 0xF000, 0x2000, 0x4000, 0xF000, // z
+    0x0000, 0x0000, 0x1000, 0x2000, 0x6000, 0x2000, 0x1000, // {
+    0x0000, 0x0000, 0x4000, 0x4000, 0x4000, 0x4000, 0x4000, // |
+    0x0000, 0x0000, 0x8000, 0x4000, 0x6000, 0x4000, 0x8000, // }
+    0x0000, 0x0000, 0x0000, 0x5000, 0xF000, 0xA000, 0x0000, // ~ Tilde
+};
+
+static constexpr auto Font6x7Packed = PackFont<6, 7>(Font6x7);
+
+FontDef Font_6x7 = {6, 7, Font6x7, Font6x7Packed.columns};
@@ -0,0 +1,46 @@
+#pragma once
+#ifndef DSY_OLED_FONTS_PACKED_H
+#define DSY_OLED_FONTS_PACKED_H
+#include "util/oled_fonts.h"
+#include <stddef.h>
+
+/* Internal to the oled_fonts_*.cpp files. Each font is in a file of its
+ * own, so that only the fonts that are used end up in the binary, with or
+ * without the linker dropping unused sections.
+ */
+
+/** The glyphs of a font table packed into columns of 8 pixel pages, see
+ *  FontDef::columns. Built at compile time.
+ */
+template <uint8_t kWidth, uint8_t kHeight, size_t kTableSize>
+struct PackedFont
+{
+    static constexpr size_t kNumPages  = (kHeight + 7) / 8;
+    static constexpr size_t kNumGlyphs = kTableSize / kHeight;
+
+    constexpr PackedFont(const uint16_t (&rows)[kTableSize]) : columns{}
+    {
+        for(size_t glyph = 0; glyph < kNumGlyphs; glyph++)
+        {
+            uint8_t* dest = columns + glyph * kNumPages * kWidth;
+            for(size_t y = 0; y < kHeight; y++)
+            {
+                const uint16_t row = rows[glyph * kHeight + y];
+                for(size_t x = 0; x < kWidth; x++)
+                    if(row & (0x8000 >> x))
+                        dest[(y / 8) * kWidth + x] |= 1 << (y % 8);
+            }
+        }
+    }
+
+    uint8_t columns[kNumGlyphs * kNumPages * kWidth];
+};
+
+template <uint8_t kWidth, uint8_t kHeight, size_t kTableSize>
+constexpr PackedFont<kWidth, kHeight, kTableSize>
+PackFont(const uint16_t (&rows)[kTableSize])
+{
+    return PackedFont<kWidth, kHeight, kTableSize>(rows);
+}
+
+#endif
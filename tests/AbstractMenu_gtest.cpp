@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include "ui/AbstractMenu.h"
 #include "util/MappedValue.h"
+#include "sys/system.h"
 #include <vector>
 
 using namespace daisy;
@@ -979,4 +980,69 @@ TEST(ui_AbstractMenu, m_closeMenu)
     // close menu with the cancel button
     menu.OnCancelButton(1, false);
     EXPECT_FALSE(menu.IsActive());
-}
\ No newline at end of file
+}
+TEST(ui_AbstractMenu, n_invalidatesOnChanges)
+{
+    // checks if the menu invalidates itself when something changes
+    // that it displays, so that a UI only redraws it then
+
+    class DamageTrackingMenu : public ExposedAbstractMenu
+    {
+      public:
+        bool TracksDamage() const override { return true; }
+        void Draw(const UiCanvasDescriptor& /* canvas */) override
+        {
+            numDraws_++;
+        }
+        int numDraws_ = 0;
+    };
+    DamageTrackingMenu menu;
+    menu.AddValueItemsAndInit();
+
+    UiCanvasDescriptor canvas;
+    canvas.id_            = 0;
+    canvas.handle_        = nullptr;
+    canvas.updateRateMs_  = 10;
+    canvas.clearFunction_ = [](const UiCanvasDescriptor&) {};
+    canvas.flushFunction_ = [](const UiCanvasDescriptor&) {};
+
+    System::SetUsForUnitTest(0);
+    UiEventQueue queue;
+    UI           ui;
+    ui.Init(queue, UI::SpecialControlIds{}, {canvas});
+    ui.OpenPage(menu);
+    auto processNextUpdate = [&]() {
+        System::Delay(11);
+        ui.Process();
+        return menu.numDraws_;
+    };
+
+    EXPECT_EQ(processNextUpdate(), 1);
+    EXPECT_EQ(processNextUpdate(), 1); // nothing changed
+
+    // the value is changed by the application
+    menu.mappedIntValue_.Set(8);
+    EXPECT_EQ(processNextUpdate(), 2);
+
+    // select the next item
+    menu.OnArrowButton(ArrowButtonType::right, 1, false);
+    EXPECT_EQ(processNextUpdate(), 3);
+
+    // enter the item for editing
+    menu.OnOkayButton(1, false);
+    EXPECT_TRUE(menu.IsEnteredForEditing());
+    EXPECT_EQ(processNextUpdate(), 4);
+
+    // the function button isn't displayed
+    menu.OnFunctionButton(1, false);
+    EXPECT_EQ(processNextUpdate(), 4);
+
+    // re-initializing the menu
+    menu.AddCheckboxItemsAndInit();
+    EXPECT_EQ(processNextUpdate(), 5);
+
+    // the checkbox is changed by the application
+    menu.checkboxItemValue_ = true;
+    EXPECT_EQ(processNextUpdate(), 6);
+    EXPECT_EQ(processNextUpdate(), 6);
+}
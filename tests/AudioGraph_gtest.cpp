@@ -0,0 +1,225 @@
+#include "util/AudioGraph.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+/** Records the order the nodes ran in */
+std::vector<int> run_log;
+
+/** out[0] = in[0] * gain + offset, optionally takes some ticks */
+class GainNode : public AudioGraphNode
+{
+  public:
+    GainNode(int id, float gain, float offset = 0.0f, uint32_t ticks = 0)
+    : id_(id), gain_(gain), offset_(offset), ticks_(ticks)
+    {
+    }
+
+    void
+    Process(const float* const* in, float* const* out, size_t size) override
+    {
+        run_log.push_back(id_);
+        last_in_  = in[0];
+        last_out_ = out[0];
+        for(size_t i = 0; i < size; i++)
+            out[0][i] = in[0][i] * gain_ + offset_;
+        System::SetTickForUnitTest(System::GetTick() + ticks_);
+    }
+
+    const float* last_in_  = nullptr;
+    float*       last_out_ = nullptr;
+
+  private:
+    int      id_;
+    float    gain_;
+    float    offset_;
+    uint32_t ticks_;
+};
+
+/** Sums two inputs into two outputs */
+class MixNode : public AudioGraphNode
+{
+  public:
+    void
+    Process(const float* const* in, float* const* out, size_t size) override
+    {
+        run_log.push_back(100);
+        for(size_t i = 0; i < size; i++)
+        {
+            out[0][i] = in[0][i] + in[1][i];
+            out[1][i] = -out[0][i];
+        }
+    }
+};
+
+constexpr size_t kBlockSize = 4;
+} // namespace
+
+TEST(util_AudioGraph, a_processesInDependencyOrder)
+{
+    using Graph = AudioGraph<8, 8>;
+    static AudioGraphArena<4, kBlockSize> arena;
+    Graph                                 graph;
+    ASSERT_EQ(graph.Init(arena, 2, 2), Graph::Result::OK);
+
+    const int a = graph.AddBuffer();
+    const int b = graph.AddBuffer();
+    ASSERT_GE(a, 0);
+    ASSERT_GE(b, 0);
+
+    // added back to front
+    MixNode  mix;
+    GainNode gain_b(2, 3.0f);
+    GainNode gain_a(1, 2.0f);
+    EXPECT_EQ(graph.AddNode(mix, {a, b}, {graph.Output(0), graph.Output(1)}),
+              0);
+    EXPECT_EQ(graph.AddNode(gain_b, {graph.Input(1)}, {b}), 1);
+    EXPECT_EQ(graph.AddNode(gain_a, {graph.Input(0)}, {a}), 2);
+    ASSERT_EQ(graph.Finalize(48000.0f, kBlockSize), Graph::Result::OK);
+
+    float        in0[kBlockSize] = {1, 1, 1, 1};
+    float        in1[kBlockSize] = {2, 2, 2, 2};
+    float        out0[kBlockSize], out1[kBlockSize];
+    const float* in[]  = {in0, in1};
+    float*       out[] = {out0, out1};
+    run_log.clear();
+    graph.Process(in, out, kBlockSize);
+
+    EXPECT_EQ(run_log, (std::vector<int>{2, 1, 100}));
+    for(size_t i = 0; i < kBlockSize; i++)
+    {
+        EXPECT_FLOAT_EQ(out0[i], 8.0f);
+        EXPECT_FLOAT_EQ(out1[i], -8.0f);
+    }
+    // the first stage reads the engine's buffers directly
+    EXPECT_EQ(gain_a.last_in_, in0);
+    EXPECT_EQ(gain_b.last_in_, in1);
+}
+
+TEST(util_AudioGraph, b_inPlaceNodesKeepTheirOrder)
+{
+    using Graph = AudioGraph<4, 4>;
+    static AudioGraphArena<1, kBlockSize> arena;
+    Graph                                 graph;
+    graph.Init(arena, 1, 1);
+    const int bus = graph.AddBuffer();
+
+    GainNode times2(1, 2.0f);
+    GainNode plus1(2, 1.0f, 1.0f);
+    GainNode src(3, 1.0f);
+    GainNode sink(4, 1.0f);
+    // in place nodes before the node that fills the bus
+    EXPECT_EQ(graph.AddNode(times2, {bus}, {bus}), 0);
+    EXPECT_EQ(graph.AddNode(plus1, {bus}, {bus}), 1);
+    EXPECT_EQ(graph.AddNode(sink, {bus}, {graph.Output(0)}), 2);
+    EXPECT_EQ(graph.AddNode(src, {graph.Input(0)}, {bus}), 3);
+    ASSERT_EQ(graph.Finalize(48000.0f, kBlockSize), Graph::Result::OK);
+
+    float        in0[kBlockSize] = {1, 2, 3, 4};
+    float        out0[kBlockSize];
+    const float* in[]  = {in0};
+    float*       out[] = {out0};
+    run_log.clear();
+    graph.Process(in, out, kBlockSize);
+
+    EXPECT_EQ(run_log, (std::vector<int>{3, 1, 2, 4}));
+    for(size_t i = 0; i < kBlockSize; i++)
+        EXPECT_FLOAT_EQ(out0[i], in0[i] * 2.0f + 1.0f);
+    EXPECT_EQ(times2.last_in_, times2.last_out_);
+    EXPECT_EQ(graph.GetExecutionOrder(0), 3u);
+}
+
+TEST(util_AudioGraph, c_rejectsInvalidGraphs)
+{
+    using Graph = AudioGraph<2, 5>;
+    static AudioGraphArena<2, kBlockSize> arena;
+    Graph                                 graph;
+    graph.Init(arena, 1, 1);
+
+    // arena holds two buffers
+    const int a = graph.AddBuffer();
+    const int b = graph.AddBuffer();
+    EXPECT_EQ(graph.AddBuffer(), -1);
+
+    GainNode n1(1, 1.0f), n2(2, 1.0f), n3(3, 1.0f);
+    // inputs are read only, unknown buffers are rejected
+    EXPECT_EQ(graph.AddNode(n1, {a}, {graph.Input(0)}), -1);
+    EXPECT_EQ(graph.AddNode(n1, {a}, {7}), -1);
+    EXPECT_EQ(graph.Output(1), -1);
+
+    // a <-> b is a cycle
+    EXPECT_EQ(graph.AddNode(n1, {a}, {b}), 0);
+    EXPECT_EQ(graph.AddNode(n2, {b}, {a}), 1);
+    EXPECT_EQ(graph.AddNode(n3, {b}, {a}), -1); // full
+    EXPECT_EQ(graph.Finalize(48000.0f, kBlockSize), Graph::Result::ERR);
+    EXPECT_FALSE(graph.IsFinalized());
+
+    // not finalized, the outputs are cleared
+    float        in0[kBlockSize] = {1, 2, 3, 4};
+    float        out0[kBlockSize] = {1, 2, 3, 4};
+    const float* in[]             = {in0};
+    float*       out[]            = {out0};
+    run_log.clear();
+    graph.Process(in, out, kBlockSize);
+    EXPECT_TRUE(run_log.empty());
+    for(float x : out0)
+        EXPECT_EQ(x, 0.0f);
+
+    // blocksize larger than the arena's
+    graph.Init(arena, 1, 1);
+    EXPECT_EQ(graph.Finalize(48000.0f, kBlockSize + 1), Graph::Result::ERR);
+}
+
+TEST(util_AudioGraph, d_unwrittenOutputsAreCleared)
+{
+    using Graph = AudioGraph<2, 4>;
+    static AudioGraphArena<1, kBlockSize> arena;
+    Graph                                 graph;
+    graph.Init(arena, 1, 2);
+    GainNode n(1, 1.0f);
+    graph.AddNode(n, {graph.Input(0)}, {graph.Output(0)});
+    ASSERT_EQ(graph.Finalize(48000.0f, kBlockSize), Graph::Result::OK);
+
+    float        in0[kBlockSize]  = {1, 2, 3, 4};
+    float        out0[kBlockSize] = {};
+    float        out1[kBlockSize] = {5, 5, 5, 5};
+    const float* in[]             = {in0};
+    float*       out[]            = {out0, out1};
+    graph.Process(in, out, kBlockSize);
+    for(size_t i = 0; i < kBlockSize; i++)
+    {
+        EXPECT_EQ(out0[i], in0[i]);
+        EXPECT_EQ(out1[i], 0.0f);
+    }
+}
+
+TEST(util_AudioGraph, e_perNodeLoad)
+{
+    System::SetTickFreqForUnitTest(1000000u); // 1us tick duration
+    using Graph = AudioGraph<2, 4>;
+    static AudioGraphArena<1, 48> arena;
+    Graph                         graph;
+    graph.Init(arena, 1, 1);
+    const int bus = graph.AddBuffer();
+    GainNode  cheap(1, 1.0f, 0.0f, 100);
+    GainNode  expensive(2, 1.0f, 0.0f, 700);
+    const int cheap_idx = graph.AddNode(cheap, {graph.Input(0)}, {bus});
+    const int expensive_idx
+        = graph.AddNode(expensive, {bus}, {graph.Output(0)});
+    // 1kHz block rate, 1000us per block
+    ASSERT_EQ(graph.Finalize(48000.0f, 48), Graph::Result::OK);
+
+    float        in0[48] = {};
+    float        out0[48];
+    const float* in[]  = {in0};
+    float*       out[] = {out0};
+    graph.Process(in, out, 48);
+
+    EXPECT_FLOAT_EQ(graph.GetNodeLoadMeter(cheap_idx).GetMaxCpuLoad(), 0.1f);
+    EXPECT_FLOAT_EQ(graph.GetNodeLoadMeter(expensive_idx).GetMaxCpuLoad(),
+                    0.7f);
+    EXPECT_FLOAT_EQ(graph.GetLoadMeter().GetMaxCpuLoad(), 0.8f);
+}
@@ -0,0 +1,322 @@
+#include "hid/audio.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+/** What the callbacks in these tests have seen */
+struct CallbackLog
+{
+    size_t                    num_calls = 0;
+    size_t                    size      = 0;
+    AudioHandle::NativeFormat format    = {};
+    const int32_t*            in[2]     = {nullptr, nullptr};
+    int32_t*                  out[2]    = {nullptr, nullptr};
+    std::vector<float>        float_in;
+};
+CallbackLog cb_log;
+
+void NativeCallback(AudioHandle::NativeInputBuffer  in,
+                    AudioHandle::NativeOutputBuffer out,
+                    size_t                          size,
+                    const AudioHandle::NativeFormat& format)
+{
+    cb_log.num_calls++;
+    cb_log.size   = size;
+    cb_log.format = format;
+    for(size_t b = 0; b < format.num_buffers; b++)
+    {
+        cb_log.in[b]  = in[b];
+        cb_log.out[b] = out[b];
+        // pass through, inverted, so that we can tell the buffers apart
+        for(size_t i = 0; i < size * format.channels_per_buffer; i++)
+            out[b][i] = -in[b][i];
+    }
+}
+
+void FloatCallback(AudioHandle::InputBuffer  in,
+                   AudioHandle::OutputBuffer out,
+                   size_t                    size)
+{
+    cb_log.num_calls++;
+    cb_log.size = size;
+    cb_log.float_in.assign(in[0], in[0] + size);
+    for(size_t i = 0; i < size; i++)
+    {
+        out[0][i] = 0.5f;
+        out[1][i] = -0.5f;
+    }
+}
+
+SaiHandle MakeSai(SaiHandle::Config::Peripheral periph)
+{
+    SaiHandle::Config cfg;
+    cfg.periph    = periph;
+    cfg.sr        = SaiHandle::Config::SampleRate::SAI_48KHZ;
+    cfg.bit_depth = SaiHandle::Config::BitDepth::SAI_24BIT;
+    cfg.a_sync    = SaiHandle::Config::Sync::MASTER;
+    cfg.b_sync    = SaiHandle::Config::Sync::SLAVE;
+    cfg.a_dir     = SaiHandle::Config::Direction::TRANSMIT;
+    cfg.b_dir     = SaiHandle::Config::Direction::RECEIVE;
+    SaiHandle sai;
+    sai.Init(cfg);
+    return sai;
+}
+
+} // namespace
+
+TEST(hid_AudioHandle, a_nativeCallbackGetsDmaBuffers)
+{
+    cb_log = CallbackLog();
+    SaiHandle           sai = MakeSai(SaiHandle::Config::Peripheral::SAI_1);
+    AudioHandle::Config cfg;
+    cfg.blocksize = 4;
+    AudioHandle audio;
+    ASSERT_EQ(audio.Init(cfg, sai), AudioHandle::Result::OK);
+    ASSERT_EQ(audio.Start(NativeCallback), AudioHandle::Result::OK);
+
+    // first half
+    sai.TriggerDmaCallbackForUnitTest(false);
+    EXPECT_EQ(cb_log.num_calls, 1u);
+    EXPECT_EQ(cb_log.size, 4u);
+    EXPECT_EQ(cb_log.format.bit_depth, SaiHandle::Config::BitDepth::SAI_24BIT);
+    EXPECT_EQ(cb_log.format.num_buffers, 1u);
+    EXPECT_EQ(cb_log.format.channels_per_buffer, 2u);
+    const int32_t* first_in  = cb_log.in[0];
+    int32_t*       first_out = cb_log.out[0];
+
+    // second half points further into the same DMA buffers
+    sai.TriggerDmaCallbackForUnitTest(true);
+    EXPECT_EQ(cb_log.num_calls, 2u);
+    EXPECT_EQ(cb_log.in[0], first_in + 8);
+    EXPECT_EQ(cb_log.out[0], first_out + 8);
+
+    // raw data is handed over without conversion
+    int32_t* rx = const_cast<int32_t*>(first_in);
+    for(int i = 0; i < 8; i++)
+        rx[i] = 0x00123456 + i;
+    sai.TriggerDmaCallbackForUnitTest(false);
+    EXPECT_EQ(cb_log.in[0], first_in);
+    for(int i = 0; i < 8; i++)
+        EXPECT_EQ(first_out[i], -(0x00123456 + i));
+
+    audio.Stop();
+}
+
+TEST(hid_AudioHandle, b_changeBetweenNativeAndFloat)
+{
+    cb_log = CallbackLog();
+    SaiHandle           sai = MakeSai(SaiHandle::Config::Peripheral::SAI_1);
+    AudioHandle::Config cfg;
+    cfg.blocksize = 4;
+    AudioHandle audio;
+    ASSERT_EQ(audio.Init(cfg, sai), AudioHandle::Result::OK);
+    ASSERT_EQ(audio.Start(NativeCallback), AudioHandle::Result::OK);
+    sai.TriggerDmaCallbackForUnitTest(false);
+    int32_t* rx = const_cast<int32_t*>(cb_log.in[0]);
+    int32_t* tx = cb_log.out[0];
+
+    // switch to the float callback, it sees the same memory, converted
+    EXPECT_EQ(audio.ChangeCallback(FloatCallback), AudioHandle::Result::OK);
+    for(int i = 0; i < 8; i++)
+        rx[i] = 0x00400000; // 0.5 at 24 bit
+    sai.TriggerDmaCallbackForUnitTest(false);
+    ASSERT_EQ(cb_log.float_in.size(), 4u);
+    for(float x : cb_log.float_in)
+        EXPECT_FLOAT_EQ(x, 0.5f);
+    for(int i = 0; i < 8; i += 2)
+    {
+        EXPECT_EQ(tx[i], f2s24(0.5f));
+        EXPECT_EQ(tx[i + 1], f2s24(-0.5f));
+    }
+
+    // and back
+    EXPECT_EQ(audio.ChangeCallback(NativeCallback), AudioHandle::Result::OK);
+    const size_t calls = cb_log.num_calls;
+    sai.TriggerDmaCallbackForUnitTest(false);
+    EXPECT_EQ(cb_log.num_calls, calls + 1);
+    EXPECT_EQ(tx[0], -0x00400000);
+
+    // nullptr is rejected
+    AudioHandle::NativeAudioCallback null_cb = nullptr;
+    EXPECT_EQ(audio.ChangeCallback(null_cb), AudioHandle::Result::ERR);
+
+    audio.Stop();
+}
+
+TEST(hid_AudioHandle, c_nativeCallbackWithTwoSai)
+{
+    cb_log = CallbackLog();
+    SaiHandle sai1 = MakeSai(SaiHandle::Config::Peripheral::SAI_1);
+    SaiHandle sai2 = MakeSai(SaiHandle::Config::Peripheral::SAI_2);
+    AudioHandle::Config cfg;
+    cfg.blocksize = 8;
+    AudioHandle audio;
+    ASSERT_EQ(audio.Init(cfg, sai1, sai2), AudioHandle::Result::OK);
+    ASSERT_EQ(audio.GetChannels(), 4u);
+    ASSERT_EQ(audio.Start(NativeCallback), AudioHandle::Result::OK);
+
+    // second SAI runs ahead into its second half
+    sai2.TriggerDmaCallbackForUnitTest(false);
+    EXPECT_EQ(cb_log.num_calls, 0u);
+    sai1.TriggerDmaCallbackForUnitTest(false);
+    const int32_t* sai2_first_half = cb_log.in[1];
+    sai2.TriggerDmaCallbackForUnitTest(true);
+    sai1.TriggerDmaCallbackForUnitTest(true);
+
+    EXPECT_EQ(cb_log.num_calls, 2u);
+    EXPECT_EQ(cb_log.size, 8u);
+    EXPECT_EQ(cb_log.format.num_buffers, 2u);
+    ASSERT_NE(cb_log.in[1], nullptr);
+    EXPECT_NE(cb_log.in[1], cb_log.in[0]);
+    EXPECT_EQ(cb_log.in[1], sai2_first_half + 16);
+
+    audio.Stop();
+}
+
+TEST(hid_AudioHandle, d_blockSizeLimit)
+{
+    SaiHandle           sai = MakeSai(SaiHandle::Config::Peripheral::SAI_1);
+    AudioHandle::Config cfg;
+    AudioHandle         audio;
+    ASSERT_EQ(audio.Init(cfg, sai), AudioHandle::Result::OK);
+
+    EXPECT_EQ(audio.SetBlockSize(1024), AudioHandle::Result::ERR);
+    EXPECT_EQ(audio.GetConfig().blocksize, 256u);
+
+    cb_log = CallbackLog();
+    ASSERT_EQ(audio.Start(NativeCallback), AudioHandle::Result::OK);
+    sai.TriggerDmaCallbackForUnitTest(false);
+    EXPECT_EQ(cb_log.size, 256u);
+
+    audio.Stop();
+}
+
+TEST(hid_AudioHandle, e_tdmSingleSai)
+{
+    cb_log = CallbackLog();
+    SaiHandle::Config sai_cfg
+        = MakeSai(SaiHandle::Config::Peripheral::SAI_1).GetConfig();
+    sai_cfg.slots = 8;
+    SaiHandle sai[1];
+    ASSERT_EQ(sai[0].Init(sai_cfg), SaiHandle::Result::OK);
+    static AudioHandle::DmaBuffers<1, 8, 16> buffers;
+    EXPECT_EQ(sizeof(buffers.rx[0]), 16u * 8u * 2u * sizeof(int32_t));
+
+    AudioHandle::Config cfg;
+    cfg.blocksize = 32; // too large for the buffers, gets clamped
+    AudioHandle audio;
+    ASSERT_EQ(audio.Init(cfg, sai, buffers), AudioHandle::Result::OK);
+    EXPECT_EQ(audio.GetChannels(), 8u);
+    EXPECT_EQ(audio.GetConfig().blocksize, 16u);
+    EXPECT_EQ(audio.SetBlockSize(4), AudioHandle::Result::OK);
+    EXPECT_EQ(audio.SetBlockSize(17), AudioHandle::Result::ERR);
+    EXPECT_EQ(audio.GetConfig().blocksize, 16u);
+    ASSERT_EQ(audio.SetBlockSize(4), AudioHandle::Result::OK);
+
+    // slot n of frame i carries channel n
+    for(int i = 0; i < 4; i++)
+        for(int n = 0; n < 8; n++)
+            buffers.rx[0][i * 8 + n] = (n + 1) << 16;
+    ASSERT_EQ(audio.Start(FloatCallback), AudioHandle::Result::OK);
+    sai[0].TriggerDmaCallbackForUnitTest(false);
+    EXPECT_EQ(cb_log.size, 4u);
+    for(float x : cb_log.float_in)
+        EXPECT_FLOAT_EQ(x, s242f(1 << 16));
+    // channels 0 and 1 written by the callback, the others are silent
+    for(int i = 0; i < 4; i++)
+    {
+        EXPECT_EQ(buffers.tx[0][i * 8], f2s24(0.5f));
+        EXPECT_EQ(buffers.tx[0][i * 8 + 1], f2s24(-0.5f));
+    }
+
+    ASSERT_EQ(audio.ChangeCallback(NativeCallback), AudioHandle::Result::OK);
+    sai[0].TriggerDmaCallbackForUnitTest(true);
+    EXPECT_EQ(cb_log.format.num_buffers, 1u);
+    EXPECT_EQ(cb_log.format.channels_per_buffer, 8u);
+    EXPECT_EQ(cb_log.in[0], buffers.rx[0] + 4 * 8);
+
+    audio.Stop();
+}
+
+TEST(hid_AudioHandle, f_tdmTwoSai)
+{
+    SaiHandle sai[2];
+    for(int s = 0; s < 2; s++)
+    {
+        SaiHandle::Config sai_cfg
+            = MakeSai(s == 0 ? SaiHandle::Config::Peripheral::SAI_1
+                             : SaiHandle::Config::Peripheral::SAI_2)
+                  .GetConfig();
+        sai_cfg.slots = 4;
+        ASSERT_EQ(sai[s].Init(sai_cfg), SaiHandle::Result::OK);
+    }
+    static AudioHandle::DmaBuffers<2, 4, 8> buffers;
+
+    AudioHandle::Config cfg;
+    cfg.blocksize = 2;
+    AudioHandle audio;
+    ASSERT_EQ(audio.Init(cfg, sai, buffers), AudioHandle::Result::OK);
+    EXPECT_EQ(audio.GetChannels(), 8u);
+
+    // SAI 1 carries channels 4..7
+    for(int i = 0; i < 2; i++)
+        for(int n = 0; n < 4; n++)
+        {
+            buffers.rx[0][i * 4 + n] = n << 16;
+            buffers.rx[1][i * 4 + n] = (n + 4) << 16;
+        }
+    static float seen[8];
+    ASSERT_EQ(audio.Start([](AudioHandle::InputBuffer  in,
+                             AudioHandle::OutputBuffer out,
+                             size_t                    size) {
+                  for(size_t c = 0; c < 8; c++)
+                  {
+                      seen[c] = in[c][size - 1];
+                      for(size_t i = 0; i < size; i++)
+                          out[c][i] = in[c][i];
+                  }
+              }),
+              AudioHandle::Result::OK);
+    sai[0].TriggerDmaCallbackForUnitTest(false);
+    for(int c = 0; c < 8; c++)
+        EXPECT_FLOAT_EQ(seen[c], s242f(c << 16));
+    for(int i = 0; i < 8; i++)
+    {
+        EXPECT_EQ(buffers.tx[0][i], buffers.rx[0][i]);
+        EXPECT_EQ(buffers.tx[1][i], buffers.rx[1][i]);
+    }
+    audio.Stop();
+
+    // mismatched slot counts are rejected
+    SaiHandle::Config sai_cfg = sai[1].GetConfig();
+    sai_cfg.slots             = 2;
+    ASSERT_EQ(sai[1].Init(sai_cfg), SaiHandle::Result::OK);
+    EXPECT_EQ(audio.Init(cfg, sai, buffers), AudioHandle::Result::ERR);
+}
+
+TEST(hid_AudioHandle, g_unsupportedSlotCounts)
+{
+    // only slot counts with conversion kernels are accepted
+    SaiHandle::Config sai_cfg
+        = MakeSai(SaiHandle::Config::Peripheral::SAI_1).GetConfig();
+    for(uint8_t slots : {0, 3, 6, 12, 17})
+    {
+        sai_cfg.slots = slots;
+        SaiHandle sai;
+        EXPECT_EQ(sai.Init(sai_cfg), SaiHandle::Result::ERR);
+    }
+
+    sai_cfg.slots = 2;
+    SaiHandle sai;
+    ASSERT_EQ(sai.Init(sai_cfg), SaiHandle::Result::OK);
+    static int32_t      rx[3 * 2 * 8], tx[3 * 2 * 8];
+    int32_t* const      buff_rx[] = {rx};
+    int32_t* const      buff_tx[] = {tx};
+    AudioHandle::Config cfg;
+    AudioHandle         audio;
+    EXPECT_EQ(audio.Init(cfg, &sai, 1, buff_rx, buff_tx, 3, 8),
+              AudioHandle::Result::ERR);
+}
@@ -0,0 +1,137 @@
+#include "util/CpuLoadProfiler.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <type_traits>
+
+using namespace daisy;
+
+namespace
+{
+using Profiler = CpuLoadProfiler<4>;
+
+// a CpuLoadMeter& to the profiler would skip the counters in OnBlockEnd()
+static_assert(!std::is_convertible<Profiler&, CpuLoadMeter&>::value,
+              "the profiler must not be usable as a CpuLoadMeter");
+
+/** Measures a block that takes the given number of ticks */
+void MeasureBlock(Profiler& profiler, uint32_t ticks)
+{
+    profiler.OnBlockStart();
+    System::SetTickForUnitTest(System::GetTick() + ticks);
+    profiler.OnBlockEnd();
+}
+} // namespace
+
+TEST(util_CpuLoadProfiler, a_stateAfterInit)
+{
+    Profiler profiler;
+    profiler.Init(48000.0f, 48);
+
+    Profiler::Snapshot snapshot;
+    profiler.GetSnapshot(snapshot);
+    EXPECT_EQ(snapshot.num_blocks, 0u);
+    EXPECT_EQ(snapshot.num_overruns, 0u);
+    EXPECT_EQ(snapshot.num_near_deadline, 0u);
+    EXPECT_EQ(snapshot.num_overrun_ticks, 0u);
+    for(auto count : snapshot.histogram)
+        EXPECT_EQ(count, 0u);
+    EXPECT_TRUE(std::isnan(snapshot.max));
+    EXPECT_TRUE(std::isnan(snapshot.last));
+    EXPECT_TRUE(std::isnan(profiler.GetMaxCpuLoad()));
+}
+
+TEST(util_CpuLoadProfiler, b_bucketMath)
+{
+    // octaves below 1.0 are split into 4 buckets each
+    EXPECT_EQ(Profiler::GetBucket(1.0f), 28u);
+    EXPECT_EQ(Profiler::GetBucket(0.5f), 24u);
+    EXPECT_EQ(Profiler::GetBucket(0.74f), 25u);
+    EXPECT_EQ(Profiler::GetBucket(0.75f), 26u);
+    EXPECT_EQ(Profiler::GetBucket(0.96f), 27u);
+    EXPECT_EQ(Profiler::GetBucket(1.3f), 29u);
+    // out of range values are clamped
+    EXPECT_EQ(Profiler::GetBucket(0.0f), 0u);
+    EXPECT_EQ(Profiler::GetBucket(1e-6f), 0u);
+    EXPECT_EQ(Profiler::GetBucket(100.0f), Profiler::kNumBuckets - 1);
+
+    EXPECT_FLOAT_EQ(Profiler::GetBucketLowerBound(0), 0.0f);
+    EXPECT_FLOAT_EQ(Profiler::GetBucketLowerBound(1), 1.25f / 128.0f);
+    EXPECT_FLOAT_EQ(Profiler::GetBucketLowerBound(27), 0.875f);
+    EXPECT_FLOAT_EQ(Profiler::GetBucketLowerBound(28), 1.0f);
+    EXPECT_FLOAT_EQ(Profiler::GetBucketLowerBound(31), 1.75f);
+
+    // every bucket starts where the previous one ends
+    for(size_t b = 1; b < Profiler::kNumBuckets; b++)
+    {
+        const float lower = Profiler::GetBucketLowerBound(b);
+        EXPECT_EQ(Profiler::GetBucket(lower), b);
+        EXPECT_EQ(Profiler::GetBucket(std::nextafter(lower, 0.0f)), b - 1);
+    }
+}
+
+TEST(util_CpuLoadProfiler, c_histogramAndCounters)
+{
+    System::SetTickFreqForUnitTest(1000000u); // 1us tick duration
+    Profiler profiler;
+    profiler.Init(48000.0f, 48); // 1kHz block rate, 1000us per block
+
+    MeasureBlock(profiler, 200);  // 0.2
+    MeasureBlock(profiler, 210);  // 0.21
+    MeasureBlock(profiler, 960);  // 0.96, close to the deadline
+    MeasureBlock(profiler, 990);  // 0.99, still in time
+    MeasureBlock(profiler, 1200); // overrun
+
+    Profiler::Snapshot snapshot;
+    profiler.GetSnapshot(snapshot);
+    EXPECT_EQ(snapshot.num_blocks, 5u);
+    EXPECT_EQ(snapshot.num_near_deadline, 2u);
+    EXPECT_EQ(snapshot.num_overruns, 1u);
+    EXPECT_EQ(profiler.GetNumOverruns(), 1u);
+    EXPECT_FLOAT_EQ(snapshot.min, 0.2f);
+    EXPECT_FLOAT_EQ(snapshot.max, 1.2f);
+    EXPECT_FLOAT_EQ(snapshot.last, 1.2f);
+
+    uint32_t total = 0;
+    for(auto count : snapshot.histogram)
+        total += count;
+    EXPECT_EQ(total, 5u);
+    EXPECT_EQ(snapshot.histogram[Profiler::GetBucket(0.2f)], 2u);
+    EXPECT_EQ(snapshot.histogram[27], 2u);
+    EXPECT_EQ(snapshot.histogram[Profiler::GetBucket(1.2f)], 1u);
+
+    // custom threshold
+    profiler.Init(48000.0f, 48, 0.5f);
+    MeasureBlock(profiler, 600);
+    profiler.GetSnapshot(snapshot);
+    EXPECT_EQ(snapshot.num_near_deadline, 1u);
+}
+
+TEST(util_CpuLoadProfiler, d_lastOverrunTicks)
+{
+    System::SetTickFreqForUnitTest(1000000u);
+    System::SetTickForUnitTest(0);
+    Profiler profiler;
+    profiler.Init(48000.0f, 48);
+
+    Profiler::Snapshot snapshot;
+    uint32_t           starts[6];
+    for(int i = 0; i < 6; i++)
+    {
+        MeasureBlock(profiler, 100);
+        starts[i] = System::GetTick();
+        MeasureBlock(profiler, 1500);
+    }
+    profiler.GetSnapshot(snapshot);
+    EXPECT_EQ(snapshot.num_overruns, 6u);
+    EXPECT_EQ(snapshot.num_blocks, 12u);
+
+    // only the last 4 are kept, oldest first
+    ASSERT_EQ(snapshot.num_overrun_ticks, 4u);
+    for(int i = 0; i < 4; i++)
+        EXPECT_EQ(snapshot.overrun_ticks[i], starts[i + 2]);
+
+    profiler.Reset();
+    profiler.GetSnapshot(snapshot);
+    EXPECT_EQ(snapshot.num_overruns, 0u);
+    EXPECT_EQ(snapshot.num_overrun_ticks, 0u);
+}
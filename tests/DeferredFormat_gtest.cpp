@@ -0,0 +1,105 @@
+#include "util/DeferredFormat.h"
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace daisy;
+
+namespace
+{
+/** Packs the arguments and formats them into a buffer of the size */
+std::string
+FormatWithSizes(size_t args_size, size_t text_size, const char* format, ...)
+{
+    uint8_t args[256];
+    va_list va;
+    va_start(va, format);
+    const size_t packed = DeferredFormat::Pack(format, va, args, args_size);
+    va_end(va);
+
+    char         text[256];
+    const size_t len
+        = DeferredFormat::Format(text, text_size, format, args, packed);
+    EXPECT_EQ(strlen(text), len < text_size ? len : text_size - 1);
+    return text;
+}
+
+#define FORMAT(...) FormatWithSizes(256, 256, __VA_ARGS__)
+
+/** Checks that the deferred text is the same as from snprintf() */
+#define EXPECT_SAME(...)                                   \
+    {                                                      \
+        char expected[256];                                \
+        snprintf(expected, sizeof(expected), __VA_ARGS__); \
+        EXPECT_EQ(FORMAT(__VA_ARGS__), expected);          \
+    }
+} // namespace
+
+TEST(util_DeferredFormat, a_matchesPrintf)
+{
+    EXPECT_SAME("plain text");
+    EXPECT_SAME("%d %i %u %x %X %o %c", -12, 34, 56u, 0xab, 0xcd, 8, 'z');
+    EXPECT_SAME("%hhd %hd %ld %lld %zu %td %jd",
+                (char)-1,
+                (short)-2,
+                -3l,
+                -4ll,
+                size_t(5),
+                ptrdiff_t(-6),
+                intmax_t(7));
+    EXPECT_SAME(
+        "%f %.2f %e %g %10.3f %-8.1f|", 1.5, -2.25, 1e-5, 0.1, 3.0f, 4.0);
+    EXPECT_SAME("%s and %10s and %-4s|", "this", "that", "x");
+    EXPECT_SAME("%*d %.*f %*.*s|", 5, 42, 3, 1.0, 6, 2, "abcdef");
+    EXPECT_SAME("%p %p", (void*)0x1234, (void*)nullptr);
+    EXPECT_SAME("100%% %+d %05d %#x", 7, 8, 9);
+}
+
+TEST(util_DeferredFormat, b_copiesStrings)
+{
+    char str[] = "changes later";
+    // the format string is kept, the strings are copied
+    uint8_t     args[64];
+    const char* format = "[%s]";
+    va_list     va;
+    auto        pack = [&](const char* fmt, ...) {
+        va_start(va, fmt);
+        const size_t size = DeferredFormat::Pack(fmt, va, args, sizeof(args));
+        va_end(va);
+        return size;
+    };
+    const size_t size = pack(format, str);
+    str[0]            = 'C';
+    char text[64];
+    DeferredFormat::Format(text, sizeof(text), format, args, size);
+    EXPECT_STREQ(text, "[changes later]");
+
+    // long strings are cut
+    const std::string long_str(100, 'a');
+    EXPECT_EQ(FORMAT("%s", long_str.c_str()),
+              long_str.substr(0, DeferredFormat::kMaxStringLength));
+    EXPECT_EQ(FORMAT("%s", (const char*)nullptr), "(null)");
+}
+
+TEST(util_DeferredFormat, c_truncates)
+{
+    // the text
+    EXPECT_EQ(FormatWithSizes(256, 8, "%d and %s", 12345, "more"), "12345 a");
+    char         text[4];
+    const size_t len = DeferredFormat::Format(
+        text, sizeof(text), "abcdef", nullptr, 0);
+    EXPECT_EQ(len, 6u);
+    EXPECT_STREQ(text, "abc");
+
+    // arguments that don't fit stop the output
+    EXPECT_EQ(FormatWithSizes(6, 64, "%d, %d, %d", 1, 2, 3), "1, ");
+    EXPECT_EQ(FormatWithSizes(6, 64, "%d %s", 1, "long string"), "1 l");
+}
+
+TEST(util_DeferredFormat, d_stopsAtUnsupported)
+{
+    int count = 0;
+    EXPECT_EQ(FORMAT("a %d %n b", 1, &count), "a 1 ");
+    EXPECT_EQ(count, 0);
+    EXPECT_EQ(FORMAT("x %Lf y", 1.0L), "x ");
+    EXPECT_EQ(FORMAT("z %"), "z ");
+}
@@ -0,0 +1,176 @@
+#include "util/DmaJobScheduler.h"
+#include <gtest/gtest.h>
+
+using namespace daisy;
+
+// 4 peripherals on 2 streams, 2 jobs per queue
+using Scheduler  = DmaJobScheduler<int, 4, 2, 2>;
+using Submission = Scheduler::Submission;
+
+TEST(util_DmaJobScheduler, a_stateAfterConstruction)
+{
+    Scheduler scheduler;
+    for(size_t stream = 0; stream < 2; stream++)
+    {
+        EXPECT_FALSE(scheduler.IsBusy(stream));
+        EXPECT_EQ(scheduler.GetActivePeripheral(stream), -1);
+    }
+    for(size_t per = 0; per < 4; per++)
+        EXPECT_EQ(scheduler.GetNumQueued(per), 0u);
+
+    size_t per = 42;
+    int    job = 42;
+    EXPECT_FALSE(scheduler.ClaimNext(0, per, job));
+    EXPECT_EQ(per, 42u);
+    EXPECT_EQ(job, 42);
+}
+
+TEST(util_DmaJobScheduler, b_startsRightAwayWhenIdle)
+{
+    Scheduler scheduler;
+    EXPECT_EQ(scheduler.Submit(1, 0, 10), Submission::START);
+    EXPECT_TRUE(scheduler.IsBusy(0));
+    EXPECT_EQ(scheduler.GetActivePeripheral(0), 1);
+    EXPECT_EQ(scheduler.GetNumQueued(1), 0u);
+
+    // the other stream is independent
+    EXPECT_FALSE(scheduler.IsBusy(1));
+    EXPECT_EQ(scheduler.Submit(2, 1, 20), Submission::START);
+    EXPECT_EQ(scheduler.GetActivePeripheral(1), 2);
+
+    scheduler.Release(0);
+    EXPECT_FALSE(scheduler.IsBusy(0));
+    EXPECT_TRUE(scheduler.IsBusy(1));
+}
+
+TEST(util_DmaJobScheduler, c_queuesWhileBusy)
+{
+    Scheduler scheduler;
+    EXPECT_EQ(scheduler.Submit(0, 0, 10), Submission::START);
+    EXPECT_EQ(scheduler.Submit(0, 0, 11), Submission::QUEUED);
+    EXPECT_EQ(scheduler.Submit(0, 0, 12), Submission::QUEUED);
+    EXPECT_EQ(scheduler.GetNumQueued(0), 2u);
+
+    // a full queue rejects the job instead of waiting
+    EXPECT_EQ(scheduler.Submit(0, 0, 13), Submission::REJECTED);
+    EXPECT_EQ(scheduler.GetNumQueued(0), 2u);
+
+    // nothing can be claimed while the stream is busy
+    size_t per;
+    int    job;
+    EXPECT_FALSE(scheduler.ClaimNext(0, per, job));
+
+    // the queued jobs follow in order
+    for(int expected = 11; expected <= 12; expected++)
+    {
+        scheduler.Release(0);
+        EXPECT_TRUE(scheduler.ClaimNext(0, per, job));
+        EXPECT_EQ(per, 0u);
+        EXPECT_EQ(job, expected);
+        EXPECT_EQ(scheduler.GetActivePeripheral(0), 0);
+    }
+    scheduler.Release(0);
+    EXPECT_FALSE(scheduler.ClaimNext(0, per, job));
+    EXPECT_FALSE(scheduler.IsBusy(0));
+}
+
+TEST(util_DmaJobScheduler, d_queuedJobsComeFirst)
+{
+    Scheduler scheduler;
+    EXPECT_EQ(scheduler.Submit(0, 0, 10), Submission::START);
+    EXPECT_EQ(scheduler.Submit(1, 0, 20), Submission::QUEUED);
+    scheduler.Release(0);
+
+    // the stream is idle, but peripheral 1 has a job waiting already
+    EXPECT_EQ(scheduler.Submit(1, 0, 21), Submission::QUEUED);
+    EXPECT_FALSE(scheduler.IsBusy(0));
+
+    size_t per;
+    int    job;
+    EXPECT_TRUE(scheduler.ClaimNext(0, per, job));
+    EXPECT_EQ(per, 1u);
+    EXPECT_EQ(job, 20);
+}
+
+TEST(util_DmaJobScheduler, e_roundRobin)
+{
+    Scheduler scheduler;
+    EXPECT_EQ(scheduler.Submit(2, 0, 20), Submission::START);
+    for(size_t p = 0; p < 4; p++)
+    {
+        EXPECT_EQ(scheduler.Submit(p, 0, 10 * p + 1), Submission::QUEUED);
+        EXPECT_EQ(scheduler.Submit(p, 0, 10 * p + 2), Submission::QUEUED);
+    }
+
+    // starting after the peripheral served last, each waiting peripheral
+    // gets a turn before any of them gets a second one
+    const int expected[] = {31, 1, 11, 21, 32, 2, 12, 22};
+    for(int e : expected)
+    {
+        scheduler.Release(0);
+        size_t per;
+        int    job;
+        EXPECT_TRUE(scheduler.ClaimNext(0, per, job));
+        EXPECT_EQ(job, e);
+        EXPECT_EQ(per, size_t(e / 10));
+    }
+}
+
+TEST(util_DmaJobScheduler, f_onlyServesPeripheralsOfTheStream)
+{
+    Scheduler scheduler;
+    EXPECT_EQ(scheduler.Submit(0, 0, 10), Submission::START);
+    EXPECT_EQ(scheduler.Submit(1, 1, 20), Submission::START);
+    EXPECT_EQ(scheduler.Submit(1, 1, 21), Submission::QUEUED);
+    EXPECT_EQ(scheduler.Submit(3, 0, 30), Submission::QUEUED);
+
+    // the job of peripheral 1 waits for stream 1
+    scheduler.Release(0);
+    size_t per;
+    int    job;
+    EXPECT_TRUE(scheduler.ClaimNext(0, per, job));
+    EXPECT_EQ(per, 3u);
+    scheduler.Release(0);
+    EXPECT_FALSE(scheduler.ClaimNext(0, per, job));
+    EXPECT_EQ(scheduler.GetNumQueued(1), 1u);
+
+    scheduler.Release(1);
+    EXPECT_TRUE(scheduler.ClaimNext(1, per, job));
+    EXPECT_EQ(per, 1u);
+    EXPECT_EQ(job, 21);
+}
+
+TEST(util_DmaJobScheduler, g_init)
+{
+    Scheduler scheduler;
+    EXPECT_EQ(scheduler.Submit(0, 0, 10), Submission::START);
+    EXPECT_EQ(scheduler.Submit(0, 0, 11), Submission::QUEUED);
+    scheduler.Init();
+    EXPECT_FALSE(scheduler.IsBusy(0));
+    EXPECT_EQ(scheduler.GetNumQueued(0), 0u);
+    EXPECT_EQ(scheduler.Submit(0, 0, 12), Submission::START);
+}
+
+TEST(util_DmaJobScheduler, h_requeue)
+{
+    Scheduler scheduler;
+    EXPECT_EQ(scheduler.Submit(1, 0, 10), Submission::START);
+    EXPECT_EQ(scheduler.Submit(1, 0, 11), Submission::QUEUED);
+
+    // the peripheral can't start the job yet, it goes back to the front
+    EXPECT_TRUE(scheduler.Requeue(1, 0, 10));
+    EXPECT_FALSE(scheduler.IsBusy(0));
+    EXPECT_EQ(scheduler.GetNumQueued(1), 2u);
+
+    size_t per;
+    int    job;
+    EXPECT_TRUE(scheduler.ClaimNext(0, per, job));
+    EXPECT_EQ(per, 1u);
+    EXPECT_EQ(job, 10);
+
+    // a full queue drops the job
+    EXPECT_EQ(scheduler.Submit(1, 0, 12), Submission::QUEUED);
+    EXPECT_FALSE(scheduler.Requeue(1, 0, 10));
+    EXPECT_FALSE(scheduler.IsBusy(0));
+    EXPECT_EQ(scheduler.GetNumQueued(1), 2u);
+}
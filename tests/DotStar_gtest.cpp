@@ -0,0 +1,176 @@
+#include "dev/dotstar.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+/** Records the transfers */
+class MockTransport
+{
+  public:
+    struct Config
+    {
+        void Defaults() {}
+    };
+    void Init(Config&) {}
+
+    bool Write(uint8_t* data, size_t size)
+    {
+        transfers_.emplace_back(data, data + size);
+        return true;
+    }
+
+    typedef void (*DmaCallback)(void* context, bool success);
+
+    bool
+    DmaWrite(uint8_t* data, size_t size, DmaCallback callback, void* context)
+    {
+        if(!accept_dma_)
+            return false;
+        pending_.push_back({data, size, callback, context});
+        return true;
+    }
+
+    /** Finishes the oldest pending DMA transfer */
+    void CompleteDma(bool success = true)
+    {
+        ASSERT_FALSE(pending_.empty());
+        const auto job = pending_.front();
+        pending_.erase(pending_.begin());
+        if(success)
+            Write(job.data, job.size);
+        job.callback(job.context, success);
+    }
+
+    struct Job
+    {
+        uint8_t*    data;
+        size_t      size;
+        DmaCallback callback;
+        void*       context;
+    };
+
+    std::vector<std::vector<uint8_t>> transfers_;
+    std::vector<Job>                  pending_;
+    bool                              accept_dma_ = true;
+};
+
+/** Gives access to the transport */
+class TestDotStar : public DotStar<MockTransport>
+{
+  public:
+    MockTransport& GetTransport() { return transport_; }
+};
+
+TestDotStar::Config GetConfig(uint16_t num_pixels)
+{
+    TestDotStar::Config config;
+    config.Defaults();
+    config.num_pixels  = num_pixels;
+    config.color_order = TestDotStar::Config::GRB;
+    return config;
+}
+} // namespace
+
+TEST(dev_DotStar, a_showSendsOneTransfer)
+{
+    TestDotStar dotstar;
+    auto        config = GetConfig(3);
+    ASSERT_EQ(dotstar.Init(config), TestDotStar::Result::OK);
+    dotstar.SetPixelColor(0, 1, 2, 3);
+    dotstar.SetPixelColor(2, 0x00ffffff);
+    dotstar.SetPixelGlobalBrightness(2, 31);
+    EXPECT_EQ(dotstar.GetPixelColor(0), 0x010203u);
+    EXPECT_EQ(dotstar.GetPixelColor(2), 0xffffffu);
+
+    ASSERT_EQ(dotstar.Show(), TestDotStar::Result::OK);
+    const auto& transfers = dotstar.GetTransport().transfers_;
+    ASSERT_EQ(transfers.size(), 1u);
+    const std::vector<uint8_t> expected = {
+        0x00, 0x00, 0x00, 0x00, // start frame
+        0xE1, 0x02, 0x01, 0x03, // GRB
+        0xE1, 0x00, 0x00, 0x00, //
+        0xFF, 0xFF, 0xFF, 0xFF, //
+        0xFF, 0xFF, 0xFF, 0xFF, // end frame
+    };
+    EXPECT_EQ(transfers[0], expected);
+}
+
+TEST(dev_DotStar, b_endFrameLength)
+{
+    TestDotStar dotstar;
+    auto        config = GetConfig(64);
+    ASSERT_EQ(dotstar.Init(config), TestDotStar::Result::OK);
+    dotstar.Show();
+    const auto& transfers = dotstar.GetTransport().transfers_;
+    ASSERT_EQ(transfers.size(), 1u);
+    EXPECT_EQ(transfers[0].size(), 4u + 64u * 4u + 4u);
+
+    config = GetConfig(65);
+    EXPECT_EQ(dotstar.Init(config), TestDotStar::Result::ERR_INVALID_ARGUMENT);
+}
+
+TEST(dev_DotStar, c_doubleBufferedDma)
+{
+    static TestDotStar::DmaBuffer dma_buffer;
+    TestDotStar                   dotstar;
+    auto                          config = GetConfig(2);
+    config.dma_buffer                    = &dma_buffer;
+    ASSERT_EQ(dotstar.Init(config), TestDotStar::Result::OK);
+    auto& transport = dotstar.GetTransport();
+
+    dotstar.SetPixelColor(0, 1, 1, 1);
+    ASSERT_EQ(dotstar.Show(), TestDotStar::Result::OK);
+    EXPECT_TRUE(dotstar.IsTransmitting());
+
+    // the next frame goes to the other half, while the first one is sent
+    dotstar.SetPixelColor(0, 2, 2, 2);
+    ASSERT_EQ(dotstar.Show(), TestDotStar::Result::OK);
+    ASSERT_EQ(transport.pending_.size(), 2u);
+    EXPECT_EQ(transport.pending_[0].data, dma_buffer[0]);
+    EXPECT_EQ(transport.pending_[1].data, dma_buffer[1]);
+    EXPECT_EQ(transport.pending_[0].size, 4u + 8u + 4u);
+
+    // both halves are busy, the frame is dropped instead of waiting
+    dotstar.SetPixelColor(0, 3, 3, 3);
+    EXPECT_EQ(dotstar.Show(), TestDotStar::Result::ERR_BUSY);
+    EXPECT_EQ(transport.pending_.size(), 2u);
+
+    transport.CompleteDma();
+    transport.CompleteDma();
+    EXPECT_FALSE(dotstar.IsTransmitting());
+    ASSERT_EQ(transport.transfers_.size(), 2u);
+    EXPECT_EQ(transport.transfers_[0][5], 1);
+    EXPECT_EQ(transport.transfers_[1][5], 2);
+
+    // the first half is free again
+    ASSERT_EQ(dotstar.Show(), TestDotStar::Result::OK);
+    EXPECT_EQ(transport.pending_[0].data, dma_buffer[0]);
+    transport.CompleteDma();
+    EXPECT_EQ(transport.transfers_[2][5], 3);
+}
+
+TEST(dev_DotStar, d_dmaErrors)
+{
+    static TestDotStar::DmaBuffer dma_buffer;
+    TestDotStar                   dotstar;
+    auto                          config = GetConfig(2);
+    config.dma_buffer                    = &dma_buffer;
+    ASSERT_EQ(dotstar.Init(config), TestDotStar::Result::OK);
+    auto& transport = dotstar.GetTransport();
+
+    // a failed transfer is reported by the next Show()
+    ASSERT_EQ(dotstar.Show(), TestDotStar::Result::OK);
+    transport.CompleteDma(false);
+    EXPECT_FALSE(dotstar.IsTransmitting());
+    EXPECT_EQ(dotstar.Show(), TestDotStar::Result::ERR_TRANSPORT);
+    transport.CompleteDma();
+    EXPECT_EQ(dotstar.Show(), TestDotStar::Result::OK);
+    transport.CompleteDma();
+
+    transport.accept_dma_ = false;
+    EXPECT_EQ(dotstar.Show(), TestDotStar::Result::ERR_TRANSPORT);
+    EXPECT_FALSE(dotstar.IsTransmitting());
+}
@@ -0,0 +1,84 @@
+#include "util/DoubleBuffer.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+using namespace daisy;
+
+TEST(util_DoubleBuffer, a_stateAfterConstruction)
+{
+    DoubleBuffer<int> buffer;
+    int               value = 123;
+    EXPECT_FALSE(buffer.Read(value));
+    EXPECT_EQ(value, 123);
+    EXPECT_EQ(buffer.GetNumWrites(), 0u);
+}
+
+TEST(util_DoubleBuffer, b_readsLatestValue)
+{
+    DoubleBuffer<int> buffer;
+    int               value = 0;
+
+    buffer.Write(1);
+    EXPECT_TRUE(buffer.Read(value));
+    EXPECT_EQ(value, 1);
+    EXPECT_EQ(buffer.GetNumWrites(), 1u);
+
+    // reading doesn't consume the value
+    value = 0;
+    EXPECT_TRUE(buffer.Read(value));
+    EXPECT_EQ(value, 1);
+
+    for(int i = 2; i <= 5; i++)
+        buffer.Write(i);
+    EXPECT_TRUE(buffer.Read(value));
+    EXPECT_EQ(value, 5);
+    EXPECT_EQ(buffer.GetNumWrites(), 5u);
+}
+
+/** Values that are torn when a read overlaps a write */
+struct Sample
+{
+    uint32_t a;
+    uint32_t b[15];
+};
+
+TEST(util_DoubleBuffer, c_twoThreadStress)
+{
+    static DoubleBuffer<Sample> buffer;
+    constexpr uint32_t          num_writes = 200000;
+    std::atomic<bool>           done(false);
+
+    std::thread writer([&done]() {
+        for(uint32_t i = 1; i <= num_writes; i++)
+        {
+            Sample sample;
+            sample.a = i;
+            for(auto& b : sample.b)
+                b = ~i;
+            buffer.Write(sample);
+        }
+        done = true;
+    });
+
+    // values are never torn and never go back in time
+    uint32_t last   = 0;
+    bool     failed = false;
+    while(!done && !failed)
+    {
+        Sample sample;
+        if(!buffer.Read(sample))
+            continue;
+        failed = sample.a < last;
+        for(const auto b : sample.b)
+            failed = failed || b != ~sample.a;
+        last = sample.a;
+    }
+    writer.join();
+
+    EXPECT_FALSE(failed);
+    Sample sample;
+    EXPECT_TRUE(buffer.Read(sample));
+    EXPECT_EQ(sample.a, num_writes);
+    EXPECT_EQ(buffer.GetNumWrites(), num_writes);
+}
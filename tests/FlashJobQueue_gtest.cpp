@@ -0,0 +1,253 @@
+#include "util/FlashJobQueue.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace daisy;
+
+/** Records the steps, the test plays the interrupts */
+class FakeFlash
+{
+  public:
+    enum Result
+    {
+        OK = 0,
+        ERR
+    };
+
+    using Queue = FlashJobQueue<FakeFlash, 2>;
+
+    static constexpr uint32_t kPageSize      = 256;
+    static constexpr uint32_t kStepTimeoutMs = 10;
+    static constexpr uint32_t kEraseTimeout  = 1000;
+
+    bool IsMemoryMapped() const { return memory_mapped_; }
+    bool StartExitContinuousRead()
+    {
+        memory_mapped_ = false;
+        return Log("exit");
+    }
+    bool StartWriteEnable() { return Log("wren"); }
+    bool StartWaitWriteEnabled() { return Log("wait_wren"); }
+    bool StartWaitReady() { return Log("wait_ready"); }
+    bool StartErase(uint32_t  address,
+                    uint32_t  end_addr,
+                    uint32_t& size,
+                    uint32_t& timeout_ms)
+    {
+        (void)end_addr;
+        size       = 4096;
+        timeout_ms = kEraseTimeout;
+        return Log("erase " + std::to_string(address));
+    }
+    bool StartProgram(uint32_t address, uint32_t size, uint8_t* data)
+    {
+        (void)data;
+        return Log("program " + std::to_string(address) + " "
+                   + std::to_string(size));
+    }
+    bool EnterMemoryMappedMode()
+    {
+        memory_mapped_ = true;
+        return Log("mapped");
+    }
+    bool Abort()
+    {
+        memory_mapped_ = true;
+        Log("abort");
+        return abort_works_;
+    }
+    bool     Reinit() { return Log("reinit"); }
+    uint32_t GetNowMs() { return now_ms_; }
+
+    bool Log(const std::string& step)
+    {
+        steps_.push_back(step);
+        return true;
+    }
+
+    /** Returns the steps since the last call */
+    std::vector<std::string> TakeSteps()
+    {
+        std::vector<std::string> steps;
+        steps.swap(steps_);
+        return steps;
+    }
+
+    /** Plays the interrupts of the write enable */
+    void EnableWrite()
+    {
+        jobs_.OnCommandDone();
+        jobs_.OnStatusMatch();
+    }
+
+    uint32_t now_ms_        = 0;
+    bool     memory_mapped_ = true;
+    bool     abort_works_   = true;
+    Queue    jobs_{*this};
+
+  private:
+    std::vector<std::string> steps_;
+};
+
+using Steps = std::vector<std::string>;
+
+struct Callback
+{
+    int               num_calls = 0;
+    FakeFlash::Result result    = FakeFlash::Result::OK;
+
+    static void Call(void* context, FakeFlash::Result result)
+    {
+        Callback* callback = static_cast<Callback*>(context);
+        callback->num_calls++;
+        callback->result = result;
+    }
+};
+
+FakeFlash::Queue::Job
+MakeWrite(uint32_t address, uint32_t size, Callback* callback)
+{
+    static uint8_t data[1024];
+
+    FakeFlash::Queue::Job job;
+    job.erase            = false;
+    job.address          = address;
+    job.end_addr         = address + size;
+    job.buffer           = data;
+    job.end_callback     = &Callback::Call;
+    job.callback_context = callback;
+    return job;
+}
+
+FakeFlash::Queue::Job MakeErase(uint32_t address, Callback* callback)
+{
+    FakeFlash::Queue::Job job = MakeWrite(address, 4096, callback);
+    job.erase                 = true;
+    job.buffer                = nullptr;
+    return job;
+}
+
+TEST(util_FlashJobQueue, a_writesPageByPage)
+{
+    FakeFlash flash;
+    Callback  callback;
+    EXPECT_EQ(flash.jobs_.Queue(MakeWrite(200, 100, &callback)),
+              FakeFlash::Result::OK);
+    EXPECT_TRUE(flash.jobs_.IsBusy());
+    EXPECT_EQ(flash.TakeSteps(), Steps({"exit"}));
+
+    flash.jobs_.OnCommandDone();
+    EXPECT_EQ(flash.TakeSteps(), Steps({"wren"}));
+    flash.EnableWrite();
+    EXPECT_EQ(flash.TakeSteps(), Steps({"wait_wren", "program 200 56"}));
+    flash.jobs_.OnTransmitDone();
+    flash.jobs_.OnStatusMatch();
+    EXPECT_EQ(flash.TakeSteps(), Steps({"wait_ready", "wren"}));
+
+    flash.EnableWrite();
+    flash.jobs_.OnTransmitDone();
+    EXPECT_EQ(callback.num_calls, 0);
+    flash.jobs_.OnStatusMatch();
+    EXPECT_EQ(flash.TakeSteps(),
+              Steps({"wait_wren", "program 256 44", "wait_ready", "mapped"}));
+    EXPECT_EQ(callback.num_calls, 1);
+    EXPECT_EQ(callback.result, FakeFlash::Result::OK);
+    EXPECT_FALSE(flash.jobs_.IsBusy());
+}
+
+TEST(util_FlashJobQueue, b_stuckPollingTimesOut)
+{
+    FakeFlash flash;
+    Callback  write, queued;
+    flash.memory_mapped_ = false;
+    flash.jobs_.Queue(MakeWrite(0, 16, &write));
+    flash.EnableWrite();
+    flash.jobs_.OnTransmitDone();
+    EXPECT_EQ(flash.jobs_.Queue(MakeWrite(16, 16, &queued)),
+              FakeFlash::Result::OK);
+    EXPECT_EQ(flash.jobs_.GetNumQueued(), 1u);
+    flash.TakeSteps();
+
+    // the status never matches, until the deadline the job keeps waiting
+    flash.now_ms_ = FakeFlash::kStepTimeoutMs - 1;
+    flash.jobs_.CheckTimeout();
+    EXPECT_TRUE(flash.jobs_.IsBusy());
+    EXPECT_EQ(write.num_calls, 0);
+    EXPECT_TRUE(flash.TakeSteps().empty());
+
+    // then it fails, and the queued job starts
+    flash.now_ms_ = FakeFlash::kStepTimeoutMs;
+    flash.jobs_.CheckTimeout();
+    EXPECT_EQ(write.num_calls, 1);
+    EXPECT_EQ(write.result, FakeFlash::Result::ERR);
+    EXPECT_EQ(flash.TakeSteps(), Steps({"abort", "exit"}));
+    EXPECT_TRUE(flash.jobs_.IsBusy());
+    EXPECT_EQ(flash.jobs_.GetNumQueued(), 0u);
+
+    // a late match of the failed job is ignored
+    flash.jobs_.OnStatusMatch();
+    EXPECT_TRUE(flash.TakeSteps().empty());
+
+    // the deadline starts over with each step
+    flash.now_ms_ += FakeFlash::kStepTimeoutMs - 1;
+    flash.jobs_.OnCommandDone();
+    flash.now_ms_ += FakeFlash::kStepTimeoutMs - 1;
+    flash.jobs_.CheckTimeout();
+    EXPECT_TRUE(flash.jobs_.IsBusy());
+    flash.jobs_.OnCommandDone();
+    flash.jobs_.OnStatusMatch();
+    flash.jobs_.OnTransmitDone();
+    flash.jobs_.OnStatusMatch();
+    EXPECT_EQ(queued.num_calls, 1);
+    EXPECT_EQ(queued.result, FakeFlash::Result::OK);
+    EXPECT_FALSE(flash.jobs_.IsBusy());
+}
+
+TEST(util_FlashJobQueue, c_eraseHasItsOwnDeadline)
+{
+    FakeFlash flash;
+    Callback  callback;
+    flash.memory_mapped_ = false;
+    flash.now_ms_        = 0xfffffff0; // the deadline wraps around
+    flash.jobs_.Queue(MakeErase(0, &callback));
+    flash.EnableWrite();
+    flash.jobs_.OnCommandDone();
+    EXPECT_EQ(flash.TakeSteps(),
+              Steps({"wren", "wait_wren", "erase 0", "wait_ready"}));
+
+    flash.now_ms_ += FakeFlash::kEraseTimeout - 1;
+    flash.jobs_.CheckTimeout();
+    EXPECT_TRUE(flash.jobs_.IsBusy());
+
+    flash.now_ms_ += 1;
+    flash.jobs_.CheckTimeout();
+    EXPECT_FALSE(flash.jobs_.IsBusy());
+    EXPECT_EQ(callback.num_calls, 1);
+    EXPECT_EQ(callback.result, FakeFlash::Result::ERR);
+}
+
+TEST(util_FlashJobQueue, d_failedAbortFailsJobsUntilRecovered)
+{
+    FakeFlash flash;
+    Callback  first, second, third;
+    flash.memory_mapped_ = false;
+    flash.abort_works_   = false;
+    flash.jobs_.Queue(MakeWrite(0, 16, &first));
+    flash.jobs_.Queue(MakeWrite(16, 16, &second));
+    flash.TakeSteps();
+
+    flash.now_ms_ = FakeFlash::kStepTimeoutMs;
+    flash.jobs_.CheckTimeout();
+    EXPECT_EQ(first.result, FakeFlash::Result::ERR);
+    EXPECT_EQ(second.num_calls, 1);
+    EXPECT_EQ(second.result, FakeFlash::Result::ERR);
+    EXPECT_EQ(flash.TakeSteps(), Steps({"abort"}));
+    EXPECT_TRUE(flash.jobs_.IsRecoveryPending());
+    EXPECT_FALSE(flash.jobs_.IsBusy());
+
+    // the next job reinitializes first
+    flash.jobs_.Queue(MakeWrite(32, 16, &third));
+    EXPECT_FALSE(flash.jobs_.IsRecoveryPending());
+    EXPECT_EQ(flash.TakeSteps(), Steps({"reinit", "exit"}));
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "ui/FullScreenItemMenu.h"
+#include "sys/system.h"
+
+using namespace daisy;
+
+namespace
+{
+/** A custom item that shows something the menu doesn't know about */
+class LiveItem : public AbstractMenu::CustomItem
+{
+  public:
+    void Draw(OneBitGraphicsDisplay&, int, int, Rectangle, bool) override {}
+};
+
+/** Counts the draws instead of drawing */
+class CountingMenu : public FullScreenItemMenu
+{
+  public:
+    void Draw(const UiCanvasDescriptor&) override { numDraws_++; }
+    int  numDraws_ = 0;
+};
+} // namespace
+
+TEST(ui_FullScreenItemMenu, a_redrawsSelectedCustomItems)
+{
+    LiveItem                 liveItem;
+    AbstractMenu::ItemConfig items[2];
+    items[0].type                    = AbstractMenu::ItemType::customItem;
+    items[0].text                    = "live";
+    items[0].asCustomItem.itemObject = &liveItem;
+    items[1].type                    = AbstractMenu::ItemType::closeMenuItem;
+    items[1].text                    = "close";
+
+    CountingMenu menu;
+    menu.Init(items, 2);
+
+    UiCanvasDescriptor canvas;
+    canvas.id_            = 0;
+    canvas.handle_        = nullptr;
+    canvas.updateRateMs_  = 10;
+    canvas.clearFunction_ = [](const UiCanvasDescriptor&) {};
+    canvas.flushFunction_ = [](const UiCanvasDescriptor&) {};
+
+    System::SetUsForUnitTest(0);
+    UiEventQueue queue;
+    UI           ui;
+    ui.Init(queue, UI::SpecialControlIds{}, {canvas});
+    ui.OpenPage(menu);
+    auto processNextUpdate = [&]() {
+        System::Delay(11);
+        ui.Process();
+        return menu.numDraws_;
+    };
+
+    // the custom item is redrawn with every update
+    EXPECT_EQ(processNextUpdate(), 1);
+    EXPECT_EQ(processNextUpdate(), 2);
+    EXPECT_EQ(processNextUpdate(), 3);
+
+    // the other items only when they change
+    menu.OnArrowButton(ArrowButtonType::right, 1, false);
+    EXPECT_EQ(processNextUpdate(), 4);
+    EXPECT_EQ(processNextUpdate(), 4);
+    ui.ClosePage(menu);
+}
@@ -0,0 +1,306 @@
+#include "per/spi.h"
+#include "sys/system.h"
+#include "dev/icm20948.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+/** Emulates the register banks and the FIFO of an ICM-20948 */
+class MockIcm20948
+{
+  public:
+    MockIcm20948()
+    : bank_(0), num_fifo_reads_(0), failing_fifo_read_(-1), error_(false)
+    {
+        memset(regs_, 0, sizeof(regs_));
+        regs_[0][ICM20X_B0_WHOAMI] = ICM20948_CHIP_ID;
+    }
+
+    void Write8(uint8_t reg, uint8_t value)
+    {
+        if(reg == ICM20X_B0_REG_BANK_SEL)
+            bank_ = (value >> 4) & 0b11;
+        // the reset bit clears itself
+        if(bank_ == 0 && reg == ICM20X_B0_PWR_MGMT_1)
+            value &= 0x7F;
+        if(bank_ == 0 && reg == ICM20X_B0_FIFO_RST && value != 0)
+            fifo_.clear();
+        regs_[bank_][reg] = value;
+    }
+
+    void ReadReg(uint8_t reg, uint8_t* buff, uint8_t size)
+    {
+        if(bank_ == 0 && reg == ICM20X_B0_FIFO_R_W)
+        {
+            if(num_fifo_reads_++ == failing_fifo_read_)
+            {
+                error_ = true;
+                return;
+            }
+            for(uint8_t i = 0; i < size && !fifo_.empty(); i++)
+            {
+                buff[i] = fifo_.front();
+                fifo_.pop_front();
+            }
+            return;
+        }
+        if(bank_ == 0 && reg == ICM20X_B0_FIFO_COUNTH)
+        {
+            regs_[0][reg]     = fifo_.size() >> 8;
+            regs_[0][reg + 1] = fifo_.size() & 0xFF;
+        }
+        memcpy(buff, regs_[bank_] + reg, size);
+    }
+
+    /** Adds a frame of accel and gyro data to the FIFO */
+    void PushFrame(int16_t accel, int16_t gyro)
+    {
+        for(int i = 0; i < 3; i++)
+            PushBigEndian(accel + i);
+        for(int i = 0; i < 3; i++)
+            PushBigEndian(gyro + i);
+    }
+
+    void PushBigEndian(int16_t value)
+    {
+        fifo_.push_back(uint16_t(value) >> 8);
+        fifo_.push_back(uint16_t(value) & 0xFF);
+    }
+
+    uint8_t             regs_[4][128];
+    uint8_t             bank_;
+    std::deque<uint8_t> fifo_;
+    int                 num_fifo_reads_;
+    /** the FIFO read with this index fails */
+    int                 failing_fifo_read_;
+    bool                error_;
+};
+
+class MockTransport
+{
+  public:
+    struct Config
+    {
+        MockIcm20948* device = nullptr;
+    };
+
+    void Init(Config config) { device_ = config.device; }
+
+    void Write8(uint8_t reg, uint8_t value) { device_->Write8(reg, value); }
+
+    void Write16(uint8_t reg, uint16_t value)
+    {
+        device_->Write8(reg, value >> 8);
+        device_->Write8(reg + 1, value & 0xFF);
+    }
+
+    void ReadReg(uint8_t reg, uint8_t* buff, uint8_t size)
+    {
+        device_->ReadReg(reg, buff, size);
+    }
+
+    uint8_t Read8(uint8_t reg)
+    {
+        uint8_t value;
+        device_->ReadReg(reg, &value, 1);
+        return value;
+    }
+
+    bool GetError()
+    {
+        const bool error = device_->error_;
+        device_->error_  = false;
+        return error;
+    }
+
+  private:
+    MockIcm20948* device_;
+};
+
+using TestIcm20948 = Icm20948<MockTransport>;
+using SampleQueue  = SpscQueue<TestIcm20948::FifoSample, 64>;
+
+class dev_Icm20948 : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        System::SetUsForUnitTest(0);
+        TestIcm20948::Config config;
+        config.transport_config.device = &device_;
+        ASSERT_EQ(imu_.Init(config), TestIcm20948::OK);
+        imu_.SetAccelRange(TestIcm20948::ICM20948_ACCEL_RANGE_2_G);
+        imu_.SetGyroRange(TestIcm20948::ICM20948_GYRO_RANGE_250_DPS);
+        // 1100Hz / (1 + 10) = 100Hz
+        imu_.SetGyroRateDivisor(10);
+    }
+
+    MockIcm20948 device_;
+    TestIcm20948 imu_;
+    SampleQueue  samples_;
+};
+} // namespace
+
+TEST_F(dev_Icm20948, a_setupFifoEnablesSensors)
+{
+    TestIcm20948::FifoConfig config;
+    EXPECT_EQ(imu_.SetupFifo(config), TestIcm20948::OK);
+    EXPECT_EQ(device_.regs_[0][ICM20X_B0_USER_CTRL] & 0x40, 0x40);
+    EXPECT_EQ(device_.regs_[0][ICM20X_B0_FIFO_EN_1], 0x00);
+    EXPECT_EQ(device_.regs_[0][ICM20X_B0_FIFO_EN_2], 0x1E);
+    EXPECT_EQ(device_.regs_[0][ICM20X_B0_REG_INT_ENABLE_3], 0x00);
+    EXPECT_EQ(imu_.GetFifoSamplePeriodUs(), 10000u);
+
+    config.accel               = false;
+    config.gyro                = false;
+    config.temp                = true;
+    config.mag                 = true;
+    config.watermark_interrupt = true;
+    EXPECT_EQ(imu_.SetupFifo(config), TestIcm20948::OK);
+    EXPECT_EQ(device_.regs_[0][ICM20X_B0_FIFO_EN_1], 0x01);
+    EXPECT_EQ(device_.regs_[0][ICM20X_B0_FIFO_EN_2], 0x01);
+    EXPECT_EQ(device_.regs_[0][ICM20X_B0_REG_INT_ENABLE_3], 0x01);
+
+    // nothing to read
+    config.temp = false;
+    config.mag  = false;
+    EXPECT_EQ(imu_.SetupFifo(config), TestIcm20948::ERR);
+    EXPECT_EQ(imu_.ReadFifo(samples_), 0u);
+
+    imu_.DisableFifo();
+    EXPECT_EQ(device_.regs_[0][ICM20X_B0_USER_CTRL] & 0x40, 0x00);
+}
+
+TEST_F(dev_Icm20948, b_readsFramesInBursts)
+{
+    ASSERT_EQ(imu_.SetupFifo(TestIcm20948::FifoConfig()), TestIcm20948::OK);
+
+    // 30 frames of 12 bytes don't fit into a single burst read
+    for(int i = 0; i < 30; i++)
+        device_.PushFrame(1000 * i, -100 * i);
+    System::SetUsForUnitTest(1000000);
+
+    EXPECT_EQ(imu_.ReadFifo(samples_), 30u);
+    EXPECT_EQ(device_.num_fifo_reads_, 2);
+    EXPECT_EQ(imu_.GetFifoCount(), 0u);
+    ASSERT_EQ(samples_.GetNumElements(), 30u);
+
+    for(int i = 0; i < 30; i++)
+    {
+        TestIcm20948::FifoSample sample;
+        ASSERT_TRUE(samples_.PopFront(sample));
+        // the last sample was taken when the FIFO was read
+        EXPECT_EQ(sample.timestamp_us, 1000000u - (29 - i) * 10000u);
+        EXPECT_FLOAT_EQ(sample.accel.x,
+                        1000 * i / 16384.f * SENSORS_GRAVITY_EARTH);
+        EXPECT_FLOAT_EQ(sample.accel.z,
+                        (1000 * i + 2) / 16384.f * SENSORS_GRAVITY_EARTH);
+        EXPECT_FLOAT_EQ(sample.gyro.x, -100 * i / 131.f * SENSORS_DPS_TO_RADS);
+        EXPECT_FLOAT_EQ(sample.gyro.y,
+                        (-100 * i + 1) / 131.f * SENSORS_DPS_TO_RADS);
+        EXPECT_EQ(sample.mag.x, 0.f);
+        EXPECT_EQ(sample.temp, 0.f);
+    }
+}
+
+TEST_F(dev_Icm20948, c_keepsFramesThatDontFit)
+{
+    ASSERT_EQ(imu_.SetupFifo(TestIcm20948::FifoConfig()), TestIcm20948::OK);
+
+    SpscQueue<TestIcm20948::FifoSample, 4> small;
+    for(int i = 0; i < 6; i++)
+        device_.PushFrame(i, 0);
+    // an incomplete frame stays in the FIFO as well
+    device_.PushBigEndian(6);
+
+    EXPECT_EQ(imu_.ReadFifo(small), 4u);
+    EXPECT_EQ(imu_.GetFifoCount(), 2u * 12u + 2u);
+    EXPECT_EQ(imu_.ReadFifo(small), 0u);
+
+    TestIcm20948::FifoSample sample;
+    small.PopFront(sample);
+    EXPECT_EQ(imu_.ReadFifo(small), 1u);
+    EXPECT_EQ(imu_.GetFifoCount(), 12u + 2u);
+    for(int i = 1; i < 5; i++)
+    {
+        ASSERT_TRUE(small.PopFront(sample));
+        EXPECT_FLOAT_EQ(sample.accel.x, i / 16384.f * SENSORS_GRAVITY_EARTH);
+    }
+}
+
+TEST_F(dev_Icm20948, d_decodesTempAndMag)
+{
+    TestIcm20948::FifoConfig config;
+    config.temp = true;
+    config.mag  = true;
+    ASSERT_EQ(imu_.SetupFifo(config), TestIcm20948::OK);
+
+    device_.PushFrame(100, 200);
+    device_.PushBigEndian(3339);
+    // status, x, y, z little endian, dummy, status
+    const std::vector<uint8_t> mag
+        = {0x01, 0x10, 0x00, 0xF0, 0xFF, 0x00, 0x01, 0x00, 0x00};
+    device_.fifo_.insert(device_.fifo_.end(), mag.begin(), mag.end());
+
+    EXPECT_EQ(imu_.ReadFifo(samples_), 1u);
+    TestIcm20948::FifoSample sample;
+    ASSERT_TRUE(samples_.PopFront(sample));
+    EXPECT_FLOAT_EQ(sample.accel.y, 101 / 16384.f * SENSORS_GRAVITY_EARTH);
+    EXPECT_FLOAT_EQ(sample.gyro.z, 202 / 131.f * SENSORS_DPS_TO_RADS);
+    EXPECT_NEAR(sample.temp, 3339 / 333.87 + 21.0, 1e-4);
+    EXPECT_FLOAT_EQ(sample.mag.x, 16 * ICM20948_UT_PER_LSB);
+    EXPECT_FLOAT_EQ(sample.mag.y, -16 * ICM20948_UT_PER_LSB);
+    EXPECT_FLOAT_EQ(sample.mag.z, 256 * ICM20948_UT_PER_LSB);
+}
+
+TEST_F(dev_Icm20948, e_discardsFullFifo)
+{
+    ASSERT_EQ(imu_.SetupFifo(TestIcm20948::FifoConfig()), TestIcm20948::OK);
+
+    // 42 frames fit, the 43rd doesn't
+    for(int i = 0; i < 43; i++)
+        device_.PushFrame(i, i);
+    device_.fifo_.resize(512);
+
+    EXPECT_EQ(imu_.ReadFifo(samples_), 0u);
+    EXPECT_EQ(imu_.GetNumFifoOverflows(), 1u);
+    EXPECT_EQ(imu_.GetFifoCount(), 0u);
+    EXPECT_TRUE(samples_.IsEmpty());
+
+    device_.PushFrame(1, 1);
+    EXPECT_EQ(imu_.ReadFifo(samples_), 1u);
+    EXPECT_EQ(imu_.GetNumFifoOverflows(), 1u);
+}
+
+TEST_F(dev_Icm20948, f_stopsAtTransportErrors)
+{
+    ASSERT_EQ(imu_.SetupFifo(TestIcm20948::FifoConfig()), TestIcm20948::OK);
+    for(int i = 0; i < 30; i++)
+        device_.PushFrame(i, i);
+
+    // the first burst of 21 frames is kept, the rest stays in the FIFO
+    device_.failing_fifo_read_ = 1;
+    EXPECT_EQ(imu_.ReadFifo(samples_), 21u);
+    EXPECT_EQ(samples_.GetNumElements(), 21u);
+    EXPECT_EQ(imu_.GetFifoCount(), 9u * 12u);
+
+    EXPECT_EQ(imu_.ReadFifo(samples_), 9u);
+    TestIcm20948::FifoSample sample;
+    for(int i = 0; i < 30; i++)
+    {
+        ASSERT_TRUE(samples_.PopFront(sample));
+        EXPECT_FLOAT_EQ(sample.accel.x, i / 16384.f * SENSORS_GRAVITY_EARTH);
+    }
+}
+
+TEST(dev_Icm20948_defaults, a_rateDivisorsStartAtTheResetValues)
+{
+    // 1100Hz / (1 + 0)
+    TestIcm20948 imu;
+    EXPECT_EQ(imu.GetFifoSamplePeriodUs(), 1000000u / 1100u);
+}
@@ -0,0 +1,267 @@
+#include "dev/leddriver.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace daisy;
+
+// Init() references the GPIO functions for the output enable pin
+extern "C" void dsy_gpio_init(const dsy_gpio*) {}
+extern "C" void dsy_gpio_write(const dsy_gpio*, uint8_t) {}
+
+namespace
+{
+/** A DMA transfer, with a copy of the data at the time it was started */
+struct Transfer
+{
+    uint16_t             address;
+    uint8_t*             data;
+    std::vector<uint8_t> bytes;
+};
+
+/** What the mock I2C peripheral saw. The driver copies its handle, so the
+ *  copies share this.
+ */
+struct I2CLog
+{
+    std::vector<Transfer>          transfers;
+    I2CHandle::CallbackFunctionPtr callback   = nullptr;
+    void*                          context    = nullptr;
+    bool                           accept_dma = true;
+    int                            num_inits  = 0;
+};
+
+class MockI2C
+{
+  public:
+    using Result              = I2CHandle::Result;
+    using Config              = I2CHandle::Config;
+    using CallbackFunctionPtr = I2CHandle::CallbackFunctionPtr;
+
+    MockI2C(I2CLog* log = nullptr) : log_(log) {}
+
+    Result Init(const Config&)
+    {
+        log_->num_inits++;
+        return Result::OK;
+    }
+    const Config& GetConfig() const { return config_; }
+
+    Result TransmitBlocking(uint16_t, uint8_t*, uint16_t, uint32_t)
+    {
+        return Result::OK;
+    }
+
+    Result TransmitDma(uint16_t            address,
+                       uint8_t*            data,
+                       uint16_t            size,
+                       CallbackFunctionPtr callback,
+                       void*               context)
+    {
+        if(!log_->accept_dma)
+            return Result::ERR;
+        log_->transfers.push_back(
+            {address, data, std::vector<uint8_t>(data, data + size)});
+        log_->callback = callback;
+        log_->context  = context;
+        return Result::OK;
+    }
+
+  private:
+    I2CLog* log_;
+    Config  config_;
+};
+
+using Driver = LedDriverPca9685<2, true, MockI2C>;
+
+Driver::DmaBuffer buffer_a;
+Driver::DmaBuffer buffer_b;
+
+/** Sets up a driver that already sent its initial frame */
+class dev_LedDriverPca9685 : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        const uint8_t addresses[2] = {0x00, 0x01};
+        driver_.Init(MockI2C(&log_), addresses, buffer_a, buffer_b);
+        // an off cycle with a set high byte, right before led 3
+        driver_.SetLedRaw(2, 0x200);
+        driver_.SwapBuffersAndTransmit();
+        CompleteAll();
+        log_.transfers.clear();
+        driver_.ResetStats();
+    }
+
+    /** Finishes the running DMA transfer */
+    void Complete(I2CHandle::Result result = I2CHandle::Result::OK)
+    {
+        ASSERT_NE(log_.callback, nullptr);
+        const auto callback = log_.callback;
+        log_.callback       = nullptr;
+        callback(log_.context, result);
+    }
+
+    void CompleteAll()
+    {
+        while(log_.callback)
+            Complete();
+        EXPECT_FALSE(driver_.IsTransmitting());
+    }
+
+    I2CLog log_;
+    Driver driver_;
+};
+
+} // namespace
+
+TEST_F(dev_LedDriverPca9685, a_initialFrameSendsEverything)
+{
+    const uint8_t addresses[2] = {0x00, 0x01};
+    I2CLog        log;
+    Driver        driver;
+    driver.Init(MockI2C(&log), addresses, buffer_a, buffer_b);
+    driver.SwapBuffersAndTransmit();
+    ASSERT_EQ(log.transfers.size(), 1u);
+    EXPECT_EQ(log.transfers[0].address, 0x40);
+    EXPECT_EQ(log.transfers[0].bytes.size(), 65u);
+    EXPECT_EQ(log.transfers[0].bytes[0], 0x06);
+    EXPECT_EQ(log.transfers[0].data, (uint8_t*)&buffer_a[0]);
+}
+
+TEST_F(dev_LedDriverPca9685, b_sendsFirstToLastChangedLed)
+{
+    driver_.SetLedRaw(3, 100);
+    driver_.SetLedRaw(5, 200);
+    driver_.SwapBuffersAndTransmit();
+
+    // leds 3 to 5 of the first chip, the second one is skipped
+    ASSERT_EQ(log_.transfers.size(), 1u);
+    const Transfer& transfer = log_.transfers[0];
+    EXPECT_EQ(transfer.address, 0x40);
+    EXPECT_EQ(transfer.bytes,
+              std::vector<uint8_t>({0x06 + 4 * 3, // register of led 3
+                                    12,
+                                    0,
+                                    112,
+                                    0, // led 3 on 12, off 12 + 100
+                                    16,
+                                    0,
+                                    16,
+                                    0, // led 4 unchanged
+                                    20,
+                                    0,
+                                    220,
+                                    0})); // led 5 on 20, off 20 + 200
+
+    // the register address replaced the high byte of the off cycle of led 2
+    EXPECT_EQ(transfer.data, (uint8_t*)&buffer_b[0].leds[3] - 1);
+    EXPECT_EQ(buffer_b[0].leds[2].off, 0x1208);
+    Complete();
+    EXPECT_EQ(buffer_b[0].leds[2].off, 0x0208);
+    EXPECT_EQ(buffer_b[0].registerAddr, 0x06);
+
+    EXPECT_FALSE(driver_.IsTransmitting());
+    const auto stats = driver_.GetStats();
+    EXPECT_EQ(stats.frames_sent, 1u);
+    EXPECT_EQ(stats.drivers_skipped, 1u);
+    EXPECT_EQ(stats.bytes_sent, 13u);
+}
+
+TEST_F(dev_LedDriverPca9685, c_resendsChipAfterError)
+{
+    driver_.SetLedRaw(3, 100);
+    driver_.SetLedRaw(16 + 7, 100);
+    driver_.SwapBuffersAndTransmit();
+    Complete(I2CHandle::Result::ERR);
+    // the restore doesn't depend on the result
+    EXPECT_EQ(buffer_b[0].leds[2].off, 0x0208);
+    // the next chip is sent anyway
+    ASSERT_EQ(log_.transfers.size(), 2u);
+    EXPECT_EQ(log_.transfers[1].address, 0x41);
+    Complete();
+    EXPECT_EQ(driver_.GetStats().transfer_errors, 1u);
+    log_.transfers.clear();
+
+    // the failed chip is sent in full, the other one only with its change
+    driver_.SetLedRaw(16 + 4, 100);
+    driver_.SwapBuffersAndTransmit();
+    CompleteAll();
+    ASSERT_EQ(log_.transfers.size(), 2u);
+    EXPECT_EQ(log_.transfers[0].bytes.size(), 65u);
+    EXPECT_EQ(log_.transfers[0].bytes[0], 0x06);
+    EXPECT_EQ(log_.transfers[0].bytes[1 + 4 * 3 + 2], 112); // led 3 off
+    EXPECT_EQ(log_.transfers[1].bytes.size(), 5u);
+    EXPECT_EQ(log_.transfers[1].bytes[0], 0x06 + 4 * 4);
+
+    // a transfer that can't be started reinitializes the peripheral
+    log_.accept_dma = false;
+    log_.transfers.clear();
+    driver_.SetLedRaw(0, 100);
+    driver_.SwapBuffersAndTransmit();
+    EXPECT_EQ(log_.num_inits, 1);
+    EXPECT_FALSE(driver_.IsTransmitting());
+    EXPECT_EQ(driver_.GetStats().transfer_errors, 2u);
+    log_.accept_dma = true;
+    driver_.SwapBuffersAndTransmit();
+    ASSERT_EQ(log_.transfers.size(), 1u);
+    EXPECT_EQ(log_.transfers[0].bytes.size(), 65u);
+}
+
+TEST_F(dev_LedDriverPca9685, d_mergesFramesBetweenRefreshes)
+{
+    driver_.BeginFrame();
+    driver_.SetLedRaw(3, 100);
+    driver_.SubmitFrame();
+    driver_.BeginFrame();
+    driver_.SetLedRaw(5, 200);
+    driver_.SubmitFrame();
+    EXPECT_TRUE(log_.transfers.empty());
+
+    driver_.Refresh();
+    ASSERT_EQ(log_.transfers.size(), 1u);
+    EXPECT_EQ(log_.transfers[0].bytes.size(), 13u);
+
+    // nothing new to send
+    Complete();
+    driver_.Refresh();
+    EXPECT_EQ(log_.transfers.size(), 1u);
+
+    const auto stats = driver_.GetStats();
+    EXPECT_EQ(stats.frames_sent, 1u);
+    EXPECT_EQ(stats.frames_coalesced, 1u);
+    EXPECT_EQ(stats.refreshes_dropped, 0u);
+}
+
+TEST_F(dev_LedDriverPca9685, e_noSwapWhileDrawing)
+{
+    driver_.BeginFrame();
+    driver_.SetLedRaw(3, 100);
+    driver_.SubmitFrame();
+
+    // the next frame is drawn, the refresh waits for it
+    driver_.BeginFrame();
+    driver_.SetLedRaw(4, 100);
+    driver_.Refresh();
+    EXPECT_TRUE(log_.transfers.empty());
+    driver_.SetLedRaw(5, 200);
+    driver_.SubmitFrame();
+    ASSERT_EQ(log_.transfers.size(), 1u);
+    EXPECT_EQ(log_.transfers[0].bytes.size(), 13u);
+    EXPECT_EQ(log_.transfers[0].bytes[1 + 4 + 2], 116); // led 4 off
+
+    // a refresh during the transmission is dropped
+    driver_.BeginFrame();
+    driver_.SetLedRaw(6, 100);
+    driver_.SubmitFrame();
+    driver_.Refresh();
+    EXPECT_EQ(log_.transfers.size(), 1u);
+    Complete();
+    driver_.Refresh();
+    EXPECT_EQ(log_.transfers.size(), 2u);
+    Complete();
+
+    const auto stats = driver_.GetStats();
+    EXPECT_EQ(stats.frames_sent, 2u);
+    EXPECT_EQ(stats.frames_coalesced, 1u);
+    EXPECT_EQ(stats.refreshes_dropped, 1u);
+}
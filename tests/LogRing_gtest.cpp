@@ -0,0 +1,143 @@
+#include "util/LogRing.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+/** Pops the oldest record as a string */
+std::string PopString(LogRing<256>& ring, uint8_t* tag = nullptr)
+{
+    uint8_t        record_tag;
+    const uint8_t* data;
+    size_t         size;
+    if(!ring.Peek(record_tag, data, size))
+        return "<empty>";
+    std::string result(reinterpret_cast<const char*>(data), size);
+    ring.Pop();
+    if(tag != nullptr)
+        *tag = record_tag;
+    return result;
+}
+} // namespace
+
+TEST(util_LogRing, a_keepsRecordsInOrder)
+{
+    LogRing<256> ring;
+    EXPECT_TRUE(ring.IsEmpty());
+    EXPECT_EQ(PopString(ring), "<empty>");
+
+    EXPECT_TRUE(ring.Push(1, "abc", 3));
+    EXPECT_TRUE(ring.Push(2, "de", 2, "fgh", 3));
+    EXPECT_TRUE(ring.Push(3, "", 0));
+    EXPECT_FALSE(ring.IsEmpty());
+
+    uint8_t tag = 0;
+    EXPECT_EQ(PopString(ring, &tag), "abc");
+    EXPECT_EQ(tag, 1);
+    EXPECT_EQ(PopString(ring, &tag), "defgh");
+    EXPECT_EQ(tag, 2);
+    EXPECT_EQ(PopString(ring, &tag), "");
+    EXPECT_EQ(tag, 3);
+    EXPECT_TRUE(ring.IsEmpty());
+    EXPECT_EQ(ring.GetNumDropped(), 0u);
+}
+
+TEST(util_LogRing, b_wrapsAround)
+{
+    // records of different sizes, so that they end at all positions
+    LogRing<256> ring;
+    for(int i = 0; i < 200; i++)
+    {
+        const std::string text(i % 37, char('a' + i % 26));
+        ASSERT_TRUE(ring.Push(i % 100, text.data(), text.size())) << i;
+        if(i % 3 == 0)
+        {
+            ASSERT_TRUE(ring.Push(0, "x", 1)) << i;
+        }
+
+        uint8_t tag;
+        EXPECT_EQ(PopString(ring, &tag), text);
+        EXPECT_EQ(tag, i % 100);
+        if(i % 3 == 0)
+        {
+            EXPECT_EQ(PopString(ring), "x");
+        }
+        EXPECT_TRUE(ring.IsEmpty());
+    }
+}
+
+TEST(util_LogRing, c_dropsWhenFull)
+{
+    LogRing<256> ring;
+    const char   text[60] = {};
+    int          pushed   = 0;
+    while(ring.Push(1, text, sizeof(text)))
+        pushed++;
+    // 64 bytes per record
+    EXPECT_EQ(pushed, 4);
+    EXPECT_EQ(ring.GetNumDropped(), 1u);
+
+    // too large and reserved tags
+    EXPECT_FALSE(ring.Push(1, text, 0, text, LogRing<256>::kMaxRecordSize + 1));
+    EXPECT_FALSE(ring.Push(0x7f, text, 1));
+    EXPECT_EQ(ring.GetNumDropped(), 3u);
+
+    // room again after removing a record
+    PopString(ring);
+    EXPECT_TRUE(ring.Push(1, text, sizeof(text)));
+    EXPECT_EQ(ring.GetNumDropped(), 3u);
+}
+
+TEST(util_LogRing, d_multipleProducers)
+{
+    static LogRing<1024> ring;
+    constexpr int        kThreads = 4;
+    constexpr int        kRecords = 20000;
+
+    std::vector<std::thread> producers;
+    for(int t = 0; t < kThreads; t++)
+        producers.emplace_back([t]() {
+            for(uint32_t i = 0; i < kRecords; i++)
+            {
+                // a variable size, with the sequence number repeated
+                uint32_t data[8];
+                for(auto& word : data)
+                    word = i;
+                while(!ring.Push(t, data, 4 * (1 + i % 8)))
+                    std::this_thread::yield();
+            }
+        });
+
+    // each producer's records arrive complete and in order
+    uint32_t next[kThreads] = {};
+    int      received       = 0;
+    while(received < kThreads * kRecords)
+    {
+        uint8_t        tag;
+        const uint8_t* data;
+        size_t         size;
+        if(!ring.Peek(tag, data, size))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_LT(tag, kThreads);
+        const uint32_t expected = next[tag]++;
+        ASSERT_EQ(size, 4 * (1 + expected % 8));
+        for(size_t i = 0; i < size / 4; i++)
+        {
+            uint32_t word;
+            memcpy(&word, data + 4 * i, 4);
+            ASSERT_EQ(word, expected);
+        }
+        ring.Pop();
+        received++;
+    }
+    for(auto& producer : producers)
+        producer.join();
+    EXPECT_TRUE(ring.IsEmpty());
+}
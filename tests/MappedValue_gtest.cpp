@@ -211,6 +211,28 @@ TEST(util_MappedFloatValue, g_stepUpDown)
     EXPECT_EQ(val.GetAs0to1(), 0.0f);
 }
 
+TEST(util_MappedFloatValue, h_changeCounter)
+{
+    MappedFloatValue val(-10.0f, 10.0f, 0.0f);
+    EXPECT_EQ(val.GetChangeCounter(), 0u);
+
+    // changes are counted
+    val.Set(2.0f);
+    EXPECT_EQ(val.GetChangeCounter(), 1u);
+    val.Step(1, false);
+    EXPECT_EQ(val.GetChangeCounter(), 2u);
+    val.ResetToDefault();
+    EXPECT_EQ(val.GetChangeCounter(), 3u);
+
+    // setting the same value again doesn't change anything
+    val.Set(0.0f);
+    val.SetFrom0to1(0.5f);
+    EXPECT_EQ(val.GetChangeCounter(), 3u);
+    val.Set(10.0f);
+    val.Set(20.0f); // clamped to max
+    EXPECT_EQ(val.GetChangeCounter(), 4u);
+}
+
 // ==========================================================================
 
 // ==========================================================================
@@ -363,6 +385,28 @@ TEST(util_MappedIntValue, e_stepUpDown)
     EXPECT_EQ(val, min);
 }
 
+TEST(util_MappedIntValue, f_changeCounter)
+{
+    MappedIntValue val(-10, 10, 5, 2, 1);
+    EXPECT_EQ(val.GetChangeCounter(), 0u);
+
+    // changes are counted
+    val = 2;
+    EXPECT_EQ(val.GetChangeCounter(), 1u);
+    val.Step(1, true);
+    EXPECT_EQ(val.GetChangeCounter(), 2u);
+    val.SetFrom0to1(0.0f);
+    EXPECT_EQ(val.GetChangeCounter(), 3u);
+
+    // setting the same value again doesn't change anything
+    val.Step(-1, false); // clamped to min
+    val.Set(-10);
+    EXPECT_EQ(val.GetChangeCounter(), 3u);
+    val.ResetToDefault();
+    val.ResetToDefault();
+    EXPECT_EQ(val.GetChangeCounter(), 4u);
+}
+
 // ==========================================================================
 
 // ==========================================================================
@@ -495,4 +539,26 @@ TEST(util_MappedStringListValue, e_stepUpDown)
     val = 4;
     val.Step(-100, false);
     EXPECT_EQ(val, 0);
-}
\ No newline at end of file
+}
+
+TEST(util_MappedStringListValue, f_changeCounter)
+{
+    const char*           items[] = {"A", "B", "C"};
+    MappedStringListValue val(items, 3, 1);
+    EXPECT_EQ(val.GetChangeCounter(), 0u);
+
+    // changes are counted
+    val = 2;
+    EXPECT_EQ(val.GetChangeCounter(), 1u);
+    val.Step(-1, true);
+    EXPECT_EQ(val.GetChangeCounter(), 2u);
+    val.SetFrom0to1(1.0f);
+    EXPECT_EQ(val.GetChangeCounter(), 3u);
+
+    // setting the same value again doesn't change anything
+    val.Step(1, false); // clamped to max
+    val.SetIndex(2);
+    EXPECT_EQ(val.GetChangeCounter(), 3u);
+    val.ResetToDefault();
+    EXPECT_EQ(val.GetChangeCounter(), 4u);
+}
@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <chrono>
+#include <random>
+#include <vector>
 #include "hid/midi.h"
 #include "sys/system.h"
 
@@ -43,14 +46,9 @@ class MidiTest : public ::testing::Test
         midi.Init(conf);
     }
 
-    //help with parsing messages
-    void Parse(uint8_t* msgs, int size)
-    {
-        for(int i = 0; i < size; i++)
-        {
-            midi.Parse(msgs[i]);
-        }
-    }
+    //help with parsing messages, single bytes go through MidiParser::Parse(),
+    //everything else through MidiParser::ParseBlock()
+    void Parse(uint8_t* msgs, int size) { midi.Parse(msgs, size); }
 
     //help with parsing messages
     MidiEvent ParseAndPop(uint8_t* msgs, int size)
@@ -566,6 +564,52 @@ TEST_F(MidiTest, systemExclusive)
     EXPECT_FALSE(midi.HasEvents());
 }
 
+TEST_F(MidiTest, sysexPayloadsAreQueued)
+{
+    uint8_t first[]  = {0xf0, 1, 2, 3, 0xf7};
+    uint8_t second[] = {0xf0, 4, 5, 0xf7};
+    Parse(first, 5);
+    Parse(second, 4);
+
+    // both payloads are still there when popped later
+    SystemExclusiveEvent ev = midi.PopEvent().AsSystemExclusive();
+    ASSERT_EQ(ev.length, 3);
+    EXPECT_EQ(ev.data[0], 1);
+    EXPECT_EQ(ev.data[2], 3);
+    EXPECT_EQ(ev.data[3], 0);
+    ev = midi.PopEvent().AsSystemExclusive();
+    ASSERT_EQ(ev.length, 2);
+    EXPECT_EQ(ev.data[0], 4);
+    EXPECT_EQ(ev.data[1], 5);
+}
+
+TEST_F(MidiTest, sysexRingOverwrite)
+{
+    uint8_t msgs[SYSEX_BUFFER_LEN];
+    for(int i = 0; i < SYSEX_BUFFER_LEN; i++)
+        msgs[i] = (uint8_t)i;
+
+    MidiEvent old_event = ParseAndPopSysex(msgs, 10);
+    EXPECT_EQ(old_event.AsSystemExclusive().length, 10);
+
+    // a full ring of newer SysEx data overwrites the old payload
+    for(int i = 0; i < SYSEX_RING_LEN / SYSEX_BUFFER_LEN; i++)
+        ParseAndPopSysex(msgs, SYSEX_BUFFER_LEN);
+    EXPECT_EQ(old_event.AsSystemExclusive().length, 0);
+
+    // while the newest ones can still be read
+    MidiEvent new_event = ParseAndPopSysex(msgs, SYSEX_BUFFER_LEN);
+    SystemExclusiveEvent sysexEvent = new_event.AsSystemExclusive();
+    EXPECT_EQ(sysexEvent.length, SYSEX_BUFFER_LEN);
+    for(int i = 0; i < SYSEX_BUFFER_LEN; i++)
+        EXPECT_EQ(sysexEvent.data[i], msgs[i]);
+}
+
+TEST(MidiEventTest, compactSize)
+{
+    EXPECT_LE(sizeof(MidiEvent), 8u);
+}
+
 // ================ Running Status ================
 
 TEST_F(MidiTest, runningStatus)
@@ -781,4 +825,193 @@ TEST_F(MidiTest, singleByteRunningStatusTest)
     }
 
     EXPECT_FALSE(midi.HasEvents());
-}
\ No newline at end of file
+}
+// ================ Block Parsing ================
+
+namespace
+{
+/** Collects the events of a MidiParser */
+struct EventLog
+{
+    void PushBack(const MidiEvent& event) { events.push_back(event); }
+    std::vector<MidiEvent> events;
+};
+
+/** A stream of everything, including garbage and optionally SysEx */
+std::vector<uint8_t> MakeMidiStream(size_t size, bool with_sysex)
+{
+    std::mt19937                       gen(42);
+    std::uniform_int_distribution<int> kind(0, 9);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<uint8_t>               stream;
+    while(stream.size() < size)
+    {
+        switch(kind(gen))
+        {
+            case 0: stream.push_back(uint8_t(byte(gen))); break; // garbage
+            case 1: stream.push_back(0xf8); break;               // clock
+            case 2:
+                if(!with_sysex)
+                    break;
+                stream.push_back(0xf0);
+                for(int i = 0; i < byte(gen) % 20; i++)
+                    stream.push_back(uint8_t(byte(gen) & 0x7f));
+                stream.push_back(0xf7);
+                break;
+            case 3: // status byte
+                stream.push_back(uint8_t(0x80 | (byte(gen) & 0x7f)));
+                break;
+            default: // data bytes, mostly running status
+                stream.push_back(uint8_t(byte(gen) & 0x7f));
+                break;
+        }
+    }
+    return stream;
+}
+
+size_t NumDataBytes(const MidiEvent& event)
+{
+    switch(event.type)
+    {
+        case ProgramChange:
+        case ChannelPressure: return 1;
+        case SystemRealTime: return 0;
+        case SystemCommon:
+            switch(event.sc_type)
+            {
+                case MTCQuarterFrame:
+                case SongSelect: return 1;
+                case SongPositionPointer: return 2;
+                default: return 0;
+            }
+        default: return 2;
+    }
+}
+
+/** With SysEx, the parsers' events get different ring handles. These
+ *  end up in the data bytes of events that don't overwrite both of them,
+ *  so the data bytes can only be compared for streams without SysEx.
+ */
+void ExpectSameEvents(const std::vector<MidiEvent>& a,
+                      const std::vector<MidiEvent>& b,
+                      bool                          compare_data)
+{
+    ASSERT_EQ(a.size(), b.size());
+    for(size_t i = 0; i < a.size(); i++)
+    {
+        MidiEvent x = a[i], y = b[i];
+        EXPECT_EQ(x.type, y.type) << "event " << i;
+        EXPECT_EQ(x.channel, y.channel) << "event " << i;
+        EXPECT_EQ(x.sc_type, y.sc_type) << "event " << i;
+        EXPECT_EQ(x.srt_type, y.srt_type) << "event " << i;
+        EXPECT_EQ(x.cm_type, y.cm_type) << "event " << i;
+        if(x.type == SystemCommon && x.sc_type == SystemExclusive)
+        {
+            // different handles, same payload
+            SystemExclusiveEvent sx = x.AsSystemExclusive();
+            SystemExclusiveEvent sy = y.AsSystemExclusive();
+            ASSERT_EQ(sx.length, sy.length) << "event " << i;
+            for(int d = 0; d < sx.length; d++)
+                EXPECT_EQ(sx.data[d], sy.data[d]) << "event " << i;
+        }
+        else if(compare_data)
+        {
+            // the bytes beyond a message's data are leftovers
+            for(size_t d = 0; d < NumDataBytes(x); d++)
+                EXPECT_EQ(x.data[d], y.data[d]) << "event " << i;
+        }
+    }
+}
+/** Parses stream byte by byte and in blocks, and compares the events */
+void CompareParsers(const std::vector<uint8_t>& stream,
+                    size_t                      block_size,
+                    bool                        compare_data)
+{
+    MidiParser bytewise, blockwise;
+    bytewise.Init();
+    blockwise.Init();
+    EventLog  expected, result;
+    MidiEvent event;
+    size_t    num_events = 0;
+    for(size_t i = 0; i < stream.size(); i += block_size)
+    {
+        const size_t n = std::min(block_size, stream.size() - i);
+        for(size_t b = i; b < i + n; b++)
+            if(bytewise.Parse(stream[b], &event))
+                expected.PushBack(event);
+        num_events += blockwise.ParseBlock(&stream[i], n, result);
+        // check every block, so that SysEx payloads are still in the ring
+        ExpectSameEvents(expected.events, result.events, compare_data);
+        expected.events.clear();
+        result.events.clear();
+    }
+    EXPECT_GT(num_events, 1000u);
+}
+} // namespace
+
+TEST(MidiParserTest, parseBlockMatchesParse)
+{
+    for(bool with_sysex : {false, true})
+    {
+        const auto stream = MakeMidiStream(4000, with_sysex);
+        // split into blocks of different sizes, like UART DMA transfers
+        for(size_t block_size : {1, 2, 3, 7, 64, 256})
+            CompareParsers(stream, block_size, !with_sysex);
+    }
+}
+
+/** Records the throughput of Parse() and ParseBlock() on a dense stream
+ *  of running status CCs and clocks as test properties, see
+ *  --gtest_output. Both have to find the same number of events.
+ */
+TEST(MidiParserTest, parseBlockBenchmark)
+{
+    using clock = std::chrono::steady_clock;
+    std::vector<uint8_t> stream = {0xb0};
+    for(int i = 0; stream.size() < 256; i++)
+    {
+        if(i % 8 == 7)
+            stream.push_back(0xf8);
+        stream.push_back(uint8_t(i & 0x7f));
+        stream.push_back(uint8_t((i * 3) & 0x7f));
+    }
+    constexpr size_t kIterations = 20000;
+
+    FIFO<MidiEvent, 256> queue;
+    MidiParser           parser;
+    parser.Init();
+    MidiEvent event;
+    size_t    num_parsed = 0;
+
+    auto start = clock::now();
+    for(size_t n = 0; n < kIterations; n++)
+    {
+        for(uint8_t byte : stream)
+            if(parser.Parse(byte, &event))
+                queue.PushBack(event);
+        num_parsed += queue.GetNumElements();
+        queue.Clear();
+    }
+    const double parse_ns
+        = std::chrono::duration<double, std::nano>(clock::now() - start)
+              .count()
+          / (kIterations * stream.size());
+
+    size_t num_block_parsed = 0;
+    start                   = clock::now();
+    for(size_t n = 0; n < kIterations; n++)
+    {
+        parser.ParseBlock(stream.data(), stream.size(), queue);
+        num_block_parsed += queue.GetNumElements();
+        queue.Clear();
+    }
+    const double block_ns
+        = std::chrono::duration<double, std::nano>(clock::now() - start)
+              .count()
+          / (kIterations * stream.size());
+
+    RecordProperty("parse_ns_per_byte", std::to_string(parse_ns));
+    RecordProperty("parse_block_ns_per_byte", std::to_string(block_ns));
+    EXPECT_GT(num_parsed, kIterations);
+    EXPECT_EQ(num_block_parsed, num_parsed);
+}
@@ -0,0 +1,266 @@
+#include "dev/neopixel.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+/** Emulates the seesaw neopixel buffer, and records the writes */
+class MockTransport
+{
+  public:
+    struct Config
+    {
+    };
+    void Init(const Config&) {}
+
+    void
+    WriteLen(uint8_t reg_high, uint8_t reg_low, uint8_t* buff, uint16_t size)
+    {
+        num_writes_++;
+        HandleWrite(reg_high, reg_low, buff, size);
+    }
+    void    Write8(uint8_t, uint8_t, uint8_t) {}
+    uint8_t Read8(uint8_t, uint8_t) { return 0; }
+    void    ReadLen(uint8_t, uint8_t, uint8_t*, uint16_t) {}
+    bool    GetError() { return false; }
+
+    typedef void (*DmaCallback)(void* context, bool success);
+
+    bool
+    WriteDma(uint8_t* data, uint16_t size, DmaCallback callback, void* context)
+    {
+        if(!accept_dma_)
+            return false;
+        pending_.push_back({data, size, callback, context});
+        return true;
+    }
+
+    /** Finishes the oldest pending DMA write */
+    void CompleteDma(bool success = true)
+    {
+        ASSERT_FALSE(pending_.empty());
+        const auto job = pending_.front();
+        pending_.erase(pending_.begin());
+        if(success)
+            WriteLen(job.data[0], job.data[1], job.data + 2, job.size - 2);
+        job.callback(job.context, success);
+    }
+
+    void HandleWrite(uint8_t  reg_high,
+                     uint8_t  reg_low,
+                     uint8_t* buff,
+                     uint16_t size)
+    {
+        if(reg_high != 0x0E)
+            return;
+        if(reg_low == 0x04)
+        {
+            ASSERT_LE(size, 2 + 28);
+            const uint16_t offset = (buff[0] << 8) | buff[1];
+            for(uint16_t i = 2; i < size; i++)
+                buffer_[offset + i - 2] = buff[i];
+            num_pixel_bytes_ += size - 2;
+        }
+        else if(reg_low == 0x05)
+        {
+            num_shows_++;
+        }
+    }
+
+    void ResetCounters() { num_writes_ = num_pixel_bytes_ = num_shows_ = 0; }
+
+    struct Job
+    {
+        uint8_t*    data;
+        uint16_t    size;
+        DmaCallback callback;
+        void*       context;
+    };
+
+    uint8_t          buffer_[256]     = {};
+    size_t           num_writes_      = 0;
+    size_t           num_pixel_bytes_ = 0;
+    size_t           num_shows_       = 0;
+    bool             accept_dma_      = true;
+    std::vector<Job> pending_;
+};
+
+/** Gives access to the transport */
+class TestNeoPixel : public NeoPixel<MockTransport>
+{
+  public:
+    MockTransport& GetTransport() { return transport_; }
+};
+
+void InitNeoPixel(TestNeoPixel& neopixel, bool frame_mode, uint16_t num = 16)
+{
+    System::SetUsForUnitTest(1000);
+    TestNeoPixel::Config config;
+    config.frame_mode = frame_mode;
+    config.numLEDs    = num;
+    neopixel.Init(config);
+    neopixel.GetTransport().ResetCounters();
+    // the last show was long ago
+    System::SetUsForUnitTest(1000000);
+}
+
+/** Checks that the seesaw buffer matches the local one */
+void ExpectSeesawMatches(TestNeoPixel& neopixel)
+{
+    const uint8_t* pixels = neopixel.GetPixels();
+    for(uint16_t i = 0; i < neopixel.NumPixels() * 3; i++)
+        ASSERT_EQ(neopixel.GetTransport().buffer_[i], pixels[i]) << i;
+}
+} // namespace
+
+TEST(dev_NeoPixel, a_immediateMode)
+{
+    TestNeoPixel neopixel;
+    InitNeoPixel(neopixel, false);
+    auto& transport = neopixel.GetTransport();
+
+    neopixel.SetPixelColor(0, 1, 2, 3);
+    neopixel.SetPixelColor(1, 4, 5, 6);
+    EXPECT_EQ(transport.num_writes_, 2u);
+    EXPECT_FALSE(neopixel.IsDirty());
+    neopixel.Show();
+    EXPECT_EQ(transport.num_writes_, 3u);
+    EXPECT_EQ(transport.num_shows_, 1u);
+    ExpectSeesawMatches(neopixel);
+}
+
+TEST(dev_NeoPixel, b_frameModeCoalescesWrites)
+{
+    TestNeoPixel neopixel;
+    InitNeoPixel(neopixel, true);
+    auto& transport = neopixel.GetTransport();
+
+    for(uint16_t n = 0; n < 16; n++)
+        neopixel.SetPixelColor(n, n, 2 * n, 3 * n);
+    EXPECT_EQ(transport.num_writes_, 0u);
+    EXPECT_TRUE(neopixel.IsDirty());
+
+    // 48 bytes in writes of 27 and 21 bytes
+    neopixel.Show();
+    EXPECT_EQ(transport.num_writes_, 3u);
+    EXPECT_EQ(transport.num_pixel_bytes_, 48u);
+    EXPECT_EQ(transport.num_shows_, 1u);
+    EXPECT_FALSE(neopixel.IsDirty());
+    ExpectSeesawMatches(neopixel);
+
+    // nothing changed
+    transport.ResetCounters();
+    System::SetUsForUnitTest(2000000);
+    neopixel.Show();
+    EXPECT_EQ(transport.num_pixel_bytes_, 0u);
+    EXPECT_EQ(transport.num_shows_, 1u);
+}
+
+TEST(dev_NeoPixel, c_spansAreMerged)
+{
+    TestNeoPixel neopixel;
+    InitNeoPixel(neopixel, true);
+    auto& transport = neopixel.GetTransport();
+
+    // a single unchanged pixel is rewritten with its neighbours
+    neopixel.SetPixelColor(0, 1, 1, 1);
+    neopixel.SetPixelColor(2, 1, 1, 1);
+    // two unchanged pixels are skipped
+    neopixel.SetPixelColor(5, 1, 1, 1);
+    neopixel.Show();
+    EXPECT_EQ(transport.num_writes_, 3u);
+    EXPECT_EQ(transport.num_pixel_bytes_, 9u + 3u);
+    ExpectSeesawMatches(neopixel);
+
+    // Clear() only writes on the next show
+    transport.ResetCounters();
+    System::SetUsForUnitTest(2000000);
+    neopixel.Clear();
+    EXPECT_EQ(transport.num_writes_, 0u);
+    neopixel.Show();
+    EXPECT_EQ(transport.num_pixel_bytes_, 48u);
+    ExpectSeesawMatches(neopixel);
+}
+
+TEST(dev_NeoPixel, d_flush)
+{
+    static TestNeoPixel::DmaBuffer dma_buffer;
+    TestNeoPixel                   neopixel;
+    InitNeoPixel(neopixel, true);
+    auto& transport = neopixel.GetTransport();
+
+    for(uint16_t n = 0; n < 16; n++)
+        neopixel.SetPixelColor(n, 10 + n, 20, 30);
+    ASSERT_TRUE(neopixel.Flush(dma_buffer));
+    EXPECT_TRUE(neopixel.IsFlushing());
+    EXPECT_FALSE(neopixel.Flush(dma_buffer));
+
+    // drawing doesn't affect the transfer in progress
+    neopixel.SetPixelColor(15, 0, 0, 0);
+
+    // one write at a time, the show comes last
+    size_t num_writes = 0;
+    while(neopixel.IsFlushing())
+    {
+        EXPECT_EQ(transport.pending_.size(), 1u);
+        EXPECT_EQ(transport.num_shows_, 0u);
+        transport.CompleteDma();
+        num_writes++;
+    }
+    EXPECT_EQ(num_writes, 3u);
+    EXPECT_EQ(transport.num_shows_, 1u);
+    EXPECT_EQ(transport.buffer_[15 * 3 + 1], 10 + 15);
+    EXPECT_TRUE(neopixel.IsDirty());
+
+    // too early for another show, only the pixel is written
+    System::SetUsForUnitTest(1000100);
+    ASSERT_TRUE(neopixel.Flush(dma_buffer));
+    transport.CompleteDma();
+    EXPECT_FALSE(neopixel.IsFlushing());
+    EXPECT_EQ(transport.num_shows_, 1u);
+    EXPECT_TRUE(neopixel.IsDirty());
+    ExpectSeesawMatches(neopixel);
+
+    // the show is sent later
+    System::SetUsForUnitTest(1000400);
+    ASSERT_TRUE(neopixel.Flush(dma_buffer));
+    transport.CompleteDma();
+    EXPECT_EQ(transport.num_shows_, 2u);
+    EXPECT_FALSE(neopixel.IsDirty());
+}
+
+TEST(dev_NeoPixel, e_flushErrorsRewriteEverything)
+{
+    static TestNeoPixel::DmaBuffer dma_buffer;
+    TestNeoPixel                   neopixel;
+    InitNeoPixel(neopixel, true);
+    auto& transport = neopixel.GetTransport();
+
+    neopixel.SetPixelColor(3, 1, 2, 3);
+    ASSERT_TRUE(neopixel.Flush(dma_buffer));
+    transport.CompleteDma(false);
+    EXPECT_FALSE(neopixel.IsFlushing());
+    EXPECT_TRUE(neopixel.IsDirty());
+
+    transport.ResetCounters();
+    neopixel.Show();
+    EXPECT_EQ(transport.num_pixel_bytes_, 48u);
+    EXPECT_EQ(transport.num_shows_, 1u);
+
+    // the transport rejects the write
+    transport.accept_dma_ = false;
+    neopixel.SetPixelColor(4, 1, 2, 3);
+    ASSERT_TRUE(neopixel.Flush(dma_buffer));
+    EXPECT_FALSE(neopixel.IsFlushing());
+    transport.accept_dma_ = true;
+    transport.ResetCounters();
+    System::SetUsForUnitTest(3000000);
+    ASSERT_TRUE(neopixel.Flush(dma_buffer));
+    while(neopixel.IsFlushing())
+        transport.CompleteDma();
+    EXPECT_EQ(transport.num_pixel_bytes_, 48u);
+    EXPECT_EQ(transport.num_shows_, 1u);
+    ExpectSeesawMatches(neopixel);
+}
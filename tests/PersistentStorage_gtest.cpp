@@ -1,5 +1,6 @@
 #include "util/PersistentStorage.h"
 #include <gtest/gtest.h>
+#include <vector>
 
 using namespace daisy;
 
@@ -85,9 +86,184 @@ TEST(util_PersistentStorage, d_stateBeforeInitialize)
     EXPECT_EQ(state, StorageTestClass::State::UNKNOWN);
 }
 
+namespace
+{
+struct LogTestData
+{
+    uint32_t values[30];
+
+    bool operator!=(const LogTestData &rhs) const
+    {
+        return memcmp(values, rhs.values, sizeof(values)) != 0;
+    }
+};
+
+using LogTestClass = PersistentStorage<LogTestData>;
+
+constexpr uint32_t kLogOffset     = 0x10000;
+constexpr uint32_t kNumLogSectors = 3;
+
+LogTestData MakeLogTestData(uint32_t value)
+{
+    LogTestData data;
+    for(auto &v : data.values)
+        v = value;
+    return data;
+}
+
+/** Reads the settings back like after a reboot */
+LogTestData ReadBack(QSPIHandle &qspi, LogTestClass::State *state = nullptr)
+{
+    LogTestClass storage(qspi);
+    storage.Init(MakeLogTestData(0), kLogOffset, kNumLogSectors);
+    if(state)
+        *state = storage.GetState();
+    return storage.GetSettings();
+}
+
+std::vector<uint8_t> CopyLogMemory(QSPIHandle &qspi)
+{
+    auto data = reinterpret_cast<uint8_t *>(qspi.GetData(kLogOffset));
+    return std::vector<uint8_t>(
+        data, data + kNumLogSectors * LogTestClass::kSectorSize);
+}
+} // namespace
+
+TEST(util_PersistentStorage, e_logInitClean)
+{
+    QSPIHandle   qspi;
+    LogTestClass storage(qspi);
+    storage.Init(MakeLogTestData(7), kLogOffset, kNumLogSectors);
+    EXPECT_EQ(storage.GetState(), LogTestClass::State::FACTORY);
+    EXPECT_EQ(storage.GetSettings().values[0], 7u);
+    EXPECT_FALSE(storage.IsSavePending());
+
+    // the defaults were stored
+    LogTestClass::State state;
+    EXPECT_EQ(ReadBack(qspi, &state).values[29], 7u);
+    EXPECT_EQ(state, LogTestClass::State::FACTORY);
+}
+
+TEST(util_PersistentStorage, f_logSaveIsDeferred)
+{
+    QSPIHandle   qspi;
+    LogTestClass storage(qspi);
+    storage.Init(MakeLogTestData(0), kLogOffset, kNumLogSectors);
+    // the next sector is erased in the background
+    storage.Process();
+
+    const auto before = CopyLogMemory(qspi);
+    storage.GetSettings() = MakeLogTestData(1);
+    storage.Save();
+    EXPECT_TRUE(storage.IsSavePending());
+    EXPECT_EQ(CopyLogMemory(qspi), before);
+
+    storage.Process();
+    EXPECT_FALSE(storage.IsSavePending());
+    LogTestClass::State state;
+    EXPECT_EQ(ReadBack(qspi, &state).values[0], 1u);
+    EXPECT_EQ(state, LogTestClass::State::USER);
+
+    // unchanged settings aren't written again
+    const auto after = CopyLogMemory(qspi);
+    storage.Save();
+    EXPECT_FALSE(storage.IsSavePending());
+    storage.Process();
+    EXPECT_EQ(CopyLogMemory(qspi), after);
+}
+
+TEST(util_PersistentStorage, g_logWrapsAroundTheSectors)
+{
+    QSPIHandle   qspi;
+    LogTestClass storage(qspi);
+    storage.Init(MakeLogTestData(0), kLogOffset, kNumLogSectors);
+
+    // enough saves to go around the ring a few times
+    for(uint32_t i = 1; i < 200; i++)
+    {
+        storage.GetSettings() = MakeLogTestData(i);
+        storage.Save();
+        storage.Process();
+        // the save never waits for an erase
+        ASSERT_FALSE(storage.IsSavePending()) << i;
+        ASSERT_EQ(ReadBack(qspi).values[0], i);
+        // erase in the background
+        storage.Process();
+    }
+
+    LogTestClass::State state;
+    EXPECT_EQ(ReadBack(qspi, &state).values[15], 199u);
+    EXPECT_EQ(state, LogTestClass::State::USER);
+
+    // continue after a "reboot"
+    LogTestClass rebooted(qspi);
+    rebooted.Init(MakeLogTestData(0), kLogOffset, kNumLogSectors);
+    rebooted.GetSettings() = MakeLogTestData(1000);
+    rebooted.Save();
+    rebooted.Flush();
+    EXPECT_EQ(ReadBack(qspi).values[0], 1000u);
+
+    rebooted.RestoreDefaults();
+    rebooted.Flush();
+    EXPECT_EQ(ReadBack(qspi, &state).values[0], 0u);
+    EXPECT_EQ(state, LogTestClass::State::FACTORY);
+}
+
+TEST(util_PersistentStorage, h_logRecoversFromTornWrites)
+{
+    QSPIHandle   qspi;
+    LogTestClass storage(qspi);
+    storage.Init(MakeLogTestData(0), kLogOffset, kNumLogSectors);
+    storage.GetSettings() = MakeLogTestData(1);
+    storage.Save();
+    storage.Flush();
+    storage.GetSettings() = MakeLogTestData(2);
+    storage.Save();
+    storage.Flush();
+
+    // damage the latest record, like a power loss during the write
+    // magic, sequence, state, settings and CRC
+    const uint32_t record_size
+        = 3 * sizeof(uint32_t) + sizeof(LogTestClass::State)
+          + sizeof(LogTestData);
+    uint8_t zero = 0;
+    qspi.Write(kLogOffset + 2 * record_size + 20, 1, &zero);
+    EXPECT_EQ(ReadBack(qspi).values[0], 1u);
+
+    // the damaged slot is skipped
+    LogTestClass rebooted(qspi);
+    rebooted.Init(MakeLogTestData(0), kLogOffset, kNumLogSectors);
+    rebooted.GetSettings() = MakeLogTestData(3);
+    rebooted.Save();
+    rebooted.Flush();
+    EXPECT_EQ(ReadBack(qspi).values[0], 3u);
+}
+
 // A few short tests for the QSPIHandle mock wrapper as well.
 // These can move to their own file
 
+TEST(util_PersistentStorage, i_logWaitsWhileTheQspiIsBusy)
+{
+    QSPIHandle   qspi;
+    LogTestClass storage(qspi);
+    storage.Init(MakeLogTestData(0), kLogOffset, kNumLogSectors);
+    storage.Process();
+
+    // another asynchronous operation has the flash
+    qspi.SetBusyForUnitTest(true);
+    const auto before = CopyLogMemory(qspi);
+    storage.GetSettings() = MakeLogTestData(1);
+    storage.Save();
+    storage.Process();
+    EXPECT_TRUE(storage.IsSavePending());
+    EXPECT_EQ(CopyLogMemory(qspi), before);
+
+    qspi.SetBusyForUnitTest(false);
+    storage.Process();
+    EXPECT_FALSE(storage.IsSavePending());
+    EXPECT_EQ(ReadBack(qspi).values[0], 1u);
+}
+
 TEST(per_QSPIHandle_mock, a_stateAfterInit)
 {
     QSPIHandle qspi;
@@ -151,4 +327,41 @@ TEST(per_QSPIHandle_mock, c_testWrite)
     val = testsize / 2;
     test = data[testoffset+val];
     EXPECT_EQ(test, val & 0xff);
-}
\ No newline at end of file
+}
+
+TEST(per_QSPIHandle_mock, d_writeOnlyClearsBits)
+{
+    QSPIHandle qspi;
+    qspi.Erase(0, 256);
+    uint8_t data[3] = {0xf0, 0x0f, 0x55};
+    // unaligned address
+    qspi.Write(13, 3, data);
+    auto mem = reinterpret_cast<uint8_t *>(qspi.GetData());
+    EXPECT_EQ(mem[12], 0xff);
+    EXPECT_EQ(mem[13], 0xf0);
+    EXPECT_EQ(mem[15], 0x55);
+
+    uint8_t more[1] = {0x3c};
+    qspi.Write(13, 1, more);
+    EXPECT_EQ(mem[13], 0x30);
+}
+
+TEST(per_QSPIHandle_mock, e_asyncOperationsCallBack)
+{
+    QSPIHandle qspi;
+    int        num_calls = 0;
+    auto       callback  = [](void* context, QSPIHandle::Result result) {
+        EXPECT_EQ(result, QSPIHandle::Result::OK);
+        (*static_cast<int*>(context))++;
+    };
+    uint8_t data[2] = {0x12, 0x34};
+    EXPECT_EQ(qspi.EraseAsync(0, 256, callback, &num_calls),
+              QSPIHandle::Result::OK);
+    EXPECT_EQ(qspi.WriteAsync(4, 2, data, callback, &num_calls),
+              QSPIHandle::Result::OK);
+    EXPECT_EQ(num_calls, 2);
+    EXPECT_FALSE(qspi.IsBusy());
+    auto mem = reinterpret_cast<uint8_t*>(qspi.GetData());
+    EXPECT_EQ(mem[4], 0x12);
+    EXPECT_EQ(mem[5], 0x34);
+}
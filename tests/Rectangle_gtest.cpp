@@ -212,4 +212,15 @@ TEST(hid_disp_Rectangle, k_alignedWithin)
               Rectangle(90, 45, 10, 10));
     EXPECT_EQ(srcRect.AlignedWithin(boundingBox, Alignment::centered),
               Rectangle(45, 45, 10, 10));
-}
\ No newline at end of file
+}
+TEST(hid_disp_Rectangle, l_unitedWith)
+{
+    const auto rect = Rectangle(10, 20, 10, 10);
+    EXPECT_EQ(rect.UnitedWith(Rectangle(30, 5, 5, 5)),
+              Rectangle(10, 5, 25, 25));
+    EXPECT_EQ(rect.UnitedWith(Rectangle(12, 22, 2, 2)), rect);
+    EXPECT_EQ(Rectangle(12, 22, 2, 2).UnitedWith(rect), rect);
+    // empty rectangles are ignored
+    EXPECT_EQ(rect.UnitedWith(Rectangle(0, 0, 0, 5)), rect);
+    EXPECT_EQ(Rectangle(0, 0, 5, 0).UnitedWith(rect), rect);
+}
@@ -0,0 +1,415 @@
+#include "dev/oled_ssd130x.h"
+#include "dev/oled_sh1106.h"
+#include "hid/disp/oled_display.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+/** Records what the driver sends, and emulates the display RAM */
+class MockTransport
+{
+  public:
+    struct Config
+    {
+        /** receives the transport, for drivers that aren't accessible */
+        MockTransport** instance = nullptr;
+    };
+    void Init(const Config& config)
+    {
+        if(config.instance)
+            *config.instance = this;
+    }
+
+    void SendCommand(uint8_t cmd)
+    {
+        num_cmd_bytes_++;
+        HandleCommand(cmd);
+    }
+
+    void SendData(uint8_t* buff, size_t size)
+    {
+        num_data_bytes_ += size;
+        for(size_t i = 0; i < size; i++)
+            ram_[page_][column_++] = buff[i];
+    }
+
+    typedef void (*DmaCallback)(void* context, bool success);
+
+    bool DmaSendCommandsAndData(uint8_t*    cmds,
+                                size_t      num_cmds,
+                                uint8_t*    data,
+                                size_t      size,
+                                DmaCallback callback,
+                                void*       context)
+    {
+        if(!accept_dma_)
+            return false;
+        pending_.push_back({cmds, num_cmds, data, size, callback, context});
+        return true;
+    }
+
+    /** Finishes the oldest pending DMA transfer */
+    void CompleteDma(bool success = true)
+    {
+        ASSERT_FALSE(pending_.empty());
+        const auto job = pending_.front();
+        pending_.erase(pending_.begin());
+        if(success)
+        {
+            for(size_t i = 0; i < job.num_cmds; i++)
+                SendCommand(job.cmds[i]);
+            SendData(job.data, job.size);
+        }
+        job.callback(job.context, success);
+    }
+
+    void HandleCommand(uint8_t cmd)
+    {
+        // only the page addressing commands sent by Update()
+        if(cmd >= 0xB0 && cmd <= 0xB7)
+            page_ = cmd - 0xB0;
+        else if(cmd < 0x10)
+            column_ = (column_ & 0xf0) | cmd;
+        else if(cmd < 0x20)
+            column_ = (column_ & 0x0f) | ((cmd & 0x0f) << 4);
+    }
+
+    void ResetCounters() { num_cmd_bytes_ = num_data_bytes_ = 0; }
+
+    struct Job
+    {
+        uint8_t*    cmds;
+        size_t      num_cmds;
+        uint8_t*    data;
+        size_t      size;
+        DmaCallback callback;
+        void*       context;
+    };
+
+    uint8_t          ram_[8][132]    = {};
+    size_t           page_           = 0;
+    size_t           column_         = 0;
+    size_t           num_cmd_bytes_  = 0;
+    size_t           num_data_bytes_ = 0;
+    bool             accept_dma_     = true;
+    std::vector<Job> pending_;
+};
+
+/** Gives access to the transport */
+template <size_t width, size_t height>
+class TestDriver : public SSD130xDriver<width, height, MockTransport>
+{
+  public:
+    MockTransport& GetTransport() { return this->transport_; }
+};
+
+using Driver128x64 = TestDriver<128, 64>;
+
+/** Checks that the display RAM matches what's been drawn */
+void ExpectDisplayMatches(Driver128x64& driver, size_t column_offset = 0)
+{
+    auto& ram = driver.GetTransport().ram_;
+    for(size_t y = 0; y < 64; y++)
+        for(size_t x = 0; x < 128; x++)
+        {
+            const bool on = ram[y / 8][x + column_offset] & (1 << (y % 8));
+            ASSERT_EQ(on, y == x || y == 2 * x) << "x=" << x << " y=" << y;
+        }
+}
+
+/** Draws with DrawPixel() only, as a reference for the faster functions */
+class PixelDisplay : public OneBitGraphicsDisplayImpl<PixelDisplay>
+{
+  public:
+    uint16_t Height() const override { return 64; }
+    uint16_t Width() const override { return 128; }
+    void     Fill(bool on) override { driver_.Fill(on); }
+    void     DrawPixel(uint_fast8_t x, uint_fast8_t y, bool on) override
+    {
+        driver_.DrawPixel(x, y, on);
+    }
+    void Update() override { driver_.Update(); }
+
+    Driver128x64 driver_;
+};
+
+/** An OledDisplay and a PixelDisplay that are drawn to in the same way */
+class DisplayPair
+{
+  public:
+    DisplayPair()
+    {
+        OledDisplay<Driver128x64>::Config config;
+        config.driver_config.transport_config.instance = &transport_;
+        display_.Init(config);
+        reference_.driver_.Init({});
+        display_.Fill(false);
+        reference_.Fill(false);
+        display_.Update();
+        transport_->ResetCounters();
+    }
+
+    void ExpectEqual()
+    {
+        display_.Update();
+        reference_.Update();
+        auto& ram     = transport_->ram_;
+        auto& ref_ram = reference_.driver_.GetTransport().ram_;
+        for(size_t page = 0; page < 8; page++)
+            for(size_t x = 0; x < 128; x++)
+                ASSERT_EQ(ram[page][x], ref_ram[page][x])
+                    << "page=" << page << " x=" << x;
+    }
+
+    OledDisplay<Driver128x64> display_;
+    PixelDisplay              reference_;
+    MockTransport*            transport_ = nullptr;
+};
+
+void DrawLines(Driver128x64& driver)
+{
+    for(size_t x = 0; x < 64; x++)
+    {
+        driver.DrawPixel(x, x, true);
+        driver.DrawPixel(x, 2 * x, true);
+    }
+}
+} // namespace
+
+TEST(dev_SSD130x, a_firstUpdateSendsEverything)
+{
+    Driver128x64 driver;
+    driver.Init({});
+    auto& transport = driver.GetTransport();
+    transport.ResetCounters();
+
+    EXPECT_TRUE(driver.IsDirty());
+    driver.Update();
+    EXPECT_EQ(transport.num_data_bytes_, 128u * 8u);
+    EXPECT_EQ(transport.num_cmd_bytes_, 3u * 8u);
+    EXPECT_FALSE(driver.IsDirty());
+
+    // nothing changed
+    transport.ResetCounters();
+    driver.Update();
+    EXPECT_EQ(transport.num_data_bytes_, 0u);
+    EXPECT_EQ(transport.num_cmd_bytes_, 0u);
+}
+
+TEST(dev_SSD130x, b_onlyChangedColumnsAreSent)
+{
+    Driver128x64 driver;
+    driver.Init({});
+    driver.Fill(false);
+    driver.Update();
+    auto& transport = driver.GetTransport();
+    transport.ResetCounters();
+
+    // columns 10..20 on page 1, column 100 on page 7
+    driver.DrawPixel(10, 8, true);
+    driver.DrawPixel(20, 15, true);
+    driver.DrawPixel(100, 63, true);
+    // no change
+    driver.DrawPixel(50, 30, false);
+    driver.Update();
+    EXPECT_EQ(transport.num_data_bytes_, 11u + 1u);
+    EXPECT_EQ(transport.num_cmd_bytes_, 2u * 3u);
+    EXPECT_EQ(transport.ram_[1][10], 0x01);
+    EXPECT_EQ(transport.ram_[1][20], 0x80);
+    EXPECT_EQ(transport.ram_[7][100], 0x80);
+
+    // Fill only marks bytes that change
+    transport.ResetCounters();
+    driver.Fill(false);
+    driver.Update();
+    EXPECT_EQ(transport.num_data_bytes_, 11u + 1u);
+}
+
+TEST(dev_SSD130x, c_displayMatchesAfterManyUpdates)
+{
+    Driver128x64 driver;
+    driver.Init({});
+    driver.Fill(true);
+    driver.Update();
+    driver.Fill(false);
+    DrawLines(driver);
+    driver.Update();
+    ExpectDisplayMatches(driver);
+
+    // redrawing the same frame sends only what Fill() cleared
+    auto& transport = driver.GetTransport();
+    transport.ResetCounters();
+    driver.Fill(false);
+    DrawLines(driver);
+    driver.Update();
+    EXPECT_LT(transport.num_data_bytes_, 128u * 8u);
+    ExpectDisplayMatches(driver);
+}
+
+TEST(dev_SSD130x, d_updateAsync)
+{
+    static Driver128x64::DmaBuffer dma_buffer;
+    Driver128x64                   driver;
+    driver.Init({});
+    driver.Fill(false);
+    driver.Update();
+    auto& transport = driver.GetTransport();
+    transport.ResetCounters();
+
+    DrawLines(driver);
+    ASSERT_TRUE(driver.UpdateAsync(dma_buffer));
+    EXPECT_FALSE(driver.IsDirty());
+    EXPECT_TRUE(driver.IsUpdating());
+    EXPECT_FALSE(driver.UpdateAsync(dma_buffer));
+
+    // drawing doesn't affect the transfer in progress
+    driver.DrawPixel(127, 0, true);
+
+    // one page at a time
+    size_t num_pages = 0;
+    while(driver.IsUpdating())
+    {
+        EXPECT_EQ(transport.pending_.size(), 1u);
+        transport.CompleteDma();
+        num_pages++;
+    }
+    EXPECT_EQ(num_pages, 8u);
+    driver.DrawPixel(127, 0, false);
+    ExpectDisplayMatches(driver);
+    EXPECT_EQ(transport.num_cmd_bytes_, 3u * 8u);
+}
+
+TEST(dev_SSD130x, e_updateAsyncErrorsResendEverything)
+{
+    static Driver128x64::DmaBuffer dma_buffer;
+    Driver128x64                   driver;
+    driver.Init({});
+    driver.Fill(false);
+    driver.Update();
+    auto& transport = driver.GetTransport();
+
+    driver.DrawPixel(0, 0, true);
+    driver.DrawPixel(0, 63, true);
+    ASSERT_TRUE(driver.UpdateAsync(dma_buffer));
+    transport.CompleteDma(false);
+    EXPECT_FALSE(driver.IsUpdating());
+    EXPECT_TRUE(transport.pending_.empty());
+
+    transport.ResetCounters();
+    driver.Update();
+    EXPECT_EQ(transport.num_data_bytes_, 128u * 8u);
+
+    // the transport rejects the job
+    transport.accept_dma_ = false;
+    driver.DrawPixel(1, 0, true);
+    ASSERT_TRUE(driver.UpdateAsync(dma_buffer));
+    EXPECT_FALSE(driver.IsUpdating());
+    transport.ResetCounters();
+    driver.Update();
+    EXPECT_EQ(transport.num_data_bytes_, 128u * 8u);
+}
+
+TEST(dev_SSD130x, f_columnOffsets)
+{
+    // 32 rows high displays start at column 32
+    TestDriver<64, 32> small;
+    small.Init({});
+    small.Fill(false);
+    small.DrawPixel(0, 0, true);
+    small.Update();
+    EXPECT_EQ(small.GetTransport().ram_[0][32], 0x01);
+
+    // the SH1106 starts at column 2
+    class TestSH1106 : public SH1106Driver<128, 64, MockTransport>
+    {
+      public:
+        MockTransport& GetTransport() { return this->transport_; }
+    } sh1106;
+    sh1106.Init({});
+    sh1106.Fill(false);
+    sh1106.DrawPixel(127, 0, true);
+    sh1106.Update();
+    EXPECT_EQ(sh1106.GetTransport().ram_[0][129], 0x01);
+    EXPECT_EQ(sh1106.GetTransport().ram_[0][127], 0x00);
+}
+
+TEST(dev_SSD130x, g_fillRectMatchesPixels)
+{
+    DisplayPair pair;
+    // within a page, across pages, clipped, reversed
+    for(OneBitGraphicsDisplay* display :
+        {(OneBitGraphicsDisplay*)&pair.display_,
+         (OneBitGraphicsDisplay*)&pair.reference_})
+    {
+        display->DrawRect(3, 2, 9, 5, true, true);
+        display->DrawRect(20, 5, 40, 30, true, true);
+        display->DrawRect(25, 9, 30, 24, false, true);
+        display->DrawRect(100, 50, 200, 200, true, true);
+        display->DrawRect(60, 10, 50, 20, true, true);
+        display->DrawRect(70, 3, 90, 60, true, false);
+        display->DrawLine(0, 63, 127, 63, true);
+        display->DrawLine(5, 40, 5, 33, true);
+        display->DrawLine(10, 40, 20, 50, true);
+    }
+    pair.ExpectEqual();
+}
+
+TEST(dev_SSD130x, h_fillRectSendsOnlyChangedColumns)
+{
+    DisplayPair pair;
+    pair.display_.DrawRect(10, 12, 19, 13, true, true);
+    pair.display_.Update();
+    EXPECT_EQ(pair.transport_->num_data_bytes_, 10u);
+
+    // drawing it again changes nothing
+    pair.transport_->ResetCounters();
+    pair.display_.DrawLine(10, 12, 19, 12, true);
+    pair.display_.Update();
+    EXPECT_EQ(pair.transport_->num_data_bytes_, 0u);
+}
+
+TEST(dev_SSD130x, i_textMatchesPixels)
+{
+    const char* text = " !Hello, World~{}";
+    for(const FontDef* font : {&Font_4x6,
+                               &Font_4x8,
+                               &Font_5x8,
+                               &Font_6x7,
+                               &Font_6x8,
+                               &Font_7x10,
+                               &Font_11x18,
+                               &Font_16x26})
+    {
+        ASSERT_NE(font->columns, nullptr);
+        // the same font without the packed glyphs
+        const FontDef unpacked
+            = {font->FontWidth, font->FontHeight, font->data, nullptr};
+        for(uint16_t y : {0, 3, 8, 13})
+        {
+            for(bool on : {true, false})
+            {
+                DisplayPair pair;
+                pair.display_.Fill(!on);
+                pair.reference_.Fill(!on);
+                // the reference draws every pixel of the packed glyphs
+                pair.display_.SetCursor(1, y);
+                pair.display_.WriteString(text, *font, on);
+                pair.reference_.SetCursor(1, y);
+                pair.reference_.WriteString(text, *font, on);
+                pair.ExpectEqual();
+                EXPECT_EQ(pair.display_.CurrentX(),
+                          pair.reference_.CurrentX());
+
+                // and the original font tables
+                pair.reference_.Fill(true);
+                pair.reference_.Fill(!on);
+                pair.reference_.SetCursor(1, y);
+                pair.reference_.WriteString(text, unpacked, on);
+                pair.ExpectEqual();
+            }
+        }
+    }
+}
@@ -0,0 +1,249 @@
+#include "util/SampleConversion.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace daisy;
+
+using BitDepth = SaiHandle::Config::BitDepth;
+
+namespace
+{
+/** Scalar reference, as formerly used by AudioHandle's InternalCallback */
+int32_t RefToInt(BitDepth bd, float x)
+{
+    switch(bd)
+    {
+        case BitDepth::SAI_16BIT: return f2s16(x);
+        case BitDepth::SAI_24BIT: return f2s24(x);
+        default: return f2s32(x);
+    }
+}
+
+float RefToFloat(BitDepth bd, int32_t x)
+{
+    switch(bd)
+    {
+        case BitDepth::SAI_16BIT: return s162f(x);
+        case BitDepth::SAI_24BIT: return s242f(x);
+        default: return s322f(x);
+    }
+}
+
+void RefDeinterleave(BitDepth       bd,
+                     const int32_t* in,
+                     float* const*  out,
+                     size_t         chns,
+                     size_t         frames,
+                     float          gain)
+{
+    for(size_t i = 0; i < frames; i++)
+        for(size_t c = 0; c < chns; c++)
+            out[c][i] = RefToFloat(bd, in[i * chns + c]) * gain;
+}
+
+void RefInterleave(BitDepth            bd,
+                   const float* const* in,
+                   int32_t*            out,
+                   size_t              chns,
+                   size_t              frames,
+                   float               gain)
+{
+    for(size_t i = 0; i < frames; i++)
+        for(size_t c = 0; c < chns; c++)
+            out[i * chns + c] = RefToInt(bd, in[c][i] * gain);
+}
+
+/** Random raw words, including garbage in the unused upper bits */
+std::vector<int32_t> MakeIntInput(size_t n)
+{
+    std::mt19937                            gen(1234);
+    std::uniform_int_distribution<uint32_t> dist;
+    std::vector<int32_t>                    v(n);
+    for(auto& x : v)
+        x = static_cast<int32_t>(dist(gen));
+    // the extremes
+    v[0] = INT32_MIN;
+    v[1] = INT32_MAX;
+    v[2] = 0x007fffff;
+    v[3] = 0x00800000;
+    return v;
+}
+
+/** Random floats, some of them beyond full scale to exercise saturation */
+std::vector<float> MakeFloatInput(size_t n)
+{
+    std::mt19937                          gen(5678);
+    std::uniform_real_distribution<float> dist(-1.5f, 1.5f);
+    std::vector<float>                    v(n);
+    for(auto& x : v)
+        x = dist(gen);
+    v[0] = 1.0f;
+    v[1] = -1.0f;
+    v[2] = 0.0f;
+    v[3] = -0.0f;
+    return v;
+}
+
+const BitDepth kBitDepths[]
+    = {BitDepth::SAI_16BIT, BitDepth::SAI_24BIT, BitDepth::SAI_32BIT};
+const size_t kChannelCounts[] = {1, 2, 4, 8, 16};
+// odd sizes to hit the scalar tail after the packed loop
+const size_t kFrameCounts[] = {1, 3, 4, 7, 48, 129};
+const float  kGains[]       = {1.0f, 0.5f, 1.7f};
+
+} // namespace
+
+TEST(util_SampleConversion, a_unsupportedLayouts)
+{
+    auto k = SampleConversion::GetKernels(BitDepth::SAI_24BIT, 3, false);
+    EXPECT_EQ(k.in, nullptr);
+    EXPECT_EQ(k.out, nullptr);
+
+    // interleaved float buffers don't care about the channel count
+    k = SampleConversion::GetKernels(BitDepth::SAI_24BIT, 3, true);
+    EXPECT_NE(k.in, nullptr);
+    EXPECT_NE(k.out, nullptr);
+}
+
+TEST(util_SampleConversion, b_deinterleaveBitExact)
+{
+    for(auto bd : kBitDepths)
+        for(auto chns : kChannelCounts)
+            for(auto frames : kFrameCounts)
+                for(auto gain : kGains)
+                {
+                    const auto in = MakeIntInput(frames * chns + 4);
+                    std::vector<float> res(frames * chns), ref(frames * chns);
+                    std::vector<float*> res_ch(chns), ref_ch(chns);
+                    for(size_t c = 0; c < chns; c++)
+                    {
+                        res_ch[c] = res.data() + c * frames;
+                        ref_ch[c] = ref.data() + c * frames;
+                    }
+
+                    auto k = SampleConversion::GetKernels(bd, chns, false);
+                    ASSERT_NE(k.in, nullptr);
+                    k.in(in.data(), res_ch.data(), frames, gain);
+                    RefDeinterleave(
+                        bd, in.data(), ref_ch.data(), chns, frames, gain);
+                    EXPECT_EQ(0,
+                              std::memcmp(res.data(),
+                                          ref.data(),
+                                          res.size() * sizeof(float)))
+                        << "bd=" << int(bd) << " chns=" << chns
+                        << " frames=" << frames << " gain=" << gain;
+                }
+}
+
+TEST(util_SampleConversion, c_interleaveBitExact)
+{
+    for(auto bd : kBitDepths)
+        for(auto chns : kChannelCounts)
+            for(auto frames : kFrameCounts)
+                for(auto gain : kGains)
+                {
+                    const auto in = MakeFloatInput(frames * chns + 4);
+                    std::vector<const float*> in_ch(chns);
+                    for(size_t c = 0; c < chns; c++)
+                        in_ch[c] = in.data() + c * frames;
+                    std::vector<int32_t> res(frames * chns),
+                        ref(frames * chns);
+
+                    auto k = SampleConversion::GetKernels(bd, chns, false);
+                    ASSERT_NE(k.out, nullptr);
+                    k.out(in_ch.data(), res.data(), frames, gain);
+                    RefInterleave(
+                        bd, in_ch.data(), ref.data(), chns, frames, gain);
+                    EXPECT_EQ(res, ref) << "bd=" << int(bd) << " chns=" << chns
+                                        << " frames=" << frames
+                                        << " gain=" << gain;
+                }
+}
+
+TEST(util_SampleConversion, d_interleavedCopyBitExact)
+{
+    for(auto bd : kBitDepths)
+        for(auto n : kFrameCounts)
+        {
+            const auto         in_int   = MakeIntInput(n + 4);
+            const auto         in_float = MakeFloatInput(n + 4);
+            std::vector<float> res_f(n), ref_f(n);
+            std::vector<int32_t> res_i(n), ref_i(n);
+            float*               res_ptr = res_f.data();
+            float*               ref_ptr = ref_f.data();
+            const float*         src_ptr = in_float.data();
+
+            auto k = SampleConversion::GetKernels(bd, 2, true);
+            k.in(in_int.data(), &res_ptr, n, 0.5f);
+            k.out(&src_ptr, res_i.data(), n, 1.7f);
+            RefDeinterleave(bd, in_int.data(), &ref_ptr, 1, n, 0.5f);
+            RefInterleave(bd, &src_ptr, ref_i.data(), 1, n, 1.7f);
+
+            EXPECT_EQ(
+                0,
+                std::memcmp(
+                    res_f.data(), ref_f.data(), res_f.size() * sizeof(float)));
+            EXPECT_EQ(res_i, ref_i);
+        }
+}
+
+/** Records the time spent converting a 4-channel, 24-bit stream at
+ *  blocksize 4 with the scalar reference and the selected kernels as
+ *  test properties, see --gtest_output. The timed kernels have to
+ *  produce the same buffers as the reference.
+ */
+TEST(util_SampleConversion, e_benchmark)
+{
+    using clock                  = std::chrono::steady_clock;
+    constexpr size_t kFrames     = 4;
+    constexpr size_t kChans      = 2; // per SAI
+    constexpr size_t kIterations = 200000;
+    const BitDepth   bd          = BitDepth::SAI_24BIT;
+
+    const auto           in = MakeIntInput(kFrames * kChans);
+    std::vector<int32_t> out(kFrames * kChans);
+    float                buff[kFrames * kChans];
+    float*               ch[kChans] = {buff, buff + kFrames};
+    volatile float       gain       = 1.0f;
+
+    const auto measure = [&](bool use_kernels) {
+        const auto k     = SampleConversion::GetKernels(bd, kChans, false);
+        const auto start = clock::now();
+        for(size_t i = 0; i < kIterations; i++)
+        {
+            // two SAI, as with the 4-channel engine
+            for(size_t sai = 0; sai < 2; sai++)
+            {
+                if(use_kernels)
+                {
+                    k.in(in.data(), ch, kFrames, gain);
+                    k.out(ch, out.data(), kFrames, gain);
+                }
+                else
+                {
+                    RefDeinterleave(bd, in.data(), ch, kChans, kFrames, gain);
+                    RefInterleave(bd, ch, out.data(), kChans, kFrames, gain);
+                }
+            }
+        }
+        return std::chrono::duration<double, std::nano>(clock::now() - start)
+                   .count()
+               / kIterations;
+    };
+
+    const double scalar_ns = measure(false);
+    const double kernel_ns = measure(true);
+    RecordProperty("scalar_ns_per_block", std::to_string(scalar_ns));
+    RecordProperty("kernel_ns_per_block", std::to_string(kernel_ns));
+
+    std::vector<int32_t> ref_out(kFrames * kChans);
+    float                ref_buff[kFrames * kChans];
+    float*               ref_ch[kChans] = {ref_buff, ref_buff + kFrames};
+    RefDeinterleave(bd, in.data(), ref_ch, kChans, kFrames, gain);
+    RefInterleave(bd, ref_ch, ref_out.data(), kChans, kFrames, gain);
+    EXPECT_EQ(0, std::memcmp(buff, ref_buff, sizeof(buff)));
+    EXPECT_EQ(out, ref_out);
+}
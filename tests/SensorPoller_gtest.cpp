@@ -0,0 +1,368 @@
+#include <cmath>
+#include "per/i2c.h"
+#include "per/spi.h"
+#include "sys/system.h"
+#include "util/SensorPoller.h"
+#include "dev/dps310.h"
+#include "dev/mpr121.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+/** Emulates the registers of a device from a register dump, and holds the
+ *  DMA reads until the test completes them.
+ */
+class MockDevice
+{
+  public:
+    MockDevice() { memset(regs_, 0, sizeof(regs_)); }
+
+    void LoadDump(uint8_t reg, const std::vector<uint8_t>& dump)
+    {
+        memcpy(regs_ + reg, dump.data(), dump.size());
+    }
+
+    bool DmaReadReg(uint8_t            reg,
+                    uint8_t*           buff,
+                    uint16_t           size,
+                    SensorPollCallback callback,
+                    void*              context)
+    {
+        if(!accept_dma_)
+            return false;
+        pending_.push_back({reg, buff, size, callback, context});
+        return true;
+    }
+
+    /** Finishes the oldest pending read with the current registers */
+    void CompleteDma(bool success = true)
+    {
+        ASSERT_FALSE(pending_.empty());
+        const auto read = pending_.front();
+        pending_.erase(pending_.begin());
+        if(success)
+            memcpy(read.buff, regs_ + read.reg, read.size);
+        read.callback(read.context, success);
+    }
+
+    struct PendingRead
+    {
+        uint8_t            reg;
+        uint8_t*           buff;
+        uint16_t           size;
+        SensorPollCallback callback;
+        void*              context;
+    };
+
+    uint8_t                  regs_[256];
+    uint8_t                  pointer_    = 0;
+    bool                     accept_dma_ = true;
+    std::vector<PendingRead> pending_;
+};
+
+/** Provides the blocking functions of the driver transports as well as
+ *  DmaReadReg() for a MockDevice
+ */
+class MockTransport
+{
+  public:
+    struct Config
+    {
+        MockDevice* device = nullptr;
+    };
+
+    bool Init(const Config& config)
+    {
+        device_ = config.device;
+        return false;
+    }
+
+    void Write8(uint8_t reg, uint8_t value) { device_->regs_[reg] = value; }
+
+    void ReadReg(uint8_t reg, uint8_t* buff, uint8_t size)
+    {
+        memcpy(buff, device_->regs_ + reg, size);
+    }
+
+    uint8_t Read8(uint8_t reg) { return device_->regs_[reg]; }
+
+    uint32_t Read24(uint8_t reg)
+    {
+        const uint8_t* r = device_->regs_ + reg;
+        return uint32_t(r[0]) << 16 | uint32_t(r[1]) << 8 | r[2];
+    }
+
+    /** The first byte sets the register pointer, the others are written */
+    bool Write(uint8_t* data, uint16_t size)
+    {
+        device_->pointer_ = data[0];
+        for(uint16_t i = 1; i < size; i++)
+            device_->regs_[device_->pointer_ + i - 1] = data[i];
+        return false;
+    }
+
+    bool Read(uint8_t* data, uint16_t size)
+    {
+        memcpy(data, device_->regs_ + device_->pointer_, size);
+        return false;
+    }
+
+    bool GetError() { return false; }
+
+    bool DmaReadReg(uint8_t            reg,
+                    uint8_t*           buff,
+                    uint16_t           size,
+                    SensorPollCallback callback,
+                    void*              context)
+    {
+        return device_->DmaReadReg(reg, buff, size, callback, context);
+    }
+
+  private:
+    MockDevice* device_ = nullptr;
+};
+
+/** A minimal driver that records what it decodes */
+class FakeSensor
+{
+  public:
+    FakeSensor(MockDevice& device, uint8_t reg, uint8_t size, uint32_t period)
+    : device_(device), window_({reg, size, period})
+    {
+    }
+
+    SensorPollWindow GetPollWindow() const { return window_; }
+
+    bool
+    StartPollRead(uint8_t* buff, SensorPollCallback callback, void* context)
+    {
+        return device_.DmaReadReg(
+            window_.reg, buff, window_.size, callback, context);
+    }
+
+    void DecodePoll(const uint8_t* regs)
+    {
+        decoded_.assign(regs, regs + window_.size);
+        num_decoded_++;
+    }
+
+    std::vector<uint8_t> decoded_;
+    int                  num_decoded_ = 0;
+
+  private:
+    MockDevice&      device_;
+    SensorPollWindow window_;
+};
+
+using SmallPoller = SensorPoller<2, 16>;
+
+void SetTimeMs(uint32_t ms)
+{
+    System::SetUsForUnitTest(ms * 1000);
+}
+} // namespace
+
+TEST(util_SensorPoller, a_readsSensorsWhenDue)
+{
+    SetTimeMs(100);
+    MockDevice                device;
+    FakeSensor                fast(device, 0x10, 4, 10);
+    FakeSensor                slow(device, 0x20, 2, 30);
+    SensorPoller<>            poller;
+    SensorPoller<>::DmaBuffer buffer;
+    poller.Init(buffer);
+    EXPECT_EQ(poller.Add(fast), SensorPoller<>::Result::OK);
+    EXPECT_EQ(poller.Add(slow), SensorPoller<>::Result::OK);
+    EXPECT_EQ(poller.GetNumSensors(), 2u);
+    device.LoadDump(0x10, {1, 2, 3, 4});
+    device.LoadDump(0x20, {5, 6});
+
+    // both are read right away, into separate parts of the buffer
+    poller.Process();
+    ASSERT_EQ(device.pending_.size(), 2u);
+    EXPECT_EQ(device.pending_[0].reg, 0x10);
+    EXPECT_EQ(device.pending_[0].size, 4);
+    EXPECT_EQ(device.pending_[1].reg, 0x20);
+    EXPECT_GE(device.pending_[1].buff, device.pending_[0].buff + 4);
+    EXPECT_LE(device.pending_[1].buff + 2, buffer + sizeof(buffer));
+    device.CompleteDma();
+    device.CompleteDma();
+    EXPECT_EQ(fast.decoded_, std::vector<uint8_t>({1, 2, 3, 4}));
+    EXPECT_EQ(slow.decoded_, std::vector<uint8_t>({5, 6}));
+
+    // nothing is due before the period elapsed
+    SetTimeMs(109);
+    poller.Process();
+    EXPECT_TRUE(device.pending_.empty());
+
+    SetTimeMs(110);
+    poller.Process();
+    ASSERT_EQ(device.pending_.size(), 1u);
+    device.CompleteDma();
+    EXPECT_EQ(fast.num_decoded_, 2);
+
+    // the period is kept even if Process() is late
+    SetTimeMs(125);
+    poller.Process();
+    device.CompleteDma();
+    SetTimeMs(130);
+    poller.Process();
+    ASSERT_EQ(device.pending_.size(), 2u);
+    device.CompleteDma();
+    device.CompleteDma();
+    EXPECT_EQ(fast.num_decoded_, 4);
+    EXPECT_EQ(slow.num_decoded_, 2);
+
+    // ...unless it fell behind by a whole period
+    SetTimeMs(175);
+    poller.Process();
+    device.CompleteDma();
+    device.CompleteDma();
+    SetTimeMs(184);
+    poller.Process();
+    EXPECT_TRUE(device.pending_.empty());
+    SetTimeMs(185);
+    poller.Process();
+    EXPECT_EQ(device.pending_.size(), 1u);
+
+    EXPECT_EQ(poller.GetNumErrors(), 0u);
+    EXPECT_EQ(poller.GetNumOverruns(), 0u);
+}
+
+TEST(util_SensorPoller, b_countsOverrunsAndErrors)
+{
+    SetTimeMs(0);
+    MockDevice                device;
+    FakeSensor                sensor(device, 0x00, 4, 10);
+    SensorPoller<>            poller;
+    SensorPoller<>::DmaBuffer buffer;
+    poller.Init(buffer);
+    poller.Add(sensor);
+
+    // the previous read didn't finish in time
+    poller.Process();
+    SetTimeMs(10);
+    poller.Process();
+    EXPECT_EQ(device.pending_.size(), 1u);
+    EXPECT_EQ(poller.GetNumOverruns(), 1u);
+
+    // a failed read isn't decoded
+    device.CompleteDma(false);
+    EXPECT_EQ(sensor.num_decoded_, 0);
+    EXPECT_EQ(poller.GetNumErrors(), 1u);
+
+    // a read that can't be started
+    device.accept_dma_ = false;
+    SetTimeMs(20);
+    poller.Process();
+    EXPECT_EQ(poller.GetNumErrors(), 2u);
+
+    // the sensor isn't stuck
+    device.accept_dma_ = true;
+    SetTimeMs(30);
+    poller.Process();
+    device.CompleteDma();
+    EXPECT_EQ(sensor.num_decoded_, 1);
+}
+
+TEST(util_SensorPoller, c_rejectsSensorsThatDontFit)
+{
+    SetTimeMs(0);
+    MockDevice             device;
+    FakeSensor             big(device, 0x00, 12, 10);
+    FakeSensor             small(device, 0x00, 4, 10);
+    SmallPoller            poller;
+    SmallPoller::DmaBuffer buffer;
+
+    // not initialized
+    EXPECT_EQ(poller.Add(small), SmallPoller::Result::ERR);
+
+    poller.Init(buffer);
+    EXPECT_EQ(poller.Add(big), SmallPoller::Result::OK);
+    EXPECT_EQ(poller.Add(big), SmallPoller::Result::ERR);
+    EXPECT_EQ(poller.Add(small), SmallPoller::Result::OK);
+    EXPECT_EQ(poller.Add(small), SmallPoller::Result::ERR);
+    EXPECT_EQ(poller.GetNumSensors(), 2u);
+}
+
+TEST(util_SensorPoller, d_decodesDps310RegisterDump)
+{
+    SetTimeMs(0);
+    MockDevice device;
+    // product id, ready flags and calibration coefficients
+    device.LoadDump(DPS310_PRODREVID, {0x10});
+    device.LoadDump(DPS310_MEASCFG, {0xf0});
+    device.LoadDump(0x10, {0x0c, 0x0f, 0xf2, 0x13, 0x89, 0xc2, 0xbd, 0x93,
+                           0x0a, 0x3e, 0x05, 0x4b, 0xff, 0x1d, 0x00, 0x0b,
+                           0xfc, 0x70});
+    device.LoadDump(DPS310_TMPCOEFSRCE, {0x80});
+
+    Dps310<MockTransport>         dps310;
+    Dps310<MockTransport>::Config config;
+    config.transport_config.device = &device;
+    ASSERT_EQ(dps310.Init(config), Dps310<MockTransport>::OK);
+
+    // 64 measurements per second
+    EXPECT_EQ(dps310.GetPollWindow().period_ms, 15u);
+
+    SensorPoller<>            poller;
+    SensorPoller<>::DmaBuffer buffer;
+    poller.Init(buffer);
+    ASSERT_EQ(poller.Add(dps310), SensorPoller<>::Result::OK);
+
+    Dps310<MockTransport>::PolledData data;
+    EXPECT_FALSE(dps310.GetPolledData(data));
+
+    // pressure and temperature readings
+    device.LoadDump(DPS310_PRSB2, {0xf6, 0x4e, 0x2a, 0x05, 0x86, 0x1c});
+    poller.Process();
+    ASSERT_EQ(device.pending_.size(), 1u);
+    device.CompleteDma();
+
+    // the same as reading the registers with blocking transfers
+    dps310.Process();
+    ASSERT_TRUE(dps310.GetPolledData(data));
+    EXPECT_FLOAT_EQ(data.temperature, dps310.GetTemperature());
+    EXPECT_FLOAT_EQ(data.pressure, dps310.GetPressure());
+}
+
+TEST(util_SensorPoller, e_decodesMpr121RegisterDump)
+{
+    SetTimeMs(0);
+    MockDevice                    device;
+    Mpr121<MockTransport>         mpr121;
+    Mpr121<MockTransport>::Config config;
+    config.transport_config.device = &device;
+    mpr121.Init(config);
+
+    SensorPoller<>            poller;
+    SensorPoller<>::DmaBuffer buffer;
+    poller.Init(buffer);
+    ASSERT_EQ(poller.Add(mpr121), SensorPoller<>::Result::OK);
+
+    // touch status with the over current flag set, and filtered data
+    std::vector<uint8_t> dump = {0x21, 0x88, 0x00, 0x00};
+    for(uint16_t t = 0; t < 13; t++)
+    {
+        dump.push_back(uint8_t(100 + t * 50));
+        dump.push_back(uint8_t((100 + t * 50) >> 8));
+    }
+    device.LoadDump(0x00, dump);
+    poller.Process();
+    ASSERT_EQ(device.pending_.size(), 1u);
+    device.CompleteDma();
+
+    Mpr121<MockTransport>::PolledData data;
+    ASSERT_TRUE(mpr121.GetPolledData(data));
+    EXPECT_EQ(data.touched, 0x0821);
+    EXPECT_EQ(data.touched, mpr121.Touched());
+    for(uint8_t t = 0; t < 13; t++)
+    {
+        EXPECT_EQ(data.filtered[t], 100 + t * 50);
+        EXPECT_EQ(data.filtered[t], mpr121.FilteredData(t));
+    }
+}
@@ -0,0 +1,149 @@
+#include "util/SpscQueue.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace daisy;
+
+TEST(util_SpscQueue, a_stateAfterConstruction)
+{
+    SpscQueue<int, 8> queue;
+    EXPECT_TRUE(queue.IsEmpty());
+    EXPECT_FALSE(queue.IsFull());
+    EXPECT_EQ(queue.GetNumElements(), 0u);
+    EXPECT_EQ(queue.GetCapacity(), 8u);
+
+    int value = 42;
+    EXPECT_FALSE(queue.PopFront(value));
+    EXPECT_FALSE(queue.Peek(value));
+    EXPECT_EQ(value, 42);
+}
+
+TEST(util_SpscQueue, b_pushAndPop)
+{
+    SpscQueue<int, 4> queue;
+    EXPECT_TRUE(queue.PushBack(1));
+    EXPECT_TRUE(queue.PushBack(2));
+    EXPECT_TRUE(queue.PushBack(3));
+    EXPECT_TRUE(queue.PushBack(4));
+    EXPECT_TRUE(queue.IsFull());
+    EXPECT_FALSE(queue.PushBack(5));
+    EXPECT_EQ(queue.GetNumElements(), 4u);
+
+    int value;
+    EXPECT_TRUE(queue.Peek(value));
+    EXPECT_EQ(value, 1);
+    for(int i = 1; i <= 4; i++)
+    {
+        EXPECT_TRUE(queue.PopFront(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_TRUE(queue.IsEmpty());
+
+    // many times around the ring
+    for(int i = 0; i < 100; i++)
+    {
+        EXPECT_TRUE(queue.PushBack(i));
+        EXPECT_TRUE(queue.PushBack(-i));
+        EXPECT_TRUE(queue.PopFront(value));
+        EXPECT_EQ(value, i);
+        EXPECT_TRUE(queue.PopFront(value));
+        EXPECT_EQ(value, -i);
+    }
+
+    queue.PushBack(1);
+    queue.PushBack(2);
+    queue.Clear();
+    EXPECT_TRUE(queue.IsEmpty());
+    EXPECT_FALSE(queue.PopFront(value));
+}
+
+TEST(util_SpscQueue, c_batchPushAndPop)
+{
+    SpscQueue<int, 8> queue;
+    const int         in[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    int               out[10];
+
+    // move the positions so the batches wrap around
+    EXPECT_EQ(queue.PushBack(in, 5), 5u);
+    EXPECT_EQ(queue.PopFront(out, 3), 3u);
+    EXPECT_EQ(out[2], 2);
+
+    // only room for 6 more
+    EXPECT_EQ(queue.PushBack(in, 10), 6u);
+    EXPECT_TRUE(queue.IsFull());
+    EXPECT_EQ(queue.PushBack(in, 1), 0u);
+
+    EXPECT_EQ(queue.PopFront(out, 10), 8u);
+    const int expected[8] = {3, 4, 0, 1, 2, 3, 4, 5};
+    for(int i = 0; i < 8; i++)
+        EXPECT_EQ(out[i], expected[i]);
+    EXPECT_EQ(queue.PopFront(out, 10), 0u);
+}
+
+namespace
+{
+constexpr uint32_t kNumStressItems = 1000000;
+
+/** Pushes a sequence from one thread, pops and checks it from another.
+ *  Both sides yield when they can't make progress, so this doesn't take
+ *  forever on a single core machine.
+ */
+template <typename Queue>
+void RunStressTest(Queue& queue, size_t max_batch)
+{
+    std::thread producer([&queue, max_batch]() {
+        uint32_t next = 0;
+        uint32_t batch[16];
+        while(next < kNumStressItems)
+        {
+            size_t num = 1 + next % max_batch;
+            if(next + num > kNumStressItems)
+                num = kNumStressItems - next;
+            for(size_t i = 0; i < num; i++)
+                batch[i] = next + i;
+            const size_t pushed = max_batch == 1
+                                      ? (queue.PushBack(batch[0]) ? 1 : 0)
+                                      : queue.PushBack(batch, num);
+            if(pushed == 0)
+                std::this_thread::yield();
+            next += pushed;
+        }
+    });
+
+    uint32_t expected   = 0;
+    uint32_t num_errors = 0;
+    uint32_t batch[16];
+    while(expected < kNumStressItems)
+    {
+        size_t num;
+        if(max_batch == 1)
+            num = queue.PopFront(batch[0]) ? 1 : 0;
+        else
+            num = queue.PopFront(batch, 1 + expected % max_batch);
+        if(num == 0)
+            std::this_thread::yield();
+        for(size_t i = 0; i < num; i++)
+        {
+            if(batch[i] != expected)
+                num_errors++;
+            expected++;
+        }
+    }
+    producer.join();
+
+    EXPECT_EQ(num_errors, 0u);
+    EXPECT_TRUE(queue.IsEmpty());
+}
+} // namespace
+
+TEST(util_SpscQueue, d_twoThreadStress)
+{
+    static SpscQueue<uint32_t, 64> queue;
+    RunStressTest(queue, 1);
+}
+
+TEST(util_SpscQueue, e_twoThreadBatchStress)
+{
+    static SpscQueue<uint32_t, 64> queue;
+    RunStressTest(queue, 16);
+}
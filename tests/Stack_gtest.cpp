@@ -157,4 +157,22 @@ TEST_F(util_Stack, i_countEqualTo)
     EXPECT_EQ(stack_.CountEqualTo(1), 1u);
     EXPECT_EQ(stack_.CountEqualTo(2), 2u);
     EXPECT_EQ(stack_.CountEqualTo(3), 0u);
-}
\ No newline at end of file
+}
+
+TEST_F(util_Stack, j_constructFromList)
+{
+    struct Element
+    {
+        int value   = 0;
+        int another = 0;
+    };
+    Element element;
+    element.value   = 1;
+    element.another = 2;
+
+    // the elements keep their values, not the member defaults
+    Stack<Element, 3> stack({element, element});
+    ASSERT_EQ(stack.GetNumElements(), 2u);
+    EXPECT_EQ(stack[1].value, 1);
+    EXPECT_EQ(stack[1].another, 2);
+}
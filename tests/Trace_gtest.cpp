@@ -0,0 +1,117 @@
+#include "util/Trace.h"
+#include <gtest/gtest.h>
+#include <cstdarg>
+#include <string>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+using SmallTrace = Tracer<8>;
+
+/** Collects the lines printed by Tracer::Dump() */
+struct FakeLog
+{
+    static void PrintLine(const char* format, ...)
+    {
+        char    line[256];
+        va_list va;
+        va_start(va, format);
+        vsnprintf(line, sizeof(line), format, va);
+        va_end(va);
+        lines.push_back(line);
+        unflushed++;
+    }
+    static void Flush() { unflushed = 0; }
+
+    static std::vector<std::string> lines;
+    static int                      unflushed;
+};
+std::vector<std::string> FakeLog::lines;
+int                      FakeLog::unflushed = 0;
+} // namespace
+
+TEST(util_Trace, a_recordsEvents)
+{
+    System::SetTickForUnitTest(1000);
+    SmallTrace::Begin(TraceEvent::AUDIO_CALLBACK);
+    EXPECT_EQ(SmallTrace::GetNumRecords(), 0u);
+    EXPECT_FALSE(SmallTrace::IsRunning());
+
+    SmallTrace::Start();
+    SmallTrace::Begin(TraceEvent::SAI_DMA_HALF, 2);
+    System::SetTickForUnitTest(1010);
+    SmallTrace::Instant(TraceEvent::SPI_DMA_DONE, 5);
+    SmallTrace::Counter(TraceEvent::I2C_DMA_DONE, 0xbeef);
+    System::SetTickForUnitTest(1030);
+    SmallTrace::End(TraceEvent::SAI_DMA_HALF);
+
+    ASSERT_EQ(SmallTrace::GetNumRecords(), 4u);
+    EXPECT_EQ(SmallTrace::GetNumOverwritten(), 0u);
+    const auto& begin = SmallTrace::GetRecord(0);
+    EXPECT_EQ(begin.tick, 1000u);
+    EXPECT_EQ(begin.event, uint8_t(TraceEvent::SAI_DMA_HALF));
+    EXPECT_EQ(begin.phase, SmallTrace::Phase::BEGIN);
+    EXPECT_EQ(begin.value, 2);
+    EXPECT_EQ(SmallTrace::GetRecord(1).phase, SmallTrace::Phase::INSTANT);
+    EXPECT_EQ(SmallTrace::GetRecord(2).value, 0xbeef);
+    EXPECT_EQ(SmallTrace::GetRecord(3).tick, 1030u);
+    EXPECT_EQ(SmallTrace::GetRecord(3).phase, SmallTrace::Phase::END);
+
+    EXPECT_STREQ(SmallTrace::GetEventName(0), "AUDIO_CALLBACK");
+    EXPECT_STREQ(SmallTrace::GetEventName(uint8_t(TraceEvent::I2C_DMA_DONE)),
+                 "I2C_DMA_DONE");
+    EXPECT_STREQ(SmallTrace::GetEventName(200), "");
+    SmallTrace::Stop();
+}
+
+TEST(util_Trace, b_keepsTheNewestRecords)
+{
+    SmallTrace::Start();
+    for(uint32_t i = 0; i < 21; i++)
+    {
+        System::SetTickForUnitTest(i);
+        SmallTrace::Instant(TraceEvent::AUDIO_CALLBACK, i);
+    }
+    EXPECT_EQ(SmallTrace::GetNumRecords(), 8u);
+    EXPECT_EQ(SmallTrace::GetNumOverwritten(), 13u);
+    for(size_t i = 0; i < 8; i++)
+        EXPECT_EQ(SmallTrace::GetRecord(i).value, 13 + i);
+
+    // restarting empties the ring
+    SmallTrace::Start();
+    EXPECT_EQ(SmallTrace::GetNumRecords(), 0u);
+    SmallTrace::Stop();
+}
+
+TEST(util_Trace, c_dumpsText)
+{
+    System::SetTickFreqForUnitTest(200000000);
+    SmallTrace::Start();
+    for(uint32_t i = 0; i < 7; i++)
+    {
+        System::SetTickForUnitTest(0xfffffff0 + 4 * i);
+        SmallTrace::Begin(TraceEvent::SPI_DMA_DONE, 0x100 + i);
+    }
+
+    FakeLog::lines.clear();
+    SmallTrace::Dump<FakeLog>();
+    EXPECT_FALSE(SmallTrace::IsRunning());
+    EXPECT_EQ(FakeLog::unflushed, 0);
+
+    const size_t num_events = size_t(TraceEvent::NUM_EVENTS);
+    ASSERT_EQ(FakeLog::lines.size(), 1 + num_events + 2 + 1);
+    EXPECT_EQ(FakeLog::lines[0], "#trace start 200000000 7 0");
+    EXPECT_EQ(FakeLog::lines[1], "#trace event 0 AUDIO_CALLBACK");
+    EXPECT_EQ(FakeLog::lines[1 + num_events],
+              "#trace data fffffff003420100fffffff403420101fffffff803420102"
+              "fffffffc034201030000000003420104000000040342010"
+              "5");
+    EXPECT_EQ(FakeLog::lines[2 + num_events],
+              "#trace data 0000000803420106");
+    EXPECT_EQ(FakeLog::lines.back(), "#trace end");
+    const size_t max_size = SmallTrace::kDumpLineSize;
+    for(const auto& line : FakeLog::lines)
+        EXPECT_LT(line.size(), max_size);
+}
@@ -0,0 +1,232 @@
+#include <gtest/gtest.h>
+#include "ui/UI.h"
+#include "sys/system.h"
+
+using namespace daisy;
+
+namespace
+{
+/** Records what the UI did with a canvas */
+struct CanvasLog
+{
+    int       numClears  = 0;
+    int       numFlushes = 0;
+    Rectangle lastClearedArea;
+    Rectangle lastFlushedArea;
+};
+
+void ClearCanvas(const UiCanvasDescriptor& canvas)
+{
+    auto& log = *(CanvasLog*)(canvas.handle_);
+    log.numClears++;
+    log.lastClearedArea = canvas.damagedArea_;
+}
+
+void FlushCanvas(const UiCanvasDescriptor& canvas)
+{
+    auto& log = *(CanvasLog*)(canvas.handle_);
+    log.numFlushes++;
+    log.lastFlushedArea = canvas.damagedArea_;
+}
+
+UiCanvasDescriptor MakeCanvas(uint8_t id, CanvasLog& log)
+{
+    UiCanvasDescriptor canvas;
+    canvas.id_            = id;
+    canvas.handle_        = &log;
+    canvas.updateRateMs_  = 10;
+    canvas.clearFunction_ = &ClearCanvas;
+    canvas.flushFunction_ = &FlushCanvas;
+    return canvas;
+}
+
+class TestPage : public UiPage
+{
+  public:
+    explicit TestPage(bool tracksDamage) : tracksDamage_(tracksDamage) {}
+
+    void Draw(const UiCanvasDescriptor& canvas) override
+    {
+        numDraws_++;
+        lastDrawnArea_ = canvas.damagedArea_;
+    }
+    bool TracksDamage() const override { return tracksDamage_; }
+    void CheckForDamage() override { numChecks_++; }
+
+    bool      tracksDamage_;
+    int       numDraws_  = 0;
+    int       numChecks_ = 0;
+    Rectangle lastDrawnArea_;
+};
+
+class ui_UI : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        System::SetUsForUnitTest(0);
+        ui_.Init(queue_,
+                 UI::SpecialControlIds{},
+                 {MakeCanvas(0, log0_), MakeCanvas(1, log1_)});
+    }
+
+    /** Advances the time so that all canvases are due and processes the UI */
+    void ProcessNextUpdate()
+    {
+        System::Delay(11);
+        ui_.Process();
+    }
+
+    UiEventQueue queue_;
+    UI           ui_;
+    CanvasLog    log0_;
+    CanvasLog    log1_;
+};
+} // namespace
+
+TEST_F(ui_UI, a_redrawsPagesWithoutDamageTracking)
+{
+    TestPage page(false);
+    ui_.OpenPage(page);
+
+    // nothing happens before the canvases are due
+    System::Delay(10);
+    ui_.Process();
+    EXPECT_EQ(page.numDraws_, 0);
+
+    // the page is redrawn entirely with each update
+    for(int i = 1; i <= 3; i++)
+    {
+        ProcessNextUpdate();
+        EXPECT_EQ(page.numDraws_, 2 * i);
+        EXPECT_EQ(log0_.numClears, i);
+        EXPECT_EQ(log1_.numFlushes, i);
+        EXPECT_TRUE(page.lastDrawnArea_.IsEmpty());
+    }
+    EXPECT_EQ(page.numChecks_, 0);
+    ui_.ClosePage(page);
+}
+
+TEST_F(ui_UI, b_skipsCanvasesWithoutDamage)
+{
+    TestPage page(true);
+    ui_.OpenPage(page);
+
+    // opening the page invalidates everything
+    ProcessNextUpdate();
+    EXPECT_EQ(page.numDraws_, 2);
+    EXPECT_EQ(log0_.numFlushes, 1);
+    EXPECT_TRUE(log0_.lastFlushedArea.IsEmpty());
+
+    // nothing changed
+    ProcessNextUpdate();
+    ProcessNextUpdate();
+    EXPECT_EQ(page.numDraws_, 2);
+    EXPECT_EQ(log0_.numClears, 1);
+    EXPECT_EQ(log1_.numClears, 1);
+    // but the page was asked to look for changes
+    EXPECT_EQ(page.numChecks_, 6);
+
+    // only the damaged canvas is redrawn, with the united areas
+    page.Invalidate(1, Rectangle(10, 10, 5, 5));
+    page.Invalidate(1, Rectangle(20, 0, 10, 2));
+    ProcessNextUpdate();
+    EXPECT_EQ(page.numDraws_, 3);
+    EXPECT_EQ(log0_.numClears, 1);
+    EXPECT_EQ(log1_.numClears, 2);
+    EXPECT_EQ(log1_.lastClearedArea, Rectangle(10, 0, 20, 15));
+    EXPECT_EQ(page.lastDrawnArea_, Rectangle(10, 0, 20, 15));
+    EXPECT_EQ(log1_.lastFlushedArea, Rectangle(10, 0, 20, 15));
+
+    // an empty area damages the entire canvas
+    page.Invalidate(1, Rectangle(10, 10, 5, 5));
+    page.Invalidate(1, Rectangle());
+    page.Invalidate(1, Rectangle(10, 10, 5, 5));
+    ProcessNextUpdate();
+    EXPECT_EQ(log1_.numFlushes, 3);
+    EXPECT_TRUE(log1_.lastFlushedArea.IsEmpty());
+
+    // unknown canvases are ignored
+    page.Invalidate(2, Rectangle());
+    ProcessNextUpdate();
+    EXPECT_EQ(page.numDraws_, 4);
+    ui_.ClosePage(page);
+}
+
+TEST_F(ui_UI, c_keepsTheUpdateRate)
+{
+    TestPage page(true);
+    ui_.OpenPage(page);
+    ProcessNextUpdate();
+    EXPECT_EQ(page.numDraws_, 2);
+
+    page.Invalidate();
+    System::Delay(5);
+    ui_.Process();
+    EXPECT_EQ(page.numDraws_, 2);
+    System::Delay(6);
+    ui_.Process();
+    EXPECT_EQ(page.numDraws_, 4);
+    ui_.ClosePage(page);
+}
+
+TEST_F(ui_UI, d_pagesWithoutDamageTrackingForceRedraws)
+{
+    TestPage bottom(true);
+    TestPage top(false);
+    ui_.OpenPage(bottom);
+    ui_.OpenPage(top);
+    ProcessNextUpdate();
+    ProcessNextUpdate();
+    EXPECT_EQ(top.numDraws_, 4);
+    // the top page is opaque, the bottom one isn't visible
+    EXPECT_EQ(bottom.numDraws_, 0);
+    EXPECT_EQ(bottom.numChecks_, 0);
+
+    // closing the top page invalidates everything
+    ui_.ClosePage(top);
+    ProcessNextUpdate();
+    EXPECT_EQ(bottom.numDraws_, 2);
+    EXPECT_TRUE(bottom.lastDrawnArea_.IsEmpty());
+    ProcessNextUpdate();
+    EXPECT_EQ(bottom.numDraws_, 2);
+
+    // the canvas is cleared when the last page is closed
+    ui_.ClosePage(bottom);
+    ProcessNextUpdate();
+    EXPECT_EQ(log0_.numClears, 4);
+    ProcessNextUpdate();
+    EXPECT_EQ(log0_.numClears, 4);
+}
+
+TEST_F(ui_UI, e_screenSaver)
+{
+    CanvasLog log;
+    auto      canvas = MakeCanvas(0, log);
+
+    canvas.screenSaverTimeOut = 100;
+    ui_.Init(queue_, UI::SpecialControlIds{}, {canvas});
+
+    TestPage page(true);
+    ui_.OpenPage(page);
+    ProcessNextUpdate();
+    EXPECT_EQ(page.numDraws_, 1);
+
+    // the canvas is turned off once
+    System::Delay(100);
+    ui_.Process();
+    EXPECT_EQ(log.numClears, 2);
+    EXPECT_EQ(log.numFlushes, 2);
+    EXPECT_TRUE(log.lastFlushedArea.IsEmpty());
+    ProcessNextUpdate();
+    EXPECT_EQ(log.numClears, 2);
+
+    // and redrawn entirely when it's turned on again
+    queue_.AddButtonPressed(0, 1);
+    ProcessNextUpdate();
+    EXPECT_EQ(page.numDraws_, 2);
+    EXPECT_TRUE(page.lastDrawnArea_.IsEmpty());
+    ProcessNextUpdate();
+    EXPECT_EQ(page.numDraws_, 2);
+    ui_.ClosePage(page);
+}
@@ -0,0 +1,287 @@
+#include "hid/wavstreamer.h"
+#include <gtest/gtest.h>
+#include <vector>
+#include "WavTestFile.h"
+
+using namespace daisy;
+
+namespace
+{
+/** Renders frames and checks them against the test samples
+ *  \param start first frame number expected
+ *  \return false on the first mismatch
+ */
+bool RenderAndCheck(WavStreamVoice& voice,
+                    size_t          num_channels,
+                    size_t          frames,
+                    size_t          start,
+                    size_t          file_frames = 0)
+{
+    std::vector<std::vector<float>> buffers(num_channels,
+                                            std::vector<float>(frames));
+    std::vector<float*>             out;
+    for(auto& buffer : buffers)
+        out.push_back(buffer.data());
+    EXPECT_EQ(voice.Render(out.data(), num_channels, frames), frames);
+
+    const size_t file_channels = voice.GetFormat().num_channels;
+    for(size_t c = 0; c < num_channels; c++)
+        for(size_t i = 0; i < frames; i++)
+        {
+            const size_t frame = file_frames > 0 ? (start + i) % file_frames
+                                                 : start + i;
+            const float expected
+                = GetTestSample(frame, file_channels == 1 ? 0 : c);
+            if(buffers[c][i] != expected)
+            {
+                ADD_FAILURE() << "frame " << start + i << " channel " << c
+                              << ": " << buffers[c][i] << " != " << expected;
+                return false;
+            }
+        }
+    return true;
+}
+} // namespace
+
+TEST(dev_WavStreamer, a_readsHeaders)
+{
+    static uint8_t buffer[4096];
+    WavStreamVoice voice;
+    ASSERT_EQ(voice.Init(buffer, sizeof(buffer), 1024),
+              WavStreamVoice::Result::OK);
+
+    FakeFs::AddFile("s16.wav", MakeWav(WAVE_FORMAT_PCM, 16, 2, 10));
+    ASSERT_EQ(voice.Open("s16.wav"), WavStreamVoice::Result::OK);
+    EXPECT_EQ(voice.GetFormat().sample_format,
+              WavStreamVoice::SampleFormat::S16);
+    EXPECT_EQ(voice.GetFormat().num_channels, 2u);
+    EXPECT_EQ(voice.GetFormat().block_align, 4u);
+    EXPECT_EQ(voice.GetFormat().samplerate, 48000u);
+    EXPECT_EQ(voice.GetFormat().data_offset, 44u);
+    EXPECT_EQ(voice.GetFormat().data_size, 40u);
+    EXPECT_TRUE(voice.IsPlaying());
+    EXPECT_EQ(voice.GetBufferedFrames(), 10u);
+
+    // other chunks are skipped, with their padding
+    FakeFs::AddFile("s24.wav",
+                    MakeWav(WAVE_FORMAT_PCM, 24, 1, 10, true, true));
+    ASSERT_EQ(voice.Open("s24.wav", false), WavStreamVoice::Result::OK);
+    EXPECT_EQ(voice.GetFormat().sample_format,
+              WavStreamVoice::SampleFormat::S24);
+    EXPECT_EQ(voice.GetFormat().data_offset, 12u + 48u + 14u + 8u);
+    EXPECT_FALSE(voice.IsPlaying());
+
+    FakeFs::AddFile("f32.wav", MakeWav(WAVE_FORMAT_IEEE_FLOAT, 32, 8, 10));
+    ASSERT_EQ(voice.Open("f32.wav"), WavStreamVoice::Result::OK);
+    EXPECT_EQ(voice.GetFormat().sample_format,
+              WavStreamVoice::SampleFormat::F32);
+
+    // data size beyond the end of the file
+    auto truncated = MakeWav(WAVE_FORMAT_PCM, 32, 1, 10);
+    truncated.resize(truncated.size() - 6);
+    FakeFs::AddFile("truncated.wav", truncated);
+    ASSERT_EQ(voice.Open("truncated.wav"), WavStreamVoice::Result::OK);
+    EXPECT_EQ(voice.GetFormat().data_size, 32u);
+
+    FakeFs::AddFile("u8.wav", MakeWav(WAVE_FORMAT_PCM, 8, 1, 10));
+    EXPECT_EQ(voice.Open("u8.wav"), WavStreamVoice::Result::ERR_FORMAT);
+    EXPECT_FALSE(voice.IsOpen());
+    FakeFs::AddFile("junk.wav", std::vector<uint8_t>(100, 0x42));
+    EXPECT_EQ(voice.Open("junk.wav"), WavStreamVoice::Result::ERR_FORMAT);
+    EXPECT_EQ(voice.Open("missing.wav"), WavStreamVoice::Result::ERR_FILE);
+
+    uint8_t odd_buffer[1000];
+    EXPECT_EQ(voice.Init(odd_buffer, sizeof(odd_buffer)),
+              WavStreamVoice::Result::ERR_BUFFER);
+    EXPECT_EQ(voice.Init(buffer, sizeof(buffer), 4096),
+              WavStreamVoice::Result::ERR_BUFFER);
+}
+
+TEST(dev_WavStreamer, b_decodesAllFormats)
+{
+    static uint8_t buffer[8192];
+    WavStreamVoice voice;
+    voice.Init(buffer, sizeof(buffer), 1024);
+
+    const struct
+    {
+        uint16_t code;
+        uint16_t bits;
+        uint16_t channels;
+        bool     extensible;
+    } formats[] = {
+        {WAVE_FORMAT_PCM, 16, 1, false},
+        {WAVE_FORMAT_PCM, 16, 2, false},
+        {WAVE_FORMAT_PCM, 24, 2, true},
+        {WAVE_FORMAT_PCM, 32, 3, false},
+        {WAVE_FORMAT_IEEE_FLOAT, 32, 4, true},
+    };
+    for(const auto& format : formats)
+    {
+        FakeFs::AddFile("test.wav",
+                        MakeWav(format.code,
+                                format.bits,
+                                format.channels,
+                                100,
+                                format.extensible));
+        ASSERT_EQ(voice.Open("test.wav"), WavStreamVoice::Result::OK);
+        // mono goes to both outputs, channels beyond the output are skipped
+        EXPECT_TRUE(RenderAndCheck(voice, 2, 48, 0)) << format.bits;
+        EXPECT_TRUE(RenderAndCheck(voice, 2, 52, 48)) << format.bits;
+        EXPECT_EQ(voice.GetStarvationCount(), 0u);
+    }
+}
+
+TEST(dev_WavStreamer, c_readsAreAligned)
+{
+    static uint8_t buffer[4096];
+    WavStreamVoice voice;
+    voice.Init(buffer, sizeof(buffer), 1024);
+    FakeFs::AddFile("test.wav", MakeWav(WAVE_FORMAT_PCM, 16, 2, 10000));
+    ASSERT_EQ(voice.Open("test.wav"), WavStreamVoice::Result::OK);
+
+    // 3 + 1 reads: up to the first boundary, then full ones
+    auto& reads = FakeFs::GetReads();
+    const size_t header_reads = reads.size() - 4;
+    EXPECT_EQ(reads[header_reads].offset, 44u);
+    EXPECT_EQ(reads[header_reads].size, 1024u - 44u);
+    for(size_t i = header_reads + 1; i < reads.size(); i++)
+    {
+        EXPECT_EQ(reads[i].offset % 1024, 0u);
+        EXPECT_EQ(reads[i].size, 1024u);
+    }
+    EXPECT_EQ(voice.GetFreeSpace(), 44u);
+
+    // nothing is read until there's room for a whole read
+    EXPECT_EQ(voice.Prepare(), 0u);
+    EXPECT_TRUE(RenderAndCheck(voice, 2, 200, 0));
+    EXPECT_EQ(voice.Prepare(), 0u);
+    EXPECT_TRUE(RenderAndCheck(voice, 2, 100, 200));
+    EXPECT_EQ(voice.Prepare(), 1024u);
+}
+
+TEST(dev_WavStreamer, d_framesAcrossTheBufferEnd)
+{
+    // 6 byte frames don't fit evenly into the buffer
+    static uint8_t buffer[2048];
+    WavStreamVoice voice;
+    voice.Init(buffer, sizeof(buffer), 512);
+    const size_t frames = 5000;
+    FakeFs::AddFile("test.wav", MakeWav(WAVE_FORMAT_PCM, 24, 2, frames));
+    ASSERT_EQ(voice.Open("test.wav"), WavStreamVoice::Result::OK);
+
+    size_t pos = 0;
+    while(pos + 37 <= frames)
+    {
+        ASSERT_TRUE(RenderAndCheck(voice, 2, 37, pos));
+        pos += 37;
+        while(voice.Prepare() > 0) {}
+    }
+    EXPECT_EQ(voice.GetStarvationCount(), 0u);
+
+    // the end of the file stops the voice, without starving
+    float  left[64], right[64];
+    float* out[2] = {left, right};
+    EXPECT_EQ(voice.Render(out, 2, 64), frames - pos);
+    EXPECT_FALSE(voice.IsPlaying());
+    EXPECT_EQ(voice.GetStarvationCount(), 0u);
+    EXPECT_EQ(voice.Render(out, 2, 64), 0u);
+}
+
+TEST(dev_WavStreamer, e_starvation)
+{
+    static uint8_t buffer[2048];
+    WavStreamVoice voice;
+    voice.Init(buffer, sizeof(buffer), 512);
+    FakeFs::AddFile("test.wav", MakeWav(WAVE_FORMAT_PCM, 16, 1, 5000));
+    ASSERT_EQ(voice.Open("test.wav"), WavStreamVoice::Result::OK);
+
+    // no Prepare() in between, 1002 frames fit up to the next aligned read
+    float  mono[600] = {};
+    float* out[1]    = {mono};
+    EXPECT_EQ(voice.Render(out, 1, 600), 600u);
+    EXPECT_EQ(voice.Render(out, 1, 600), 402u);
+    EXPECT_EQ(voice.GetStarvationCount(), 1u);
+    EXPECT_TRUE(voice.IsPlaying());
+
+    // catches up where it left off
+    while(voice.Prepare() > 0) {}
+    EXPECT_TRUE(RenderAndCheck(voice, 1, 600, 1002));
+    voice.ResetStarvationCount();
+    EXPECT_EQ(voice.GetStarvationCount(), 0u);
+
+    // read errors end the file early, but don't count as starvation
+    FakeFs::SetDiskError(true);
+    EXPECT_EQ(voice.Prepare(), 0u);
+    while(voice.Render(out, 1, 600) > 0) {}
+    EXPECT_FALSE(voice.IsPlaying());
+    EXPECT_EQ(voice.GetStarvationCount(), 0u);
+}
+
+TEST(dev_WavStreamer, f_loopingAndRestart)
+{
+    static uint8_t buffer[4096];
+    WavStreamVoice voice;
+    voice.Init(buffer, sizeof(buffer), 512);
+    const size_t frames = 300;
+    FakeFs::AddFile("test.wav",
+                    MakeWav(WAVE_FORMAT_PCM, 24, 1, frames, false, true));
+    voice.SetLooping(true);
+    ASSERT_EQ(voice.Open("test.wav"), WavStreamVoice::Result::OK);
+
+    // seamless across the loop point
+    for(size_t pos = 0; pos < 10 * frames; pos += 64)
+    {
+        ASSERT_TRUE(RenderAndCheck(voice, 1, 64, pos, frames));
+        while(voice.Prepare() > 0) {}
+    }
+    EXPECT_EQ(voice.GetStarvationCount(), 0u);
+
+    ASSERT_EQ(voice.Restart(), WavStreamVoice::Result::OK);
+    EXPECT_TRUE(voice.IsPlaying());
+    EXPECT_TRUE(RenderAndCheck(voice, 1, 64, 0, frames));
+
+    voice.Stop();
+    ASSERT_EQ(voice.Restart(), WavStreamVoice::Result::OK);
+    EXPECT_FALSE(voice.IsPlaying());
+    voice.Play();
+    EXPECT_TRUE(RenderAndCheck(voice, 1, 64, 0, frames));
+}
+
+TEST(dev_WavStreamer, g_streamerMixesVoices)
+{
+    static uint8_t  buffer[3 * 4096 + 100];
+    WavStreamer<3> streamer;
+    ASSERT_EQ(streamer.Init(buffer, sizeof(buffer), 1024),
+              WavStreamVoice::Result::OK);
+    FakeFs::AddFile("a.wav", MakeWav(WAVE_FORMAT_PCM, 16, 2, 20000));
+    FakeFs::AddFile("b.wav", MakeWav(WAVE_FORMAT_IEEE_FLOAT, 32, 1, 20000));
+    ASSERT_EQ(streamer.GetVoice(0).Open("a.wav"), WavStreamVoice::Result::OK);
+    ASSERT_EQ(streamer.GetVoice(2).Open("b.wav"), WavStreamVoice::Result::OK);
+
+    float  left[128], right[128];
+    float* out[2] = {left, right};
+    for(size_t pos = 0; pos < 10000; pos += 128)
+    {
+        streamer.Render(out, 2, 128);
+        for(size_t i = 0; i < 128; i++)
+        {
+            ASSERT_EQ(left[i],
+                      GetTestSample(pos + i, 0) + GetTestSample(pos + i, 0));
+            ASSERT_EQ(right[i],
+                      GetTestSample(pos + i, 1) + GetTestSample(pos + i, 0));
+        }
+        while(streamer.Prepare()) {}
+    }
+    EXPECT_EQ(streamer.GetStarvationCount(), 0u);
+
+    // the voice with the most room is read first
+    streamer.Render(out, 2, 128);
+    streamer.GetVoice(2).Render(out, 2, 128);
+    const size_t free_0 = streamer.GetVoice(0).GetFreeSpace();
+    const size_t free_2 = streamer.GetVoice(2).GetFreeSpace();
+    ASSERT_GT(free_2, free_0);
+    EXPECT_TRUE(streamer.Prepare());
+    EXPECT_EQ(streamer.GetVoice(0).GetFreeSpace(), free_0);
+    EXPECT_EQ(streamer.GetVoice(2).GetFreeSpace(), free_2 - 1024u);
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "util/wav_format.h"
+#include <string.h>
+#include <vector>
+
+/** Helpers for building .wav files for the fake file system in ff.h */
+
+inline void PutU16(std::vector<uint8_t>& data, uint32_t value)
+{
+    data.push_back(value & 0xff);
+    data.push_back((value >> 8) & 0xff);
+}
+
+inline void PutU32(std::vector<uint8_t>& data, uint32_t value)
+{
+    PutU16(data, value & 0xffff);
+    PutU16(data, value >> 16);
+}
+
+/** Returns a test sample in [-1, 1) that's exact in all formats */
+inline float GetTestSample(size_t frame, size_t channel)
+{
+    const int32_t value = int32_t((frame * 37 + channel * 1001) % 65536);
+    return float(value - 32768) / 32768.0f;
+}
+
+/** Builds a .wav file with the test samples.
+ *  \param extra_chunk adds a LIST chunk with an odd size before the data
+ *  \param first_channel the test samples of the first channel in the file
+ */
+inline std::vector<uint8_t> MakeWav(uint16_t code,
+                                    uint16_t bits,
+                                    uint16_t channels,
+                                    size_t   frames,
+                                    bool     extensible    = false,
+                                    bool     extra_chunk   = false,
+                                    size_t   first_channel = 0)
+{
+    const uint32_t       block_align = channels * bits / 8;
+    std::vector<uint8_t> data;
+    PutU32(data, daisy::kWavFileChunkId);
+    PutU32(data, 0); // not checked
+    PutU32(data, daisy::kWavFileWaveId);
+
+    PutU32(data, daisy::kWavFileSubChunk1Id);
+    PutU32(data, extensible ? 40 : 16);
+    PutU16(data, extensible ? uint16_t(daisy::WAVE_FORMAT_EXTENSIBLE) : code);
+    PutU16(data, channels);
+    PutU32(data, 48000);
+    PutU32(data, 48000 * block_align);
+    PutU16(data, block_align);
+    PutU16(data, bits);
+    if(extensible)
+    {
+        PutU16(data, 22);
+        PutU16(data, bits);
+        PutU32(data, 0); // channel mask
+        PutU16(data, code);
+        for(int i = 0; i < 14; i++)
+            data.push_back(0);
+    }
+
+    if(extra_chunk)
+    {
+        PutU32(data, 0x5453494c); // "LIST"
+        PutU32(data, 5);
+        for(int i = 0; i < 6; i++)
+            data.push_back('x');
+    }
+
+    PutU32(data, daisy::kWavFileSubChunk2Id);
+    PutU32(data, frames * block_align);
+    for(size_t i = 0; i < frames; i++)
+        for(size_t c = 0; c < channels; c++)
+        {
+            const float sample = GetTestSample(i, first_channel + c);
+            if(code == daisy::WAVE_FORMAT_IEEE_FLOAT)
+            {
+                uint32_t bits_of_float;
+                memcpy(&bits_of_float, &sample, sizeof(sample));
+                PutU32(data, bits_of_float);
+            }
+            else
+            {
+                const int32_t value = int32_t(sample * 2147483648.0f);
+                for(int b = 4 - bits / 8; b < 4; b++)
+                    data.push_back((value >> (8 * b)) & 0xff);
+            }
+        }
+    return data;
+}
@@ -0,0 +1,262 @@
+#include "util/WavWriter.h"
+#include "util/WavParser.h"
+#include <gtest/gtest.h>
+#include <vector>
+
+using namespace daisy;
+
+namespace
+{
+float GetTestSample(size_t frame, size_t channel)
+{
+    return float(int((frame * 7 + channel * 50) % 201) - 100) / 90.0f;
+}
+
+/** Records frames with SampleBlock(), calling Write() after each block */
+template <typename Writer>
+void Record(Writer& writer, size_t channels, size_t start, size_t frames)
+{
+    const size_t                    block = 48;
+    std::vector<std::vector<float>> buffers(channels,
+                                            std::vector<float>(block));
+    std::vector<const float*>       in;
+    for(auto& buffer : buffers)
+        in.push_back(buffer.data());
+    for(size_t pos = start; pos < start + frames; pos += block)
+    {
+        const size_t num = std::min(block, start + frames - pos);
+        for(size_t c = 0; c < channels; c++)
+            for(size_t i = 0; i < num; i++)
+                buffers[c][i] = GetTestSample(pos + i, c);
+        writer.SampleBlock(in.data(), num);
+        writer.Write();
+    }
+}
+
+uint32_t GetU32(const std::vector<uint8_t>& file, size_t pos)
+{
+    uint32_t x;
+    memcpy(&x, file.data() + pos, sizeof(x));
+    return x;
+}
+
+/** Returns the sample as written for a format */
+int32_t GetExpected(float x, int32_t bits, bool floatingpoint)
+{
+    if(floatingpoint)
+    {
+        int32_t result;
+        memcpy(&result, &x, sizeof(x));
+        return result;
+    }
+    return bits == 16 ? f2s16(x) : bits == 24 ? f2s24(x) : f2s32(x);
+}
+
+/** Checks the header and the data of a recorded file */
+template <typename Config>
+void ExpectFileMatches(const char* path, const Config& cfg, size_t frames)
+{
+    const auto* file = FakeFs::GetFile(path);
+    ASSERT_NE(file, nullptr);
+    const size_t bytes       = cfg.bitspersample / 8;
+    const size_t block_align = cfg.channels * bytes;
+    // float files have the extended fmt chunk and a fact chunk
+    const size_t header_size = cfg.floatingpoint ? 58 : 44;
+    ASSERT_EQ(file->size(), header_size + frames * block_align);
+    EXPECT_EQ(GetU32(*file, 4), header_size - 8 + frames * block_align);
+    EXPECT_EQ(GetU32(*file, 16), cfg.floatingpoint ? 18u : 16u);
+    EXPECT_EQ(GetU32(*file, 20) & 0xffff,
+              cfg.floatingpoint ? 3u : 1u); // audio format
+    EXPECT_EQ(GetU32(*file, 32), block_align | (cfg.bitspersample << 16));
+    if(cfg.floatingpoint)
+    {
+        EXPECT_EQ(GetU32(*file, 36) & 0xffff, 0u); // no extension
+        EXPECT_EQ(GetU32(*file, 38), kWavFileFactId);
+        EXPECT_EQ(GetU32(*file, 42), 4u);
+        EXPECT_EQ(GetU32(*file, 46), frames);
+    }
+    EXPECT_EQ(GetU32(*file, header_size - 8), kWavFileSubChunk2Id);
+    EXPECT_EQ(GetU32(*file, header_size - 4), frames * block_align);
+
+    // the file can be played back
+    FIL               fil;
+    WavParser::Format format;
+    ASSERT_EQ(f_open(&fil, path, FA_READ), FR_OK);
+    EXPECT_TRUE(WavParser::ReadHeader(&fil, format, 16));
+    f_close(&fil);
+    EXPECT_EQ(format.data_offset, header_size);
+    EXPECT_EQ(format.data_size, frames * block_align);
+    EXPECT_EQ(format.num_channels, cfg.channels);
+    EXPECT_EQ(format.sample_format == WavParser::SampleFormat::F32,
+              cfg.floatingpoint);
+
+    const uint8_t* data = file->data() + header_size;
+    for(size_t i = 0; i < frames; i++)
+        for(int32_t c = 0; c < cfg.channels; c++)
+        {
+            int32_t x = 0;
+            memcpy(&x, data, bytes);
+            // sign extend
+            x = int32_t(uint32_t(x) << (32 - 8 * bytes)) >> (32 - 8 * bytes);
+            data += bytes;
+            const int32_t expected
+                = GetExpected(GetTestSample(i, c),
+                              cfg.bitspersample,
+                              cfg.floatingpoint);
+            ASSERT_EQ(x, expected) << "frame " << i << " channel " << c;
+        }
+}
+} // namespace
+
+TEST(util_WavWriter, a_writesAllFormats)
+{
+    const WavWriter<1024>::Config configs[] = {
+        {48000, 2, 16},
+        {48000, 2, 24},
+        {48000, 1, 32},
+        {48000, 2, 32, true},
+        // no conversion kernel for 3 channels
+        {48000, 3, 16},
+        {48000, 3, 24},
+    };
+    for(const auto& cfg : configs)
+    {
+        static WavWriter<1024> writer;
+        ASSERT_EQ(writer.Init(cfg), WavWriter<1024>::Result::OK);
+        ASSERT_EQ(writer.OpenFile("test.wav"), WavWriter<1024>::Result::OK);
+        EXPECT_TRUE(writer.IsRecording());
+        // the last chunk isn't full
+        Record(writer, cfg.channels, 0, 1000);
+        EXPECT_EQ(writer.GetLengthSamps(), 1000u);
+        ASSERT_EQ(writer.SaveFile(), WavWriter<1024>::Result::OK);
+        EXPECT_FALSE(writer.IsRecording());
+        EXPECT_EQ(writer.GetDroppedChunks(), 0u);
+        ExpectFileMatches("test.wav", cfg, 1000);
+        if(HasFailure())
+            return;
+    }
+}
+
+TEST(util_WavWriter, b_unalignedChunks)
+{
+    // the second chunk starts at an odd address
+    using Writer                   = WavWriter<1022>;
+    const Writer::Config configs[] = {
+        {48000, 2, 32},
+        {48000, 2, 32, true},
+    };
+    for(const auto& cfg : configs)
+    {
+        static Writer writer;
+        ASSERT_EQ(writer.Init(cfg), Writer::Result::OK);
+        ASSERT_EQ(writer.OpenFile("test.wav"), Writer::Result::OK);
+        Record(writer, cfg.channels, 0, 1000);
+        ASSERT_EQ(writer.SaveFile(), Writer::Result::OK);
+        EXPECT_EQ(writer.GetDroppedChunks(), 0u);
+        ExpectFileMatches("test.wav", cfg, 1000);
+    }
+}
+
+TEST(util_WavWriter, c_singleFrames)
+{
+    static WavWriter<1024>        writer;
+    const WavWriter<1024>::Config cfg = {48000, 2, 24};
+    writer.Init(cfg);
+    ASSERT_EQ(writer.OpenFile("test.wav"), WavWriter<1024>::Result::OK);
+    for(size_t i = 0; i < 500; i++)
+    {
+        const float frame[2] = {GetTestSample(i, 0), GetTestSample(i, 1)};
+        writer.Sample(frame);
+        writer.Write();
+    }
+    ASSERT_EQ(writer.SaveFile(), WavWriter<1024>::Result::OK);
+    ExpectFileMatches("test.wav", cfg, 500);
+
+    // nothing is recorded after saving
+    writer.Sample(std::vector<float>(2).data());
+    EXPECT_EQ(writer.GetLengthSamps(), 500u);
+    EXPECT_EQ(writer.SaveFile(), WavWriter<1024>::Result::ERROR);
+}
+
+TEST(util_WavWriter, d_dropsChunksWhenTheCardStalls)
+{
+    // 170 frames per chunk, 2 of them can wait
+    using Writer = WavWriter<1024, 3>;
+    static Writer        writer;
+    const Writer::Config cfg = {48000, 2, 24};
+    writer.Init(cfg);
+    ASSERT_EQ(writer.OpenFile("test.wav"), Writer::Result::OK);
+
+    std::vector<float> left(170 * 5), right(170 * 5);
+    for(size_t i = 0; i < left.size(); i++)
+    {
+        left[i]  = GetTestSample(i, 0);
+        right[i] = GetTestSample(i, 1);
+    }
+    const float* in[2] = {left.data(), right.data()};
+    writer.SampleBlock(in, left.size());
+    EXPECT_EQ(writer.GetDroppedChunks(), 3u);
+    EXPECT_EQ(writer.GetLengthSamps(), 2u * 170u);
+
+    // the file goes on after the last chunk that was kept
+    writer.Write();
+    const float* rest[2] = {left.data() + 2 * 170, right.data() + 2 * 170};
+    writer.SampleBlock(rest, 100);
+    ASSERT_EQ(writer.SaveFile(), Writer::Result::OK);
+    EXPECT_EQ(writer.GetLengthSamps(), 2u * 170u + 100u);
+    ExpectFileMatches("test.wav", cfg, 2 * 170 + 100);
+}
+
+TEST(util_WavWriter, e_writeErrors)
+{
+    static WavWriter<1024>        writer;
+    const WavWriter<1024>::Config cfg = {48000, 1, 16};
+    writer.Init(cfg);
+    ASSERT_EQ(writer.OpenFile("test.wav"), WavWriter<1024>::Result::OK);
+    EXPECT_EQ(writer.OpenFile("other.wav"), WavWriter<1024>::Result::ERROR);
+
+    Record(writer, 1, 0, 512);
+    FakeFs::SetDiskError(true);
+    Record(writer, 1, 512, 600);
+    EXPECT_EQ(writer.GetDroppedChunks(), 1u);
+    EXPECT_EQ(writer.SaveFile(), WavWriter<1024>::Result::ERROR);
+    EXPECT_EQ(writer.GetDroppedChunks(), 2u);
+}
+
+TEST(util_WavWriter, f_rejectsUnsupportedConfigs)
+{
+    using Writer = WavWriter<1024>;
+    static Writer        writer;
+    const Writer::Config configs[] = {
+        {48000, 0, 16},
+        {48000, -1, 16},
+        {48000, Writer::kMaxChannels + 1, 16},
+        {48000, 2, 8},
+        {48000, 2, 0},
+        {48000, 2, 20},
+    };
+    for(const auto& cfg : configs)
+    {
+        EXPECT_EQ(writer.Init(cfg), Writer::Result::ERROR)
+            << cfg.channels << " channels, " << cfg.bitspersample << " bits";
+        EXPECT_EQ(writer.OpenFile("test.wav"), Writer::Result::ERROR);
+        EXPECT_FALSE(writer.IsRecording());
+    }
+
+    // bitspersample doesn't matter for floats
+    const Writer::Config float_cfg = {48000, Writer::kMaxChannels, 8, true};
+    ASSERT_EQ(writer.Init(float_cfg), Writer::Result::OK);
+    ASSERT_EQ(writer.OpenFile("test.wav"), Writer::Result::OK);
+    Record(writer, Writer::kMaxChannels, 0, 10);
+
+    // not while recording
+    EXPECT_EQ(writer.Init({48000, 1, 16}), Writer::Result::ERROR);
+    ASSERT_EQ(writer.SaveFile(), Writer::Result::OK);
+    ExpectFileMatches("test.wav", Writer::Config{48000, 16, 32, true}, 10);
+
+    // a frame has to fit a chunk
+    static WavWriter<32> small_writer;
+    EXPECT_EQ(small_writer.Init({48000, 16, 16}), WavWriter<32>::Result::OK);
+    EXPECT_EQ(small_writer.Init({48000, 16, 24}),
+              WavWriter<32>::Result::ERROR);
+}
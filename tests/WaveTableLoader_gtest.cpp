@@ -0,0 +1,209 @@
+#include "util/WaveTableLoader.h"
+#include <gtest/gtest.h>
+#include <vector>
+#include "WavTestFile.h"
+
+using namespace daisy;
+
+namespace
+{
+/** Builds a mono .wav file of test samples, with a LIST chunk before the
+ *  data */
+std::vector<uint8_t>
+MakeMonoWav(uint16_t code, uint16_t bits, size_t samples, size_t seed = 0)
+{
+    return MakeWav(code, bits, 1, samples, false, true, seed);
+}
+
+/** Checks that the memory holds the test samples
+ *  \return false on the first mismatch
+ */
+bool ExpectSamples(const float* mem, size_t samples, size_t seed = 0)
+{
+    for(size_t i = 0; i < samples; i++)
+        if(mem[i] != GetTestSample(i, seed))
+        {
+            ADD_FAILURE() << "sample " << i << ": " << mem[i]
+                          << " != " << GetTestSample(i, seed);
+            return false;
+        }
+    return true;
+}
+} // namespace
+
+TEST(util_WaveTableLoader, a_loadsAllFormats)
+{
+    const struct
+    {
+        uint16_t                code;
+        uint16_t                bits;
+        WavParser::SampleFormat format;
+    } formats[] = {
+        {WAVE_FORMAT_PCM, 16, WavParser::SampleFormat::S16},
+        {WAVE_FORMAT_PCM, 24, WavParser::SampleFormat::S24},
+        {WAVE_FORMAT_PCM, 32, WavParser::SampleFormat::S32},
+        {WAVE_FORMAT_IEEE_FLOAT, 32, WavParser::SampleFormat::F32},
+    };
+    for(const auto& format : formats)
+    {
+        // more than one workspace of data
+        static float    mem[4096];
+        WaveTableLoader loader;
+        loader.Init(mem, 4096);
+        ASSERT_EQ(loader.SetWaveTableInfo(256, 16),
+                  WaveTableLoader::Result::OK);
+        FakeFs::AddFile("bank.wav",
+                        MakeMonoWav(format.code, format.bits, 3000));
+
+        size_t tables = 0;
+        ASSERT_EQ(loader.Import("bank.wav", 0, &tables),
+                  WaveTableLoader::Result::OK);
+        EXPECT_EQ(tables, 12u);
+        EXPECT_EQ(loader.GetFormat().sample_format, format.format);
+        EXPECT_TRUE(ExpectSamples(mem, 3000)) << format.bits;
+        // the rest of the last table is cleared
+        EXPECT_EQ(mem[3000], 0.0f);
+        EXPECT_EQ(mem[3071], 0.0f);
+        EXPECT_EQ(loader.GetTable(1), mem + 256);
+        EXPECT_EQ(loader.GetTable(16), nullptr);
+
+        // whole samples per read, only as much as there is
+        for(const auto& read : FakeFs::GetReads())
+        {
+            if(read.offset < loader.GetFormat().data_offset)
+                continue;
+            EXPECT_LE(read.size, 4096u);
+            EXPECT_EQ(read.size % (format.bits / 8), 0u);
+        }
+        FakeFs::GetReads().clear();
+    }
+}
+
+TEST(util_WaveTableLoader, b_staysInTheMemory)
+{
+    float           mem[1024 + 16];
+    WaveTableLoader loader;
+    for(auto& sample : mem)
+        sample = 42.0f;
+    loader.Init(mem, 1024);
+    loader.SetWaveTableInfo(256, 4);
+    FakeFs::AddFile("bank.wav", MakeMonoWav(WAVE_FORMAT_PCM, 16, 1500));
+
+    EXPECT_EQ(loader.Import("bank.wav"),
+              WaveTableLoader::Result::ERR_TABLE_INFO_OVERFLOW);
+    EXPECT_TRUE(ExpectSamples(mem, 1024));
+    for(size_t i = 1024; i < 1024 + 16; i++)
+        EXPECT_EQ(mem[i], 42.0f);
+
+    // starting at a later table
+    size_t tables = 0;
+    FakeFs::AddFile("short.wav", MakeMonoWav(WAVE_FORMAT_PCM, 24, 300, 1));
+    EXPECT_EQ(loader.Import("short.wav", 2, &tables),
+              WaveTableLoader::Result::OK);
+    EXPECT_EQ(tables, 2u);
+    EXPECT_TRUE(ExpectSamples(mem + 512, 300, 1));
+    EXPECT_EQ(mem[812], 0.0f);
+    EXPECT_EQ(mem[1023], 0.0f);
+    EXPECT_EQ(mem[1024], 42.0f);
+    EXPECT_EQ(loader.Import("short.wav", 4, &tables),
+              WaveTableLoader::Result::ERR_TABLE_INFO_OVERFLOW);
+    EXPECT_EQ(tables, 0u);
+}
+
+TEST(util_WaveTableLoader, c_errors)
+{
+    static float    mem[1024];
+    WaveTableLoader loader;
+    loader.Init(mem, 1024);
+    EXPECT_EQ(loader.Import("missing.wav"),
+              WaveTableLoader::Result::ERR_FILE_READ);
+    FakeFs::AddFile("u8.wav", MakeMonoWav(WAVE_FORMAT_PCM, 8, 100));
+    EXPECT_EQ(loader.Import("u8.wav"), WaveTableLoader::Result::ERR_FORMAT);
+    FakeFs::AddFile("junk.wav", std::vector<uint8_t>(100, 0));
+    EXPECT_EQ(loader.Import("junk.wav"), WaveTableLoader::Result::ERR_FORMAT);
+
+    // a data chunk that's longer than the file, e.g. from a recording that
+    // wasn't finished, loads what's there
+    auto truncated = MakeMonoWav(WAVE_FORMAT_PCM, 16, 400);
+    truncated.resize(truncated.size() - 201);
+    FakeFs::AddFile("truncated.wav", truncated);
+    EXPECT_EQ(loader.Import("truncated.wav"), WaveTableLoader::Result::OK);
+    EXPECT_TRUE(ExpectSamples(mem, 299));
+    EXPECT_EQ(mem[299], 0.0f);
+
+    FakeFs::AddFile("ok.wav", MakeMonoWav(WAVE_FORMAT_PCM, 16, 4000));
+    FakeFs::SetDiskError(true);
+    EXPECT_EQ(loader.Import("ok.wav"), WaveTableLoader::Result::ERR_FORMAT);
+}
+
+TEST(util_WaveTableLoader, d_importsDirectories)
+{
+    static float    mem[1024];
+    WaveTableLoader loader;
+    loader.Init(mem, 1024);
+    loader.SetWaveTableInfo(256, 4);
+    FakeFs::AddFile("tables/b.wav", MakeMonoWav(WAVE_FORMAT_PCM, 16, 300, 2));
+    FakeFs::AddFile("tables/a.WAV",
+                    MakeMonoWav(WAVE_FORMAT_IEEE_FLOAT, 32, 256));
+    FakeFs::AddFile("tables/c.wav", MakeMonoWav(WAVE_FORMAT_PCM, 24, 10, 3));
+    FakeFs::AddFile("tables/notes.txt", {'h', 'i'});
+    FakeFs::AddFile("tables/sub/d.wav", MakeMonoWav(WAVE_FORMAT_PCM, 16, 256));
+    FakeFs::AddFile("other.wav", MakeMonoWav(WAVE_FORMAT_PCM, 16, 256));
+
+    // in alphabetical order, each file starts a new table
+    size_t tables = 0;
+    EXPECT_EQ(loader.ImportDirectory("tables", 0, &tables),
+              WaveTableLoader::Result::OK);
+    EXPECT_EQ(tables, 4u);
+    EXPECT_TRUE(ExpectSamples(loader.GetTable(0), 256));
+    EXPECT_TRUE(ExpectSamples(loader.GetTable(1), 300, 2));
+    EXPECT_EQ(loader.GetTable(2)[44], 0.0f);
+    EXPECT_TRUE(ExpectSamples(loader.GetTable(3), 10, 3));
+
+    // not enough room
+    EXPECT_EQ(loader.ImportDirectory("tables", 1, &tables),
+              WaveTableLoader::Result::ERR_TABLE_INFO_OVERFLOW);
+    EXPECT_EQ(tables, 3u);
+
+    EXPECT_EQ(loader.ImportDirectory("missing"),
+              WaveTableLoader::Result::ERR_FILE_READ);
+}
+
+TEST(util_WaveTableLoader, e_readsTheDirectoryOncePerBatch)
+{
+    static float    mem[100 * 16];
+    WaveTableLoader loader;
+    loader.Init(mem, 100 * 16);
+    loader.SetWaveTableInfo(16, 100);
+
+    // a small directory is read once, plus the end of the listing
+    for(size_t i = 0; i < 10; i++)
+        FakeFs::AddFile("small/" + std::to_string(i) + ".wav",
+                        MakeMonoWav(WAVE_FORMAT_PCM, 16, 16, i));
+    FakeFs::AddFile("small/readme.txt", {'h', 'i'});
+    size_t tables = 0;
+    EXPECT_EQ(loader.ImportDirectory("small", 0, &tables),
+              WaveTableLoader::Result::OK);
+    EXPECT_EQ(tables, 10u);
+    EXPECT_EQ(FakeFs::NumDirReads(), 12u);
+
+    // a large one is sorted in several passes, names of different lengths
+    // are dropped from the batch and come again with the next one
+    FakeFs::NumDirReads() = 0;
+    for(size_t i = 0; i < 70; i++)
+    {
+        const std::string name = std::string(i % 7 + 1, 'x')
+                                 + std::to_string(1000 + i) + ".wav";
+        FakeFs::AddFile("large/" + name,
+                        MakeMonoWav(WAVE_FORMAT_PCM, 16, 16, i));
+    }
+    EXPECT_EQ(loader.ImportDirectory("large", 0, &tables),
+              WaveTableLoader::Result::OK);
+    EXPECT_EQ(tables, 70u);
+    EXPECT_EQ(FakeFs::NumDirReads(), 3u * 71u);
+    // "x1000.wav", "x1007.wav", ..., "xx1001.wav", ...
+    size_t table = 0;
+    for(size_t length = 0; length < 7; length++)
+        for(size_t i = length; i < 70; i += 7)
+            EXPECT_TRUE(ExpectSamples(loader.GetTable(table++), 16, i));
+}
@@ -0,0 +1,262 @@
+#pragma once
+#include "TestIsolator.h"
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+/** A fake of the parts of the FatFs API used by libDaisy, for unit tests.
+ *  It's found instead of the real ff.h since the tests directory is on the
+ *  include path. Files live in memory, separately for each test, and the
+ *  reads are recorded so tests can check their sizes and offsets.
+ */
+
+typedef unsigned int UINT;
+typedef uint8_t      BYTE;
+typedef uint16_t     WORD;
+typedef uint32_t     DWORD;
+typedef DWORD        FSIZE_t;
+typedef char         TCHAR;
+
+typedef enum
+{
+    FR_OK = 0,
+    FR_DISK_ERR,
+    FR_INT_ERR,
+    FR_NOT_READY,
+    FR_NO_FILE,
+    FR_NO_PATH,
+    FR_INVALID_NAME,
+    FR_DENIED,
+    FR_EXIST,
+    FR_INVALID_OBJECT,
+} FRESULT;
+
+typedef struct
+{
+    FSIZE_t objsize;
+} FFOBJID;
+
+typedef struct
+{
+    FFOBJID               obj;
+    FSIZE_t               fptr;
+    BYTE                  flag;
+    std::vector<uint8_t>* data;
+} FIL;
+
+#define FA_READ 0x01
+#define FA_WRITE 0x02
+#define FA_OPEN_EXISTING 0x00
+#define FA_CREATE_NEW 0x04
+#define FA_CREATE_ALWAYS 0x08
+#define FA_OPEN_ALWAYS 0x10
+#define FA_OPEN_APPEND 0x30
+
+#define AM_DIR 0x10
+
+#define _MAX_LFN 255
+
+typedef struct
+{
+    FSIZE_t fsize;
+    BYTE    fattrib;
+    TCHAR   fname[_MAX_LFN + 1];
+} FILINFO;
+
+typedef struct
+{
+    std::string path;
+    size_t      index;
+} DIR;
+
+#define f_eof(fp) ((int)((fp)->fptr == (fp)->obj.objsize))
+#define f_tell(fp) ((fp)->fptr)
+#define f_size(fp) ((fp)->obj.objsize)
+
+/** Test access to the fake file system */
+class FakeFs
+{
+  public:
+    struct Read
+    {
+        FSIZE_t offset;
+        UINT    size;
+    };
+
+    static void AddFile(const std::string& path, std::vector<uint8_t> data)
+    {
+        GetState()->files[path] = std::move(data);
+    }
+
+    /** Returns the file contents, or nullptr if it doesn't exist */
+    static std::vector<uint8_t>* GetFile(const std::string& path)
+    {
+        auto& files = GetState()->files;
+        auto  file  = files.find(path);
+        return file != files.end() ? &file->second : nullptr;
+    }
+
+    /** All f_read() calls of the current test */
+    static std::vector<Read>& GetReads() { return GetState()->reads; }
+
+    /** Makes all further reads and writes fail */
+    static void SetDiskError(bool error) { GetState()->disk_error = error; }
+
+    static bool HasDiskError() { return GetState()->disk_error; }
+
+    /** Number of directory entries read with f_readdir() */
+    static size_t& NumDirReads() { return GetState()->num_dir_reads; }
+
+    /** Returns the names in a directory, and whether they are directories */
+    static std::vector<std::pair<std::string, bool>>
+    GetDirectory(const std::string& path)
+    {
+        const std::string           prefix = path + "/";
+        std::map<std::string, bool> entries;
+        for(const auto& file : GetState()->files)
+        {
+            if(file.first.compare(0, prefix.size(), prefix) != 0)
+                continue;
+            const std::string rest  = file.first.substr(prefix.size());
+            const size_t      slash = rest.find('/');
+            entries[rest.substr(0, slash)] = slash != std::string::npos;
+        }
+        // not sorted, like on a real card
+        return {entries.rbegin(), entries.rend()};
+    }
+
+  private:
+    struct State
+    {
+        std::map<std::string, std::vector<uint8_t>> files;
+        std::vector<Read>                           reads;
+        bool                                        disk_error    = false;
+        size_t                                      num_dir_reads = 0;
+    };
+
+    static std::shared_ptr<State> GetState()
+    {
+        static TestIsolator<State> isolator;
+        return isolator.GetStateForCurrentTest();
+    }
+};
+
+inline FRESULT f_open(FIL* fp, const TCHAR* path, BYTE mode)
+{
+    auto file = FakeFs::GetFile(path);
+    if(file == nullptr || (mode & FA_CREATE_ALWAYS))
+    {
+        if(!(mode & (FA_CREATE_ALWAYS | FA_OPEN_ALWAYS | FA_CREATE_NEW)))
+        {
+            fp->data = nullptr;
+            return FR_NO_FILE;
+        }
+        FakeFs::AddFile(path, {});
+        file = FakeFs::GetFile(path);
+    }
+    fp->data        = file;
+    fp->flag        = mode;
+    fp->fptr        = 0;
+    fp->obj.objsize = FSIZE_t(file->size());
+    return FR_OK;
+}
+
+inline FRESULT f_close(FIL* fp)
+{
+    if(fp->data == nullptr)
+        return FR_INVALID_OBJECT;
+    fp->data = nullptr;
+    return FR_OK;
+}
+
+inline FRESULT f_read(FIL* fp, void* buff, UINT btr, UINT* br)
+{
+    *br = 0;
+    if(fp->data == nullptr)
+        return FR_INVALID_OBJECT;
+    if(FakeFs::HasDiskError())
+        return FR_DISK_ERR;
+    FakeFs::GetReads().push_back({fp->fptr, btr});
+    const FSIZE_t left = fp->obj.objsize - fp->fptr;
+    const UINT    num  = btr < left ? btr : UINT(left);
+    memcpy(buff, fp->data->data() + fp->fptr, num);
+    fp->fptr += num;
+    *br = num;
+    return FR_OK;
+}
+
+inline FRESULT f_write(FIL* fp, const void* buff, UINT btw, UINT* bw)
+{
+    *bw = 0;
+    if(fp->data == nullptr || !(fp->flag & FA_WRITE))
+        return FR_INVALID_OBJECT;
+    if(FakeFs::HasDiskError())
+        return FR_DISK_ERR;
+    if(fp->fptr + btw > fp->data->size())
+        fp->data->resize(fp->fptr + btw);
+    memcpy(fp->data->data() + fp->fptr, buff, btw);
+    fp->fptr += btw;
+    fp->obj.objsize = FSIZE_t(fp->data->size());
+    *bw = btw;
+    return FR_OK;
+}
+
+inline FRESULT f_lseek(FIL* fp, FSIZE_t ofs)
+{
+    if(fp->data == nullptr)
+        return FR_INVALID_OBJECT;
+    // like FatFs, seeking beyond the end of a read-only file clips
+    if(ofs > fp->obj.objsize && !(fp->flag & FA_WRITE))
+        ofs = fp->obj.objsize;
+    if(ofs > fp->obj.objsize)
+    {
+        fp->data->resize(ofs);
+        fp->obj.objsize = ofs;
+    }
+    fp->fptr = ofs;
+    return FR_OK;
+}
+
+inline FRESULT f_sync(FIL* fp)
+{
+    return fp->data != nullptr ? FR_OK : FR_INVALID_OBJECT;
+}
+
+inline FRESULT f_opendir(DIR* dp, const TCHAR* path)
+{
+    if(FakeFs::GetDirectory(path).empty())
+        return FR_NO_PATH;
+    dp->path  = path;
+    dp->index = 0;
+    return FR_OK;
+}
+
+/** Reads the next entry, or rewinds if fno is nullptr */
+inline FRESULT f_readdir(DIR* dp, FILINFO* fno)
+{
+    if(FakeFs::HasDiskError())
+        return FR_DISK_ERR;
+    if(fno == nullptr)
+    {
+        dp->index = 0;
+        return FR_OK;
+    }
+    FakeFs::NumDirReads()++;
+    const auto entries = FakeFs::GetDirectory(dp->path);
+    memset(fno, 0, sizeof(*fno));
+    if(dp->index >= entries.size())
+        return FR_OK;
+    const auto& entry = entries[dp->index++];
+    strncpy(fno->fname, entry.first.c_str(), _MAX_LFN);
+    fno->fattrib = entry.second ? AM_DIR : 0;
+    if(!entry.second)
+        fno->fsize = FakeFs::GetFile(dp->path + "/" + entry.first)->size();
+    return FR_OK;
+}
+
+inline FRESULT f_closedir(DIR*)
+{
+    return FR_OK;
+}
@@ -1,7 +1,21 @@
 #include "sys/system.cpp"
 #include "ui/AbstractMenu.cpp"
+#include "ui/FullScreenItemMenu.cpp"
 #include "ui/UI.cpp"
 #include "util/MappedValue.cpp"
-#include "util/oled_fonts.c"
+#include "util/oled_fonts_4x6.cpp"
+#include "util/oled_fonts_4x8.cpp"
+#include "util/oled_fonts_5x8.cpp"
+#include "util/oled_fonts_6x7.cpp"
+#include "util/oled_fonts_6x8.cpp"
+#include "util/oled_fonts_7x10.cpp"
+#include "util/oled_fonts_11x18.cpp"
+#include "util/oled_fonts_16x26.cpp"
 #include "per/qspi.cpp"
 #include "hid/midi_parser.cpp"
+#include "per/sai.cpp"
+#include "hid/audio.cpp"
+#include "util/WavParser.cpp"
+#include "util/DeferredFormat.cpp"
+#include "hid/wavstreamer.cpp"
+#include "util/WaveTableLoader.cpp"